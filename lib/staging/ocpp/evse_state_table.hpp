@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVEREST_EVSE_STATE_TABLE_HPP
+#define EVEREST_EVSE_STATE_TABLE_HPP
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// \brief State of the EVSEs that the OCPP modules keep next to libocpp, indexed by the EVerest EVSE id (starting at
+/// 1). The number of EVSEs is fixed at construction, so the table never changes its layout.
+///
+/// Every field is a single atomic: the event callbacks of the EvseManagers write it, the meter value callbacks read it
+/// without taking a lock.
+class EvseStateTable {
+public:
+    explicit EvseStateTable(std::size_t evse_count) : entries(evse_count) {
+    }
+
+    EvseStateTable(const EvseStateTable&) = delete;
+    EvseStateTable& operator=(const EvseStateTable&) = delete;
+
+    std::size_t size() const {
+        return entries.size();
+    }
+
+    /// \brief the EVSE has sent its ready signal
+    void set_ready(std::int32_t evse_id) {
+        entry(evse_id).ready.store(true, std::memory_order_release);
+    }
+
+    bool is_ready(std::int32_t evse_id) const {
+        return entry(evse_id).ready.load(std::memory_order_acquire);
+    }
+
+    bool all_ready() const {
+        for (const auto& e : entries) {
+            if (not e.ready.load(std::memory_order_acquire)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// \brief SoC in percent last reported by the EV of the current session
+    void set_soc(std::int32_t evse_id, float soc_percent) {
+        entry(evse_id).soc.store(soc_percent, std::memory_order_relaxed);
+    }
+
+    /// \brief forget the SoC, e.g. at the end of the session
+    void reset_soc(std::int32_t evse_id) {
+        entry(evse_id).soc.store(NO_SOC, std::memory_order_relaxed);
+    }
+
+    std::optional<float> get_soc(std::int32_t evse_id) const {
+        const auto soc = entry(evse_id).soc.load(std::memory_order_relaxed);
+        if (std::isnan(soc)) {
+            return std::nullopt;
+        }
+        return soc;
+    }
+
+private:
+    static constexpr float NO_SOC = std::numeric_limits<float>::quiet_NaN();
+
+    struct Entry {
+        std::atomic<bool> ready{false};
+        std::atomic<float> soc{NO_SOC};
+    };
+
+    const Entry& entry(std::int32_t evse_id) const {
+        if (evse_id < 1 or static_cast<std::size_t>(evse_id) > entries.size()) {
+            throw std::out_of_range("No EVSE with id " + std::to_string(evse_id));
+        }
+        return entries[evse_id - 1];
+    }
+
+    Entry& entry(std::int32_t evse_id) {
+        return const_cast<Entry&>(static_cast<const EvseStateTable&>(*this).entry(evse_id));
+    }
+
+    // constructed once with the number of EVSEs and never resized
+    std::vector<Entry> entries;
+};
+
+#endif // EVEREST_EVSE_STATE_TABLE_HPP
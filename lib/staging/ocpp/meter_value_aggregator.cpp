@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <meter_value_aggregator.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+MeterValueReduction meter_value_reduction_from_string(const std::string& reduction) {
+    if (reduction == "Last") {
+        return MeterValueReduction::Last;
+    }
+    if (reduction == "Average") {
+        return MeterValueReduction::Average;
+    }
+    if (reduction == "Minimum") {
+        return MeterValueReduction::Minimum;
+    }
+    if (reduction == "Maximum") {
+        return MeterValueReduction::Maximum;
+    }
+    throw std::out_of_range("Provided string " + reduction + " could not be converted to enum of type MeterValueReduction");
+}
+
+void MeterValueAggregator::Statistics::add(float value) {
+    if (count == 0) {
+        minimum = value;
+        maximum = value;
+    } else {
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+    }
+    count++;
+    sum += value;
+    last = value;
+}
+
+float MeterValueAggregator::Statistics::reduce(MeterValueReduction reduction) const {
+    switch (reduction) {
+    case MeterValueReduction::Average:
+        return static_cast<float>(sum / count);
+    case MeterValueReduction::Minimum:
+        return minimum;
+    case MeterValueReduction::Maximum:
+        return maximum;
+    case MeterValueReduction::Last:
+        break;
+    }
+    return last;
+}
+
+MeterValueAggregator::MeterValueAggregator(std::chrono::seconds interval, MeterValueReduction reduction) :
+    interval(interval), reduction(reduction) {
+    if (interval.count() <= 0) {
+        throw std::invalid_argument("MeterValueAggregator: interval must be positive");
+    }
+}
+
+std::optional<types::powermeter::Powermeter>
+MeterValueAggregator::add(const types::powermeter::Powermeter& sample, std::chrono::system_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::optional<types::powermeter::Powermeter> completed;
+    const auto sample_interval = interval_of(now);
+    if (sample_interval != current_interval) {
+        completed = reduce_and_reset();
+        current_interval = sample_interval;
+    }
+
+    collect(sample);
+    // copy assignment reuses the storage of the previous sample
+    last_sample = sample;
+    return completed;
+}
+
+std::optional<types::powermeter::Powermeter>
+MeterValueAggregator::close_if_due(std::chrono::system_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (interval_of(now) <= current_interval) {
+        return std::nullopt;
+    }
+    // the next sample starts the new interval
+    return reduce_and_reset();
+}
+
+std::optional<types::powermeter::Powermeter> MeterValueAggregator::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reduce_and_reset();
+}
+
+std::int64_t MeterValueAggregator::interval_of(std::chrono::system_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()) / interval;
+}
+
+void MeterValueAggregator::collect(Channel channel, float value) {
+    statistics[channel].add(value);
+}
+
+void MeterValueAggregator::collect(Channel channel, const std::optional<float>& value) {
+    if (value.has_value()) {
+        statistics[channel].add(value.value());
+    }
+}
+
+void MeterValueAggregator::collect(const types::powermeter::Powermeter& sample) {
+    if (sample.power_W.has_value()) {
+        const auto& power = sample.power_W.value();
+        collect(PowerTotal, power.total);
+        collect(PowerL1, power.L1);
+        collect(PowerL2, power.L2);
+        collect(PowerL3, power.L3);
+    }
+    if (sample.VAR.has_value()) {
+        const auto& var = sample.VAR.value();
+        collect(ReactivePowerTotal, var.total);
+        collect(ReactivePowerL1, var.L1);
+        collect(ReactivePowerL2, var.L2);
+        collect(ReactivePowerL3, var.L3);
+    }
+    if (sample.voltage_V.has_value()) {
+        const auto& voltage = sample.voltage_V.value();
+        collect(VoltageDC, voltage.DC);
+        collect(VoltageL1, voltage.L1);
+        collect(VoltageL2, voltage.L2);
+        collect(VoltageL3, voltage.L3);
+    }
+    if (sample.current_A.has_value()) {
+        const auto& current = sample.current_A.value();
+        collect(CurrentDC, current.DC);
+        collect(CurrentL1, current.L1);
+        collect(CurrentL2, current.L2);
+        collect(CurrentL3, current.L3);
+        collect(CurrentN, current.N);
+    }
+    if (sample.frequency_Hz.has_value()) {
+        const auto& frequency = sample.frequency_Hz.value();
+        collect(FrequencyL1, frequency.L1);
+        collect(FrequencyL2, frequency.L2);
+        collect(FrequencyL3, frequency.L3);
+    }
+}
+
+bool MeterValueAggregator::has_values(Channel channel) const {
+    return statistics[channel].count > 0;
+}
+
+void MeterValueAggregator::apply(Channel channel, float& value) const {
+    if (has_values(channel)) {
+        value = statistics[channel].reduce(reduction);
+    }
+}
+
+void MeterValueAggregator::apply(Channel channel, std::optional<float>& value) const {
+    if (has_values(channel)) {
+        value = statistics[channel].reduce(reduction);
+    }
+}
+
+std::optional<types::powermeter::Powermeter> MeterValueAggregator::reduce_and_reset() {
+    if (not last_sample.has_value()) {
+        return std::nullopt;
+    }
+
+    auto result = std::move(last_sample.value());
+    last_sample.reset();
+
+    if (reduction != MeterValueReduction::Last) {
+        // a measurand missing in the last sample is added if earlier samples of the interval had it
+        if (has_values(PowerTotal)) {
+            auto& power = result.power_W.has_value() ? result.power_W.value() : result.power_W.emplace();
+            apply(PowerTotal, power.total);
+            apply(PowerL1, power.L1);
+            apply(PowerL2, power.L2);
+            apply(PowerL3, power.L3);
+            result.power_W_signed.reset();
+        }
+        if (has_values(ReactivePowerTotal)) {
+            auto& var = result.VAR.has_value() ? result.VAR.value() : result.VAR.emplace();
+            apply(ReactivePowerTotal, var.total);
+            apply(ReactivePowerL1, var.L1);
+            apply(ReactivePowerL2, var.L2);
+            apply(ReactivePowerL3, var.L3);
+            result.VAR_signed.reset();
+        }
+        if (has_values(VoltageDC) or has_values(VoltageL1) or has_values(VoltageL2) or has_values(VoltageL3)) {
+            auto& voltage = result.voltage_V.has_value() ? result.voltage_V.value() : result.voltage_V.emplace();
+            apply(VoltageDC, voltage.DC);
+            apply(VoltageL1, voltage.L1);
+            apply(VoltageL2, voltage.L2);
+            apply(VoltageL3, voltage.L3);
+            result.voltage_V_signed.reset();
+        }
+        if (has_values(CurrentDC) or has_values(CurrentL1) or has_values(CurrentL2) or has_values(CurrentL3) or
+            has_values(CurrentN)) {
+            auto& current = result.current_A.has_value() ? result.current_A.value() : result.current_A.emplace();
+            apply(CurrentDC, current.DC);
+            apply(CurrentL1, current.L1);
+            apply(CurrentL2, current.L2);
+            apply(CurrentL3, current.L3);
+            apply(CurrentN, current.N);
+            result.current_A_signed.reset();
+        }
+        if (has_values(FrequencyL1)) {
+            auto& frequency =
+                result.frequency_Hz.has_value() ? result.frequency_Hz.value() : result.frequency_Hz.emplace();
+            apply(FrequencyL1, frequency.L1);
+            apply(FrequencyL2, frequency.L2);
+            apply(FrequencyL3, frequency.L3);
+            result.frequency_Hz_signed.reset();
+        }
+    }
+
+    statistics.fill(Statistics{});
+    return result;
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVEREST_METER_VALUE_AGGREGATOR_HPP
+#define EVEREST_METER_VALUE_AGGREGATOR_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <generated/types/powermeter.hpp>
+
+/// \brief Reduction applied to the instantaneous measurands (power, reactive power, voltage, current, frequency) of
+/// all samples of one interval. Energy registers are cumulative and always taken from the last sample.
+enum class MeterValueReduction {
+    Last,
+    Average,
+    Minimum,
+    Maximum
+};
+
+/// \brief Converts "Last", "Average", "Minimum" or "Maximum" to a MeterValueReduction, throws std::out_of_range
+/// otherwise
+MeterValueReduction meter_value_reduction_from_string(const std::string& reduction);
+
+/// \brief Collects the powermeter samples of one EVSE and emits one meter value per interval.
+///
+/// Intervals are aligned to the system clock (e.g. an interval of 900s ends at :00, :15, :30 and :45), like the
+/// aligned data interval of OCPP. Every measurand keeps fixed size running statistics, so adding a sample is O(1) and
+/// does not allocate. The emitted meter value is the last sample of the interval with its instantaneous measurands
+/// replaced by the configured reduction. Signed values of reduced measurands are removed, since they do not match the
+/// reduced value anymore.
+class MeterValueAggregator {
+public:
+    MeterValueAggregator(std::chrono::seconds interval, MeterValueReduction reduction);
+
+    /// \brief Adds \p sample received at \p now. Returns the meter value of the previous interval if \p now is in a
+    /// later interval than the samples collected so far. Thread safe.
+    std::optional<types::powermeter::Powermeter> add(const types::powermeter::Powermeter& sample,
+                                                     std::chrono::system_clock::time_point now);
+
+    /// \brief Returns the meter value of the previous interval if \p now is in a later interval than the samples
+    /// collected so far, std::nullopt otherwise. Call it periodically, so an interval is emitted at its end and not only
+    /// with the first sample of the next one. Thread safe.
+    std::optional<types::powermeter::Powermeter> close_if_due(std::chrono::system_clock::time_point now);
+
+    /// \brief Returns the meter value of the samples collected so far and starts a new interval, std::nullopt if there
+    /// are none. Call it before a transaction ends, so its last interval is sent with it. Thread safe.
+    std::optional<types::powermeter::Powermeter> flush();
+
+private:
+    enum Channel {
+        PowerTotal,
+        PowerL1,
+        PowerL2,
+        PowerL3,
+        ReactivePowerTotal,
+        ReactivePowerL1,
+        ReactivePowerL2,
+        ReactivePowerL3,
+        VoltageDC,
+        VoltageL1,
+        VoltageL2,
+        VoltageL3,
+        CurrentDC,
+        CurrentL1,
+        CurrentL2,
+        CurrentL3,
+        CurrentN,
+        FrequencyL1,
+        FrequencyL2,
+        FrequencyL3,
+        CHANNEL_COUNT
+    };
+
+    struct Statistics {
+        std::uint32_t count{0};
+        double sum{0};
+        float minimum{0};
+        float maximum{0};
+        float last{0};
+
+        void add(float value);
+        float reduce(MeterValueReduction reduction) const;
+    };
+
+    void collect(Channel channel, float value);
+    void collect(Channel channel, const std::optional<float>& value);
+    void collect(const types::powermeter::Powermeter& sample);
+    bool has_values(Channel channel) const;
+    void apply(Channel channel, float& value) const;
+    void apply(Channel channel, std::optional<float>& value) const;
+    std::int64_t interval_of(std::chrono::system_clock::time_point time) const;
+    // must be called with mutex locked
+    std::optional<types::powermeter::Powermeter> reduce_and_reset();
+
+    const std::chrono::seconds interval;
+    const MeterValueReduction reduction;
+
+    std::mutex mutex;
+    std::array<Statistics, CHANNEL_COUNT> statistics;
+    std::optional<types::powermeter::Powermeter> last_sample;
+    std::int64_t current_interval{0};
+};
+
+#endif // EVEREST_METER_VALUE_AGGREGATOR_HPP
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <evse_state_table.hpp>
+
+namespace {
+
+TEST(EvseStateTable, readiness) {
+    EvseStateTable table(2);
+    EXPECT_FALSE(table.all_ready());
+    table.set_ready(2);
+    EXPECT_FALSE(table.is_ready(1));
+    EXPECT_TRUE(table.is_ready(2));
+    table.set_ready(1);
+    EXPECT_TRUE(table.all_ready());
+}
+
+TEST(EvseStateTable, soc) {
+    EvseStateTable table(2);
+    EXPECT_FALSE(table.get_soc(1).has_value());
+    table.set_soc(1, 42.5f);
+    EXPECT_EQ(table.get_soc(1), 42.5f);
+    EXPECT_FALSE(table.get_soc(2).has_value());
+    table.reset_soc(1);
+    EXPECT_FALSE(table.get_soc(1).has_value());
+}
+
+TEST(EvseStateTable, unknownEvse) {
+    EvseStateTable table(2);
+    EXPECT_THROW(table.get_soc(0), std::out_of_range);
+    EXPECT_THROW(table.set_soc(3, 10.f), std::out_of_range);
+    EXPECT_THROW(table.is_ready(-1), std::out_of_range);
+}
+
+// one writer per EVSE like the ev_info and session event callbacks, readers like the powermeter callbacks
+TEST(EvseStateTable, concurrentAccess) {
+    constexpr int evse_count = 4;
+    constexpr int updates = 20000;
+    EvseStateTable table(evse_count);
+
+    std::vector<std::thread> threads;
+    for (int evse_id = 1; evse_id <= evse_count; evse_id++) {
+        threads.emplace_back([&table, evse_id]() {
+            for (int i = 0; i < updates; i++) {
+                if (i % 100 == 99) {
+                    table.reset_soc(evse_id);
+                } else {
+                    table.set_soc(evse_id, static_cast<float>(evse_id * 1000 + i % 100));
+                }
+            }
+            table.set_ready(evse_id);
+        });
+    }
+
+    std::atomic<bool> wrong_value{false};
+    for (int reader = 0; reader < 2; reader++) {
+        threads.emplace_back([&table, &wrong_value]() {
+            while (not table.all_ready()) {
+                for (int evse_id = 1; evse_id <= evse_count; evse_id++) {
+                    const auto soc = table.get_soc(evse_id);
+                    // only values written for this EVSE may be read
+                    if (soc.has_value() and (soc.value() < evse_id * 1000 or soc.value() >= evse_id * 1000 + 99)) {
+                        wrong_value = true;
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(wrong_value);
+    // the last update of every writer was a reset
+    for (int evse_id = 1; evse_id <= evse_count; evse_id++) {
+        EXPECT_FALSE(table.get_soc(evse_id).has_value());
+    }
+}
+
+} // namespace
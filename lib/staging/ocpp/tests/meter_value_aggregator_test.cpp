@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <gtest/gtest.h>
+
+#include <meter_value_aggregator.hpp>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+types::powermeter::Powermeter sample(float energy, float power, std::optional<float> voltage = std::nullopt) {
+    types::powermeter::Powermeter powermeter;
+    powermeter.timestamp = "2024-01-01T00:00:00Z";
+    powermeter.energy_Wh_import.total = energy;
+    powermeter.power_W = types::units::Power{};
+    powermeter.power_W->total = power;
+    if (voltage.has_value()) {
+        powermeter.voltage_V = types::units::Voltage{};
+        powermeter.voltage_V->L1 = voltage;
+    }
+    return powermeter;
+}
+
+// 60s intervals, start of an interval
+const std::chrono::system_clock::time_point interval_start{std::chrono::seconds(1704067200)};
+
+TEST(MeterValueAggregator, emitsAtIntervalBoundary) {
+    MeterValueAggregator aggregator(60s, MeterValueReduction::Average);
+
+    EXPECT_FALSE(aggregator.add(sample(100, 1000), interval_start).has_value());
+    EXPECT_FALSE(aggregator.add(sample(110, 2000), interval_start + 20s).has_value());
+    EXPECT_FALSE(aggregator.add(sample(120, 6000), interval_start + 59s).has_value());
+
+    // the first sample of the next interval completes the previous one
+    const auto meter_value = aggregator.add(sample(130, 5000), interval_start + 60s);
+    ASSERT_TRUE(meter_value.has_value());
+    // energy is taken from the last sample, power is averaged
+    EXPECT_FLOAT_EQ(meter_value->energy_Wh_import.total, 120);
+    EXPECT_FLOAT_EQ(meter_value->power_W->total, 3000);
+
+    const auto rest = aggregator.flush();
+    ASSERT_TRUE(rest.has_value());
+    EXPECT_FLOAT_EQ(rest->power_W->total, 5000);
+    EXPECT_FALSE(aggregator.flush().has_value());
+}
+
+TEST(MeterValueAggregator, closesIntervalWithoutNextSample) {
+    MeterValueAggregator aggregator(60s, MeterValueReduction::Average);
+    EXPECT_FALSE(aggregator.close_if_due(interval_start + 120s).has_value());
+
+    aggregator.add(sample(100, 1000), interval_start);
+    aggregator.add(sample(110, 3000), interval_start + 30s);
+    EXPECT_FALSE(aggregator.close_if_due(interval_start + 59s).has_value());
+
+    const auto meter_value = aggregator.close_if_due(interval_start + 60s);
+    ASSERT_TRUE(meter_value.has_value());
+    EXPECT_FLOAT_EQ(meter_value->energy_Wh_import.total, 110);
+    EXPECT_FLOAT_EQ(meter_value->power_W->total, 2000);
+    EXPECT_FALSE(aggregator.close_if_due(interval_start + 61s).has_value());
+
+    // the next sample starts a new interval without emitting anything
+    EXPECT_FALSE(aggregator.add(sample(120, 5000), interval_start + 70s).has_value());
+    const auto next = aggregator.close_if_due(interval_start + 120s);
+    ASSERT_TRUE(next.has_value());
+    EXPECT_FLOAT_EQ(next->power_W->total, 5000);
+}
+
+TEST(MeterValueAggregator, reductions) {
+    const std::vector<std::pair<MeterValueReduction, float>> expected{{MeterValueReduction::Last, 2000},
+                                                                      {MeterValueReduction::Average, 2000},
+                                                                      {MeterValueReduction::Minimum, 1000},
+                                                                      {MeterValueReduction::Maximum, 3000}};
+    for (const auto& [reduction, power] : expected) {
+        MeterValueAggregator aggregator(60s, reduction);
+        aggregator.add(sample(1, 1000), interval_start);
+        aggregator.add(sample(2, 3000), interval_start + 1s);
+        aggregator.add(sample(3, 2000), interval_start + 2s);
+        const auto meter_value = aggregator.flush();
+        ASSERT_TRUE(meter_value.has_value());
+        EXPECT_FLOAT_EQ(meter_value->power_W->total, power);
+        EXPECT_FLOAT_EQ(meter_value->energy_Wh_import.total, 3);
+    }
+}
+
+TEST(MeterValueAggregator, measurandMissingInLastSample) {
+    MeterValueAggregator aggregator(60s, MeterValueReduction::Maximum);
+    aggregator.add(sample(1, 1000, 230), interval_start);
+    aggregator.add(sample(2, 1000, 235), interval_start + 1s);
+    aggregator.add(sample(3, 1000), interval_start + 2s);
+
+    const auto meter_value = aggregator.flush();
+    ASSERT_TRUE(meter_value.has_value());
+    ASSERT_TRUE(meter_value->voltage_V.has_value());
+    EXPECT_FLOAT_EQ(meter_value->voltage_V->L1.value(), 235);
+    EXPECT_FALSE(meter_value->voltage_V->L2.has_value());
+}
+
+TEST(MeterValueAggregator, invalidConfiguration) {
+    EXPECT_THROW(MeterValueAggregator(0s, MeterValueReduction::Last), std::invalid_argument);
+    EXPECT_THROW(meter_value_reduction_from_string("Median"), std::out_of_range);
+    EXPECT_EQ(meter_value_reduction_from_string("Maximum"), MeterValueReduction::Maximum);
+}
+
+} // namespace
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <startup_profiler/startup_profiler.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <everest/logging.hpp>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+std::optional<std::string> get_report_dir() {
+    const char* dir = std::getenv("EVEREST_STARTUP_REPORT_DIR");
+    if (dir == nullptr or *dir == '\0') {
+        return std::nullopt;
+    }
+    return std::string(dir);
+}
+
+const char* to_string(StartupProfiler::Kind kind) {
+    switch (kind) {
+    case StartupProfiler::Kind::Phase:
+        return "phase";
+    case StartupProfiler::Kind::Concurrent:
+        return "concurrent";
+    case StartupProfiler::Kind::Milestone:
+        return "milestone";
+    }
+    return "unknown";
+}
+
+double to_ms(StartupProfiler::clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+StartupProfiler::Phase::Phase(StartupProfiler* profiler, std::string name) :
+    profiler(profiler),
+    name(std::move(name)),
+    start(std::chrono::system_clock::now()),
+    steady_start(clock::now()) {
+}
+
+StartupProfiler::Phase::Phase(Phase&& other) noexcept :
+    profiler(other.profiler),
+    name(std::move(other.name)),
+    start(other.start),
+    steady_start(other.steady_start) {
+    other.profiler = nullptr;
+}
+
+StartupProfiler::Phase::~Phase() {
+    done();
+}
+
+void StartupProfiler::Phase::done() {
+    if (profiler == nullptr) {
+        return;
+    }
+    profiler->record({std::move(name), Kind::Phase, start, clock::now() - steady_start});
+    profiler = nullptr;
+}
+
+StartupProfiler::StartupProfiler(const std::string& module_id) :
+    module_id(module_id), report_dir(get_report_dir()), created(std::chrono::system_clock::now()) {
+}
+
+StartupProfiler::~StartupProfiler() {
+    wait();
+}
+
+void StartupProfiler::wait() {
+    std::vector<std::thread> running;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running.swap(threads);
+    }
+    for (auto& thread : running) {
+        thread.join();
+    }
+}
+
+StartupProfiler::Phase StartupProfiler::measure(const std::string& name) {
+    return Phase(this, name);
+}
+
+void StartupProfiler::mark(const std::string& name) {
+    record({name, Kind::Milestone, std::chrono::system_clock::now(), clock::duration::zero()});
+}
+
+std::shared_future<void> StartupProfiler::run_concurrently(const std::string& name, std::function<void()> work) {
+    auto task = std::make_shared<std::packaged_task<void()>>(std::move(work));
+    std::shared_future<void> result = task->get_future().share();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.emplace_back([this, name, task, result]() {
+        const auto start = std::chrono::system_clock::now();
+        const auto steady_start = clock::now();
+        (*task)();
+        bool failed = false;
+        try {
+            result.get();
+        } catch (const std::exception& e) {
+            EVLOG_error << module_id << ": " << name << " failed during startup: " << e.what();
+            failed = true;
+        }
+        record({name, Kind::Concurrent, start, clock::now() - steady_start, failed});
+    });
+    return result;
+}
+
+void StartupProfiler::ready_done() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ready) {
+        return;
+    }
+    ready = true;
+
+    std::ostringstream summary;
+    summary << "Startup of " << module_id << " took "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - created).count()
+            << "ms";
+    for (const auto& entry : entries) {
+        if (entry.kind == Kind::Milestone) {
+            continue;
+        }
+        summary << ", " << entry.name << " "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(entry.duration).count() << "ms";
+        if (entry.kind == Kind::Concurrent) {
+            summary << " (concurrent)";
+        }
+    }
+    EVLOG_info << summary.str();
+
+    write_report_unlocked();
+}
+
+std::vector<StartupProfiler::Entry> StartupProfiler::get_entries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries;
+}
+
+std::string StartupProfiler::get_report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return get_report_unlocked();
+}
+
+void StartupProfiler::record(Entry entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(std::move(entry));
+    if (ready) {
+        write_report_unlocked();
+    }
+}
+
+std::string StartupProfiler::get_report_unlocked() const {
+    const auto to_epoch_ms = [](std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    };
+
+    nlohmann::json report;
+    report["module"] = module_id;
+    report["created_ms"] = to_epoch_ms(created);
+    report["ready"] = ready;
+    report["entries"] = nlohmann::json::array();
+    for (const auto& entry : entries) {
+        report["entries"].push_back({{"name", entry.name},
+                                     {"kind", to_string(entry.kind)},
+                                     {"start_ms", to_epoch_ms(entry.start)},
+                                     {"duration_ms", to_ms(entry.duration)},
+                                     {"failed", entry.failed}});
+    }
+    return report.dump();
+}
+
+void StartupProfiler::write_report_unlocked() const {
+    if (not report_dir.has_value()) {
+        return;
+    }
+
+    // written to a temporary file first, so readers never see a partial report
+    const auto path = report_dir.value() + "/" + module_id + ".json";
+    const auto tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::trunc);
+        if (not file) {
+            EVLOG_warning << "Could not write startup report to " << tmp_path;
+            return;
+        }
+        file << get_report_unlocked() << "\n";
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        EVLOG_warning << "Could not write startup report to " << path;
+    }
+}
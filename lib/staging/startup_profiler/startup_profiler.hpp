@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVEREST_STARTUP_PROFILER_HPP
+#define EVEREST_STARTUP_PROFILER_HPP
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// \brief Records how long the startup of a module takes and runs the expensive parts of it off the critical path.
+///
+/// The manager calls ready() of all modules only after init() of every module has returned, so the slowest init()
+/// delays the whole charger. Work that is not needed to answer the first command can be started from init() with
+/// run_concurrently().
+///
+/// If the environment variable EVEREST_STARTUP_REPORT_DIR is set, the report is written to
+/// EVEREST_STARTUP_REPORT_DIR/<module id>.json whenever an entry has been recorded after ready_done(). A summary is
+/// logged at ready_done() in any case.
+class StartupProfiler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    enum class Kind {
+        Phase,      //!< measured on the thread calling init() or ready()
+        Concurrent, //!< started with run_concurrently()
+        Milestone   //!< recorded with mark()
+    };
+
+    struct Entry {
+        std::string name;
+        Kind kind;
+        std::chrono::system_clock::time_point start;
+        clock::duration duration;
+        bool failed{false};
+    };
+
+    /// \brief Measures a phase from its creation until it is destroyed or done() is called
+    class Phase {
+    public:
+        Phase(Phase&& other) noexcept;
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+        Phase& operator=(Phase&&) = delete;
+        ~Phase();
+
+        void done();
+
+    private:
+        friend class StartupProfiler;
+        Phase(StartupProfiler* profiler, std::string name);
+
+        StartupProfiler* profiler;
+        std::string name;
+        std::chrono::system_clock::time_point start;
+        clock::time_point steady_start;
+    };
+
+    explicit StartupProfiler(const std::string& module_id);
+    StartupProfiler(const StartupProfiler&) = delete;
+    StartupProfiler& operator=(const StartupProfiler&) = delete;
+
+    /// \brief Waits for concurrent work that is still running
+    ~StartupProfiler();
+
+    [[nodiscard]] Phase measure(const std::string& name);
+
+    /// \brief Records that the module reached \p name, e.g. when it accepts EVs
+    void mark(const std::string& name);
+
+    /// \brief Starts \p work on its own thread immediately. The returned future becomes ready when \p work has
+    /// finished, get() rethrows its exception.
+    std::shared_future<void> run_concurrently(const std::string& name, std::function<void()> work);
+
+    /// \brief Marks the end of the startup of the module: logs the summary and writes the report
+    void ready_done();
+
+    /// \brief Waits until the concurrent work started so far has finished
+    void wait();
+
+    std::vector<Entry> get_entries() const;
+
+    /// \brief The report as JSON
+    std::string get_report() const;
+
+private:
+    void record(Entry entry);
+    // must be called with mutex locked
+    std::string get_report_unlocked() const;
+    void write_report_unlocked() const;
+
+    const std::string module_id;
+    const std::optional<std::string> report_dir;
+    const std::chrono::system_clock::time_point created;
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::vector<std::thread> threads;
+    bool ready{false};
+};
+
+#endif // EVEREST_STARTUP_PROFILER_HPP
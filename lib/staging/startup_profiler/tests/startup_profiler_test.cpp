@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <gtest/gtest.h>
+#include <startup_profiler/startup_profiler.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+using namespace std::chrono_literals;
+using Kind = StartupProfiler::Kind;
+
+const StartupProfiler::Entry* find(const std::vector<StartupProfiler::Entry>& entries, const std::string& name) {
+    for (const auto& entry : entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+TEST(StartupProfiler, measuresPhases) {
+    StartupProfiler profiler("module");
+    {
+        auto phase = profiler.measure("init");
+        std::this_thread::sleep_for(20ms);
+    }
+    auto phase = profiler.measure("ready");
+    phase.done();
+    profiler.mark("ready_to_charge");
+
+    const auto entries = profiler.get_entries();
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].name, "init");
+    EXPECT_EQ(entries[0].kind, Kind::Phase);
+    EXPECT_GE(entries[0].duration, 20ms);
+    EXPECT_EQ(entries[1].name, "ready");
+    EXPECT_EQ(entries[2].kind, Kind::Milestone);
+}
+
+TEST(StartupProfiler, runsConcurrentWorkBeyondPhase) {
+    StartupProfiler profiler("module");
+    std::atomic<bool> release{false};
+
+    std::shared_future<void> loaded;
+    {
+        auto phase = profiler.measure("init");
+        loaded = profiler.run_concurrently("load", [&release]() {
+            while (not release) {
+                std::this_thread::sleep_for(1ms);
+            }
+        });
+    }
+    // init returned while the work is still running
+    EXPECT_EQ(loaded.wait_for(0s), std::future_status::timeout);
+
+    release = true;
+    loaded.get();
+
+    auto failing = profiler.run_concurrently("fail", []() { throw std::runtime_error("no certificates"); });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+
+    profiler.wait();
+    const auto entries = profiler.get_entries();
+    const auto load = find(entries, "load");
+    ASSERT_NE(load, nullptr);
+    EXPECT_EQ(load->kind, Kind::Concurrent);
+    EXPECT_FALSE(load->failed);
+    const auto fail = find(entries, "fail");
+    ASSERT_NE(fail, nullptr);
+    EXPECT_TRUE(fail->failed);
+}
+
+TEST(StartupProfiler, writesReport) {
+    const auto dir = std::filesystem::temp_directory_path() / "startup_profiler_test";
+    std::filesystem::create_directories(dir);
+    setenv("EVEREST_STARTUP_REPORT_DIR", dir.c_str(), 1);
+
+    {
+        StartupProfiler profiler("evse_manager_1");
+        profiler.measure("init").done();
+        profiler.ready_done();
+        // recorded after ready, the report is written again
+        profiler.run_concurrently("cleanup", []() {});
+    }
+    unsetenv("EVEREST_STARTUP_REPORT_DIR");
+
+    std::ifstream file(dir / "evse_manager_1.json");
+    ASSERT_TRUE(file.good());
+    const auto report = nlohmann::json::parse(file);
+    EXPECT_EQ(report.at("module"), "evse_manager_1");
+    EXPECT_TRUE(report.at("ready").get<bool>());
+    ASSERT_EQ(report.at("entries").size(), 2);
+    EXPECT_EQ(report.at("entries").at(0).at("name"), "init");
+    EXPECT_EQ(report.at("entries").at(1).at("kind"), "concurrent");
+
+    std::filesystem::remove_all(dir);
+}
+
+} // namespace
@@ -2,6 +2,7 @@
 // Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
 
 #include <cassert>
+#include <climits>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -240,11 +241,34 @@ bool base64_decode(const char* text, std::size_t len, std::uint8_t* out_data, st
     assert(out_data != nullptr);
 
     bool bResult = false;
-    auto res = base64_decode(text, len);
-    if ((res.size() > 0) && (res.size() <= out_len)) {
-        std::memcpy(out_data, res.data(), res.size());
-        out_len = res.size();
-        bResult = true;
+
+    // callers may include the terminating \0 in len
+    while ((len > 0) && (text[len - 1] == '\0')) {
+        len--;
+    }
+
+    // decode straight into out_data when it is large enough for any input of this length
+    if ((len > 0) && (out_len >= ((len + 3) / 4) * 3) && (len <= static_cast<std::size_t>(INT_MAX))) {
+        auto* ctx = EVP_ENCODE_CTX_new();
+        if (ctx != nullptr) {
+            int update_len{0};
+            int final_len{0};
+            EVP_DecodeInit(ctx);
+            if ((EVP_DecodeUpdate(ctx, out_data, &update_len, reinterpret_cast<const unsigned char*>(text),
+                                  static_cast<int>(len)) >= 0) &&
+                (EVP_DecodeFinal(ctx, out_data + update_len, &final_len) == 1) && ((update_len + final_len) > 0)) {
+                out_len = static_cast<std::size_t>(update_len) + static_cast<std::size_t>(final_len);
+                bResult = true;
+            }
+            EVP_ENCODE_CTX_free(ctx);
+        }
+    } else {
+        auto res = base64_decode(text, len);
+        if ((res.size() > 0) && (res.size() <= out_len)) {
+            std::memcpy(out_data, res.data(), res.size());
+            out_len = res.size();
+            bResult = true;
+        }
     }
     return bResult;
 }
@@ -131,6 +131,17 @@ TEST(openssl, base64Decode) {
     EXPECT_TRUE(openssl::base64_decode(&iso_exi_a_hash_b64[0], sizeof(iso_exi_a_hash_b64), buffer.data(), buffer_len));
     ASSERT_EQ(buffer_len, sizeof(iso_exi_a_hash));
     EXPECT_EQ(std::memcmp(buffer.data(), &iso_exi_a_hash[0], buffer_len), 0);
+
+    // exactly the decoded size is enough, one byte less is not
+    buffer_len = sizeof(iso_exi_a_hash);
+    EXPECT_TRUE(openssl::base64_decode(&iso_exi_a_hash_b64[0], sizeof(iso_exi_a_hash_b64), buffer.data(), buffer_len));
+    ASSERT_EQ(buffer_len, sizeof(iso_exi_a_hash));
+    EXPECT_EQ(std::memcmp(buffer.data(), &iso_exi_a_hash[0], buffer_len), 0);
+    buffer_len = sizeof(iso_exi_a_hash) - 1;
+    EXPECT_FALSE(openssl::base64_decode(&iso_exi_a_hash_b64[0], sizeof(iso_exi_a_hash_b64), buffer.data(), buffer_len));
+
+    buffer_len = buffer.size();
+    EXPECT_FALSE(openssl::base64_decode("not base64!", 11, buffer.data(), buffer_len));
 }
 
 TEST(openssl, base64DecodeNl) {
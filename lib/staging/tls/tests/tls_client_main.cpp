@@ -4,17 +4,22 @@
 #include <tls.hpp>
 
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <sys/resource.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 using namespace std::chrono_literals;
 
 namespace {
-const char* short_opts = "h123";
+const char* short_opts = "h123kb:";
 bool use_tls1_3{false};
 bool use_status_request{false};
 bool use_status_request_v2{false};
+bool enable_ktls{false};
+std::size_t benchmark_mib{0};
 
 void parse_options(int argc, char** argv) {
     int c;
@@ -31,12 +36,20 @@ void parse_options(int argc, char** argv) {
         case '3':
             use_tls1_3 = true;
             break;
+        case 'k':
+            enable_ktls = true;
+            break;
+        case 'b':
+            benchmark_mib = std::strtoul(optarg, nullptr, 10);
+            break;
         case 'h':
         case '?':
-            std::cout << "Usage: " << argv[0] << " [-1|-2|-3]" << std::endl;
+            std::cout << "Usage: " << argv[0] << " [-1|-2|-3] [-k] [-b MiB]" << std::endl;
             std::cout << "       -1 request status_request" << std::endl;
             std::cout << "       -2 request status_request_v2" << std::endl;
             std::cout << "       -3 use TLS 1.3 (TLS 1.2 otherwise)" << std::endl;
+            std::cout << "       -k enable kernel TLS" << std::endl;
+            std::cout << "       -b echo MiB through tls_server and report throughput and CPU time" << std::endl;
             exit(1);
             break;
         default:
@@ -44,6 +57,44 @@ void parse_options(int argc, char** argv) {
         }
     }
 }
+double cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// sends records of 16 KiB and waits for each echo, like request/response V2G traffic
+void benchmark(tls::Connection& connection) {
+    std::vector<std::byte> out(16384, std::byte{0x5a});
+    std::vector<std::byte> in(out.size());
+    const std::size_t blocks = benchmark_mib * 1024 * 1024 / out.size();
+
+    const auto cpu_start = cpu_seconds();
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t echoed{0};
+    bool bOk = true;
+    for (std::size_t i = 0; (i < blocks) && bOk; i++) {
+        std::size_t writebytes = 0;
+        bOk = connection.write(out.data(), out.size(), writebytes) == tls::Connection::result_t::success;
+        std::size_t total = 0;
+        while (bOk && (total < in.size())) {
+            std::size_t readbytes = 0;
+            bOk = connection.read(in.data() + total, in.size() - total, readbytes) !=
+                  tls::Connection::result_t::error;
+            total += readbytes;
+        }
+        echoed += total;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto cpu = cpu_seconds() - cpu_start;
+
+    const auto mib = static_cast<double>(echoed) / (1024 * 1024);
+    std::cout << "kTLS send: " << connection.ktls_send() << " recv: " << connection.ktls_recv() << std::endl;
+    std::cout << mib << " MiB echoed in " << elapsed.count() << " s: " << mib / elapsed.count() << " MiB/s, "
+              << cpu << " s CPU" << std::endl;
+}
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -67,6 +118,7 @@ int main(int argc, char** argv) {
     config.verify_locations_file = "server_root_cert.pem";
     config.io_timeout_ms = 500;
     config.verify_server = false;
+    config.enable_ktls = enable_ktls;
 
     if (use_status_request) {
         config.status_request = true;
@@ -89,7 +141,10 @@ int main(int argc, char** argv) {
     // localhost works in some cases but not in the CI pipeline
     auto connection = client.connect("ip6-localhost", "8444", true);
     if (connection) {
-        if (connection->connect()) {
+        if (connection->connect() && (benchmark_mib > 0)) {
+            benchmark(*connection);
+            connection->shutdown();
+        } else if (connection->state() == tls::Connection::state_t::connected) {
             std::array<std::byte, 1024> buffer{};
             std::size_t readbytes = 0;
             std::cout << "about to read" << std::endl;
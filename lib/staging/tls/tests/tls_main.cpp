@@ -14,14 +14,42 @@
 #include <iostream>
 #include <memory>
 #include <thread>
+#include <unistd.h>
 
 using namespace std::chrono_literals;
 
+namespace {
+const char* short_opts = "hk";
+bool enable_ktls{false};
+
+void parse_options(int argc, char** argv) {
+    int c;
+
+    while ((c = getopt(argc, argv, short_opts)) != -1) {
+        switch (c) {
+        case 'k':
+            enable_ktls = true;
+            break;
+        case 'h':
+        case '?':
+            std::cout << "Usage: " << argv[0] << " [-k]" << std::endl;
+            std::cout << "       -k enable kernel TLS" << std::endl;
+            exit(1);
+            break;
+        default:
+            exit(2);
+        }
+    }
+}
+} // namespace
+
 void handle_connection(std::shared_ptr<tls::ServerConnection>& con) {
     std::cout << "Connection" << std::endl;
     if (con->accept()) {
+        std::cout << "kTLS send: " << con->ktls_send() << " recv: " << con->ktls_recv() << std::endl;
         std::uint32_t count{0};
-        std::array<std::byte, 1024> buffer{};
+        // one TLS record, so that the -b option of tls_client measures record throughput
+        std::array<std::byte, 16384> buffer{};
         bool bExit = false;
         while (!bExit) {
             std::size_t readbytes = 0;
@@ -57,7 +85,9 @@ void handle_connection(std::shared_ptr<tls::ServerConnection>& con) {
     std::cout << "Connection closed" << std::endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    parse_options(argc, argv);
+
     tls::Server server;
     tls::Server::config_t config;
 
@@ -80,6 +110,7 @@ int main() {
     config.ipv6_only = false;
     config.verify_client = true;
     config.io_timeout_ms = 1000;
+    config.enable_ktls = enable_ktls;
 
     std::thread stop([&server]() {
         std::this_thread::sleep_for(30s);
@@ -4,7 +4,14 @@
 #include <gtest/gtest.h>
 #include <tls.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 std::string to_string(const openssl::sha_256_digest_t& digest) {
     std::stringstream string_stream;
@@ -86,6 +93,29 @@ TEST(ConfigItem, test) {
     EXPECT_STREQ(p, "Hello");
 }
 
+TEST(ConfigItem, keepsCopy) {
+    tls::ConfigItem item;
+    {
+        const std::string path{"/etc/everest/certs/cpo_cert_chain.pem"};
+        item = path.c_str();
+        tls::Server::config_t config;
+        config.certificate_chain_file = path.c_str();
+        config.ocsp_response_files.push_back(path.c_str());
+        item = config.certificate_chain_file;
+    }
+    // the source strings are gone
+    EXPECT_EQ(item, "/etc/everest/certs/cpo_cert_chain.pem");
+
+    const char* p = item;
+    item = p;
+    EXPECT_EQ(item, "/etc/everest/certs/cpo_cert_chain.pem");
+    const auto& same = item;
+    item = same;
+    EXPECT_EQ(item, "/etc/everest/certs/cpo_cert_chain.pem");
+    item = nullptr;
+    EXPECT_EQ(item, nullptr);
+}
+
 TEST(OcspCache, initEmpty) {
     tls::OcspCache cache;
     openssl::sha_256_digest_t digest{};
@@ -112,4 +142,313 @@ TEST(OcspCache, init) {
     EXPECT_NE(res.get(), nullptr);
 }
 
+TEST(OcspCache, status) {
+    tls::OcspCache cache;
+    EXPECT_TRUE(cache.status().empty());
+    EXPECT_FALSE(cache.next_update());
+
+    auto chain = openssl::load_certificates("client_chain.pem");
+    std::vector<tls::OcspCache::ocsp_entry_t> entries;
+
+    openssl::sha_256_digest_t digest{};
+    for (const auto& cert : chain) {
+        ASSERT_TRUE(tls::OcspCache::digest(digest, cert.get()));
+        entries.emplace_back(digest, "ocsp_response.der");
+    }
+
+    EXPECT_TRUE(cache.load(entries));
+    const auto status = cache.status();
+    EXPECT_EQ(status.size(), chain.size());
+
+    // ocsp_response.der: This Update: Apr 18 04:45:01 2024 GMT, Next Update: Apr 25 03:45:01 2024 GMT
+    const auto this_update = std::chrono::system_clock::from_time_t(1713415501);
+    const auto next_update = std::chrono::system_clock::from_time_t(1714016701);
+    for (const auto& entry : status) {
+        ASSERT_TRUE(entry.this_update);
+        ASSERT_TRUE(entry.next_update);
+        EXPECT_EQ(entry.this_update.value(), this_update);
+        EXPECT_EQ(entry.next_update.value(), next_update);
+    }
+    ASSERT_TRUE(cache.next_update());
+    EXPECT_EQ(cache.next_update().value(), next_update);
+
+    // clearing the cache
+    EXPECT_TRUE(cache.load({}));
+    EXPECT_TRUE(cache.status().empty());
+}
+
+TEST(OcspRefreshScheduler, nextRefresh) {
+    using namespace std::chrono_literals;
+    using tls::OcspRefreshScheduler;
+
+    OcspRefreshScheduler::config_t config;
+    config.lead_time = 24h;
+    config.jitter = 1h;
+    config.retry_interval = 15min;
+    config.max_interval = 48h;
+
+    const auto now = OcspRefreshScheduler::clock_t::now();
+
+    // nothing known - retry soon
+    EXPECT_EQ(OcspRefreshScheduler::next_refresh(now, std::nullopt, config, 0s), now + 15min);
+
+    // lead time and jitter before expiry
+    EXPECT_EQ(OcspRefreshScheduler::next_refresh(now, now + 36h, config, 0s), now + 12h);
+    EXPECT_EQ(OcspRefreshScheduler::next_refresh(now, now + 36h, config, 30min), now + 11h + 30min);
+
+    // already within the lead time (reload didn't help) - retry
+    EXPECT_EQ(OcspRefreshScheduler::next_refresh(now, now + 1h, config, 0s), now + 15min);
+    EXPECT_EQ(OcspRefreshScheduler::next_refresh(now, now - 1h, config, 0s), now + 15min);
+
+    // far in the future - check at least every max_interval
+    EXPECT_EQ(OcspRefreshScheduler::next_refresh(now, now + 24h * 30, config, 0s), now + 48h);
+}
+
+TEST(OcspRefreshScheduler, refresh) {
+    using namespace std::chrono_literals;
+
+    tls::OcspCache cache;
+    std::mutex mux;
+    std::condition_variable cv;
+    int count{0};
+
+    auto refresh = [&]() {
+        std::lock_guard lock(mux);
+        count++;
+        cv.notify_all();
+        return count > 1;
+    };
+
+    tls::OcspRefreshScheduler::config_t config;
+    config.retry_interval = 1h;
+    tls::OcspRefreshScheduler scheduler(cache, refresh, config);
+
+    // warm the cache on start
+    scheduler.start();
+    {
+        std::unique_lock lock(mux);
+        ASSERT_TRUE(cv.wait_for(lock, 5s, [&count]() { return count == 1; }));
+    }
+
+    scheduler.trigger();
+    {
+        std::unique_lock lock(mux);
+        ASSERT_TRUE(cv.wait_for(lock, 5s, [&count]() { return count == 2; }));
+    }
+    scheduler.stop();
+
+    const auto metrics = scheduler.metrics();
+    EXPECT_EQ(metrics.refreshes, 2);
+    EXPECT_EQ(metrics.failed_refreshes, 1);
+    EXPECT_EQ(metrics.entries, 0);
+    EXPECT_EQ(metrics.expired_entries, 0);
+    ASSERT_TRUE(metrics.next_refresh);
+    EXPECT_GT(metrics.next_refresh.value(), metrics.last_refresh.value() + 59min);
+}
+
+// ----------------------------------------------------------------------------
+// kernel TLS
+
+// echo server, records whether the server side used kernel TLS
+struct KtlsState {
+    std::atomic_bool send{false};
+    std::atomic_bool recv{false};
+};
+KtlsState server_ktls;
+
+void echo_handler(std::shared_ptr<tls::ServerConnection>& con) {
+    if (con->accept()) {
+        server_ktls.send = con->ktls_send();
+        server_ktls.recv = con->ktls_recv();
+        std::uint32_t count{0};
+        std::vector<std::byte> buffer(16384);
+        bool bExit = false;
+        while (!bExit) {
+            std::size_t readbytes = 0;
+            std::size_t writebytes = 0;
+
+            switch (con->read(buffer.data(), buffer.size(), readbytes)) {
+            case tls::Connection::result_t::success:
+                bExit = con->write(buffer.data(), readbytes, writebytes) != tls::Connection::result_t::success;
+                break;
+            case tls::Connection::result_t::timeout:
+                count++;
+                bExit = count > 10;
+                break;
+            case tls::Connection::result_t::error:
+            default:
+                bExit = true;
+                break;
+            }
+        }
+        con->shutdown();
+    }
+}
+
+class KtlsTest : public testing::Test {
+protected:
+    tls::Server server;
+    tls::Server::config_t server_config;
+    std::thread server_thread;
+    tls::Client client;
+    tls::Client::config_t client_config;
+
+    static void SetUpTestSuite() {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = SIG_IGN;
+        sigaction(SIGPIPE, &action, nullptr);
+    }
+
+    void SetUp() override {
+        // the ISO 15118-2 cipher suite, TLS 1.2 only
+        server_config.cipher_list = "ECDHE-ECDSA-AES128-SHA256";
+        server_config.ciphersuites = "";
+        server_config.certificate_chain_file = "server_chain.pem";
+        server_config.private_key_file = "server_priv.pem";
+        server_config.ocsp_response_files = {"ocsp_response.der", "ocsp_response.der"};
+        server_config.host = "localhost";
+        server_config.service = "8445";
+        server_config.ipv6_only = false;
+        server_config.verify_client = false;
+        server_config.io_timeout_ms = 500;
+
+        client_config.cipher_list = "ECDHE-ECDSA-AES128-SHA256";
+        client_config.verify_locations_file = "server_root_cert.pem";
+        client_config.io_timeout_ms = 500;
+        client_config.verify_server = false;
+
+        server_ktls.send = false;
+        server_ktls.recv = false;
+    }
+
+    void TearDown() override {
+        server.stop();
+        server.wait_stopped();
+        if (server_thread.joinable()) {
+            server_thread.join();
+        }
+    }
+
+    void use_tls1_3() {
+        server_config.ciphersuites = "TLS_AES_128_GCM_SHA256";
+        client_config.ciphersuites = "TLS_AES_128_GCM_SHA256";
+    }
+
+    void enable_ktls() {
+        server_config.enable_ktls = true;
+        client_config.enable_ktls = true;
+    }
+
+    std::unique_ptr<tls::ClientConnection> connect() {
+        using state_t = tls::Server::state_t;
+        EXPECT_EQ(server.init(server_config, nullptr), state_t::init_complete);
+        server_thread = std::thread([this]() { server.serve(&echo_handler); });
+        server.wait_running();
+
+        EXPECT_TRUE(client.init(client_config));
+        auto connection = client.connect("localhost", "8445", false);
+        if (connection && !connection->connect()) {
+            connection.reset();
+        }
+        return connection;
+    }
+
+    // reads until num bytes have been received
+    static std::vector<std::byte> receive(tls::Connection& con, std::size_t num) {
+        std::vector<std::byte> result(num);
+        std::size_t total{0};
+        std::uint32_t timeouts{0};
+        while ((total < num) && (timeouts < 10)) {
+            std::size_t readbytes{0};
+            const auto res = con.read(result.data() + total, num - total, readbytes);
+            if (res == tls::Connection::result_t::error) {
+                break;
+            }
+            timeouts += (res == tls::Connection::result_t::timeout) ? 1 : 0;
+            total += readbytes;
+        }
+        result.resize(total);
+        return result;
+    }
+
+    static void echo(tls::Connection& con) {
+        const std::string message{"SupportedAppProtocolReq"};
+        std::size_t writebytes{0};
+        ASSERT_EQ(con.write(reinterpret_cast<const std::byte*>(message.data()), message.size(), writebytes),
+                  tls::Connection::result_t::success);
+        ASSERT_EQ(writebytes, message.size());
+        const auto reply = receive(con, message.size());
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(reply.data()), reply.size()), message);
+    }
+
+    static void echo_file(tls::Connection& con) {
+        // larger than a TLS record and not a multiple of the block size
+        std::vector<std::byte> content(100000);
+        for (std::size_t i = 0; i < content.size(); i++) {
+            content[i] = static_cast<std::byte>(i * 7);
+        }
+        std::FILE* file = std::tmpfile();
+        ASSERT_NE(file, nullptr);
+        ASSERT_EQ(std::fwrite(content.data(), 1, content.size(), file), content.size());
+        ASSERT_EQ(std::fflush(file), 0);
+
+        // skip the first bytes and request more than the file contains
+        constexpr std::size_t offset = 1000;
+        std::size_t writebytes{0};
+        EXPECT_EQ(con.sendfile(fileno(file), offset, content.size(), writebytes), tls::Connection::result_t::success);
+        EXPECT_EQ(writebytes, content.size() - offset);
+
+        const auto reply = receive(con, writebytes);
+        EXPECT_TRUE(std::equal(reply.begin(), reply.end(), content.begin() + offset, content.end()));
+        std::fclose(file);
+    }
+};
+
+TEST_F(KtlsTest, disabled) {
+    use_tls1_3();
+    auto connection = connect();
+    ASSERT_NE(connection, nullptr);
+    EXPECT_FALSE(connection->ktls_send());
+    EXPECT_FALSE(connection->ktls_recv());
+
+    echo(*connection);
+    echo_file(*connection);
+    EXPECT_FALSE(server_ktls.send);
+    EXPECT_FALSE(server_ktls.recv);
+    connection->shutdown();
+}
+
+TEST_F(KtlsTest, unsupportedCipher) {
+    // Linux kernel TLS has no AES-CBC, OpenSSL falls back to userspace encryption
+    enable_ktls();
+    auto connection = connect();
+    ASSERT_NE(connection, nullptr);
+    EXPECT_FALSE(connection->ktls_send());
+    EXPECT_FALSE(connection->ktls_recv());
+
+    echo(*connection);
+    echo_file(*connection);
+    EXPECT_FALSE(server_ktls.send);
+    connection->shutdown();
+}
+
+TEST_F(KtlsTest, enabled) {
+    use_tls1_3();
+    enable_ktls();
+    auto connection = connect();
+    ASSERT_NE(connection, nullptr);
+
+    // both paths have to deliver the same data
+    echo(*connection);
+    echo_file(*connection);
+    EXPECT_EQ(connection->ktls_send(), server_ktls.send);
+    const bool offloaded = connection->ktls_send();
+    connection->shutdown();
+
+    if (!offloaded) {
+        GTEST_SKIP() << "kernel TLS not available (modprobe tls)";
+    }
+}
+
 } // namespace
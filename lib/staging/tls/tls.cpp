@@ -4,10 +4,12 @@
 #include "tls.hpp"
 #include "openssl_util.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <ctime>
 #include <fcntl.h>
 #include <iomanip>
 #include <iostream>
@@ -17,9 +19,11 @@
 #include <netinet/tcp.h>
 #include <openssl/types.h>
 #include <poll.h>
+#include <random>
 #include <sstream>
 #include <string>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #include <openssl/asn1.h>
 #include <openssl/bio.h>
@@ -87,6 +91,7 @@ std::string to_string(const openssl::sha_256_digest_t& digest) {
 }
 
 constexpr std::uint32_t c_shutdown_timeout_ms = 5000; // 5 seconds
+constexpr std::size_t c_sendfile_block_size = 16384;    // maximum TLS record payload
 
 enum class ssl_error_t : std::uint8_t {
     error,
@@ -225,6 +230,8 @@ int wait_for(int soc, bool forWrite, std::int32_t timeout_ms) {
                                     std::int32_t timeout_ms);
 [[nodiscard]] ssl_result_t ssl_write(SSL* ctx, const std::byte* buf, std::size_t num, std::size_t& writebytes,
                                      std::int32_t timeout_ms);
+[[nodiscard]] ssl_result_t ssl_sendfile(SSL* ctx, int fd, std::int64_t offset, std::size_t num,
+                                        std::size_t& writebytes, std::int32_t timeout_ms);
 [[nodiscard]] ssl_result_t ssl_accept(SSL* ctx, std::int32_t timeout_ms);
 [[nodiscard]] ssl_result_t ssl_connect(SSL* ctx, std::int32_t timeout_ms);
 void ssl_shutdown(SSL* ctx, std::int32_t timeout_ms);
@@ -293,6 +300,35 @@ ssl_result_t ssl_write(SSL* ctx, const std::byte* buf, const std::size_t num, st
     return convert(result);
 }
 
+ssl_result_t ssl_sendfile(SSL* ctx, int fd, std::int64_t offset, const std::size_t num, std::size_t& writebytes,
+                          std::int32_t timeout_ms) {
+    ssl_error_t result = ssl_error_t::error;
+    bool bLoop = ctx != nullptr;
+    while (bLoop) {
+        // only available with kernel TLS, returns the number of bytes sent or < 0
+        const auto res = SSL_sendfile(ctx, fd, offset, num, 0);
+        writebytes = (res > 0) ? static_cast<std::size_t>(res) : 0;
+        bLoop = process_result(ctx, "SSL_sendfile: ", (res > 0) ? 1 : static_cast<int>(res), result, timeout_ms);
+    }
+    return convert(result);
+}
+
+bool ktls_send_active(SSL* ctx) {
+#ifdef OPENSSL_NO_KTLS
+    return false;
+#else
+    return (ctx != nullptr) && BIO_get_ktls_send(SSL_get_wbio(ctx));
+#endif
+}
+
+bool ktls_recv_active(SSL* ctx) {
+#ifdef OPENSSL_NO_KTLS
+    return false;
+#else
+    return (ctx != nullptr) && BIO_get_ktls_recv(SSL_get_rbio(ctx));
+#endif
+}
+
 ssl_result_t ssl_accept(SSL* ctx, std::int32_t timeout_ms) {
     ssl_error_t result = ssl_error_t::error;
     bool bLoop = ctx != nullptr;
@@ -329,7 +365,7 @@ void ssl_shutdown(SSL* ctx, std::int32_t timeout_ms) {
 
 bool configure_ssl_ctx(SSL_CTX* ctx, const char* ciphersuites, const char* cipher_list,
                        const char* certificate_chain_file, const char* private_key_file,
-                       const char* private_key_password, bool required) {
+                       const char* private_key_password, bool required, bool enable_ktls) {
     bool bRes{true};
 
     if (ctx == nullptr) {
@@ -360,6 +396,11 @@ bool configure_ssl_ctx(SSL_CTX* ctx, const char* ciphersuites, const char* ciphe
                 bRes = false;
             }
         }
+        if (enable_ktls) {
+            // OpenSSL hands the record layer to the kernel after the handshake and
+            // silently stays in userspace when the kernel or cipher doesn't support it
+            SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+        }
 
         if (certificate_chain_file != nullptr) {
             if (SSL_CTX_use_certificate_chain_file(ctx, certificate_chain_file) != 1) {
@@ -418,6 +459,58 @@ OCSP_RESPONSE* load_ocsp(const char* filename) {
     return resp;
 }
 
+/**
+ * \brief convert an ASN.1 time into a time point
+ * \param[in] time the ASN.1 time (can be nullptr)
+ * \return the time point or std::nullopt when time isn't set or invalid
+ */
+std::optional<std::chrono::system_clock::time_point> to_time_point(const ASN1_GENERALIZEDTIME* time) {
+    std::optional<std::chrono::system_clock::time_point> result;
+    if (time != nullptr) {
+        std::tm tm{};
+        if (ASN1_TIME_to_tm(time, &tm) == 1) {
+            result = std::chrono::system_clock::from_time_t(timegm(&tm));
+        }
+    }
+    return result;
+}
+
+/**
+ * \brief extract thisUpdate and nextUpdate from an OCSP response
+ * \param[in] resp the OCSP response
+ * \param[out] this_update the latest thisUpdate of all single responses
+ * \param[out] next_update the earliest nextUpdate of all single responses
+ */
+void ocsp_validity(OCSP_RESPONSE* resp, std::optional<std::chrono::system_clock::time_point>& this_update,
+                   std::optional<std::chrono::system_clock::time_point>& next_update) {
+    this_update.reset();
+    next_update.reset();
+
+    OCSP_BASICRESP* basic = OCSP_response_get1_basic(resp);
+    if (basic == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < OCSP_resp_count(basic); i++) {
+        OCSP_SINGLERESP* single = OCSP_resp_get0(basic, i);
+        ASN1_GENERALIZEDTIME* this_upd{nullptr};
+        ASN1_GENERALIZEDTIME* next_upd{nullptr};
+        if ((single != nullptr) &&
+            (OCSP_single_get0_status(single, nullptr, nullptr, &this_upd, &next_upd) != -1)) {
+            const auto this_tp = to_time_point(this_upd);
+            const auto next_tp = to_time_point(next_upd);
+            if (this_tp && (!this_update || (this_tp.value() > this_update.value()))) {
+                this_update = this_tp;
+            }
+            if (next_tp && (!next_update || (next_tp.value() < next_update.value()))) {
+                next_update = next_tp;
+            }
+        }
+    }
+
+    OCSP_BASICRESP_free(basic);
+}
+
 constexpr char* dup(const char* value) {
     char* res = nullptr;
     if (value != nullptr) {
@@ -433,21 +526,26 @@ namespace tls {
 ConfigItem::ConfigItem(const char* value) : m_ptr(dup(value)) {
 }
 ConfigItem& ConfigItem::operator=(const char* value) {
+    // value may point into the current copy
+    char* previous = m_ptr;
     m_ptr = dup(value);
+    free(previous);
     return *this;
 }
 ConfigItem::ConfigItem(const ConfigItem& obj) : m_ptr(dup(obj.m_ptr)) {
 }
 ConfigItem& ConfigItem::operator=(const ConfigItem& obj) {
-    m_ptr = dup(obj.m_ptr);
-    return *this;
+    return *this = obj.m_ptr;
 }
 ConfigItem::ConfigItem(ConfigItem&& obj) noexcept : m_ptr(obj.m_ptr) {
     obj.m_ptr = nullptr;
 }
 ConfigItem& ConfigItem::operator=(ConfigItem&& obj) noexcept {
-    m_ptr = obj.m_ptr;
-    obj.m_ptr = nullptr;
+    if (this != &obj) {
+        free(m_ptr);
+        m_ptr = obj.m_ptr;
+        obj.m_ptr = nullptr;
+    }
     return *this;
 }
 ConfigItem::~ConfigItem() {
@@ -474,10 +572,18 @@ struct connection_ctx {
     SSL_ptr ctx;
     BIO* soc_bio{nullptr};
     int soc{0};
+    // sendfile() without kernel TLS, SSL_write retries need the same buffer
+    std::unique_ptr<std::array<std::byte, c_sendfile_block_size>> file_buffer;
+};
+
+struct ocsp_cache_entry {
+    OCSP_RESPONSE_ptr response;
+    std::optional<OcspCache::clock_t::time_point> this_update;
+    std::optional<OcspCache::clock_t::time_point> next_update;
 };
 
 struct ocsp_cache_ctx {
-    std::map<openssl::sha_256_digest_t, OCSP_RESPONSE_ptr> cache;
+    std::map<openssl::sha_256_digest_t, ocsp_cache_entry> cache;
 };
 
 struct server_ctx {
@@ -505,7 +611,7 @@ bool OcspCache::load(const std::vector<ocsp_entry_t>& filenames) {
         std::lock_guard lock(mux);
         m_context->cache.clear();
     } else {
-        std::map<openssl::sha_256_digest_t, OCSP_RESPONSE_ptr> updates;
+        std::map<openssl::sha_256_digest_t, ocsp_cache_entry> updates;
         for (const auto& entry : filenames) {
             const auto& digest = std::get<openssl::sha_256_digest_t>(entry);
             const auto* filename = std::get<const char*>(entry);
@@ -520,7 +626,9 @@ bool OcspCache::load(const std::vector<ocsp_entry_t>& filenames) {
             }
 
             if (resp != nullptr) {
-                updates[digest] = std::shared_ptr<OCSP_RESPONSE>(resp, &::OCSP_RESPONSE_free);
+                auto& entry = updates[digest];
+                entry.response = std::shared_ptr<OCSP_RESPONSE>(resp, &::OCSP_RESPONSE_free);
+                ocsp_validity(resp, entry.this_update, entry.next_update);
             }
         }
 
@@ -539,7 +647,7 @@ std::shared_ptr<OcspResponse> OcspCache::lookup(const openssl::sha_256_digest_t&
     std::shared_ptr<OcspResponse> resp;
     std::lock_guard lock(mux);
     if (const auto itt = m_context->cache.find(digest); itt != m_context->cache.end()) {
-        resp = itt->second;
+        resp = itt->second.response;
     } else {
         log_error("OcspCache::lookup: not in cache: " + to_string(digest));
     }
@@ -566,6 +674,136 @@ bool OcspCache::digest(openssl::sha_256_digest_t& digest, const x509_st* cert) {
     return bResult;
 }
 
+std::vector<OcspCache::status_t> OcspCache::status() {
+    assert(m_context != nullptr);
+
+    std::vector<status_t> result;
+    std::lock_guard lock(mux);
+    result.reserve(m_context->cache.size());
+    for (const auto& [digest, entry] : m_context->cache) {
+        result.push_back({digest, entry.this_update, entry.next_update});
+    }
+    return result;
+}
+
+std::optional<OcspCache::clock_t::time_point> OcspCache::next_update() {
+    assert(m_context != nullptr);
+
+    std::optional<clock_t::time_point> result;
+    std::lock_guard lock(mux);
+    for (const auto& [digest, entry] : m_context->cache) {
+        if (entry.next_update && (!result || (entry.next_update.value() < result.value()))) {
+            result = entry.next_update;
+        }
+    }
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// OcspRefreshScheduler
+
+OcspRefreshScheduler::OcspRefreshScheduler(OcspCache& cache, refresh_t refresh, const config_t& config) :
+    m_cache(cache), m_refresh(std::move(refresh)), m_config(config) {
+}
+
+OcspRefreshScheduler::OcspRefreshScheduler(OcspCache& cache, refresh_t refresh) :
+    OcspRefreshScheduler(cache, std::move(refresh), config_t{}) {
+}
+
+OcspRefreshScheduler::~OcspRefreshScheduler() {
+    stop();
+}
+
+void OcspRefreshScheduler::start() {
+    std::lock_guard lock(m_mutex);
+    if (!m_thread.joinable()) {
+        m_exit = false;
+        m_triggered = true;
+        m_thread = std::thread(&OcspRefreshScheduler::run, this);
+    }
+}
+
+void OcspRefreshScheduler::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_exit = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void OcspRefreshScheduler::trigger() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_triggered = true;
+    }
+    m_cv.notify_all();
+}
+
+OcspRefreshScheduler::metrics_t OcspRefreshScheduler::metrics() {
+    std::lock_guard lock(m_mutex);
+    return m_metrics;
+}
+
+OcspRefreshScheduler::clock_t::time_point
+OcspRefreshScheduler::next_refresh(clock_t::time_point now, const std::optional<clock_t::time_point>& next_update,
+                                   const config_t& config, std::chrono::seconds jitter) {
+    const auto earliest = now + config.retry_interval;
+    const auto latest = now + std::max(config.max_interval, config.retry_interval);
+
+    if (!next_update) {
+        return earliest;
+    }
+
+    const auto due = next_update.value() - config.lead_time - jitter;
+    return std::clamp(due, earliest, latest);
+}
+
+void OcspRefreshScheduler::run() {
+    // jitter spreads the refreshes of many chargers sharing the same responses
+    std::mt19937 rng(std::random_device{}());
+    std::uniform_int_distribution<std::int64_t> jitter_distribution(0, m_config.jitter.count());
+
+    std::unique_lock lock(m_mutex);
+    while (!m_exit) {
+        if (m_triggered) {
+            m_triggered = false;
+            lock.unlock();
+            const bool refreshed = m_refresh();
+            const auto status = m_cache.status();
+            const auto next_update = m_cache.next_update();
+            const auto now = clock_t::now();
+            const auto next = next_refresh(now, next_update, m_config,
+                                           std::chrono::seconds(jitter_distribution(rng)));
+            lock.lock();
+
+            m_metrics.refreshes++;
+            if (!refreshed) {
+                m_metrics.failed_refreshes++;
+            }
+            m_metrics.entries = status.size();
+            m_metrics.expired_entries = std::count_if(status.begin(), status.end(), [now](const auto& entry) {
+                return entry.next_update && (entry.next_update.value() <= now);
+            });
+            m_metrics.last_refresh = now;
+            m_metrics.next_update = next_update;
+            m_metrics.next_refresh = next;
+
+            if (m_metrics.expired_entries > 0) {
+                log_warning("OCSP cache: " + std::to_string(m_metrics.expired_entries) + " of " +
+                            std::to_string(m_metrics.entries) + " responses expired");
+            }
+        }
+
+        const auto wakeup = m_metrics.next_refresh.value_or(clock_t::now() + m_config.retry_interval);
+        if (m_cv.wait_until(lock, wakeup, [this] { return m_exit || m_triggered; }) == false) {
+            m_triggered = true;
+        }
+    }
+}
+
 // ----------------------------------------------------------------------------
 // CertificateStatusRequestV2
 
@@ -872,6 +1110,56 @@ Connection::result_t Connection::write(const std::byte* buf, std::size_t num, st
     return convert(result);
 }
 
+Connection::result_t Connection::sendfile(int fd, std::int64_t offset, std::size_t num, std::size_t& writebytes) {
+    assert(m_context != nullptr);
+    ssl_result_t result{ssl_result_t::error};
+    writebytes = 0;
+    if (m_state == state_t::connected) {
+        auto* ctx = m_context->ctx.get();
+        if (ktls_send_active(ctx)) {
+            result = ssl_sendfile(ctx, fd, offset, num, writebytes, m_timeout_ms);
+        } else {
+            if (m_context->file_buffer == nullptr) {
+                m_context->file_buffer = std::make_unique<std::array<std::byte, c_sendfile_block_size>>();
+            }
+            auto& buffer = *m_context->file_buffer;
+            result = ssl_result_t::success;
+            while ((writebytes < num) && (result == ssl_result_t::success)) {
+                const auto block = std::min(num - writebytes, buffer.size());
+                const auto readbytes = pread(fd, buffer.data(), block, offset + static_cast<std::int64_t>(writebytes));
+                if (readbytes < 0) {
+                    log_error(std::string("Connection::sendfile pread: ") + std::to_string(errno));
+                    result = ssl_result_t::error;
+                } else if (readbytes == 0) {
+                    // end of file
+                    break;
+                } else {
+                    std::size_t sent{0};
+                    result = ssl_write(ctx, buffer.data(), readbytes, sent, m_timeout_ms);
+                    writebytes += sent;
+                }
+            }
+        }
+        switch (result) {
+        case ssl_result_t::success:
+        case ssl_result_t::timeout:
+            break;
+        case ssl_result_t::error_syscall:
+            m_state = state_t::fault;
+            break;
+        case ssl_result_t::closed:
+            shutdown();
+            break;
+        case ssl_result_t::error:
+        default:
+            shutdown();
+            m_state = state_t::fault;
+            break;
+        }
+    }
+    return convert(result);
+}
+
 void Connection::shutdown() {
     assert(m_context != nullptr);
     if (m_state == state_t::connected) {
@@ -884,6 +1172,16 @@ int Connection::socket() const {
     return m_context->soc;
 }
 
+bool Connection::ktls_send() const {
+    assert(m_context != nullptr);
+    return ktls_send_active(m_context->ctx.get());
+}
+
+bool Connection::ktls_recv() const {
+    assert(m_context != nullptr);
+    return ktls_recv_active(m_context->ctx.get());
+}
+
 // ----------------------------------------------------------------------------
 // ServerConnection represents a TLS server connection
 
@@ -1050,7 +1348,7 @@ bool Server::init_ssl(const config_t& cfg) {
     const SSL_METHOD* method = TLS_server_method();
     auto* ctx = SSL_CTX_new(method);
     auto bRes = configure_ssl_ctx(ctx, cfg.ciphersuites, cfg.cipher_list, cfg.certificate_chain_file,
-                                  cfg.private_key_file, cfg.private_key_password, true);
+                                  cfg.private_key_file, cfg.private_key_password, true, cfg.enable_ktls);
     if (bRes) {
         int mode = SSL_VERIFY_NONE;
 
@@ -1117,25 +1415,32 @@ bool Server::update(const config_t& cfg) {
     bool bRes = init_ssl(cfg);
 
     if (bRes) {
-        std::vector<OcspCache::ocsp_entry_t> entries;
-        auto chain = openssl::load_certificates(cfg.certificate_chain_file);
-        if (chain.size() == cfg.ocsp_response_files.size()) {
-            for (std::size_t i = 0; i < chain.size(); i++) {
-                const auto& file = cfg.ocsp_response_files[i];
-                const auto& cert = chain[i];
-
-                if (file != nullptr) {
-                    openssl::sha_256_digest_t digest{};
-                    if (OcspCache::digest(digest, cert.get())) {
-                        entries.emplace_back(digest, file);
-                    }
+        bRes = update_ocsp_cache(cfg);
+    }
+
+    return bRes;
+}
+
+bool Server::update_ocsp_cache(const config_t& cfg) {
+    bool bRes{true};
+    std::vector<OcspCache::ocsp_entry_t> entries;
+    auto chain = openssl::load_certificates(cfg.certificate_chain_file);
+    if (chain.size() == cfg.ocsp_response_files.size()) {
+        for (std::size_t i = 0; i < chain.size(); i++) {
+            const auto& file = cfg.ocsp_response_files[i];
+            const auto& cert = chain[i];
+
+            if (file != nullptr) {
+                openssl::sha_256_digest_t digest{};
+                if (OcspCache::digest(digest, cert.get())) {
+                    entries.emplace_back(digest, file);
                 }
             }
-
-            bRes = m_cache.load(entries);
-        } else {
-            log_warning(std::string("update_ocsp: ocsp files != ") + std::to_string(chain.size()));
         }
+
+        bRes = m_cache.load(entries);
+    } else {
+        log_warning(std::string("update_ocsp: ocsp files != ") + std::to_string(chain.size()));
     }
 
     return bRes;
@@ -1291,7 +1596,7 @@ bool Client::init(const config_t& cfg) {
     const SSL_METHOD* method = TLS_client_method();
     auto* ctx = SSL_CTX_new(method);
     auto bRes = configure_ssl_ctx(ctx, cfg.ciphersuites, cfg.cipher_list, cfg.certificate_chain_file,
-                                  cfg.private_key_file, cfg.private_key_password, false);
+                                  cfg.private_key_file, cfg.private_key_password, false, cfg.enable_ktls);
     if (bRes) {
         int mode = SSL_VERIFY_NONE;
 
@@ -7,13 +7,16 @@
 #include "openssl_util.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unistd.h>
 
@@ -94,6 +97,18 @@ public:
 class OcspCache {
 public:
     using ocsp_entry_t = std::tuple<openssl::sha_256_digest_t, const char*>;
+    using clock_t = std::chrono::system_clock;
+
+    /**
+     * \brief validity of a cached OCSP response
+     * \note when a response contains several single responses the earliest
+     *       nextUpdate is reported
+     */
+    struct status_t {
+        openssl::sha_256_digest_t digest;
+        std::optional<clock_t::time_point> this_update;
+        std::optional<clock_t::time_point> next_update;
+    };
 
 private:
     std::unique_ptr<ocsp_cache_ctx> m_context;
@@ -110,6 +125,113 @@ public:
     bool load(const std::vector<ocsp_entry_t>& filenames);
     std::shared_ptr<OcspResponse> lookup(const openssl::sha_256_digest_t& digest);
     static bool digest(openssl::sha_256_digest_t& digest, const x509_st* cert);
+
+    /**
+     * \brief validity of all cached responses
+     * \return one entry per cached response
+     */
+    std::vector<status_t> status();
+
+    /**
+     * \brief earliest nextUpdate of all cached responses
+     * \return the time or std::nullopt when no cached response has a nextUpdate
+     */
+    std::optional<clock_t::time_point> next_update();
+};
+
+// ----------------------------------------------------------------------------
+// Refreshing the OCSP cache ahead of expiry
+
+/**
+ * \brief reloads an OcspCache ahead of the nextUpdate of its responses
+ *
+ * The refresh function is called once on start() so that the cache is warm
+ * before the first handshake, and then lead_time (minus a random jitter)
+ * before the earliest nextUpdate in the cache. When the reload didn't
+ * produce fresher responses it is retried every retry_interval.
+ *
+ * The refresh function is expected to reload the cache via OcspCache::load()
+ * (e.g. via Server::update_ocsp_cache()) which swaps all responses atomically.
+ */
+class OcspRefreshScheduler {
+public:
+    using clock_t = OcspCache::clock_t;
+    using refresh_t = std::function<bool()>;
+
+    struct config_t {
+        std::chrono::seconds lead_time{std::chrono::hours(24)};        //!< refresh this long before nextUpdate
+        std::chrono::seconds jitter{std::chrono::hours(1)};            //!< maximum random offset added to lead_time
+        std::chrono::seconds retry_interval{std::chrono::minutes(15)}; //!< minimum time between two refreshes
+        std::chrono::seconds max_interval{std::chrono::hours(24)};     //!< maximum time between two refreshes
+    };
+
+    /**
+     * \brief freshness of the cache after the last refresh
+     */
+    struct metrics_t {
+        std::uint32_t refreshes{0};        //!< number of refresh attempts
+        std::uint32_t failed_refreshes{0}; //!< number of refresh attempts that returned false
+        std::size_t entries{0};            //!< number of cached responses
+        std::size_t expired_entries{0};    //!< cached responses past their nextUpdate
+        std::optional<clock_t::time_point> last_refresh;
+        std::optional<clock_t::time_point> next_update; //!< earliest nextUpdate in the cache
+        std::optional<clock_t::time_point> next_refresh;
+    };
+
+private:
+    OcspCache& m_cache;
+    refresh_t m_refresh;
+    config_t m_config;
+    metrics_t m_metrics;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_exit{false};
+    bool m_triggered{false};
+
+    void run();
+
+public:
+    OcspRefreshScheduler(OcspCache& cache, refresh_t refresh, const config_t& config);
+    OcspRefreshScheduler(OcspCache& cache, refresh_t refresh);
+    OcspRefreshScheduler(const OcspRefreshScheduler&) = delete;
+    OcspRefreshScheduler(OcspRefreshScheduler&&) = delete;
+    OcspRefreshScheduler& operator=(const OcspRefreshScheduler&) = delete;
+    OcspRefreshScheduler& operator=(OcspRefreshScheduler&&) = delete;
+    ~OcspRefreshScheduler();
+
+    /**
+     * \brief start the scheduler thread, refreshes immediately
+     */
+    void start();
+
+    /**
+     * \brief stop the scheduler thread
+     * \note blocks until a running refresh has completed
+     */
+    void stop();
+
+    /**
+     * \brief refresh now, e.g. after new OCSP responses have been stored
+     */
+    void trigger();
+
+    /**
+     * \brief cache freshness after the last refresh
+     */
+    metrics_t metrics();
+
+    /**
+     * \brief calculate when the next refresh is due
+     * \param[in] now current time
+     * \param[in] next_update earliest nextUpdate in the cache
+     * \param[in] config scheduler configuration
+     * \param[in] jitter random offset in the range [0, config.jitter]
+     * \return time of the next refresh
+     */
+    static clock_t::time_point next_refresh(clock_t::time_point now,
+                                            const std::optional<clock_t::time_point>& next_update,
+                                            const config_t& config, std::chrono::seconds jitter);
 };
 
 // ----------------------------------------------------------------------------
@@ -277,6 +399,20 @@ public:
      */
     [[nodiscard]] result_t write(const std::byte* buf, std::size_t num, std::size_t& writebytes);
 
+    /**
+     * \brief write part of a file to the TLS connection
+     * \param[in] fd file descriptor of the file to send
+     * \param[in] offset offset in the file to start from
+     * \param[in] num number of bytes to send
+     * \param[out] writebytes number of sent bytes. May be less than num
+     *             when there has been a timeout or the end of the file was reached
+     * \return success, error, or timeout. On error the connection will have been closed
+     * \note with kernel TLS the file is sent without being copied to userspace (SSL_sendfile),
+     *       otherwise it is read in blocks and sent via SSL_write
+     * \note after a timeout the remaining data must be sent again starting at offset + writebytes
+     */
+    [[nodiscard]] result_t sendfile(int fd, std::int64_t offset, std::size_t num, std::size_t& writebytes);
+
     /**
      * \brief close the TLS connection
      */
@@ -309,6 +445,21 @@ public:
      * \returns the underlying socket or INVALID_SOCKET on error
      */
     [[nodiscard]] int socket() const;
+
+    /**
+     * \brief check whether the kernel encrypts the records sent
+     * \return true when kernel TLS is active for sending
+     * \note kernel TLS needs to be enabled in the configuration, the kernel
+     *       needs the tls module and the negotiated cipher needs to be supported
+     *       by it. Otherwise OpenSSL uses userspace encryption.
+     */
+    [[nodiscard]] bool ktls_send() const;
+
+    /**
+     * \brief check whether the kernel decrypts the records received
+     * \return true when kernel TLS is active for receiving
+     */
+    [[nodiscard]] bool ktls_recv() const;
 };
 
 /**
@@ -439,6 +590,7 @@ public:
         std::int32_t io_timeout_ms{-1}; // socket timeout in milliseconds
         bool ipv6_only{true};
         bool verify_client{true};
+        bool enable_ktls{false}; // kernel TLS after the handshake when supported by kernel and cipher
     };
 
 private:
@@ -504,6 +656,22 @@ public:
      */
     bool update(const config_t& cfg);
 
+    /**
+     * \brief update the OCSP cache only
+     * \param[in] cfg server configuration (certificate chain and OCSP files)
+     * \return true on success
+     * \note existing connections and the SSL config are not affected
+     */
+    bool update_ocsp_cache(const config_t& cfg);
+
+    /**
+     * \brief access the OCSP cache e.g. for an OcspRefreshScheduler
+     * \return the cache used for status_request and status_request_v2
+     */
+    OcspCache& ocsp_cache() {
+        return m_cache;
+    }
+
     /**
      * \brief wait for incomming connections
      * \param[in] handler called when there is a new connection
@@ -575,6 +743,7 @@ public:
         bool verify_server{true};
         bool status_request{false};
         bool status_request_v2{false};
+        bool enable_ktls{false}; // kernel TLS after the handshake when supported by kernel and cipher
     };
 
 private:
@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright Pionix GmbH and Contributors to EVerest
+"""Merges the <module>.trace.json files written to EVEREST_TRACE_DIR into one trace.
+
+All modules take their timestamps from CLOCK_MONOTONIC and every module runs in its own process, so the events can
+be concatenated as they are. The result opens in chrome://tracing and the Perfetto UI.
+"""
+
+import argparse
+import json
+from pathlib import Path
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Merge the traces of EVerest modules into one trace')
+    parser.add_argument('trace_dir', type=Path, help='directory the modules wrote their traces to')
+    parser.add_argument('-o', '--output', type=Path, default=Path('everest.trace.json'), help='merged trace')
+    args = parser.parse_args()
+
+    trace_events = []
+    for trace_file in sorted(args.trace_dir.glob('*.trace.json')):
+        if trace_file.resolve() == args.output.resolve():
+            continue
+        with trace_file.open() as f:
+            trace_events.extend(json.load(f).get('traceEvents', []))
+
+    with args.output.open('w') as f:
+        json.dump({'traceEvents': trace_events, 'displayTimeUnit': 'ms'}, f)
+    print(f'Merged {len(trace_events)} events into {args.output}')
+
+
+if __name__ == '__main__':
+    main()
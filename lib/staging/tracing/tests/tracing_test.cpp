@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <gtest/gtest.h>
+#include <tracing/tracing.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+class TracingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        tracing::clear();
+        tracing::set_enabled(true);
+    }
+
+    void TearDown() override {
+        tracing::set_enabled(false);
+    }
+
+    static std::vector<nlohmann::json> events(const std::string& name) {
+        std::vector<nlohmann::json> result;
+        const auto trace = nlohmann::json::parse(tracing::export_chrome_json());
+        for (const auto& event : trace.at("traceEvents")) {
+            if (event.at("name") == name and event.at("ph") != "M") {
+                result.push_back(event);
+            }
+        }
+        return result;
+    }
+};
+
+TEST_F(TracingTest, disabledRecordsNothing) {
+    tracing::set_enabled(false);
+    int evaluated = 0;
+    {
+        EVTRACE_SCOPE("disabled");
+        EVTRACE_SCOPE_ID("disabled_with_id", (evaluated++, tracing::TraceId{1}));
+        EVTRACE_INSTANT("disabled_instant", (evaluated++, tracing::TraceId{1}));
+    }
+    EXPECT_EQ(evaluated, 0);
+    EXPECT_TRUE(events("disabled").empty());
+    EXPECT_TRUE(events("disabled_with_id").empty());
+    EXPECT_TRUE(events("disabled_instant").empty());
+}
+
+TEST_F(TracingTest, exportsScopesAndFlows) {
+    const auto id = tracing::trace_id_from_session("4b3c4e4c-1b0b-4d1e-9a43-1b2a4a7b1f00");
+    {
+        EVTRACE_SCOPE_ID("session_event", id);
+        EVTRACE_SCOPE("inner");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EVTRACE_INSTANT("plug_in", id);
+
+    const auto outer = events("session_event");
+    ASSERT_EQ(outer.size(), 1);
+    EXPECT_EQ(outer[0].at("ph"), "X");
+    EXPECT_GE(outer[0].at("dur").get<double>(), 2000.0);
+    EXPECT_EQ(outer[0].at("bind_id"), outer[0].at("args").at("trace_id"));
+    EXPECT_TRUE(outer[0].at("flow_in").get<bool>());
+
+    const auto inner = events("inner");
+    ASSERT_EQ(inner.size(), 1);
+    EXPECT_FALSE(inner[0].contains("bind_id"));
+    EXPECT_GE(inner[0].at("ts").get<double>(), outer[0].at("ts").get<double>());
+
+    const auto instant = events("plug_in");
+    ASSERT_EQ(instant.size(), 1);
+    EXPECT_EQ(instant[0].at("ph"), "i");
+    EXPECT_EQ(instant[0].at("args").at("trace_id"), outer[0].at("args").at("trace_id"));
+}
+
+TEST_F(TracingTest, sessionTraceIdIsStable) {
+    EXPECT_EQ(tracing::trace_id_from_session(""), tracing::NO_TRACE_ID);
+    EXPECT_EQ(tracing::trace_id_from_session("a"), tracing::trace_id_from_session("a"));
+    EXPECT_NE(tracing::trace_id_from_session("a"), tracing::trace_id_from_session("b"));
+}
+
+TEST_F(TracingTest, keepsLatestEventsOfThread) {
+    const auto name = tracing::intern("ring");
+    for (std::size_t i = 0; i < tracing::EVENTS_PER_THREAD + 100; i++) {
+        tracing::record_complete(name, tracing::NO_TRACE_ID, i, i + 1);
+    }
+    const auto recorded = events("ring");
+    ASSERT_EQ(recorded.size(), tracing::EVENTS_PER_THREAD);
+    EXPECT_EQ(recorded.front().at("ts").get<double>(), 100 / 1000.0);
+}
+
+TEST_F(TracingTest, recordsFromManyThreadsWhileExporting) {
+    constexpr int threads = 8;
+    constexpr int scopes_per_thread = 1000;
+    std::atomic<bool> done{false};
+
+    std::thread exporter([&done]() {
+        while (not done) {
+            const auto trace = nlohmann::json::parse(tracing::export_chrome_json());
+            EXPECT_TRUE(trace.at("traceEvents").is_array());
+        }
+    });
+
+    // the writers stay alive until all have finished, an exited thread hands its buffer to the next new thread
+    std::atomic<int> finished{0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; t++) {
+        writers.emplace_back([&finished]() {
+            for (int i = 0; i < scopes_per_thread; i++) {
+                EVTRACE_SCOPE("worker");
+            }
+            finished++;
+            while (finished < threads) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    exporter.join();
+
+    EXPECT_EQ(events("worker").size(), threads * scopes_per_thread);
+}
+
+} // namespace
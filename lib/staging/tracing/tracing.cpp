@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <tracing/tracing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+#include <nlohmann/json.hpp>
+
+namespace tracing {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+constexpr std::int64_t INSTANT = -1;
+
+// all fields are atomics, so the exporter can read a slot while its thread overwrites it
+struct Event {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<TraceId> id{NO_TRACE_ID};
+    std::atomic<std::int64_t> tid{0};
+    std::atomic<std::int64_t> start_ns{0};
+    std::atomic<std::int64_t> duration_ns{0};
+};
+
+struct ThreadBuffer {
+    // a buffer is written by one thread at a time, it is handed over to a new thread when its thread exits
+    std::atomic<bool> in_use{true};
+    // reserved is advanced before a slot is written, committed after it was written
+    std::atomic<std::uint64_t> reserved{0};
+    std::atomic<std::uint64_t> committed{0};
+    std::atomic<std::uint64_t> cleared{0};
+    std::array<Event, EVENTS_PER_THREAD> events;
+};
+
+struct Registry {
+    std::mutex mutex;
+    // never shrinks, so the exporter can read buffers of threads that are gone
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // node based, the c_str() of an element stays valid
+    std::unordered_set<std::string> names;
+    std::string process_name{"everest"};
+};
+
+Registry& registry() {
+    // never destroyed, threads may still record during static destruction
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+struct BufferOwner {
+    ThreadBuffer* buffer{nullptr};
+
+    ~BufferOwner() {
+        if (buffer != nullptr) {
+            buffer->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local BufferOwner owner;
+
+ThreadBuffer& thread_buffer() {
+    if (owner.buffer == nullptr) {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto& buffer : r.buffers) {
+            bool expected = false;
+            if (buffer->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                owner.buffer = buffer.get();
+                break;
+            }
+        }
+        if (owner.buffer == nullptr) {
+            r.buffers.push_back(std::make_unique<ThreadBuffer>());
+            owner.buffer = r.buffers.back().get();
+        }
+    }
+    return *owner.buffer;
+}
+
+std::int64_t current_tid() {
+    thread_local const std::int64_t tid = syscall(SYS_gettid);
+    return tid;
+}
+
+void record(const char* name, TraceId id, std::int64_t start_ns, std::int64_t duration_ns) {
+    auto& buffer = thread_buffer();
+    const auto index = buffer.reserved.load(std::memory_order_relaxed);
+    buffer.reserved.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto& event = buffer.events[index % EVENTS_PER_THREAD];
+    event.name.store(name, std::memory_order_relaxed);
+    event.id.store(id, std::memory_order_relaxed);
+    event.tid.store(current_tid(), std::memory_order_relaxed);
+    event.start_ns.store(start_ns, std::memory_order_relaxed);
+    event.duration_ns.store(duration_ns, std::memory_order_relaxed);
+
+    buffer.committed.store(index + 1, std::memory_order_release);
+}
+
+struct EventCopy {
+    const char* name;
+    TraceId id;
+    std::int64_t tid;
+    std::int64_t start_ns;
+    std::int64_t duration_ns;
+};
+
+// copies the events of \p buffer that were not overwritten while copying
+void copy_events(const ThreadBuffer& buffer, std::vector<EventCopy>& out) {
+    const auto committed = buffer.committed.load(std::memory_order_acquire);
+    const auto cleared = buffer.cleared.load(std::memory_order_relaxed);
+    auto first = committed > EVENTS_PER_THREAD ? committed - EVENTS_PER_THREAD : 0;
+    first = std::max(first, cleared);
+
+    std::vector<std::pair<std::uint64_t, EventCopy>> copies;
+    copies.reserve(committed - std::min(first, committed));
+    for (auto index = first; index < committed; index++) {
+        const auto& event = buffer.events[index % EVENTS_PER_THREAD];
+        copies.push_back({index,
+                          {event.name.load(std::memory_order_relaxed), event.id.load(std::memory_order_relaxed),
+                           event.tid.load(std::memory_order_relaxed), event.start_ns.load(std::memory_order_relaxed),
+                           event.duration_ns.load(std::memory_order_relaxed)}});
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto reserved = buffer.reserved.load(std::memory_order_relaxed);
+    const auto valid_from = reserved > EVENTS_PER_THREAD ? reserved - EVENTS_PER_THREAD : 0;
+    for (const auto& [index, copy] : copies) {
+        if (index >= valid_from and copy.name != nullptr) {
+            out.push_back(copy);
+        }
+    }
+}
+
+std::uint64_t total_recorded() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::uint64_t total = 0;
+    for (const auto& buffer : r.buffers) {
+        total += buffer->committed.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string to_hex(TraceId id) {
+    char buffer[19];
+    std::snprintf(buffer, sizeof(buffer), "0x%016llx", static_cast<unsigned long long>(id));
+    return buffer;
+}
+
+} // namespace
+
+void set_enabled(bool enable) {
+    detail::enabled.store(enable, std::memory_order_relaxed);
+}
+
+void init(const std::string& process_name) {
+    const char* dir = std::getenv("EVEREST_TRACE_DIR");
+    if (dir == nullptr or *dir == '\0') {
+        return;
+    }
+
+    static std::once_flag started;
+    std::call_once(started, [&process_name, dir]() {
+        {
+            auto& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.process_name = process_name;
+        }
+        set_enabled(true);
+
+        const auto path = std::string(dir) + "/" + process_name + ".trace.json";
+        EVLOG_info << "Tracing enabled, writing trace to " << path;
+        std::thread([path]() {
+            std::uint64_t written = 0;
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                const auto recorded = total_recorded();
+                if (recorded != written and write_chrome_json(path)) {
+                    written = recorded;
+                }
+            }
+        }).detach();
+    });
+}
+
+TraceId trace_id_from_session(const std::string& session_uuid) {
+    if (session_uuid.empty()) {
+        return NO_TRACE_ID;
+    }
+    // FNV-1a, the same in every module
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const auto c : session_uuid) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash == NO_TRACE_ID ? 1 : hash;
+}
+
+const char* intern(const std::string& name) {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.names.insert(name).first->c_str();
+}
+
+std::int64_t now_ns() {
+    // CLOCK_MONOTONIC is shared by all processes, unlike the epoch of std::chrono::steady_clock in general
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void record_complete(const char* name, TraceId id, std::int64_t start_ns, std::int64_t end_ns) {
+    record(name, id, start_ns, end_ns - start_ns);
+}
+
+void record_instant(const char* name, TraceId id) {
+    record(name, id, now_ns(), INSTANT);
+}
+
+std::string export_chrome_json() {
+    std::vector<EventCopy> events;
+    std::string process_name;
+    {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        process_name = r.process_name;
+        for (const auto& buffer : r.buffers) {
+            copy_events(*buffer, events);
+        }
+    }
+
+    const auto pid = static_cast<std::int64_t>(getpid());
+    auto trace_events = nlohmann::json::array();
+    trace_events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", pid}, {"args", {{"name", process_name}}}});
+
+    for (const auto& event : events) {
+        nlohmann::json entry = {{"name", event.name},
+                                {"cat", "everest"},
+                                {"pid", pid},
+                                {"tid", event.tid},
+                                {"ts", static_cast<double>(event.start_ns) / 1000.0}};
+        if (event.duration_ns == INSTANT) {
+            entry["ph"] = "i";
+            entry["s"] = "t";
+        } else {
+            entry["ph"] = "X";
+            entry["dur"] = static_cast<double>(event.duration_ns) / 1000.0;
+        }
+        if (event.id != NO_TRACE_ID) {
+            const auto id = to_hex(event.id);
+            entry["args"] = {{"trace_id", id}};
+            if (event.duration_ns != INSTANT) {
+                // links all slices of the same trace id, also across processes
+                entry["bind_id"] = id;
+                entry["flow_in"] = true;
+                entry["flow_out"] = true;
+            }
+        }
+        trace_events.push_back(std::move(entry));
+    }
+
+    return nlohmann::json{{"traceEvents", std::move(trace_events)}, {"displayTimeUnit", "ms"}}.dump();
+}
+
+bool write_chrome_json(const std::string& path) {
+    // written to a temporary file first, so readers never see a partial trace
+    const auto tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::trunc);
+        if (not file) {
+            EVLOG_warning << "Could not write trace to " << tmp_path;
+            return false;
+        }
+        file << export_chrome_json() << "\n";
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        EVLOG_warning << "Could not write trace to " << path;
+        return false;
+    }
+    return true;
+}
+
+void clear() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& buffer : r.buffers) {
+        buffer->cleared.store(buffer->committed.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+} // namespace tracing
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVEREST_TRACING_HPP
+#define EVEREST_TRACING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/// \brief Lightweight tracing of the hot paths of a charging session across modules.
+///
+/// Tracing is off by default: a disabled EVTRACE_SCOPE costs one relaxed atomic load and does not evaluate its trace
+/// id. When enabled, every thread records into its own ring buffer without locks. The buffers of a module are exported
+/// in the Chrome trace event format, which chrome://tracing and the Perfetto UI open directly.
+///
+/// Timestamps are taken from CLOCK_MONOTONIC, which all processes on the charger share, so the traces of several
+/// modules can be merged into one timeline (see merge_traces.py). Events with the same trace id are linked by flow
+/// arrows. The trace id of a charging session is derived from its session uuid with trace_id_from_session(), so every
+/// module that knows the session uuid links its events to the same flow.
+namespace tracing {
+
+using TraceId = std::uint64_t;
+constexpr TraceId NO_TRACE_ID = 0;
+
+/// \brief number of events kept per thread, older events are overwritten
+constexpr std::size_t EVENTS_PER_THREAD = 4096;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}
+
+inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+void set_enabled(bool enable);
+
+/// \brief Enables tracing if the environment variable EVEREST_TRACE_DIR is set. The trace of this process is then
+/// written to EVEREST_TRACE_DIR/<process_name>.trace.json every second while new events are recorded.
+void init(const std::string& process_name);
+
+/// \brief Stable trace id of a charging session, NO_TRACE_ID for an empty uuid
+TraceId trace_id_from_session(const std::string& session_uuid);
+
+/// \brief Returns a pointer to a copy of \p name that stays valid for the lifetime of the process, for event names
+/// that are not string literals. Takes a lock, only call it when tracing is enabled.
+const char* intern(const std::string& name);
+
+std::int64_t now_ns();
+
+/// \brief Records an event that started at \p start_ns and ended at \p end_ns. \p name must stay valid for the
+/// lifetime of the process (a string literal or the result of intern()).
+void record_complete(const char* name, TraceId id, std::int64_t start_ns, std::int64_t end_ns);
+
+/// \brief Records an event without duration
+void record_instant(const char* name, TraceId id);
+
+/// \brief Trace of all threads of this process in the Chrome trace event format
+std::string export_chrome_json();
+
+/// \brief Writes export_chrome_json() to \p path, returns false on error
+bool write_chrome_json(const std::string& path);
+
+/// \brief Discards all recorded events, e.g. between tests
+void clear();
+
+/// \brief Records the time from its construction to its destruction if tracing was enabled at construction
+class Scope {
+public:
+    explicit Scope(const char* name, TraceId id = NO_TRACE_ID) {
+        if (enabled()) {
+            this->name = name;
+            this->id = id;
+            this->start_ns = now_ns();
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() {
+        if (name != nullptr) {
+            record_complete(name, id, start_ns, now_ns());
+        }
+    }
+
+private:
+    const char* name{nullptr};
+    TraceId id{NO_TRACE_ID};
+    std::int64_t start_ns{0};
+};
+
+} // namespace tracing
+
+#define EVTRACE_CONCAT_INNER(a, b) a##b
+#define EVTRACE_CONCAT(a, b)       EVTRACE_CONCAT_INNER(a, b)
+
+/// \brief Traces the enclosing scope, \p name must be a string literal
+#define EVTRACE_SCOPE(name) ::tracing::Scope EVTRACE_CONCAT(evtrace_scope_, __LINE__)(name)
+
+/// \brief Traces the enclosing scope as part of the flow \p id, which is only evaluated if tracing is enabled
+#define EVTRACE_SCOPE_ID(name, id)                                                                                     \
+    ::tracing::Scope EVTRACE_CONCAT(evtrace_scope_, __LINE__)(name,                                                    \
+                                                              ::tracing::enabled() ? (id) : ::tracing::NO_TRACE_ID)
+
+/// \brief Records an instant event as part of the flow \p id, which is only evaluated if tracing is enabled
+#define EVTRACE_INSTANT(name, id)                                                                                      \
+    do {                                                                                                               \
+        if (::tracing::enabled()) {                                                                                    \
+            ::tracing::record_instant(name, (id));                                                                     \
+        }                                                                                                              \
+    } while (0)
+
+#endif // EVEREST_TRACING_HPP
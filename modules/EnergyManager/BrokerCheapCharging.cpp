@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "BrokerCheapCharging.hpp"
+#include <algorithm>
+#include <everest/logging.hpp>
+
+namespace module {
+
+BrokerCheapCharging::BrokerCheapCharging(Market& _market, std::vector<float> _planned_power_W) :
+    Broker(_market), planned_power_W(std::move(_planned_power_W)) {
+}
+
+bool BrokerCheapCharging::trade(Offer& offer) {
+    if (bought) {
+        // the plan is complete, leave the rest of the market to the other brokers
+        return false;
+    }
+    bought = true;
+
+    if (globals.debug)
+        EVLOG_info << local_market.energy_flow_request.uuid << " Broker: " << offer;
+
+    ScheduleRes trading = globals.empty_schedule_res;
+    bool traded = false;
+    const auto voltage = local_market.nominal_ac_voltage();
+
+    for (int i = 0; i < globals.schedule_length and i < static_cast<int>(planned_power_W.size()); i++) {
+        // the offer may be lower than planned, e.g. if other brokers bought before us
+        const auto& limits = offer.import_offer[i].limits_to_root;
+        auto power = planned_power_W[i];
+        if (limits.total_power_W.has_value()) {
+            power = std::min<float>(power, limits.total_power_W.value());
+        }
+
+        if (limits.ac_max_current_A.has_value()) {
+            const auto phases = limits.ac_max_phase_count.value_or(3);
+            auto ampere = std::min<float>(power / phases / voltage, limits.ac_max_current_A.value());
+
+            // the plan does not know about the minimal current, round up if the offer allows it
+            const auto min_current = limits.ac_min_current_A.value_or(0.);
+            if (ampere > 0. and ampere < min_current) {
+                const bool min_current_available =
+                    min_current <= limits.ac_max_current_A.value() and
+                    (not limits.total_power_W.has_value() or
+                     min_current * phases * voltage <= limits.total_power_W.value());
+                ampere = min_current_available ? min_current : 0.;
+            }
+
+            trading[i].limits_to_root.ac_max_current_A = std::max<float>(ampere, 0.);
+            trading[i].limits_to_root.ac_max_phase_count = phases;
+            if (limits.total_power_W.has_value()) {
+                trading[i].limits_to_root.total_power_W = std::max<float>(ampere * phases * voltage, 0.);
+            }
+            traded = traded or ampere > 0.;
+        } else if (limits.total_power_W.has_value()) {
+            trading[i].limits_to_root.total_power_W = std::max<float>(power, 0.);
+            traded = traded or power > 0.;
+        }
+    }
+
+    local_market.trade(trading);
+    return traded;
+}
+
+} // namespace module
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef BROKER_CHEAP_CHARGING_HPP
+#define BROKER_CHEAP_CHARGING_HPP
+
+#include "Broker.hpp"
+
+namespace module {
+
+// This broker buys the import planned by the CostOptimizer for its EVSE, all slots in the first trade.
+class BrokerCheapCharging : public Broker {
+public:
+    BrokerCheapCharging(Market& market, std::vector<float> planned_power_W);
+    virtual bool trade(Offer& offer) override;
+
+private:
+    std::vector<float> planned_power_W;
+    bool bought{false};
+};
+
+} // namespace module
+
+#endif // BROKER_CHEAP_CHARGING_HPP
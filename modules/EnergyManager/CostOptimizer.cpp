@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "CostOptimizer.hpp"
+#include "MinCostFlow.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <everest/logging.hpp>
+#include <optional>
+
+namespace module {
+
+namespace {
+
+// prefer earlier slots if the price is the same, must be well below any real price difference per Wh
+constexpr double TIE_BREAK_PER_SLOT = 1e-9;
+
+struct MarketNode {
+    Market* market;
+    int parent;
+    int phases;
+    ScheduleReq available;
+    std::vector<int> slot_nodes;
+    std::vector<int> up_edges; // to the parent slot or the sink
+    std::vector<std::int64_t> capacities;
+    std::vector<int> evses;    // indices of the planned EVSEs below this node (including itself)
+};
+
+std::optional<double> power_limit(const types::energy::LimitsReq& limits, int phases, double voltage) {
+    std::optional<double> power;
+    if (limits.ac_max_current_A.has_value()) {
+        power = limits.ac_max_current_A.value() * phases * voltage;
+    }
+    if (limits.total_power_W.has_value() and (not power.has_value() or limits.total_power_W.value() < power)) {
+        power = limits.total_power_W.value();
+    }
+    return power;
+}
+
+std::int64_t to_capacity(const std::optional<double>& power_W, double hours) {
+    if (not power_W.has_value()) {
+        return MinCostFlow::INFINITE_CAPACITY;
+    }
+    return std::max<std::int64_t>(0, std::floor(power_W.value() * hours));
+}
+
+double hours_between(date::utc_clock::time_point from, date::utc_clock::time_point to) {
+    return std::max(0., std::chrono::duration<double, std::ratio<3600>>(to - from).count());
+}
+
+} // namespace
+
+bool CostOptimizer::wants_cost_optimization(const types::energy::EnergyFlowRequest& evse) {
+    return evse.optimizer_target.has_value() and evse.optimizer_target->energy_amount_needed.has_value() and
+           evse.optimizer_target->leave_time.has_value();
+}
+
+const CostOptimizer::Stats& CostOptimizer::last_stats() const {
+    return stats;
+}
+
+std::map<Market*, std::vector<float>> CostOptimizer::plan(const std::vector<Market*>& evses) {
+    const auto& slots = globals.empty_schedule_req;
+    const int slot_count = slots.size();
+
+    // slot begin and end, the first slot starts before start_time
+    std::vector<date::utc_clock::time_point> slot_begin(slot_count);
+    std::vector<date::utc_clock::time_point> slot_end(slot_count);
+    for (int t = 0; t < slot_count; t++) {
+        slot_begin[t] = std::max(Everest::Date::from_rfc3339(slots[t].timestamp), globals.start_time);
+    }
+    for (int t = 0; t < slot_count; t++) {
+        slot_end[t] = t + 1 < slot_count ? slot_begin[t + 1]
+                                         : Everest::Date::from_rfc3339(slots[t].timestamp) + globals.interval_duration;
+    }
+
+    // all market places on the way from the planned EVSEs to the root, parents before children
+    std::vector<MarketNode> nodes;
+    std::map<Market*, int> node_index;
+    const auto add_market = [&](Market* market, const auto& add_parent) -> int {
+        const auto found = node_index.find(market);
+        if (found != node_index.end()) {
+            return found->second;
+        }
+        const int parent = market->is_root() ? -1 : add_parent(market->parent(), add_parent);
+        MarketNode node{market, parent, 3, market->get_available_energy_import(), {}, {}, {}, {}};
+        nodes.push_back(std::move(node));
+        node_index[market] = nodes.size() - 1;
+        return nodes.size() - 1;
+    };
+
+    std::vector<int> evse_nodes;
+    for (std::size_t i = 0; i < evses.size(); i++) {
+        const int index = add_market(evses[i], add_market);
+        evse_nodes.push_back(index);
+        for (int node = index; node >= 0; node = nodes[node].parent) {
+            nodes[node].evses.push_back(i);
+        }
+    }
+
+    MinCostFlow network;
+    const int source = network.add_node();
+    const int sink = network.add_node();
+
+    for (auto& node : nodes) {
+        for (int t = 0; t < slot_count; t++) {
+            node.slot_nodes.push_back(network.add_node());
+        }
+    }
+    for (std::size_t n = 0; n < nodes.size(); n++) {
+        auto& node = nodes[n];
+        if (node.market->energy_flow_request.node_type == types::energy::NodeType::Evse) {
+            node.phases = node.available.empty() ? 3 : node.available[0].limits_to_root.ac_max_phase_count.value_or(3);
+        }
+        for (int t = 0; t < slot_count; t++) {
+            const auto capacity = to_capacity(
+                power_limit(node.available[t].limits_to_root, node.phases, node.market->nominal_ac_voltage()),
+                hours_between(slot_begin[t], slot_end[t]));
+            const int to = node.parent >= 0 ? nodes[node.parent].slot_nodes[t] : sink;
+            node.up_edges.push_back(network.add_edge(node.slot_nodes[t], to, capacity, 0.));
+            node.capacities.push_back(capacity);
+        }
+    }
+
+    // energy needed per EVSE and its import per slot until the leave time
+    std::vector<int> demand_edges;
+    std::vector<std::vector<int>> slot_edges(evses.size());
+    std::vector<std::vector<std::int64_t>> start_flow(evses.size(), std::vector<std::int64_t>(slot_count, 0));
+    std::vector<std::vector<double>> usable_hours(evses.size(), std::vector<double>(slot_count, 0.));
+    std::vector<std::int64_t> demand(evses.size());
+
+    stats = Stats{};
+    for (std::size_t i = 0; i < evses.size(); i++) {
+        const auto& request = evses[i]->energy_flow_request;
+        const auto& target = request.optimizer_target.value();
+        const auto& node = nodes[evse_nodes[i]];
+
+        auto leave_time = slot_end.empty() ? globals.start_time : slot_end.back();
+        try {
+            leave_time = std::min(leave_time, Everest::Date::from_rfc3339(target.leave_time.value()));
+        } catch (const std::exception& e) {
+            EVLOG_warning << request.uuid << ": invalid leave_time, planning until the end of the schedule";
+        }
+
+        demand[i] = std::max<std::int64_t>(0, std::llround(target.energy_amount_needed.value() * 1000.));
+        const int evse = network.add_node();
+        demand_edges.push_back(network.add_edge(source, evse, demand[i], 0.));
+
+        const auto previous_flow = previous.find(request.uuid);
+        for (int t = 0; t < slot_count; t++) {
+            usable_hours[i][t] = hours_between(slot_begin[t], std::min(slot_end[t], leave_time));
+
+            // the price is merged into the schedule of the EVSE or one of its parents
+            double price_per_kwh = 0.;
+            for (int n = evse_nodes[i]; n >= 0; n = nodes[n].parent) {
+                if (nodes[n].available[t].price_per_kwh.has_value()) {
+                    price_per_kwh = nodes[n].available[t].price_per_kwh->value;
+                    break;
+                }
+            }
+
+            const auto capacity =
+                to_capacity(power_limit(node.available[t].limits_to_root, node.phases, node.market->nominal_ac_voltage()),
+                            usable_hours[i][t]);
+            slot_edges[i].push_back(
+                network.add_edge(evse, node.slot_nodes[t], capacity, price_per_kwh / 1000. + TIE_BREAK_PER_SLOT * t));
+
+            if (previous_flow != previous.end()) {
+                const auto flow = previous_flow->second.find(slots[t].timestamp);
+                if (flow != previous_flow->second.end()) {
+                    start_flow[i][t] = std::min(flow->second, capacity);
+                    stats.warm_start = true;
+                }
+            }
+        }
+
+        // the car may have charged in the meantime, drop the start flow of the latest slots
+        std::int64_t total = 0;
+        for (int t = 0; t < slot_count; t++) {
+            start_flow[i][t] = std::min(start_flow[i][t], demand[i] - total);
+            total += start_flow[i][t];
+        }
+    }
+
+    // limits may have been lowered since the last run, make the start flow feasible again
+    for (const auto& node : nodes) {
+        for (int t = 0; t < slot_count; t++) {
+            std::int64_t excess = -node.capacities[t];
+            for (const auto i : node.evses) {
+                excess += start_flow[i][t];
+            }
+            for (auto i = node.evses.rbegin(); i != node.evses.rend() and excess > 0; i++) {
+                const auto reduce = std::min(excess, start_flow[*i][t]);
+                start_flow[*i][t] -= reduce;
+                excess -= reduce;
+            }
+        }
+    }
+
+    // load the start flow, conservation holds by construction
+    for (std::size_t i = 0; i < evses.size(); i++) {
+        std::int64_t total = 0;
+        for (int t = 0; t < slot_count; t++) {
+            network.set_flow(slot_edges[i][t], start_flow[i][t]);
+            total += start_flow[i][t];
+        }
+        network.set_flow(demand_edges[i], total);
+    }
+    for (auto& node : nodes) {
+        for (int t = 0; t < slot_count; t++) {
+            std::int64_t flow = 0;
+            for (const auto i : node.evses) {
+                flow += start_flow[i][t];
+            }
+            network.set_flow(node.up_edges[t], flow);
+        }
+    }
+
+    const auto result = network.solve(source, sink);
+    stats.augmentations = result.augmentations;
+    stats.cancelled_cycles = result.cancelled_cycles;
+    stats.energy_Wh = result.flow;
+
+    std::map<Market*, std::vector<float>> plans;
+    previous.clear();
+    for (std::size_t i = 0; i < evses.size(); i++) {
+        auto& plan = plans[evses[i]];
+        plan.resize(slot_count, 0.);
+        auto& solution = previous[evses[i]->energy_flow_request.uuid];
+        for (int t = 0; t < slot_count; t++) {
+            const auto energy_Wh = network.flow(slot_edges[i][t]);
+            if (energy_Wh > 0 and usable_hours[i][t] > 0.) {
+                plan[t] = energy_Wh / usable_hours[i][t];
+                solution[slots[t].timestamp] = energy_Wh;
+            }
+        }
+    }
+
+    // report the cost without the tie break
+    stats.cost = result.cost;
+    for (std::size_t i = 0; i < evses.size(); i++) {
+        for (int t = 0; t < slot_count; t++) {
+            stats.cost -= network.flow(slot_edges[i][t]) * TIE_BREAK_PER_SLOT * t;
+        }
+    }
+
+    return plans;
+}
+
+} // namespace module
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef COST_OPTIMIZER_HPP
+#define COST_OPTIMIZER_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Market.hpp"
+
+namespace module {
+
+// Plans the import of all EVSEs that have an energy target and a leave time for the lowest energy cost over the
+// schedule horizon. The limits of all market places on the way to the root are respected per schedule slot.
+//
+// The plan is solved as a min cost flow in Wh:
+//   source -> EVSE (energy needed) -> EVSE slot (price of the slot) -> parent slot -> ... -> root slot -> sink
+// Current limits are converted to power with the phase count of the EVSE (3 for all other nodes), the minimal
+// charging current is not part of the plan. Both are corrected by the broker when it buys the plan on the market.
+//
+// The flow of the previous run is used as start solution, so only the changes since then need to be solved.
+class CostOptimizer {
+public:
+    struct Stats {
+        bool warm_start{false};
+        int augmentations{0};
+        int cancelled_cycles{0};
+        std::int64_t energy_Wh{0};
+        double cost{0.};
+    };
+
+    /// \brief true if the EVSE asks for cheapest charging (energy_amount_needed and leave_time are set)
+    static bool wants_cost_optimization(const types::energy::EnergyFlowRequest& evse);
+
+    /// \brief plan the import of the given EVSE markets for the current globals schedule
+    /// \return planned import power in W per schedule slot for each EVSE market
+    std::map<Market*, std::vector<float>> plan(const std::vector<Market*>& evses);
+
+    const Stats& last_stats() const;
+
+private:
+    // solution of the last run in Wh per EVSE uuid and slot timestamp
+    std::map<std::string, std::map<std::string, std::int64_t>> previous;
+    Stats stats;
+};
+
+} // namespace module
+
+#endif // COST_OPTIMIZER_HPP
@@ -2,20 +2,39 @@
 // Copyright 2022 - 2022 Pionix GmbH and Contributors to EVerest
 #include "EnergyManager.hpp"
 #include "Broker.hpp"
+#include "BrokerCheapCharging.hpp"
 #include "BrokerFastCharging.hpp"
 #include "Market.hpp"
+#include <algorithm>
 #include <fmt/core.h>
+#include <iterator>
 #include <optional>
+#include <tracing/tracing.hpp>
 
 using namespace std::literals::chrono_literals;
 
 namespace module {
 
 void EnergyManager::init() {
+    tracing::init(info.id);
+
+    if (not config.record_file.empty()) {
+        try {
+            recorder = std::make_unique<EnergyRecorder>(config.record_file);
+            recorder->record_config(config);
+            EVLOG_info << "Recording energy flow requests to " << config.record_file;
+        } catch (const std::runtime_error& e) {
+            EVLOG_error << e.what();
+        }
+    }
+
     r_energy_trunk->subscribe_energy_flow_request([this](types::energy::EnergyFlowRequest e) {
         // Received new energy object from a child.
         std::scoped_lock lock(energy_mutex);
         energy_flow_request = e;
+        if (recorder) {
+            recorder->record_request(e);
+        }
 
         if (is_priority_request(e)) {
             // trigger optimization now
@@ -32,9 +51,19 @@ void EnergyManager::ready() {
     // start thread to update energy optimization
     std::thread([this] {
         while (true) {
-            globals.init(date::utc_clock::now(), config.schedule_interval_duration, config.schedule_total_duration,
-                         config.slice_ampere, config.slice_watt, config.debug, energy_flow_request);
-            auto optimized_values = run_optimizer(energy_flow_request);
+            const auto start_time = date::utc_clock::now();
+            types::energy::EnergyFlowRequest request;
+            {
+                // the tick must be recorded after exactly the requests this run sees
+                std::scoped_lock lock(energy_mutex);
+                request = energy_flow_request;
+                if (recorder) {
+                    recorder->record_tick(start_time);
+                }
+            }
+            globals.init(start_time, config.schedule_interval_duration, config.schedule_total_duration,
+                         config.slice_ampere, config.slice_watt, config.debug, request);
+            auto optimized_values = run_optimizer(request);
             enforce_limits(optimized_values);
             {
                 std::unique_lock<std::mutex> lock(mainloop_sleep_mutex);
@@ -64,7 +93,13 @@ bool EnergyManager::is_priority_request(const types::energy::EnergyFlowRequest&
 }
 
 void EnergyManager::enforce_limits(const std::vector<types::energy::EnforcedLimits>& limits) {
+    EVTRACE_SCOPE("EnergyManager::enforce_limits");
+    std::size_t published = 0;
     for (const auto& it : limits) {
+        if (not limits_need_publishing(it)) {
+            continue;
+        }
+        published++;
         if (globals.debug)
             EVLOG_info << fmt::format("\033[1;92m{} Enforce limits {}A {}W {} ph\033[1;0m", it.uuid,
                                       it.limits_root_side.value().ac_max_current_A.value_or(-9999),
@@ -72,6 +107,39 @@ void EnergyManager::enforce_limits(const std::vector<types::energy::EnforcedLimi
                                       it.limits_root_side.value().ac_max_phase_count.value_or(-9999));
         r_energy_trunk->call_enforce_limits(it);
     }
+
+    // forget EVSEs that left the energy tree
+    for (auto it = published_limits.begin(); it != published_limits.end();) {
+        const auto present = std::any_of(limits.begin(), limits.end(),
+                                         [&it](const types::energy::EnforcedLimits& l) { return l.uuid == it->first; });
+        it = present ? std::next(it) : published_limits.erase(it);
+    }
+
+    if (globals.debug) {
+        const auto total = limits_published + limits_suppressed;
+        EVLOG_info << fmt::format("Enforce limits: published {} of {}, {:.1f}% suppressed in total", published,
+                                  limits.size(), total > 0 ? 100.0 * limits_suppressed / total : 0.0);
+    }
+}
+
+bool EnergyManager::limits_need_publishing(const types::energy::EnforcedLimits& limits) {
+    // valid_until moves with every optimizer run, it is kept alive by the refresh below
+    json content = limits;
+    content.erase("valid_until");
+
+    // refresh after half of the validity, so the EVSE never runs into valid_until
+    const auto refresh_at = globals.start_time + std::chrono::seconds(config.update_interval * 10 / 2);
+
+    const auto last = published_limits.find(limits.uuid);
+    if (last != published_limits.end() and last->second.content == content and
+        globals.start_time < last->second.refresh_at) {
+        limits_suppressed++;
+        return false;
+    }
+
+    published_limits[limits.uuid] = {std::move(content), refresh_at};
+    limits_published++;
+    return true;
 }
 
 static BrokerFastCharging::Switch1ph3phMode to_switch_1ph3ph_mode(const std::string& m) {
@@ -85,6 +153,7 @@ static BrokerFastCharging::Switch1ph3phMode to_switch_1ph3ph_mode(const std::str
 }
 
 std::vector<types::energy::EnforcedLimits> EnergyManager::run_optimizer(types::energy::EnergyFlowRequest request) {
+    EVTRACE_SCOPE("EnergyManager::run_optimizer");
 
     std::scoped_lock lock(energy_mutex);
 
@@ -105,11 +174,34 @@ std::vector<types::energy::EnforcedLimits> EnergyManager::run_optimizer(types::e
 
     auto evse_markets = market.get_list_of_evses();
 
+    // evses with an energy target and a leave time are planned together for the lowest cost
+    std::vector<Market*> cost_optimized_evses;
+    std::copy_if(evse_markets.begin(), evse_markets.end(), std::back_inserter(cost_optimized_evses),
+                 [](Market* m) { return CostOptimizer::wants_cost_optimization(m->energy_flow_request); });
+
+    std::map<Market*, std::vector<float>> plans;
+    if (not cost_optimized_evses.empty()) {
+        time_probe plan_tp;
+        plan_tp.start();
+        plans = cost_optimizer.plan(cost_optimized_evses);
+        if (globals.debug) {
+            const auto& stats = cost_optimizer.last_stats();
+            EVLOG_info << fmt::format("Cost optimizer: {} evses, {} Wh for {:.2f}, {} augmentations, {} cycles, "
+                                      "warm start {} ({}ms)",
+                                      cost_optimized_evses.size(), stats.energy_Wh, stats.cost, stats.augmentations,
+                                      stats.cancelled_cycles, stats.warm_start, plan_tp.stop());
+        }
+    }
+
     for (auto m : evse_markets) {
-        // FIXME: check for actual optimizer_targets and create correct broker for this evse
-        // For now always create simple FastCharging broker
-        brokers.push_back(
-            std::make_shared<BrokerFastCharging>(*m, to_switch_1ph3ph_mode(config.switch_3ph1ph_while_charging_mode)));
+        const auto plan = plans.find(m);
+        if (plan != plans.end()) {
+            brokers.push_back(std::make_shared<BrokerCheapCharging>(*m, plan->second));
+        } else {
+            // all other evses charge as fast as possible
+            brokers.push_back(std::make_shared<BrokerFastCharging>(
+                *m, to_switch_1ph3ph_mode(config.switch_3ph1ph_while_charging_mode)));
+        }
         // EVLOG_info << fmt::format("Created broker for {}", m->energy_flow_request.uuid);
     }
 
@@ -191,4 +283,27 @@ std::vector<types::energy::EnforcedLimits> EnergyManager::run_optimizer(types::e
 
     return optimized_values;
 }
+
+void to_json(json& j, const Conf& c) {
+    j = json{{"nominal_ac_voltage", c.nominal_ac_voltage},
+             {"update_interval", c.update_interval},
+             {"schedule_interval_duration", c.schedule_interval_duration},
+             {"schedule_total_duration", c.schedule_total_duration},
+             {"slice_ampere", c.slice_ampere},
+             {"slice_watt", c.slice_watt},
+             {"debug", c.debug},
+             {"switch_3ph1ph_while_charging_mode", c.switch_3ph1ph_while_charging_mode}};
+}
+
+void from_json(const json& j, Conf& c) {
+    c.nominal_ac_voltage = j.at("nominal_ac_voltage");
+    c.update_interval = j.at("update_interval");
+    c.schedule_interval_duration = j.at("schedule_interval_duration");
+    c.schedule_total_duration = j.at("schedule_total_duration");
+    c.slice_ampere = j.at("slice_ampere");
+    c.slice_watt = j.at("slice_watt");
+    c.debug = j.at("debug");
+    c.switch_3ph1ph_while_charging_mode = j.at("switch_3ph1ph_while_charging_mode");
+}
+
 } // namespace module
@@ -23,8 +23,13 @@
 #include <date/tz.h>
 #include <utils/date.hpp>
 
+#include <map>
+#include <memory>
 #include <mutex>
 
+#include "CostOptimizer.hpp"
+#include "EnergyRecorder.hpp"
+
 #ifdef BUILD_TESTING_MODULE_ENERGY_MANAGER
 #include <gtest/gtest_prod.h>
 namespace module::test {
@@ -46,6 +51,7 @@ struct Conf {
     double slice_watt;
     bool debug;
     std::string switch_3ph1ph_while_charging_mode;
+    std::string record_file;
 };
 
 class EnergyManager : public Everest::ModuleBase {
@@ -82,15 +88,37 @@ private:
     types::energy::EnergyFlowRequest energy_flow_request;
 
     void enforce_limits(const std::vector<types::energy::EnforcedLimits>& limits);
+    bool limits_need_publishing(const types::energy::EnforcedLimits& limits);
+
+    // last published limits per EVSE uuid, unchanged limits are only refreshed before valid_until expires
+    struct PublishedLimits {
+        json content; // without valid_until
+        date::utc_clock::time_point refresh_at;
+    };
+    std::map<std::string, PublishedLimits> published_limits;
+    std::uint64_t limits_published{0};
+    std::uint64_t limits_suppressed{0};
     std::vector<types::energy::EnforcedLimits> run_optimizer(types::energy::EnergyFlowRequest request);
 
     std::condition_variable mainloop_sleep_condvar;
     std::mutex mainloop_sleep_mutex;
 
+    // keeps the last plan to warm start the next optimizer run
+    CostOptimizer cost_optimizer;
+
+    // only set if record_file is configured
+    std::unique_ptr<EnergyRecorder> recorder;
+
+    friend class EnergyReplay;
+
 #ifdef BUILD_TESTING_MODULE_ENERGY_MANAGER
     FRIEND_TEST(EnergyManagerTest, empty);
     FRIEND_TEST(EnergyManagerTest, noSchedules);
     FRIEND_TEST(EnergyManagerTest, schedules);
+    FRIEND_TEST(EnergyRecorderTest, replayMatchesOptimizer);
+    FRIEND_TEST(EnergyManagerTest, unchangedLimitsSuppressed);
+    FRIEND_TEST(CostOptimizerTest, cheaperThanFastCharging);
+    FRIEND_TEST(CostOptimizerTest, warmStart);
     friend void test::schedule_test(const types::energy::EnergyFlowRequest& energy_flow_request,
                                     const std::string& start_time_str, float expected_limit);
 #endif
@@ -99,6 +127,8 @@ private:
 
 // ev@087e516b-124c-48df-94fb-109508c7cda9:v1
 // insert other definitions here
+void to_json(json& j, const Conf& c);
+void from_json(const json& j, Conf& c);
 // ev@087e516b-124c-48df-94fb-109508c7cda9:v1
 
 } // namespace module
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "EnergyRecorder.hpp"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace module {
+
+namespace {
+constexpr std::array<char, 7> MAGIC{'E', 'V', 'E', 'M', 'R', 'E', 'C'};
+constexpr std::uint8_t VERSION = 1;
+
+// a request tree of a large site is a few 100 kB, anything beyond is garbage
+constexpr std::uint32_t MAX_RECORD_SIZE = 64 * 1024 * 1024;
+
+json tick_payload(date::utc_clock::time_point start_time) {
+    // full resolution, the optimizer compares the start time with schedule timestamps
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(start_time.time_since_epoch()).count();
+}
+} // namespace
+
+EnergyRecorder::EnergyRecorder(const std::string& path) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (not ec and size > 0) {
+        // continue the log of the previous run, dropping a record cut off when it was stopped
+        EnergyRecordReader reader(path);
+        Record record;
+        while (reader.next(record)) {
+        }
+        if (reader.truncated()) {
+            std::filesystem::resize_file(path, reader.complete_size());
+        }
+        out.open(path, std::ios::binary | std::ios::app);
+        if (not out) {
+            throw std::runtime_error("Cannot append to energy record file " + path);
+        }
+        return;
+    }
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (not out) {
+        throw std::runtime_error("Cannot create energy record file " + path);
+    }
+    out.write(MAGIC.data(), MAGIC.size());
+    out.put(static_cast<char>(VERSION));
+}
+
+void EnergyRecorder::record_config(const json& config) {
+    write(RecordType::Config, config);
+}
+
+void EnergyRecorder::record_request(const types::energy::EnergyFlowRequest& request) {
+    write(RecordType::Request, request);
+}
+
+void EnergyRecorder::record_tick(date::utc_clock::time_point start_time) {
+    write(RecordType::Tick, tick_payload(start_time));
+}
+
+void EnergyRecorder::record_result(date::utc_clock::time_point start_time,
+                                   const std::vector<types::energy::EnforcedLimits>& limits) {
+    write(RecordType::Result, {{"start_time", tick_payload(start_time)}, {"limits", limits}});
+}
+
+void EnergyRecorder::write(RecordType type, const json& payload) {
+    const auto cbor = json::to_cbor(payload);
+    const auto length = static_cast<std::uint32_t>(cbor.size());
+    const std::array<char, 5> header{static_cast<char>(type), static_cast<char>(length & 0xff),
+                                     static_cast<char>((length >> 8) & 0xff), static_cast<char>((length >> 16) & 0xff),
+                                     static_cast<char>((length >> 24) & 0xff)};
+
+    std::scoped_lock lock(mutex);
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(cbor.data()), cbor.size());
+    if (type == RecordType::Tick) {
+        // a tick completes the inputs of an optimizer run
+        out.flush();
+    }
+}
+
+EnergyRecordReader::EnergyRecordReader(const std::string& path) : in(path, std::ios::binary) {
+    if (not in) {
+        throw std::runtime_error("Cannot open energy record file " + path);
+    }
+    std::array<char, MAGIC.size() + 1> header{};
+    in.read(header.data(), header.size());
+    if (not in or std::memcmp(header.data(), MAGIC.data(), MAGIC.size()) != 0) {
+        throw std::runtime_error(path + " is not an energy record file");
+    }
+    if (static_cast<std::uint8_t>(header[MAGIC.size()]) != VERSION) {
+        throw std::runtime_error(path + ": unsupported energy record version");
+    }
+    size = header.size();
+}
+
+bool EnergyRecordReader::next(Record& record) {
+    std::array<unsigned char, 5> header{};
+    in.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (in.gcount() != static_cast<std::streamsize>(header.size())) {
+        is_truncated = in.gcount() != 0;
+        return false;
+    }
+
+    const std::uint32_t length = header[1] | (header[2] << 8) | (header[3] << 16) | (header[4] << 24);
+    if (header[0] < static_cast<std::uint8_t>(RecordType::Config) or
+        header[0] > static_cast<std::uint8_t>(RecordType::Result) or length > MAX_RECORD_SIZE) {
+        throw std::runtime_error("Corrupt energy record");
+    }
+
+    std::vector<std::uint8_t> cbor(length);
+    in.read(reinterpret_cast<char*>(cbor.data()), length);
+    if (in.gcount() != static_cast<std::streamsize>(length)) {
+        is_truncated = true;
+        return false;
+    }
+
+    try {
+        record.payload = json::from_cbor(cbor);
+    } catch (const json::exception& e) {
+        throw std::runtime_error(std::string("Corrupt energy record: ") + e.what());
+    }
+    record.type = static_cast<RecordType>(header[0]);
+    size += header.size() + length;
+    return true;
+}
+
+date::utc_clock::time_point EnergyRecordReader::to_start_time(const json& tick) {
+    return date::utc_clock::time_point(
+        std::chrono::duration_cast<date::utc_clock::duration>(std::chrono::nanoseconds(tick.get<std::int64_t>())));
+}
+
+} // namespace module
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef ENERGY_RECORDER_HPP
+#define ENERGY_RECORDER_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <generated/interfaces/energy/Interface.hpp>
+#include <utils/date.hpp>
+
+namespace module {
+
+/*
+ Binary log of the EnergyManager inputs (and replay results):
+
+   header:  "EVEMREC" version(1 byte)
+   records: type(1 byte) length(4 bytes, little endian) payload(length bytes, CBOR)
+
+ A log is written by the running module (config, requests and ticks) and by
+ the replay tool (results), see energy_manager_replay. Every start of the module
+ appends a config record to the existing log. The last record may be cut off
+ when the module was stopped while writing it.
+*/
+enum class RecordType : std::uint8_t {
+    Config = 1,  // module configuration used by run_optimizer
+    Request = 2, // EnergyFlowRequest tree received from energy_trunk
+    Tick = 3,    // globals.init() start time of an optimizer run
+    Result = 4,  // EnforcedLimits of an optimizer run (replay output)
+};
+
+struct Record {
+    RecordType type;
+    json payload;
+};
+
+class EnergyRecorder {
+public:
+    /// \brief append to the log at \p path, a partial last record is removed first
+    /// \throws std::runtime_error when the file can't be created or isn't a record log
+    explicit EnergyRecorder(const std::string& path);
+
+    void record_config(const json& config);
+    void record_request(const types::energy::EnergyFlowRequest& request);
+    void record_tick(date::utc_clock::time_point start_time);
+    void record_result(date::utc_clock::time_point start_time,
+                       const std::vector<types::energy::EnforcedLimits>& limits);
+
+private:
+    void write(RecordType type, const json& payload);
+
+    std::mutex mutex;
+    std::ofstream out;
+};
+
+class EnergyRecordReader {
+public:
+    /// \throws std::runtime_error when the file can't be opened or isn't a record log
+    explicit EnergyRecordReader(const std::string& path);
+
+    /// \brief read the next record
+    /// \return false at the end of the log or at a partial last record
+    /// \throws std::runtime_error on a corrupt record
+    bool next(Record& record);
+
+    /// \brief true once next() stopped at a partial last record
+    bool truncated() const {
+        return is_truncated;
+    }
+
+    /// \brief size of the header and the complete records read so far
+    std::uintmax_t complete_size() const {
+        return size;
+    }
+
+    static date::utc_clock::time_point to_start_time(const json& tick);
+
+private:
+    std::ifstream in;
+    std::uintmax_t size{0};
+    bool is_truncated{false};
+};
+
+} // namespace module
+
+#endif // ENERGY_RECORDER_HPP
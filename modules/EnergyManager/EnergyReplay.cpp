@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "EnergyReplay.hpp"
+#include "EnergyManager.hpp"
+#include "Market.hpp"
+
+#include <everest/logging.hpp>
+
+#include <stdexcept>
+
+namespace module {
+
+namespace {
+
+const ModuleInfo c_replay_module_info{
+    "EnergyManager",
+    {},               // authors
+    "Apache-2.0",     // license
+    "energy_manager", // ID
+    {
+        // path etc
+        "",
+        // path libexec
+        "",
+        // path share
+        "",
+    },
+    false, // telemetry_enabled
+    false, // global_errors_enabled
+};
+
+// the optimizer doesn't use the provided interface
+struct energy_managerImplReplay : public energy_managerImplBase {
+    energy_managerImplReplay() : energy_managerImplBase(nullptr, "main") {
+    }
+    void init() override {
+    }
+    void ready() override {
+    }
+};
+
+} // namespace
+
+std::size_t EnergyReplay::run(EnergyRecordReader& reader, const std::function<void(const ReplayTick&)>& on_tick) {
+    Record record;
+    if (not reader.next(record) or record.type != RecordType::Config) {
+        throw std::runtime_error("Energy record doesn't start with the module config");
+    }
+
+    Conf config;
+    std::unique_ptr<EnergyManager> manager;
+    types::energy::EnergyFlowRequest request;
+    const auto start_module = [&](const json& payload) {
+        config = payload.get<Conf>();
+        // debug output would dominate the latency
+        config.debug = false;
+        manager = std::make_unique<EnergyManager>(c_replay_module_info, std::make_unique<energy_managerImplReplay>(),
+                                                  nullptr, config);
+        request = {};
+    };
+    start_module(record.payload);
+
+    std::size_t ticks{0};
+
+    try {
+        while (reader.next(record)) {
+            if (record.type == RecordType::Config) {
+                // the module was restarted and appended to the log
+                start_module(record.payload);
+            } else if (record.type == RecordType::Request) {
+                request = record.payload.get<types::energy::EnergyFlowRequest>();
+            } else if (record.type == RecordType::Tick) {
+                ReplayTick tick;
+                tick.start_time = EnergyRecordReader::to_start_time(record.payload);
+
+                const auto start = std::chrono::steady_clock::now();
+                globals.init(tick.start_time, config.schedule_interval_duration, config.schedule_total_duration,
+                             config.slice_ampere, config.slice_watt, config.debug, request);
+                tick.limits = manager->run_optimizer(request);
+                tick.latency = std::chrono::steady_clock::now() - start;
+
+                ticks++;
+                on_tick(tick);
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        EVLOG_warning << "Energy record replay stopped after " << ticks << " ticks: " << e.what();
+    }
+    if (reader.truncated()) {
+        // the module was stopped while writing the last record
+        EVLOG_warning << "Energy record ends with a partial record, replayed " << ticks << " ticks";
+    }
+
+    return ticks;
+}
+
+} // namespace module
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef ENERGY_REPLAY_HPP
+#define ENERGY_REPLAY_HPP
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "EnergyRecorder.hpp"
+
+namespace module {
+
+struct ReplayTick {
+    date::utc_clock::time_point start_time;
+    std::chrono::nanoseconds latency; // globals.init and run_optimizer, excluding reading the log
+    std::vector<types::energy::EnforcedLimits> limits;
+};
+
+class EnergyReplay {
+public:
+    /// \brief run the optimizer for every tick of a record log as fast as possible
+    ///
+    /// A config record within the log (module restart) replaces the optimizer and drops the last request.
+    /// \param reader log written by the EnergyManager (record_file config option)
+    /// \param on_tick called after every optimizer run
+    /// \return number of optimizer runs
+    /// \throws std::runtime_error when the log doesn't start with the module config
+    static std::size_t run(EnergyRecordReader& reader, const std::function<void(const ReplayTick&)>& on_tick);
+};
+
+} // namespace module
+
+#endif // ENERGY_REPLAY_HPP
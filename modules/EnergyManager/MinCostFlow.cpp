@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "MinCostFlow.hpp"
+
+#include <algorithm>
+#include <deque>
+
+namespace module {
+
+namespace {
+// costs are sums of prices, ignore rounding noise
+constexpr double COST_EPSILON = 1e-12;
+} // namespace
+
+int MinCostFlow::add_node() {
+    adjacency.emplace_back();
+    return adjacency.size() - 1;
+}
+
+int MinCostFlow::add_edge(int from, int to, std::int64_t capacity, double cost) {
+    const int index = edges.size();
+    edges.push_back({to, std::max<std::int64_t>(capacity, 0), 0, cost});
+    edges.push_back({from, 0, 0, -cost});
+    adjacency[from].push_back(index);
+    adjacency[to].push_back(index + 1);
+    return index;
+}
+
+void MinCostFlow::set_flow(int edge, std::int64_t flow) {
+    edges[edge].flow = flow;
+    edges[edge ^ 1].flow = -flow;
+}
+
+std::int64_t MinCostFlow::flow(int edge) const {
+    return edges[edge].flow;
+}
+
+std::int64_t MinCostFlow::residual(int edge) const {
+    return edges[edge].capacity - edges[edge].flow;
+}
+
+int MinCostFlow::shortest_paths(int source, std::vector<double>& distance, std::vector<int>& parent_edge) const {
+    const int nodes = adjacency.size();
+    distance.assign(nodes, source < 0 ? 0. : std::numeric_limits<double>::infinity());
+    parent_edge.assign(nodes, -1);
+    std::vector<int> relaxations(nodes, 0);
+    std::vector<bool> queued(nodes, source < 0);
+
+    std::deque<int> queue;
+    if (source < 0) {
+        for (int node = 0; node < nodes; node++) {
+            queue.push_back(node);
+        }
+    } else {
+        distance[source] = 0.;
+        queue.push_back(source);
+        queued[source] = true;
+    }
+
+    while (not queue.empty()) {
+        const int node = queue.front();
+        queue.pop_front();
+        queued[node] = false;
+
+        for (const int edge : adjacency[node]) {
+            const int to = edges[edge].to;
+            if (residual(edge) <= 0 or distance[node] + edges[edge].cost >= distance[to] - COST_EPSILON) {
+                continue;
+            }
+            distance[to] = distance[node] + edges[edge].cost;
+            parent_edge[to] = edge;
+            if (++relaxations[to] >= nodes) {
+                // a node can only be relaxed that often if it is reachable from a negative cycle
+                return to;
+            }
+            if (not queued[to]) {
+                queue.push_back(to);
+                queued[to] = true;
+            }
+        }
+    }
+    return -1;
+}
+
+void MinCostFlow::push(const std::vector<int>& path, std::int64_t amount) {
+    for (const int edge : path) {
+        edges[edge].flow += amount;
+        edges[edge ^ 1].flow -= amount;
+    }
+}
+
+MinCostFlow::Result MinCostFlow::solve(int source, int sink) {
+    Result result;
+    std::vector<double> distance;
+    std::vector<int> parent_edge;
+    std::vector<int> path;
+
+    // make the start flow cost optimal
+    for (int node = shortest_paths(-1, distance, parent_edge); node >= 0;
+         node = shortest_paths(-1, distance, parent_edge)) {
+        // walk back until we are on the cycle
+        std::vector<bool> visited(adjacency.size(), false);
+        while (not visited[node] and parent_edge[node] >= 0) {
+            visited[node] = true;
+            node = edges[parent_edge[node] ^ 1].to;
+        }
+        if (parent_edge[node] < 0) {
+            break;
+        }
+
+        path.clear();
+        std::int64_t amount = INFINITE_CAPACITY;
+        int current = node;
+        do {
+            const int edge = parent_edge[current];
+            path.push_back(edge);
+            amount = std::min(amount, residual(edge));
+            current = edges[edge ^ 1].to;
+        } while (current != node);
+
+        push(path, amount);
+        result.cancelled_cycles++;
+    }
+
+    // augment along the cheapest paths
+    while (shortest_paths(source, distance, parent_edge) < 0 and parent_edge[sink] >= 0) {
+        path.clear();
+        std::int64_t amount = INFINITE_CAPACITY;
+        for (int node = sink; node != source; node = edges[parent_edge[node] ^ 1].to) {
+            path.push_back(parent_edge[node]);
+            amount = std::min(amount, residual(parent_edge[node]));
+        }
+        push(path, amount);
+        result.augmentations++;
+    }
+
+    for (const int edge : adjacency[source]) {
+        if ((edge & 1) == 0) {
+            result.flow += edges[edge].flow;
+        }
+    }
+    for (std::size_t edge = 0; edge < edges.size(); edge += 2) {
+        result.cost += edges[edge].flow * edges[edge].cost;
+    }
+    return result;
+}
+
+} // namespace module
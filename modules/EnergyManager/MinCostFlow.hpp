@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef MIN_COST_FLOW_HPP
+#define MIN_COST_FLOW_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace module {
+
+// Min cost max flow solver for small networks (a few thousand edges).
+// It can be warm started with the flow of a previous solution: negative cycles in the residual network are cancelled
+// first, so the start flow becomes cost optimal for its value, then the flow is augmented along shortest paths.
+// After small changes of the network this needs only a few iterations.
+class MinCostFlow {
+public:
+    static constexpr std::int64_t INFINITE_CAPACITY = std::numeric_limits<std::int64_t>::max() / 4;
+
+    struct Result {
+        std::int64_t flow{0};
+        double cost{0.};
+        int augmentations{0};
+        int cancelled_cycles{0};
+    };
+
+    int add_node();
+    /// \return index of the edge
+    int add_edge(int from, int to, std::int64_t capacity, double cost);
+
+    /// \brief set the start flow of an edge, the caller has to keep the flow conservation at all nodes
+    void set_flow(int edge, std::int64_t flow);
+    std::int64_t flow(int edge) const;
+
+    Result solve(int source, int sink);
+
+private:
+    struct Edge {
+        int to;
+        std::int64_t capacity;
+        std::int64_t flow;
+        double cost;
+    };
+
+    // edge e and its residual edge e ^ 1
+    std::vector<Edge> edges;
+    std::vector<std::vector<int>> adjacency;
+
+    std::int64_t residual(int edge) const;
+    // Bellman-Ford with a queue, parent_edge gets the last edge on the shortest path to each node.
+    // Returns a node on a negative cycle or -1. If source is -1 all nodes start with distance 0.
+    int shortest_paths(int source, std::vector<double>& distance, std::vector<int>& parent_edge) const;
+    void push(const std::vector<int>& path, std::int64_t amount);
+};
+
+} // namespace module
+
+#endif // MIN_COST_FLOW_HPP
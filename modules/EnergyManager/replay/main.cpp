@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Replays a record_file of the EnergyManager through the optimizer as fast as possible. Prints the per tick
+// latency of globals.init and run_optimizer and optionally compares the enforced limits with the results of another build.
+
+#include "EnergyRecorder.hpp"
+#include "EnergyReplay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+
+using namespace module;
+
+namespace {
+
+// maximum number of differing ticks printed in detail
+constexpr std::size_t MAX_PRINTED_DIFFS = 10;
+
+void usage(const char* name) {
+    std::cerr << "Usage: " << name << " <record file> [-o <result file>] [-c <result file>]\n"
+              << "  -o  write the enforced limits of every tick to <result file>\n"
+              << "  -c  compare the enforced limits with <result file> written by another build\n";
+}
+
+double to_us(std::chrono::nanoseconds ns) {
+    return ns.count() / 1000.0;
+}
+
+void print_latency(std::vector<std::chrono::nanoseconds> latencies) {
+    if (latencies.empty()) {
+        std::cout << "No ticks in record" << std::endl;
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::chrono::nanoseconds total{0};
+    for (const auto& l : latencies) {
+        total += l;
+    }
+    const auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+    };
+
+    std::cout << "ticks:  " << latencies.size() << "\n"
+              << "total:  " << to_us(total) / 1000.0 << " ms\n"
+              << "min:    " << to_us(latencies.front()) << " us\n"
+              << "median: " << to_us(percentile(0.5)) << " us\n"
+              << "p99:    " << to_us(percentile(0.99)) << " us\n"
+              << "max:    " << to_us(latencies.back()) << " us" << std::endl;
+}
+
+std::vector<json> read_results(const std::string& path) {
+    EnergyRecordReader reader(path);
+    std::vector<json> results;
+    Record record;
+    while (reader.next(record)) {
+        if (record.type == RecordType::Result) {
+            results.push_back(std::move(record.payload));
+        }
+    }
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string record_file;
+    std::string output_file;
+    std::string compare_file;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-o") == 0 and i + 1 < argc) {
+            output_file = argv[++i];
+        } else if (std::strcmp(argv[i], "-c") == 0 and i + 1 < argc) {
+            compare_file = argv[++i];
+        } else if (argv[i][0] != '-' and record_file.empty()) {
+            record_file = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (record_file.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        EnergyRecordReader reader(record_file);
+
+        std::unique_ptr<EnergyRecorder> output;
+        if (not output_file.empty()) {
+            // the recorder appends, the results of this run must not follow those of an earlier one
+            std::filesystem::remove(output_file);
+            output = std::make_unique<EnergyRecorder>(output_file);
+        }
+
+        std::vector<json> expected;
+        if (not compare_file.empty()) {
+            expected = read_results(compare_file);
+        }
+
+        std::vector<std::chrono::nanoseconds> latencies;
+        std::size_t differences{0};
+
+        EnergyReplay::run(reader, [&](const ReplayTick& tick) {
+            const auto index = latencies.size();
+            latencies.push_back(tick.latency);
+
+            if (output) {
+                output->record_result(tick.start_time, tick.limits);
+            }
+
+            if (index < expected.size()) {
+                const json limits = tick.limits;
+                if (expected[index].at("limits") != limits) {
+                    if (differences < MAX_PRINTED_DIFFS) {
+                        std::cout << "tick " << index << " ("
+                                  << Everest::Date::to_rfc3339(tick.start_time) << ") differs: "
+                                  << json::diff(expected[index].at("limits"), limits).dump() << std::endl;
+                    }
+                    differences++;
+                }
+            }
+        });
+
+        print_latency(latencies);
+
+        if (not compare_file.empty()) {
+            if (expected.size() != latencies.size()) {
+                std::cout << compare_file << " has " << expected.size() << " ticks, replayed " << latencies.size()
+                          << std::endl;
+                return 2;
+            }
+            std::cout << differences << " of " << latencies.size() << " ticks differ" << std::endl;
+            return differences == 0 ? 0 : 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
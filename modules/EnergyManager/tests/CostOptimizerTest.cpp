@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "EnergyManager.hpp"
+#include "EnergyManagerImplStub.hpp"
+#include "Market.hpp"
+#include "MinCostFlow.hpp"
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <utils/date.hpp>
+
+#include <iostream>
+
+namespace {
+
+const ModuleInfo c_module_info{
+    "EnergyManager",
+    {},               // authors
+    "MIT",            // license
+    "energy_manager", // ID
+    {
+        // path etc
+        "",
+        // path libexec
+        "",
+        // path share
+        "",
+    },
+    false, // telemetry_enabled
+    false, // global_errors_enabled
+};
+
+const module::Conf c_config{
+    230.0,  // nominal_ac_voltage
+    1,      // update_interval
+    15,     // schedule_interval_duration
+    4,      // schedule_total_duration
+    0.5,    // slice_ampere
+    500,    // slice_watt
+    false,  // debug
+    "Never" // switch_3ph1ph_while_charging_mode
+};
+
+constexpr int c_evses = 4;
+// one hour at 16A, so the plan fills whole slots
+constexpr double c_energy_needed_kWh = 11.04;
+// price per kWh from 12:00 in hourly steps
+const std::vector<double> c_prices{0.40, 0.10, 0.30, 0.20};
+
+// grid connection with 32A and a price forecast, EVSEs with 16A each
+types::energy::EnergyFlowRequest make_site(bool with_targets) {
+    json evses = json::array();
+    for (int i = 0; i < c_evses; i++) {
+        json evse = {
+            {"children", json::array()},
+            {"uuid", "evse_" + std::to_string(i)},
+            {"node_type", "Evse"},
+            {"schedule_import",
+             {{{"timestamp", "2024-03-27T12:00:00.000Z"},
+               {"limits_to_leaves", {{"ac_max_current_A", 16.0}, {"ac_max_phase_count", 3}}},
+               {"limits_to_root",
+                {{"ac_max_current_A", 16.0},
+                 {"ac_max_phase_count", 3},
+                 {"ac_min_current_A", 6.0},
+                 {"ac_min_phase_count", 3}}}}}},
+        };
+        if (with_targets) {
+            evse["optimizer_target"] = {{"energy_amount_needed", c_energy_needed_kWh},
+                                        {"leave_time", "2024-03-27T16:00:00.000Z"}};
+        }
+        evses.push_back(evse);
+    }
+
+    json schedule = json::array();
+    for (std::size_t hour = 0; hour < c_prices.size(); hour++) {
+        const auto timestamp = fmt::format("2024-03-27T{}:00:00.000Z", 12 + hour);
+        schedule.push_back({{"timestamp", timestamp},
+                            {"limits_to_leaves", {{"ac_max_current_A", 32.0}}},
+                            {"limits_to_root", {{"ac_max_current_A", 32.0}, {"ac_max_phase_count", 3}}},
+                            {"price_per_kwh", {{"timestamp", timestamp}, {"value", c_prices[hour]}, {"currency", "EUR"}}}});
+    }
+
+    const json site = {
+        {"children", evses},
+        {"uuid", "grid_connection_point"},
+        {"node_type", "Generic"},
+        {"schedule_import", schedule},
+    };
+    return site.get<types::energy::EnergyFlowRequest>();
+}
+
+// cost of the energy needed by each EVSE according to its enforced schedule
+double energy_cost(const std::vector<types::energy::EnforcedLimits>& limits, double voltage) {
+    double cost = 0.;
+    for (const auto& evse : limits) {
+        const auto& schedule = evse.schedule.value();
+        double energy_kWh = 0.;
+        for (std::size_t i = 0; i < schedule.size() and energy_kWh < c_energy_needed_kWh; i++) {
+            const auto begin = Everest::Date::from_rfc3339(schedule[i].timestamp);
+            const auto end =
+                i + 1 < schedule.size() ? Everest::Date::from_rfc3339(schedule[i + 1].timestamp) : begin + 15min;
+            const auto hours = std::chrono::duration<double, std::ratio<3600>>(end - begin).count();
+            const auto& slot = schedule[i].limits_to_root;
+            const auto power_kW =
+                slot.ac_max_current_A.value_or(0) * slot.ac_max_phase_count.value_or(3) * voltage / 1000.;
+            const auto energy = std::min(power_kW * hours, c_energy_needed_kWh - energy_kWh);
+            const auto hour = std::chrono::duration_cast<std::chrono::hours>(
+                                  begin - Everest::Date::from_rfc3339("2024-03-27T12:00:00.000Z"))
+                                  .count();
+            cost += energy * c_prices.at(hour);
+            energy_kWh += energy;
+        }
+        EXPECT_NEAR(energy_kWh, c_energy_needed_kWh, 0.01) << evse.uuid;
+    }
+    return cost;
+}
+
+} // namespace
+
+namespace module {
+
+TEST(MinCostFlow, warmStartCancelsCycles) {
+    // two ways from a to the sink, the expensive one is used by the start flow
+    MinCostFlow network;
+    const int source = network.add_node();
+    const int sink = network.add_node();
+    const int a = network.add_node();
+    const int cheap = network.add_node();
+    const int expensive = network.add_node();
+    const int demand = network.add_edge(source, a, 7, 0.);
+    const int to_cheap = network.add_edge(a, cheap, 5, 1.);
+    const int to_expensive = network.add_edge(a, expensive, 5, 3.);
+    network.add_edge(cheap, sink, 100, 0.);
+    const int expensive_to_sink = network.add_edge(expensive, sink, 100, 0.);
+
+    network.set_flow(demand, 5);
+    network.set_flow(to_expensive, 5);
+    network.set_flow(expensive_to_sink, 5);
+
+    const auto result = network.solve(source, sink);
+    EXPECT_EQ(result.flow, 7);
+    EXPECT_DOUBLE_EQ(result.cost, 11.);
+    EXPECT_EQ(result.cancelled_cycles, 1);
+    EXPECT_EQ(result.augmentations, 1);
+    EXPECT_EQ(network.flow(to_cheap), 5);
+    EXPECT_EQ(network.flow(to_expensive), 2);
+}
+
+TEST(CostOptimizerTest, cheaperThanFastCharging) {
+    Conf config = c_config;
+    const auto start_time = Everest::Date::from_rfc3339("2024-03-27T12:00:00.000Z");
+
+    double cost[2];
+    for (const bool with_targets : {false, true}) {
+        EnergyManager manager(c_module_info, std::make_unique<stub::energy_managerImplStub>(),
+                              std::unique_ptr<energyIntf>{}, config);
+        const auto request = make_site(with_targets);
+
+        globals.init(start_time, config.schedule_interval_duration, config.schedule_total_duration,
+                     config.slice_ampere, config.slice_watt, config.debug, request);
+        const auto start = std::chrono::steady_clock::now();
+        const auto limits = manager.run_optimizer(request);
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        ASSERT_EQ(limits.size(), c_evses);
+        cost[with_targets] = energy_cost(limits, config.nominal_ac_voltage);
+        std::cout << (with_targets ? "CheapCharging" : "FastCharging") << ": cost " << cost[with_targets] << " in "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() << "us" << std::endl;
+    }
+
+    // fast charging fills 12:00 and 13:00, cheap charging 13:00 and 15:00
+    EXPECT_NEAR(cost[false], 2 * c_energy_needed_kWh * (0.40 + 0.10), 0.01);
+    EXPECT_NEAR(cost[true], 2 * c_energy_needed_kWh * (0.10 + 0.20), 0.01);
+}
+
+TEST(CostOptimizerTest, warmStart) {
+    Conf config = c_config;
+    EnergyManager manager(c_module_info, std::make_unique<stub::energy_managerImplStub>(),
+                          std::unique_ptr<energyIntf>{}, config);
+    const auto request = make_site(true);
+    const auto start_time = Everest::Date::from_rfc3339("2024-03-27T12:00:00.000Z");
+
+    globals.init(start_time, config.schedule_interval_duration, config.schedule_total_duration, config.slice_ampere,
+                 config.slice_watt, config.debug, request);
+    manager.run_optimizer(request);
+    const auto cold = manager.cost_optimizer.last_stats();
+    EXPECT_FALSE(cold.warm_start);
+
+    // next tick, nothing changed but the time
+    globals.init(start_time + std::chrono::seconds(config.update_interval), config.schedule_interval_duration,
+                 config.schedule_total_duration, config.slice_ampere, config.slice_watt, config.debug, request);
+    manager.run_optimizer(request);
+    const auto warm = manager.cost_optimizer.last_stats();
+    EXPECT_TRUE(warm.warm_start);
+    EXPECT_EQ(warm.energy_Wh, cold.energy_Wh);
+    EXPECT_NEAR(warm.cost, cold.cost, 0.01);
+    EXPECT_LT(warm.augmentations, cold.augmentations);
+}
+
+} // namespace module
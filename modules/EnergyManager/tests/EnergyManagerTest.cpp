@@ -973,4 +973,47 @@ TEST(EnergyManagerTest, gcp_after) {
     test::schedule_test(grid_connection_point::c_efr_grid_connection_point, "2024-03-28T14:45:00.557Z", 0.0);
 }
 
+TEST(EnergyManagerTest, unchangedLimitsSuppressed) {
+    struct module::Conf config {
+        230.0,     // nominal_ac_voltage
+            2,     // update_interval
+            60,    // schedule_interval_duration
+            1,     // schedule_total_duration
+            0.5,   // slice_ampere
+            500,   // slice_watt
+            false, // debug
+    };
+    std::unique_ptr<energyIntf> energy;
+    auto energy_managerImpl = std::make_unique<module::stub::energy_managerImplStub>();
+
+    module::EnergyManager manager(c_module_info, std::move(energy_managerImpl), std::move(energy), config);
+
+    types::energy::EnforcedLimits limits;
+    limits.uuid = "evse_manager";
+    limits.limits_root_side = types::energy::LimitsRes{};
+    limits.limits_root_side->ac_max_current_A = 16.0;
+
+    const auto start_time = Everest::Date::from_rfc3339("2024-01-01T12:00:00.000Z");
+    const auto publish_at = [&](int seconds) {
+        module::globals.start_time = start_time + std::chrono::seconds(seconds);
+        limits.valid_until = Everest::Date::to_rfc3339(module::globals.start_time + std::chrono::seconds(20));
+        return manager.limits_need_publishing(limits);
+    };
+
+    EXPECT_TRUE(publish_at(0));
+    // only valid_until changed
+    EXPECT_FALSE(publish_at(2));
+    EXPECT_FALSE(publish_at(8));
+    // refresh after half of the validity (update_interval * 10)
+    EXPECT_TRUE(publish_at(10));
+    EXPECT_FALSE(publish_at(12));
+
+    limits.limits_root_side->ac_max_current_A = 10.0;
+    EXPECT_TRUE(publish_at(14));
+    EXPECT_FALSE(publish_at(16));
+
+    EXPECT_EQ(manager.limits_published, 3);
+    EXPECT_EQ(manager.limits_suppressed, 4);
+}
+
 } // namespace module
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "EnergyManager.hpp"
+#include "EnergyManagerImplStub.hpp"
+#include "EnergyRecorder.hpp"
+#include "EnergyReplay.hpp"
+#include "Market.hpp"
+#include <gtest/gtest.h>
+#include <utils/date.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const ModuleInfo c_module_info{
+    "EnergyManager",
+    {},               // authors
+    "MIT",            // license
+    "energy_manager", // ID
+    {
+        // path etc
+        "",
+        // path libexec
+        "",
+        // path share
+        "",
+    },
+    false, // telemetry_enabled
+    false, // global_errors_enabled
+};
+
+const module::Conf c_config{
+    230.0,  // nominal_ac_voltage
+    1,      // update_interval
+    60,     // schedule_interval_duration
+    1,      // schedule_total_duration
+    0.5,    // slice_ampere
+    500,    // slice_watt
+    false,  // debug
+    "Never" // switch_3ph1ph_while_charging_mode
+};
+
+types::energy::EnergyFlowRequest make_request(float evse_limit_A) {
+    const json evse = {
+        {"children", json::array()},
+        {"uuid", "evse_manager"},
+        {"node_type", "Evse"},
+        {"schedule_import",
+         {{{"timestamp", "2024-03-27T12:00:00.000Z"},
+           {"limits_to_leaves", {{"ac_max_current_A", evse_limit_A}, {"ac_max_phase_count", 3}}},
+           {"limits_to_root",
+            {{"ac_max_current_A", 32.0},
+             {"ac_max_phase_count", 3},
+             {"ac_min_current_A", 6.0},
+             {"ac_min_phase_count", 3},
+             {"ac_supports_changing_phases_during_charging", false}}}}}},
+    };
+    const json root = {
+        {"children", {evse}},
+        {"uuid", "grid_connection_point"},
+        {"node_type", "Generic"},
+        {"schedule_import",
+         {{{"timestamp", "2024-03-27T12:00:00.000Z"},
+           {"limits_to_leaves", {{"ac_max_current_A", 32.0}}},
+           {"limits_to_root", {{"ac_max_current_A", 32.0}, {"ac_max_phase_count", 3}}}}}},
+    };
+    return root.get<types::energy::EnergyFlowRequest>();
+}
+
+class EnergyRecorderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // the recorder appends to an existing log
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "energy_manager_test.rec").string();
+};
+
+} // namespace
+
+namespace module {
+
+TEST_F(EnergyRecorderTest, roundTrip) {
+    const auto start_time = Everest::Date::from_rfc3339("2024-03-27T12:40:00.123Z") + std::chrono::nanoseconds(456);
+    const auto request = make_request(16.0);
+    {
+        EnergyRecorder recorder(path);
+        recorder.record_config(c_config);
+        recorder.record_request(request);
+        recorder.record_tick(start_time);
+    }
+
+    EnergyRecordReader reader(path);
+    Record record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, RecordType::Config);
+    const auto config = record.payload.get<Conf>();
+    EXPECT_EQ(config.switch_3ph1ph_while_charging_mode, "Never");
+    EXPECT_EQ(config.slice_ampere, 0.5);
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, RecordType::Request);
+    EXPECT_EQ(record.payload, json(request));
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, RecordType::Tick);
+    EXPECT_EQ(EnergyRecordReader::to_start_time(record.payload), start_time);
+
+    EXPECT_FALSE(reader.next(record));
+}
+
+TEST_F(EnergyRecorderTest, replayMatchesOptimizer) {
+    const auto start_time = Everest::Date::from_rfc3339("2024-03-27T12:40:00.000Z");
+    const std::vector<types::energy::EnergyFlowRequest> requests{make_request(16.0), make_request(10.0)};
+    {
+        EnergyRecorder recorder(path);
+        recorder.record_config(c_config);
+        for (std::size_t i = 0; i < requests.size(); i++) {
+            recorder.record_request(requests[i]);
+            recorder.record_tick(start_time + std::chrono::seconds(i));
+        }
+    }
+
+    std::vector<ReplayTick> ticks;
+    EnergyRecordReader reader(path);
+    EXPECT_EQ(EnergyReplay::run(reader, [&ticks](const ReplayTick& tick) { ticks.push_back(tick); }), 2);
+    ASSERT_EQ(ticks.size(), 2);
+
+    Conf config = c_config;
+    EnergyManager manager(c_module_info, std::make_unique<stub::energy_managerImplStub>(),
+                          std::unique_ptr<energyIntf>{}, config);
+    for (std::size_t i = 0; i < requests.size(); i++) {
+        SCOPED_TRACE(i);
+        EXPECT_EQ(ticks[i].start_time, start_time + std::chrono::seconds(i));
+        globals.init(ticks[i].start_time, config.schedule_interval_duration, config.schedule_total_duration,
+                     config.slice_ampere, config.slice_watt, config.debug, requests[i]);
+        EXPECT_EQ(json(ticks[i].limits), json(manager.run_optimizer(requests[i])));
+
+        EXPECT_EQ(ticks[i].limits.size(), 1);
+    }
+    EXPECT_NE(json(ticks[0].limits), json(ticks[1].limits));
+}
+
+TEST_F(EnergyRecorderTest, truncatedRecord) {
+    {
+        EnergyRecorder recorder(path);
+        recorder.record_config(c_config);
+        recorder.record_request(make_request(16.0));
+        recorder.record_tick(Everest::Date::from_rfc3339("2024-03-27T12:40:00.000Z"));
+        recorder.record_request(make_request(10.0));
+    }
+    // cut the last request in half, as if the module was stopped while writing it
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 20);
+
+    EnergyRecordReader reader(path);
+    EXPECT_EQ(EnergyReplay::run(reader, [](const ReplayTick&) {}), 1);
+    EXPECT_TRUE(reader.truncated());
+}
+
+TEST_F(EnergyRecorderTest, appendAfterRestart) {
+    const auto start_time = Everest::Date::from_rfc3339("2024-03-27T12:40:00.000Z");
+    {
+        EnergyRecorder recorder(path);
+        recorder.record_config(c_config);
+        recorder.record_request(make_request(16.0));
+        recorder.record_tick(start_time);
+        recorder.record_request(make_request(10.0));
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 20);
+    {
+        EnergyRecorder recorder(path);
+        recorder.record_config(c_config);
+        recorder.record_request(make_request(10.0));
+        recorder.record_tick(start_time + std::chrono::seconds(1));
+    }
+
+    std::vector<ReplayTick> ticks;
+    EnergyRecordReader reader(path);
+    EXPECT_EQ(EnergyReplay::run(reader, [&ticks](const ReplayTick& tick) { ticks.push_back(tick); }), 2);
+    EXPECT_FALSE(reader.truncated());
+    ASSERT_EQ(ticks.size(), 2);
+    EXPECT_EQ(ticks[1].start_time, start_time + std::chrono::seconds(1));
+    EXPECT_NE(json(ticks[0].limits), json(ticks[1].limits));
+}
+
+TEST_F(EnergyRecorderTest, notARecord) {
+    std::ofstream(path) << "garbage";
+    EXPECT_THROW(EnergyRecordReader{path}, std::runtime_error);
+    EXPECT_THROW(EnergyRecorder{path}, std::runtime_error);
+    EXPECT_THROW(EnergyRecordReader{path + ".missing"}, std::runtime_error);
+}
+
+} // namespace module
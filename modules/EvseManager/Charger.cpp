@@ -20,17 +20,20 @@
 #include "everest/logging.hpp"
 #include "scoped_lock_timeout.hpp"
 #include "utils.hpp"
+#include <tracing/tracing.hpp>
 
 namespace module {
 
 Charger::Charger(const std::unique_ptr<IECStateMachine>& bsp, const std::unique_ptr<ErrorHandling>& error_handling,
                  const std::vector<std::unique_ptr<powermeterIntf>>& r_powermeter_billing,
                  const std::unique_ptr<PersistentStore>& _store,
+                 const std::unique_ptr<FlightRecorder>& flight_recorder,
                  const types::evse_board_support::Connector_type& connector_type, const std::string& evse_id) :
     bsp(bsp),
     error_handling(error_handling),
     r_powermeter_billing(r_powermeter_billing),
     store(_store),
+    flight_recorder(flight_recorder),
     connector_type(connector_type),
     evse_id(evse_id) {
 
@@ -38,6 +41,22 @@ Charger::Charger(const std::unique_ptr<IECStateMachine>& bsp, const std::unique_
     Everest::install_backtrace_handler();
 #endif
 
+    std::vector<std::string> state_names;
+    for (auto s = EvseState::Disabled; s <= EvseState::Replug; s = static_cast<EvseState>(static_cast<int>(s) + 1)) {
+        state_names.push_back(evse_state_to_string(s));
+    }
+    flight_recorder->set_names(FlightRecorder::Type::ChargerState, std::move(state_names));
+    std::vector<std::string> cp_event_names;
+    for (auto e = CPEvent::CarPluggedIn; e <= CPEvent::EvseReplugFinished;
+         e = static_cast<CPEvent>(static_cast<int>(e) + 1)) {
+        cp_event_names.push_back(cpevent_to_string(e));
+    }
+    flight_recorder->set_names(FlightRecorder::Type::CPEvent, std::move(cp_event_names));
+    flight_recorder->set_names(FlightRecorder::Type::Authorization,
+                               {"Authorized", "AuthorizationRevoked", "Deauthorized"});
+    flight_recorder->set_names(FlightRecorder::Type::MaxCurrent, {"Set"});
+    flight_recorder->set_names(FlightRecorder::Type::Error, {"PreventCharging", "AllErrorsCleared"});
+
     shared_context.connector_enabled = true;
     shared_context.max_current = 6.0;
     if (connector_type == types::evse_board_support::Connector_type::IEC62196Type2Socket) {
@@ -64,77 +83,97 @@ Charger::Charger(const std::unique_ptr<IECStateMachine>& bsp, const std::unique_
 
     hlc_use_5percent_current_session = false;
 
-    // create thread for processing errors/error clearings
-    std::thread error_thread([this]() {
-        for (;;) {
-            auto events = this->error_handling_event_queue.wait();
-            if (!events.empty()) {
-                Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_signal_loop);
-                for (auto& event : events) {
-                    switch (event) {
-                    case ErrorHandlingEvents::prevent_charging:
-                        shared_context.error_prevent_charging_flag = true;
-                        break;
-                    case ErrorHandlingEvents::all_errors_cleared:
-                        shared_context.error_prevent_charging_flag = false;
-                        break;
-                    default:
-                        EVLOG_error << "ErrorHandlingEvents invalid value: "
-                                    << static_cast<std::underlying_type_t<ErrorHandlingEvents>>(event);
-                        break;
-                    }
-                }
-            }
-        }
-    });
-    error_thread.detach();
-
     // Register callbacks for errors/error clearings
     error_handling->signal_error.connect([this](const bool prevent_charging) {
         if (prevent_charging) {
             // raise external error to signal we cannot charge anymore
             error_handling_event_queue.push(ErrorHandlingEvents::prevent_charging);
+            flight_recorder->record(FlightRecorder::Type::Error, ErrorHandlingEvents::prevent_charging);
+            scheduler->post([this]() {
+                process_error_handling_events();
+                flight_recorder->dump_on_error("error");
+            });
         }
     });
 
     error_handling->signal_all_errors_cleared.connect([this]() {
         EVLOG_info << "All errors cleared";
         error_handling_event_queue.push(ErrorHandlingEvents::all_errors_cleared);
+        flight_recorder->record(FlightRecorder::Type::Error, ErrorHandlingEvents::all_errors_cleared);
+        scheduler->post([this]() { process_error_handling_events(); });
     });
 }
 
 Charger::~Charger() {
+    mainloop_timer.cancel();
+    hlc_pwm_timer.cancel();
     pwm_F();
 }
 
-void Charger::main_thread() {
-
-    // Enable CP output
-    bsp->enable(true);
-
-    // publish initial values
-    signal_max_current(get_max_current_internal());
-    signal_state(shared_context.current_state);
-
-    while (true) {
-        if (main_thread_handle.shouldExit()) {
+void Charger::process_error_handling_events() {
+    Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_signal_loop);
+    // a previous task may already have applied the events this task was posted for
+    for (auto& event : error_handling_event_queue.get_events()) {
+        switch (event) {
+        case ErrorHandlingEvents::prevent_charging:
+            shared_context.error_prevent_charging_flag = true;
+            break;
+        case ErrorHandlingEvents::all_errors_cleared:
+            shared_context.error_prevent_charging_flag = false;
+            break;
+        default:
+            EVLOG_error << "ErrorHandlingEvents invalid value: "
+                        << static_cast<std::underlying_type_t<ErrorHandlingEvents>>(event);
             break;
         }
+    }
+}
 
-        std::this_thread::sleep_for(MAINLOOP_UPDATE_RATE);
+void Charger::mainloop() {
+    Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_mainloop);
+    // update power limits
+    power_available();
+    // Run our own state machine update (i.e. run everything that needs
+    // to be done on regular intervals independent from events)
+    run_state_machine();
+}
 
-        {
-            Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_mainloop);
-            // update power limits
-            power_available();
-            // Run our own state machine update (i.e. run everything that needs
-            // to be done on regular intervals independent from events)
-            run_state_machine();
-        }
+const std::array<Charger::StateHandler, Charger::STATE_COUNT> Charger::state_handlers = [] {
+    std::array<StateHandler, STATE_COUNT> handlers{};
+    handlers[static_cast<std::size_t>(EvseState::Disabled)] = &Charger::state_disabled;
+    handlers[static_cast<std::size_t>(EvseState::Idle)] = &Charger::state_idle;
+    handlers[static_cast<std::size_t>(EvseState::WaitingForAuthentication)] =
+        &Charger::state_waiting_for_authentication;
+    handlers[static_cast<std::size_t>(EvseState::PrepareCharging)] = &Charger::state_prepare_charging;
+    handlers[static_cast<std::size_t>(EvseState::WaitingForEnergy)] = &Charger::state_waiting_for_energy;
+    handlers[static_cast<std::size_t>(EvseState::Charging)] = &Charger::state_charging;
+    handlers[static_cast<std::size_t>(EvseState::ChargingPausedEV)] = &Charger::state_charging_paused_EV;
+    handlers[static_cast<std::size_t>(EvseState::ChargingPausedEVSE)] = &Charger::state_charging_paused_EVSE;
+    handlers[static_cast<std::size_t>(EvseState::StoppingCharging)] = &Charger::state_stopping_charging;
+    handlers[static_cast<std::size_t>(EvseState::Finished)] = &Charger::state_finished;
+    handlers[static_cast<std::size_t>(EvseState::T_step_EF)] = &Charger::state_t_step_EF;
+    handlers[static_cast<std::size_t>(EvseState::T_step_X1)] = &Charger::state_t_step_X1;
+    handlers[static_cast<std::size_t>(EvseState::SwitchPhases)] = &Charger::state_switch_phases;
+    handlers[static_cast<std::size_t>(EvseState::Replug)] = &Charger::state_replug;
+    return handlers;
+}();
+
+bool Charger::checked_transition(EvseState to) {
+    const EvseState from = shared_context.current_state;
+    if (from == to) {
+        return true;
     }
+    if (not transition_allowed(from, to)) {
+        EVLOG_error << "Charger state transition " << evse_state_to_string(from) << "->" << evse_state_to_string(to)
+                    << " is not in TRANSITIONS, staying in " << evse_state_to_string(from);
+        return false;
+    }
+    shared_context.current_state = to;
+    return true;
 }
 
 void Charger::run_state_machine() {
+    EVTRACE_SCOPE_ID("Charger::run_state_machine", tracing::trace_id_from_session(shared_context.session_uuid));
 
     constexpr int max_mainloop_runs = 10;
     int mainloop_runs = 0;
@@ -151,6 +190,7 @@ void Charger::run_state_machine() {
             session_log.evse(false, fmt::format("Charger state: {}->{}",
                                                 evse_state_to_string(internal_context.last_state_detect_state_change),
                                                 evse_state_to_string(shared_context.current_state)));
+            flight_recorder->record(FlightRecorder::Type::ChargerState, shared_context.current_state);
         }
 
         internal_context.last_state = internal_context.last_state_detect_state_change;
@@ -174,598 +214,637 @@ void Charger::run_state_machine() {
         auto time_in_current_state =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - internal_context.current_state_started).count();
 
-        switch (shared_context.current_state) {
-        case EvseState::Disabled:
-            if (initialize_state) {
-                signal_simple_event(types::evse_manager::SessionEventEnum::Disabled);
-                pwm_F();
-            }
-            break;
+        const auto state = shared_context.current_state;
+        const auto handler_started = std::chrono::steady_clock::now();
+        const auto trace_started = tracing::enabled() ? tracing::now_ns() : 0;
+        (this->*state_handlers[static_cast<std::size_t>(state)])(initialize_state, now, time_in_current_state);
+        state_metrics[static_cast<std::size_t>(state)].add(std::chrono::steady_clock::now() - handler_started);
 
-        case EvseState::Replug:
-            if (initialize_state) {
-                signal_simple_event(types::evse_manager::SessionEventEnum::ReplugStarted);
-                // start timer in case we need to
-                if (shared_context.ac_with_soc_timeout) {
-                    shared_context.ac_with_soc_timer = 120000;
-                }
+        if (trace_started != 0) {
+            auto& name = state_trace_names[static_cast<std::size_t>(state)];
+            if (name == nullptr) {
+                name = tracing::intern("Charger::state_" + evse_state_to_string(state));
             }
-            // simply wait here until BSP informs us that replugging was finished
-            break;
+            tracing::record_complete(name, tracing::trace_id_from_session(shared_context.session_uuid), trace_started,
+                                     tracing::now_ns());
+        }
 
-        case EvseState::Idle:
-            // make sure we signal availability to potential new cars
-            if (initialize_state) {
-                bcb_toggle_reset();
-                shared_context.iec_allow_close_contactor = false;
-                shared_context.hlc_charging_active = false;
-                shared_context.hlc_allow_close_contactor = false;
-                shared_context.max_current_cable = 0;
-                shared_context.hlc_charging_terminate_pause = HlcTerminatePause::Unknown;
-                shared_context.legacy_wakeup_done = false;
-                pwm_off();
-                deauthorize_internal();
-                shared_context.transaction_active = false;
-                clear_errors_on_unplug();
-            }
-            break;
+        if (mainloop_runs > max_mainloop_runs) {
+            EVLOG_warning << "Charger main loop exceeded maximum number of runs, last_state "
+                          << evse_state_to_string(internal_context.last_state_detect_state_change)
+                          << " current_state: " << evse_state_to_string(shared_context.current_state);
+        }
 
-        case EvseState::WaitingForAuthentication:
+    } while (internal_context.last_state_detect_state_change not_eq shared_context.current_state);
+}
 
-            // Explicitly do not allow to be powered on. This is important
-            // to make sure control_pilot does not switch on relais even if
-            // we start PWM here
-            if (initialize_state) {
-                internal_context.pp_warning_printed = false;
-                internal_context.no_energy_warning_printed = false;
+void Charger::state_disabled(bool initialize_state, std::chrono::system_clock::time_point now,
+                             std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        signal_simple_event(types::evse_manager::SessionEventEnum::Disabled);
+        pwm_F();
+    }
+}
 
-                bsp->allow_power_on(false, types::evse_board_support::Reason::PowerOff);
+void Charger::state_replug(bool initialize_state, std::chrono::system_clock::time_point now,
+                           std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        signal_simple_event(types::evse_manager::SessionEventEnum::ReplugStarted);
+        // start timer in case we need to
+        if (shared_context.ac_with_soc_timeout) {
+            shared_context.ac_with_soc_timer = 120000;
+        }
+    }
+    // simply wait here until BSP informs us that replugging was finished
+}
 
-                if (internal_context.last_state == EvseState::Replug) {
-                    signal_simple_event(types::evse_manager::SessionEventEnum::ReplugFinished);
-                } else {
-                    // First user interaction was plug in of car? Start session here.
-                    if (not shared_context.session_active) {
-                        start_session(false);
-                    }
-                    // External signal on MQTT
-                    signal_simple_event(types::evse_manager::SessionEventEnum::AuthRequired);
-                }
-                hlc_use_5percent_current_session = false;
+void Charger::state_idle(bool initialize_state, std::chrono::system_clock::time_point now,
+                         std::int64_t time_in_current_state) {
+    // make sure we signal availability to potential new cars
+    if (initialize_state) {
+        bcb_toggle_reset();
+        shared_context.iec_allow_close_contactor = false;
+        shared_context.hlc_charging_active = false;
+        shared_context.hlc_allow_close_contactor = false;
+        shared_context.max_current_cable = 0;
+        shared_context.hlc_charging_terminate_pause = HlcTerminatePause::Unknown;
+        shared_context.legacy_wakeup_done = false;
+        pwm_off();
+        deauthorize_internal();
+        shared_context.transaction_active = false;
+        clear_errors_on_unplug();
+    }
+}
 
-                // switch on HLC if configured. May be switched off later on after retries for this session only.
-                if (config_context.charge_mode == ChargeMode::AC) {
-                    ac_hlc_enabled_current_session = config_context.ac_hlc_enabled;
-                    if (ac_hlc_enabled_current_session) {
-                        hlc_use_5percent_current_session = config_context.ac_hlc_use_5percent;
-                    }
-                } else if (config_context.charge_mode == ChargeMode::DC) {
-                    hlc_use_5percent_current_session = true;
-                } else {
-                    // unsupported charging mode, give up here.
-                    error_handling->raise_internal_error("Unsupported charging mode.");
-                }
+void Charger::state_waiting_for_authentication(bool initialize_state, std::chrono::system_clock::time_point now,
+                                               std::int64_t time_in_current_state) {
+    // Explicitly do not allow to be powered on. This is important
+    // to make sure control_pilot does not switch on relais even if
+    // we start PWM here
+    if (initialize_state) {
+        internal_context.pp_warning_printed = false;
+        internal_context.no_energy_warning_printed = false;
 
-                if (hlc_use_5percent_current_session) {
-                    // FIXME: wait for SLAC to be ready. Teslas are really fast with sending the first slac packet after
-                    // enabling PWM.
-                    std::this_thread::sleep_for(SLEEP_BEFORE_ENABLING_PWM_HLC_MODE);
-                    update_pwm_now(PWM_5_PERCENT);
-                    stopwatch.mark("HLC_PWM_5%_ON");
-                }
+        bsp->allow_power_on(false, types::evse_board_support::Reason::PowerOff);
+
+        if (internal_context.last_state == EvseState::Replug) {
+            signal_simple_event(types::evse_manager::SessionEventEnum::ReplugFinished);
+        } else {
+            // First user interaction was plug in of car? Start session here.
+            if (not shared_context.session_active) {
+                start_session(false);
             }
+            // External signal on MQTT
+            signal_simple_event(types::evse_manager::SessionEventEnum::AuthRequired);
+        }
+        hlc_use_5percent_current_session = false;
 
-            // Read PP value in case of AC socket
-            if (connector_type == types::evse_board_support::Connector_type::IEC62196Type2Socket and
-                shared_context.max_current_cable == 0) {
-                shared_context.max_current_cable = bsp->read_pp_ampacity();
-                // retry if the value is not yet available. Some BSPs may take some time to measure the PP.
-                if (shared_context.max_current_cable == 0) {
-                    if (not internal_context.pp_warning_printed) {
-                        EVLOG_warning << "PP ampacity is zero, still retrying to read PP ampacity...";
-                        internal_context.pp_warning_printed = true;
-                    }
-                    break;
-                }
+        // switch on HLC if configured. May be switched off later on after retries for this session only.
+        if (config_context.charge_mode == ChargeMode::AC) {
+            ac_hlc_enabled_current_session = config_context.ac_hlc_enabled;
+            if (ac_hlc_enabled_current_session) {
+                hlc_use_5percent_current_session = config_context.ac_hlc_use_5percent;
             }
+        } else if (config_context.charge_mode == ChargeMode::DC) {
+            hlc_use_5percent_current_session = true;
+        } else {
+            // unsupported charging mode, give up here.
+            error_handling->raise_internal_error("Unsupported charging mode.");
+        }
 
-            // Wait for Energy Manager to supply some power, otherwise wait here.
-            // If we have zero power, some cars will not like the ChargingParameter message.
-            if (config_context.charge_mode == ChargeMode::DC) {
-                // Create a copy of the atomic struct
-                types::iso15118_charger::DcEvseMaximumLimits evse_limit = shared_context.current_evse_max_limits;
-                if (not(evse_limit.evse_maximum_current_limit > 0 and evse_limit.evse_maximum_power_limit > 0)) {
-                    if (not internal_context.no_energy_warning_printed) {
-                        EVLOG_warning << "No energy available, still retrying...";
-                        internal_context.no_energy_warning_printed = true;
-                    }
-                    break;
+        internal_context.hlc_pwm_pending = false;
+        if (hlc_use_5percent_current_session) {
+            // FIXME: wait for SLAC to be ready. Teslas are really fast with sending the first slac packet after
+            // enabling PWM.
+            internal_context.hlc_pwm_pending = true;
+            const auto generation = ++internal_context.hlc_pwm_generation;
+            hlc_pwm_timer = scheduler->after(SLEEP_BEFORE_ENABLING_PWM_HLC_MODE, [this, generation]() {
+                Everest::scoped_lock_timeout lock(state_machine_mutex,
+                                                  Everest::MutexDescription::Charger_hlc_pwm_timer);
+                if (generation not_eq internal_context.hlc_pwm_generation or
+                    not internal_context.hlc_pwm_pending) {
+                    return;
                 }
+                internal_context.hlc_pwm_pending = false;
+                if (shared_context.current_state == EvseState::WaitingForAuthentication) {
+                    update_pwm_now(PWM_5_PERCENT);
+                    stopwatch.mark("HLC_PWM_5%_ON");
+                    run_state_machine();
+                }
+            });
+        }
+    }
+
+    // do not handle authorization before the 5 percent PWM is on, the timer runs the state machine once it is
+    if (internal_context.hlc_pwm_pending) {
+        return;
+    }
+
+    // Read PP value in case of AC socket
+    if (connector_type == types::evse_board_support::Connector_type::IEC62196Type2Socket and
+        shared_context.max_current_cable == 0) {
+        shared_context.max_current_cable = bsp->read_pp_ampacity();
+        // retry if the value is not yet available. Some BSPs may take some time to measure the PP.
+        if (shared_context.max_current_cable == 0) {
+            if (not internal_context.pp_warning_printed) {
+                EVLOG_warning << "PP ampacity is zero, still retrying to read PP ampacity...";
+                internal_context.pp_warning_printed = true;
             }
+            return;
+        }
+    }
 
-            // SLAC is running in the background trying to setup a PLC connection.
+    // Wait for Energy Manager to supply some power, otherwise wait here.
+    // If we have zero power, some cars will not like the ChargingParameter message.
+    if (config_context.charge_mode == ChargeMode::DC) {
+        // Create a copy of the atomic struct
+        types::iso15118_charger::DcEvseMaximumLimits evse_limit = shared_context.current_evse_max_limits;
+        if (not(evse_limit.evse_maximum_current_limit > 0 and evse_limit.evse_maximum_power_limit > 0)) {
+            if (not internal_context.no_energy_warning_printed) {
+                EVLOG_warning << "No energy available, still retrying...";
+                internal_context.no_energy_warning_printed = true;
+            }
+            return;
+        }
+    }
 
-            // we get Auth (maybe before SLAC matching or during matching)
-            // FIXME: getAuthorization needs to distinguish between EIM and PnC in Auth mananger
+    // SLAC is running in the background trying to setup a PLC connection.
 
-            // FIXME: Note Fig 7. is not fully supported here yet (AC Auth before plugin - this overides PnC and always
-            // starts with nominal PWM). We need to support this as this is the only way a user can
-            // skip PnC if he does NOT want to use it for this charging session.
+    // we get Auth (maybe before SLAC matching or during matching)
+    // FIXME: getAuthorization needs to distinguish between EIM and PnC in Auth mananger
 
-            // FIXME: In case V2G is not successfull after all, it needs
-            // to send a dlink_error request, which then needs to:
-            // AC mode: fall back to nominal PWM charging etc (not
-            // implemented yet!), it can do so because it is already authorized.
-            // DC mode: go to error_hlc and give up
+    // FIXME: Note Fig 7. is not fully supported here yet (AC Auth before plugin - this overides PnC and always
+    // starts with nominal PWM). We need to support this as this is the only way a user can
+    // skip PnC if he does NOT want to use it for this charging session.
 
-            // FIXME: if slac reports a dlink_ready=false while we are still waiting for auth we should:
-            // in AC mode: go back to non HLC nominal PWM mode
-            // in DC mode: go to error_slac for this session
+    // FIXME: In case V2G is not successfull after all, it needs
+    // to send a dlink_error request, which then needs to:
+    // AC mode: fall back to nominal PWM charging etc (not
+    // implemented yet!), it can do so because it is already authorized.
+    // DC mode: go to error_hlc and give up
 
-            if (shared_context.authorized and not shared_context.authorized_pnc) {
-                session_log.evse(false, "EIM Authorization received");
+    // FIXME: if slac reports a dlink_ready=false while we are still waiting for auth we should:
+    // in AC mode: go back to non HLC nominal PWM mode
+    // in DC mode: go to error_slac for this session
 
-                // If we are restarting, the transaction may already be active
-                if (not shared_context.transaction_active) {
-                    if (!start_transaction()) {
-                        break;
-                    }
-                }
+    if (shared_context.authorized and not shared_context.authorized_pnc) {
+        session_log.evse(false, "EIM Authorization received");
 
-                const EvseState target_state(EvseState::PrepareCharging);
+        // If we are restarting, the transaction may already be active
+        if (not shared_context.transaction_active) {
+            if (!start_transaction()) {
+                return;
+            }
+        }
 
-                // EIM done and matching process not started -> we need to go through t_step_EF and fall back to nominal
-                // PWM. This is a complete waste of 4 precious seconds.
-                if (config_context.charge_mode == ChargeMode::AC) {
-                    if (ac_hlc_enabled_current_session) {
-                        if (config_context.ac_enforce_hlc) {
-                            // non standard compliant mode: we just keep 5 percent running all the time like in DC
+        // EIM done and matching process not started -> we need to go through t_step_EF and fall back to nominal
+        // PWM. This is a complete waste of 4 precious seconds.
+        if (config_context.charge_mode == ChargeMode::AC) {
+            if (ac_hlc_enabled_current_session) {
+                if (config_context.ac_enforce_hlc) {
+                    // non standard compliant mode: we just keep 5 percent running all the time like in DC
+                    session_log.evse(
+                        false, "AC mode, HLC enabled(ac_enforce_hlc), keeping 5 percent on until a dlink error "
+                               "is signalled.");
+                    hlc_use_5percent_current_session = true;
+                    transition<EvseState::WaitingForAuthentication, EvseState::PrepareCharging>();
+                } else {
+                    if (not shared_context.matching_started) {
+                        // SLAC matching was not started when EIM arrived
+
+                        session_log.evse(
+                            false,
+                            fmt::format(
+                                "AC mode, HLC enabled, matching not started yet. Go through t_step_EF and "
+                                "disable 5 percent if it was enabled before: {}",
+                                (bool)hlc_use_5percent_current_session));
+
+                        // Figure 3 of ISO15118-3: 5 percent start, PnC and EIM
+                        // Figure 4 of ISO15118-3: X1 start, PnC and EIM
+                        set_return_state<EvseState::T_step_EF, EvseState::PrepareCharging>();
+                        internal_context.t_step_EF_return_pwm = 0.;
+                        // fall back to nominal PWM after the t_step_EF break. Note that
+                        // ac_hlc_enabled_current_session remains untouched as HLC can still start later in
+                        // nominal PWM mode
+                        hlc_use_5percent_current_session = false;
+                        transition<EvseState::WaitingForAuthentication, EvseState::T_step_EF>();
+                    } else {
+                        // SLAC matching was started already when EIM arrived
+                        if (hlc_use_5percent_current_session) {
+                            // Figure 5 of ISO15118-3: 5 percent start, PnC and EIM, matching already started
+                            // when EIM was done
                             session_log.evse(
-                                false, "AC mode, HLC enabled(ac_enforce_hlc), keeping 5 percent on until a dlink error "
-                                       "is signalled.");
-                            hlc_use_5percent_current_session = true;
-                            shared_context.current_state = target_state;
+                                false, "AC mode, HLC enabled(5percent), matching already started. Go through "
+                                       "t_step_X1 and disable 5 percent.");
+                            set_return_state<EvseState::T_step_X1, EvseState::PrepareCharging>();
+                            internal_context.t_step_X1_return_pwm = 0.;
+                            hlc_use_5percent_current_session = false;
+                            transition<EvseState::WaitingForAuthentication, EvseState::T_step_X1>();
                         } else {
-                            if (not shared_context.matching_started) {
-                                // SLAC matching was not started when EIM arrived
-
-                                session_log.evse(
-                                    false,
-                                    fmt::format(
-                                        "AC mode, HLC enabled, matching not started yet. Go through t_step_EF and "
-                                        "disable 5 percent if it was enabled before: {}",
-                                        (bool)hlc_use_5percent_current_session));
-
-                                // Figure 3 of ISO15118-3: 5 percent start, PnC and EIM
-                                // Figure 4 of ISO15118-3: X1 start, PnC and EIM
-                                internal_context.t_step_EF_return_state = target_state;
-                                internal_context.t_step_EF_return_pwm = 0.;
-                                // fall back to nominal PWM after the t_step_EF break. Note that
-                                // ac_hlc_enabled_current_session remains untouched as HLC can still start later in
-                                // nominal PWM mode
-                                hlc_use_5percent_current_session = false;
-                                shared_context.current_state = EvseState::T_step_EF;
-                            } else {
-                                // SLAC matching was started already when EIM arrived
-                                if (hlc_use_5percent_current_session) {
-                                    // Figure 5 of ISO15118-3: 5 percent start, PnC and EIM, matching already started
-                                    // when EIM was done
-                                    session_log.evse(
-                                        false, "AC mode, HLC enabled(5percent), matching already started. Go through "
-                                               "t_step_X1 and disable 5 percent.");
-                                    internal_context.t_step_X1_return_state = target_state;
-                                    internal_context.t_step_X1_return_pwm = 0.;
-                                    hlc_use_5percent_current_session = false;
-                                    shared_context.current_state = EvseState::T_step_X1;
-                                } else {
-                                    // Figure 6 of ISO15118-3: X1 start, PnC and EIM, matching already started when EIM
-                                    // was done. We can go directly to PrepareCharging, as we do not need to switch from
-                                    // 5 percent to nominal first
-                                    session_log.evse(
-                                        false,
-                                        "AC mode, HLC enabled(X1), matching already started. We are in X1 so we can "
-                                        "go directly to nominal PWM.");
-                                    shared_context.current_state = target_state;
-                                }
-                            }
+                            // Figure 6 of ISO15118-3: X1 start, PnC and EIM, matching already started when EIM
+                            // was done. We can go directly to PrepareCharging, as we do not need to switch from
+                            // 5 percent to nominal first
+                            session_log.evse(
+                                false,
+                                "AC mode, HLC enabled(X1), matching already started. We are in X1 so we can "
+                                "go directly to nominal PWM.");
+                            transition<EvseState::WaitingForAuthentication, EvseState::PrepareCharging>();
                         }
-
-                    } else {
-                        // HLC is disabled for this session.
-                        // simply proceed to PrepareCharging, as we are fully authorized to start charging whenever car
-                        // wants to.
-                        session_log.evse(false, "AC mode, HLC disabled. We are in X1 so we can "
-                                                "go directly to nominal PWM.");
-                        shared_context.current_state = target_state;
                     }
-                } else if (config_context.charge_mode == ChargeMode::DC) {
-                    // Figure 8 of ISO15118-3: DC with EIM before or after plugin or PnC
-                    // simple here as we always stay within 5 percent mode anyway.
-                    session_log.evse(false,
-                                     "DC mode. We are in 5percent mode so we can continue without further action.");
-                    shared_context.current_state = target_state;
-                } else {
-                    // unsupported charging mode, give up here.
-                    error_handling->raise_internal_error("Unsupported charging mode.");
                 }
-            } else if (shared_context.authorized and shared_context.authorized_pnc) {
-
-                if (!start_transaction()) {
-                    break;
-                }
-
-                const EvseState target_state(EvseState::PrepareCharging);
 
-                // We got authorization by Plug and Charge
-                session_log.evse(false, "PnC Authorization received");
-                if (config_context.charge_mode == ChargeMode::AC) {
-                    // Figures 3,4,5,6 of ISO15118-3: Independent on how we started we can continue with 5 percent
-                    // signalling once we got PnC authorization without going through t_step_EF or t_step_X1.
-
-                    session_log.evse(
-                        false, "AC mode, HLC enabled, PnC auth received. We will continue with 5percent independent on "
-                               "how we started.");
-                    hlc_use_5percent_current_session = true;
-                    shared_context.current_state = target_state;
-
-                } else if (config_context.charge_mode == ChargeMode::DC) {
-                    // Figure 8 of ISO15118-3: DC with EIM before or after plugin or PnC
-                    // simple here as we always stay within 5 percent mode anyway.
-                    session_log.evse(false,
-                                     "DC mode. We are in 5percent mode so we can continue without further action.");
-                    shared_context.current_state = target_state;
-                } else {
-                    // unsupported charging mode, give up here.
-                    error_handling->raise_internal_error("Unsupported charging mode.");
-                }
+            } else {
+                // HLC is disabled for this session.
+                // simply proceed to PrepareCharging, as we are fully authorized to start charging whenever car
+                // wants to.
+                session_log.evse(false, "AC mode, HLC disabled. We are in X1 so we can "
+                                        "go directly to nominal PWM.");
+                transition<EvseState::WaitingForAuthentication, EvseState::PrepareCharging>();
             }
+        } else if (config_context.charge_mode == ChargeMode::DC) {
+            // Figure 8 of ISO15118-3: DC with EIM before or after plugin or PnC
+            // simple here as we always stay within 5 percent mode anyway.
+            session_log.evse(false,
+                             "DC mode. We are in 5percent mode so we can continue without further action.");
+            transition<EvseState::WaitingForAuthentication, EvseState::PrepareCharging>();
+        } else {
+            // unsupported charging mode, give up here.
+            error_handling->raise_internal_error("Unsupported charging mode.");
+        }
+    } else if (shared_context.authorized and shared_context.authorized_pnc) {
 
-            break;
+        if (!start_transaction()) {
+            return;
+        }
 
-        case EvseState::SwitchPhases:
-            if (initialize_state) {
-                session_log.evse(false, "Start switching phases");
-                signal_simple_event(types::evse_manager::SessionEventEnum::SwitchingPhases);
-                if (config_context.switch_3ph1ph_cp_state_F) {
-                    pwm_F();
-                } else {
-                    pwm_off();
-                }
-            }
-            if (time_in_current_state >= config_context.switch_3ph1ph_delay_s * 1000) {
-                session_log.evse(false, "Exit switching phases");
-                bsp->switch_three_phases_while_charging(shared_context.switch_3ph1ph_threephase);
-                shared_context.current_state = internal_context.switching_phases_return_state;
-            }
-            break;
+        // We got authorization by Plug and Charge
+        session_log.evse(false, "PnC Authorization received");
+        if (config_context.charge_mode == ChargeMode::AC) {
+            // Figures 3,4,5,6 of ISO15118-3: Independent on how we started we can continue with 5 percent
+            // signalling once we got PnC authorization without going through t_step_EF or t_step_X1.
+
+            session_log.evse(
+                false, "AC mode, HLC enabled, PnC auth received. We will continue with 5percent independent on "
+                       "how we started.");
+            hlc_use_5percent_current_session = true;
+            transition<EvseState::WaitingForAuthentication, EvseState::PrepareCharging>();
+
+        } else if (config_context.charge_mode == ChargeMode::DC) {
+            // Figure 8 of ISO15118-3: DC with EIM before or after plugin or PnC
+            // simple here as we always stay within 5 percent mode anyway.
+            session_log.evse(false,
+                             "DC mode. We are in 5percent mode so we can continue without further action.");
+            transition<EvseState::WaitingForAuthentication, EvseState::PrepareCharging>();
+        } else {
+            // unsupported charging mode, give up here.
+            error_handling->raise_internal_error("Unsupported charging mode.");
+        }
+    }
+}
 
-        case EvseState::T_step_EF:
-            if (initialize_state) {
-                session_log.evse(false, "Enter T_step_EF");
-                pwm_F();
-            }
-            if (time_in_current_state >= T_STEP_EF) {
-                session_log.evse(false, "Exit T_step_EF");
-                if (internal_context.t_step_EF_return_pwm == 0.) {
-                    pwm_off();
-                } else {
-                    update_pwm_now(internal_context.t_step_EF_return_pwm);
-                }
-                shared_context.current_state = internal_context.t_step_EF_return_state;
-            }
-            break;
+void Charger::state_switch_phases(bool initialize_state, std::chrono::system_clock::time_point now,
+                                  std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        session_log.evse(false, "Start switching phases");
+        signal_simple_event(types::evse_manager::SessionEventEnum::SwitchingPhases);
+        if (config_context.switch_3ph1ph_cp_state_F) {
+            pwm_F();
+        } else {
+            pwm_off();
+        }
+    }
+    if (time_in_current_state >= config_context.switch_3ph1ph_delay_s * 1000) {
+        session_log.evse(false, "Exit switching phases");
+        bsp->switch_three_phases_while_charging(shared_context.switch_3ph1ph_threephase);
+        transition_to_return_state<EvseState::SwitchPhases>();
+    }
+}
 
-        case EvseState::T_step_X1:
-            if (initialize_state) {
-                session_log.evse(false, "Enter T_step_X1");
-                pwm_off();
-            }
-            if (time_in_current_state >= T_STEP_X1) {
-                session_log.evse(false, "Exit T_step_X1");
-                if (internal_context.t_step_X1_return_pwm == 0.) {
-                    pwm_off();
-                } else {
-                    update_pwm_now(internal_context.t_step_X1_return_pwm);
-                }
-                shared_context.current_state = internal_context.t_step_X1_return_state;
-            }
-            break;
+void Charger::state_t_step_EF(bool initialize_state, std::chrono::system_clock::time_point now,
+                              std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        session_log.evse(false, "Enter T_step_EF");
+        pwm_F();
+    }
+    if (time_in_current_state >= T_STEP_EF) {
+        session_log.evse(false, "Exit T_step_EF");
+        if (internal_context.t_step_EF_return_pwm == 0.) {
+            pwm_off();
+        } else {
+            update_pwm_now(internal_context.t_step_EF_return_pwm);
+        }
+        transition_to_return_state<EvseState::T_step_EF>();
+    }
+}
 
-        case EvseState::PrepareCharging:
-            if (initialize_state) {
-                signal_simple_event(types::evse_manager::SessionEventEnum::PrepareCharging);
-                bcb_toggle_reset();
-            }
+void Charger::state_t_step_X1(bool initialize_state, std::chrono::system_clock::time_point now,
+                              std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        session_log.evse(false, "Enter T_step_X1");
+        pwm_off();
+    }
+    if (time_in_current_state >= T_STEP_X1) {
+        session_log.evse(false, "Exit T_step_X1");
+        if (internal_context.t_step_X1_return_pwm == 0.) {
+            pwm_off();
+        } else {
+            update_pwm_now(internal_context.t_step_X1_return_pwm);
+        }
+        transition_to_return_state<EvseState::T_step_X1>();
+    }
+}
 
-            if (config_context.charge_mode == ChargeMode::DC) {
-                if (shared_context.hlc_allow_close_contactor and shared_context.iec_allow_close_contactor) {
-                    bsp->allow_power_on(true, types::evse_board_support::Reason::DCCableCheck);
-                }
-            }
+void Charger::state_prepare_charging(bool initialize_state, std::chrono::system_clock::time_point now,
+                                     std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        signal_simple_event(types::evse_manager::SessionEventEnum::PrepareCharging);
+        bcb_toggle_reset();
+    }
 
-            // Wait here until all errors are cleared
-            if (errors_prevent_charging_internal()) {
-                // reset the time counter for the wake-up sequence if we are blocked by errors
-                internal_context.current_state_started = now;
-                break;
-            }
+    if (config_context.charge_mode == ChargeMode::DC) {
+        if (shared_context.hlc_allow_close_contactor and shared_context.iec_allow_close_contactor) {
+            bsp->allow_power_on(true, types::evse_board_support::Reason::DCCableCheck);
+        }
+    }
 
-            // make sure we are enabling PWM
-            if (not hlc_use_5percent_current_session) {
-                auto m = get_max_current_internal();
-                update_pwm_now_if_changed_ampere(m);
-            } else {
-                update_pwm_now_if_changed(PWM_5_PERCENT);
-            }
+    // Wait here until all errors are cleared
+    if (errors_prevent_charging_internal()) {
+        // reset the time counter for the wake-up sequence if we are blocked by errors
+        internal_context.current_state_started = now;
+        return;
+    }
 
-            if (config_context.charge_mode == ChargeMode::AC) {
-                // In AC mode BASIC, iec_allow is sufficient.  The same is true for HLC mode when nominal PWM is
-                // used as the car can do BASIC and HLC charging any time. In AC HLC with 5 percent mode, we need to
-                // wait for both iec_allow and hlc_allow.
+    // make sure we are enabling PWM
+    if (not hlc_use_5percent_current_session) {
+        auto m = get_max_current_internal();
+        update_pwm_now_if_changed_ampere(m);
+    } else {
+        update_pwm_now_if_changed(PWM_5_PERCENT);
+    }
 
-                if (not power_available()) {
-                    shared_context.current_state = EvseState::WaitingForEnergy;
-                } else {
-                    // Power is available, PWM is already enabled. Check if we can go to charging
-                    if ((shared_context.iec_allow_close_contactor and not hlc_use_5percent_current_session) or
-                        (shared_context.iec_allow_close_contactor and shared_context.hlc_allow_close_contactor and
-                         hlc_use_5percent_current_session)) {
+    if (config_context.charge_mode == ChargeMode::AC) {
+        // In AC mode BASIC, iec_allow is sufficient.  The same is true for HLC mode when nominal PWM is
+        // used as the car can do BASIC and HLC charging any time. In AC HLC with 5 percent mode, we need to
+        // wait for both iec_allow and hlc_allow.
 
-                        signal_simple_event(types::evse_manager::SessionEventEnum::ChargingStarted);
-                        shared_context.current_state = EvseState::Charging;
-                    } else {
-                        // We have power and PWM is on, but EV did not proceed to state C yet (and/or HLC is not
-                        // ready)
-                        if (not shared_context.hlc_charging_active and not shared_context.legacy_wakeup_done and
-                            time_in_current_state > LEGACY_WAKEUP_TIMEOUT) {
-                            session_log.evse(false, "EV did not transition to state C, trying one legacy wakeup "
-                                                    "according to IEC61851-1 A.5.3");
-                            shared_context.legacy_wakeup_done = true;
-                            internal_context.t_step_EF_return_state = EvseState::PrepareCharging;
-                            internal_context.t_step_EF_return_pwm = ampere_to_duty_cycle(get_max_current_internal());
-                            shared_context.current_state = EvseState::T_step_EF;
-                        }
+        if (not power_available()) {
+            transition<EvseState::PrepareCharging, EvseState::WaitingForEnergy>();
+        } else {
+            // Power is available, PWM is already enabled. Check if we can go to charging
+            if ((shared_context.iec_allow_close_contactor and not hlc_use_5percent_current_session) or
+                (shared_context.iec_allow_close_contactor and shared_context.hlc_allow_close_contactor and
+                 hlc_use_5percent_current_session)) {
 
-                        // We are still here after the wakeup plus some extra delay, so probably the EV really does not
-                        // want to charge. Switch to ChargingPausedEV state.
-                        if (not shared_context.hlc_charging_active and shared_context.legacy_wakeup_done and
-                            time_in_current_state > PREPARING_TIMEOUT_PAUSED_BY_EV) {
-                            shared_context.current_state = EvseState::ChargingPausedEV;
-                        }
-                    }
+                signal_simple_event(types::evse_manager::SessionEventEnum::ChargingStarted);
+                transition<EvseState::PrepareCharging, EvseState::Charging>();
+            } else {
+                // We have power and PWM is on, but EV did not proceed to state C yet (and/or HLC is not
+                // ready)
+                if (not shared_context.hlc_charging_active and not shared_context.legacy_wakeup_done and
+                    time_in_current_state > LEGACY_WAKEUP_TIMEOUT) {
+                    session_log.evse(false, "EV did not transition to state C, trying one legacy wakeup "
+                                            "according to IEC61851-1 A.5.3");
+                    shared_context.legacy_wakeup_done = true;
+                    set_return_state<EvseState::T_step_EF, EvseState::PrepareCharging>();
+                    internal_context.t_step_EF_return_pwm = ampere_to_duty_cycle(get_max_current_internal());
+                    transition<EvseState::PrepareCharging, EvseState::T_step_EF>();
                 }
-            }
-
-            // if (charge_mode == ChargeMode::DC) {
-            //  DC: wait until car requests power on CP (B->C/D).
-            //  Then we close contactor and wait for instructions from HLC.
-            //  HLC will perform CableCheck, PreCharge, and PowerDelivery.
-            //  These are all controlled from the handlers directly, so there is nothing we need to do here.
-            //  Once HLC informs us about CurrentDemand has started, we will go to Charging in the handler.
-            //}
 
-            break;
-
-        case EvseState::Charging:
-            if (initialize_state) {
-                shared_context.hlc_charging_terminate_pause = HlcTerminatePause::Unknown;
-                stopwatch.mark("Charging started");
-                stopwatch.report_phase();
-                auto report = stopwatch.report_all_phases();
-                if (config_context.charge_mode == ChargeMode::DC) {
-                    EVLOG_info << "Timing statistics (Plugin to CurrentDemand)";
-                    EVLOG_info << "-------------------------------------------";
-                    for (const auto& r : report) {
-                        EVLOG_info << r;
-                    }
+                // We are still here after the wakeup plus some extra delay, so probably the EV really does not
+                // want to charge. Switch to ChargingPausedEV state.
+                if (not shared_context.hlc_charging_active and shared_context.legacy_wakeup_done and
+                    time_in_current_state > PREPARING_TIMEOUT_PAUSED_BY_EV) {
+                    transition<EvseState::PrepareCharging, EvseState::ChargingPausedEV>();
                 }
             }
+        }
+    }
 
-            // Wait here until all errors are cleared
-            if (errors_prevent_charging_internal()) {
-                break;
+    // if (charge_mode == ChargeMode::DC) {
+    //  DC: wait until car requests power on CP (B->C/D).
+    //  Then we close contactor and wait for instructions from HLC.
+    //  HLC will perform CableCheck, PreCharge, and PowerDelivery.
+    //  These are all controlled from the handlers directly, so there is nothing we need to do here.
+    //  Once HLC informs us about CurrentDemand has started, we will go to Charging in the handler.
+    //}
+}
+
+void Charger::state_charging(bool initialize_state, std::chrono::system_clock::time_point now,
+                             std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        shared_context.hlc_charging_terminate_pause = HlcTerminatePause::Unknown;
+        stopwatch.mark("Charging started");
+        stopwatch.report_phase();
+        auto report = stopwatch.report_all_phases();
+        if (config_context.charge_mode == ChargeMode::DC) {
+            EVLOG_info << "Timing statistics (Plugin to CurrentDemand)";
+            EVLOG_info << "-------------------------------------------";
+            for (const auto& r : report) {
+                EVLOG_info << r;
             }
+        }
+    }
 
-            if (config_context.charge_mode == ChargeMode::DC) {
-                if (initialize_state) {
-                    bsp->allow_power_on(true, types::evse_board_support::Reason::FullPowerCharging);
-                }
-            } else {
-                check_soft_over_current();
-
-                if (not power_available()) {
-                    pause_charging_wait_for_power_internal();
-                    break;
-                }
+    // Wait here until all errors are cleared
+    if (errors_prevent_charging_internal()) {
+        return;
+    }
 
-                if (initialize_state) {
-                    if (internal_context.last_state not_eq EvseState::PrepareCharging) {
-                        signal_simple_event(types::evse_manager::SessionEventEnum::ChargingResumed);
-                    }
+    if (config_context.charge_mode == ChargeMode::DC) {
+        if (initialize_state) {
+            bsp->allow_power_on(true, types::evse_board_support::Reason::FullPowerCharging);
+        }
+    } else {
+        check_soft_over_current();
 
-                    // Allow another wake-up sequence
-                    shared_context.legacy_wakeup_done = false;
+        if (not power_available()) {
+            pause_charging_wait_for_power_internal();
+            return;
+        }
 
-                    bsp->allow_power_on(true, types::evse_board_support::Reason::FullPowerCharging);
-                    // make sure we are enabling PWM
-                    if (hlc_use_5percent_current_session) {
-                        update_pwm_now_if_changed(PWM_5_PERCENT);
-                    } else {
-                        update_pwm_now_if_changed_ampere(get_max_current_internal());
-                    }
-                } else {
-                    // update PWM if it has changed and 5 seconds have passed since last update
-                    if (not hlc_use_5percent_current_session) {
-                        update_pwm_max_every_5seconds_ampere(get_max_current_internal());
-                    }
-                }
+        if (initialize_state) {
+            if (internal_context.last_state not_eq EvseState::PrepareCharging) {
+                signal_simple_event(types::evse_manager::SessionEventEnum::ChargingResumed);
             }
-            break;
 
-        case EvseState::ChargingPausedEV:
+            // Allow another wake-up sequence
+            shared_context.legacy_wakeup_done = false;
 
-            if (config_context.charge_mode == ChargeMode::AC) {
-                check_soft_over_current();
+            bsp->allow_power_on(true, types::evse_board_support::Reason::FullPowerCharging);
+            // make sure we are enabling PWM
+            if (hlc_use_5percent_current_session) {
+                update_pwm_now_if_changed(PWM_5_PERCENT);
+            } else {
+                update_pwm_now_if_changed_ampere(get_max_current_internal());
             }
+        } else {
+            // update PWM if it has changed and 5 seconds have passed since last update
+            if (not hlc_use_5percent_current_session) {
+                update_pwm_max_every_5seconds_ampere(get_max_current_internal());
+            }
+        }
+    }
+}
 
-            // A pause issued by the EV needs to be handled differently for the different charging modes
-
-            // 1) BASIC AC charging: Nominal PWM needs be running, so the EV can actually resume charging when it wants
-            // to
-
-            // 2) HLC charging: [V2G3-M07-19] requires the EV to switch to state B, so we will end up here in this state
-            //    [V2G3-M07-20] forces us to switch off PWM.
-            //    This is also true for nominal PWM AC HLC charging, so an EV that does HLC AC and pauses can only
-            //    resume in HLC mode and not in BASIC charging.
-
-            if (shared_context.hlc_charging_active) {
-                // This is for HLC charging (both AC and DC)
-                if (initialize_state) {
-                    bcb_toggle_reset();
-                    bsp->allow_power_on(false, types::evse_board_support::Reason::PowerOff);
-                    if (config_context.charge_mode == ChargeMode::DC) {
-                        signal_dc_supply_off();
-                    }
-                    signal_simple_event(types::evse_manager::SessionEventEnum::ChargingPausedEV);
-                }
+void Charger::state_charging_paused_EV(bool initialize_state, std::chrono::system_clock::time_point now,
+                                       std::int64_t time_in_current_state) {
+    if (config_context.charge_mode == ChargeMode::AC) {
+        check_soft_over_current();
+    }
 
-                if (bcb_toggle_detected()) {
-                    shared_context.current_state = EvseState::PrepareCharging;
-                }
+    // A pause issued by the EV needs to be handled differently for the different charging modes
 
-                // We come here by a state C->B transition but the ISO message may not have arrived yet,
-                // so we wait here until we know wether it is Terminate or Pause. Until we leave PWM on (should not
-                // be shut down before SessionStop.req)
+    // 1) BASIC AC charging: Nominal PWM needs be running, so the EV can actually resume charging when it wants
+    // to
 
-                if (shared_context.hlc_charging_terminate_pause == HlcTerminatePause::Terminate) {
-                    // EV wants to terminate session
-                    shared_context.current_state = EvseState::StoppingCharging;
-                    if (shared_context.pwm_running) {
-                        pwm_off();
-                    }
-                } else if (shared_context.hlc_charging_terminate_pause == HlcTerminatePause::Pause) {
-                    // EV wants an actual pause
-                    if (shared_context.pwm_running) {
-                        pwm_off();
-                    }
-                }
+    // 2) HLC charging: [V2G3-M07-19] requires the EV to switch to state B, so we will end up here in this state
+    //    [V2G3-M07-20] forces us to switch off PWM.
+    //    This is also true for nominal PWM AC HLC charging, so an EV that does HLC AC and pauses can only
+    //    resume in HLC mode and not in BASIC charging.
 
-            } else {
-                // This is for BASIC charging only
+    if (shared_context.hlc_charging_active) {
+        // This is for HLC charging (both AC and DC)
+        if (initialize_state) {
+            bcb_toggle_reset();
+            bsp->allow_power_on(false, types::evse_board_support::Reason::PowerOff);
+            if (config_context.charge_mode == ChargeMode::DC) {
+                signal_dc_supply_off();
+            }
+            signal_simple_event(types::evse_manager::SessionEventEnum::ChargingPausedEV);
+        }
 
-                // Normally power should be available, since we request a minimum power also during EV pause.
-                // In case the energy manager gives us no energy, we effectivly switch to a pause by EVSE here.
-                if (not power_available()) {
-                    pause_charging_wait_for_power_internal();
-                    break;
-                }
+        if (bcb_toggle_detected()) {
+            transition<EvseState::ChargingPausedEV, EvseState::PrepareCharging>();
+        }
 
-                if (initialize_state) {
-                    signal_simple_event(types::evse_manager::SessionEventEnum::ChargingPausedEV);
-                } else {
-                    // update PWM if it has changed and 5 seconds have passed since last update
-                    if (not errors_prevent_charging_internal()) {
-                        update_pwm_max_every_5seconds_ampere(get_max_current_internal());
-                    }
-                }
-            }
-            break;
+        // We come here by a state C->B transition but the ISO message may not have arrived yet,
+        // so we wait here until we know wether it is Terminate or Pause. Until we leave PWM on (should not
+        // be shut down before SessionStop.req)
 
-        case EvseState::ChargingPausedEVSE:
-            if (initialize_state) {
-                signal_simple_event(types::evse_manager::SessionEventEnum::ChargingPausedEVSE);
-                if (shared_context.hlc_charging_active) {
-                    // currentState = EvseState::StoppingCharging;
-                    shared_context.last_stop_transaction_reason = types::evse_manager::StopTransactionReason::Local;
-                    // tell HLC stack to stop the session
-                    signal_hlc_stop_charging();
-                    pwm_off();
-                } else {
-                    pwm_off();
-                }
+        if (shared_context.hlc_charging_terminate_pause == HlcTerminatePause::Terminate) {
+            // EV wants to terminate session
+            transition<EvseState::ChargingPausedEV, EvseState::StoppingCharging>();
+            if (shared_context.pwm_running) {
+                pwm_off();
             }
-            break;
-
-        case EvseState::WaitingForEnergy:
-            if (initialize_state) {
-                signal_simple_event(types::evse_manager::SessionEventEnum::WaitingForEnergy);
-                if (not hlc_use_5percent_current_session) {
-                    pwm_off();
-                }
+        } else if (shared_context.hlc_charging_terminate_pause == HlcTerminatePause::Pause) {
+            // EV wants an actual pause
+            if (shared_context.pwm_running) {
+                pwm_off();
             }
-            break;
+        }
 
-        case EvseState::StoppingCharging:
-            if (initialize_state) {
-                bcb_toggle_reset();
-                if (shared_context.transaction_active or shared_context.session_active) {
-                    signal_simple_event(types::evse_manager::SessionEventEnum::StoppingCharging);
-                }
+    } else {
+        // This is for BASIC charging only
 
-                if (shared_context.hlc_charging_active) {
-                    if (config_context.charge_mode == ChargeMode::DC) {
-                        // DC supply off - actually this is after relais switched off
-                        // this is a backup switch off, normally it should be switched off earlier by ISO protocol.
-                        signal_dc_supply_off();
-                    }
-                    // Car is maybe not unplugged yet, so for HLC(AC/DC) wait in this state. We will go to Finished
-                    // once car is unplugged.
-                } else {
-                    // For AC BASIC charging, we reached StoppingCharging because an unplug happend.
-                    pwm_off();
-                    shared_context.current_state = EvseState::Finished;
-                }
-            }
+        // Normally power should be available, since we request a minimum power also during EV pause.
+        // In case the energy manager gives us no energy, we effectivly switch to a pause by EVSE here.
+        if (not power_available()) {
+            pause_charging_wait_for_power_internal();
+            return;
+        }
 
-            // Allow session restart after SessionStop.terminate (full restart including new SLAC).
-            // Only allow that if the transaction is still running. If it was cancelled externally with
-            // cancel_transaction(), we do not allow restart. If OCPP cancels a transaction it assumes it cannot be
-            // restarted. In all other cases, e.g. the EV stopping the transaction it may resume with a BCB toggle.
-            if (shared_context.hlc_charging_active and bcb_toggle_detected()) {
-                if (shared_context.transaction_active) {
-                    shared_context.current_state = EvseState::PrepareCharging;
-                    // wake up SLAC as well
-                    signal_slac_start();
-                } else {
-                    session_log.car(false, "Car requested restarting with BCB toggle. Ignored, since we were cancelled "
-                                           "externally before.");
-                }
+        if (initialize_state) {
+            signal_simple_event(types::evse_manager::SessionEventEnum::ChargingPausedEV);
+        } else {
+            // update PWM if it has changed and 5 seconds have passed since last update
+            if (not errors_prevent_charging_internal()) {
+                update_pwm_max_every_5seconds_ampere(get_max_current_internal());
             }
-            break;
+        }
+    }
+}
 
-        case EvseState::Finished:
+void Charger::state_charging_paused_EVSE(bool initialize_state, std::chrono::system_clock::time_point now,
+                                         std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        signal_simple_event(types::evse_manager::SessionEventEnum::ChargingPausedEVSE);
+        if (shared_context.hlc_charging_active) {
+            // currentState = EvseState::StoppingCharging;
+            shared_context.last_stop_transaction_reason = types::evse_manager::StopTransactionReason::Local;
+            // tell HLC stack to stop the session
+            signal_hlc_stop_charging();
+            pwm_off();
+        } else {
+            pwm_off();
+        }
+    }
+}
 
-            if (initialize_state) {
-                // Transaction may already be stopped when it was cancelled earlier.
-                // In that case, do not sent a second transactionFinished event.
-                if (shared_context.transaction_active) {
-                    stop_transaction();
-                }
+void Charger::state_waiting_for_energy(bool initialize_state, std::chrono::system_clock::time_point now,
+                                       std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        signal_simple_event(types::evse_manager::SessionEventEnum::WaitingForEnergy);
+        if (not hlc_use_5percent_current_session) {
+            pwm_off();
+        }
+    }
+}
 
-                // We may come here from an error state, so a session was maybe not active.
-                if (shared_context.session_active) {
-                    stop_session();
-                }
+void Charger::state_stopping_charging(bool initialize_state, std::chrono::system_clock::time_point now,
+                                      std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        bcb_toggle_reset();
+        if (shared_context.transaction_active or shared_context.session_active) {
+            signal_simple_event(types::evse_manager::SessionEventEnum::StoppingCharging);
+        }
 
-                if (config_context.charge_mode == ChargeMode::DC) {
-                    signal_dc_supply_off();
-                }
+        if (shared_context.hlc_charging_active) {
+            if (config_context.charge_mode == ChargeMode::DC) {
+                // DC supply off - actually this is after relais switched off
+                // this is a backup switch off, normally it should be switched off earlier by ISO protocol.
+                signal_dc_supply_off();
             }
+            // Car is maybe not unplugged yet, so for HLC(AC/DC) wait in this state. We will go to Finished
+            // once car is unplugged.
+        } else {
+            // For AC BASIC charging, we reached StoppingCharging because an unplug happend.
+            pwm_off();
+            transition<EvseState::StoppingCharging, EvseState::Finished>();
+        }
+    }
 
-            shared_context.current_state = EvseState::Idle;
-            break;
+    // Allow session restart after SessionStop.terminate (full restart including new SLAC).
+    // Only allow that if the transaction is still running. If it was cancelled externally with
+    // cancel_transaction(), we do not allow restart. If OCPP cancels a transaction it assumes it cannot be
+    // restarted. In all other cases, e.g. the EV stopping the transaction it may resume with a BCB toggle.
+    if (shared_context.hlc_charging_active and bcb_toggle_detected()) {
+        if (shared_context.transaction_active) {
+            transition<EvseState::StoppingCharging, EvseState::PrepareCharging>();
+            // wake up SLAC as well
+            signal_slac_start();
+        } else {
+            session_log.car(false, "Car requested restarting with BCB toggle. Ignored, since we were cancelled "
+                                   "externally before.");
         }
+    }
+}
 
-        if (mainloop_runs > max_mainloop_runs) {
-            EVLOG_warning << "Charger main loop exceeded maximum number of runs, last_state "
-                          << evse_state_to_string(internal_context.last_state_detect_state_change)
-                          << " current_state: " << evse_state_to_string(shared_context.current_state);
+void Charger::state_finished(bool initialize_state, std::chrono::system_clock::time_point now,
+                             std::int64_t time_in_current_state) {
+    if (initialize_state) {
+        // Transaction may already be stopped when it was cancelled earlier.
+        // In that case, do not sent a second transactionFinished event.
+        if (shared_context.transaction_active) {
+            stop_transaction();
         }
 
-    } while (internal_context.last_state_detect_state_change not_eq shared_context.current_state);
+        // We may come here from an error state, so a session was maybe not active.
+        if (shared_context.session_active) {
+            stop_session();
+        }
+
+        if (config_context.charge_mode == ChargeMode::DC) {
+            signal_dc_supply_off();
+        }
+    }
+
+    transition<EvseState::Finished, EvseState::Idle>();
 }
 
 void Charger::process_event(CPEvent cp_event) {
+    flight_recorder->record(FlightRecorder::Type::CPEvent, cp_event);
+
     switch (cp_event) {
     case CPEvent::CarPluggedIn:
     case CPEvent::CarRequestedPower:
@@ -808,7 +887,7 @@ void Charger::process_cp_events_state(CPEvent cp_event) {
         if (cp_event == CPEvent::CarPluggedIn) {
             stopwatch.reset();
             stopwatch.mark_phase("ConnSetup");
-            shared_context.current_state = EvseState::WaitingForAuthentication;
+            transition<EvseState::Idle, EvseState::WaitingForAuthentication>();
         }
         break;
 
@@ -836,7 +915,7 @@ void Charger::process_cp_events_state(CPEvent cp_event) {
     case EvseState::Charging:
         if (cp_event == CPEvent::CarRequestedStopPower) {
             shared_context.iec_allow_close_contactor = false;
-            shared_context.current_state = EvseState::ChargingPausedEV;
+            transition<EvseState::Charging, EvseState::ChargingPausedEV>();
             // Tell HLC stack to stop the session. Normally the session should have already been stopped by the EV, but
             // if this is not the case, we have to do it here.
             if (shared_context.hlc_charging_active) {
@@ -845,7 +924,7 @@ void Charger::process_cp_events_state(CPEvent cp_event) {
             }
         } else if (cp_event == CPEvent::BCDtoEF) {
             shared_context.iec_allow_close_contactor = false;
-            shared_context.current_state = EvseState::StoppingCharging;
+            transition<EvseState::Charging, EvseState::StoppingCharging>();
             // Tell HLC stack to stop the session in case of an E/F event while charging.
             if (shared_context.hlc_charging_active) {
                 signal_hlc_stop_charging();
@@ -859,7 +938,7 @@ void Charger::process_cp_events_state(CPEvent cp_event) {
             shared_context.iec_allow_close_contactor = true;
             // For BASIC charging we can simply switch back to Charging
             if (config_context.charge_mode == ChargeMode::AC and not shared_context.hlc_charging_active) {
-                shared_context.current_state = EvseState::Charging;
+                transition<EvseState::ChargingPausedEV, EvseState::Charging>();
             } else if (not shared_context.pwm_running) {
                 bcb_toggle_detect_start_pulse();
             }
@@ -890,19 +969,22 @@ void Charger::process_cp_events_state(CPEvent cp_event) {
 void Charger::process_cp_events_independent(CPEvent cp_event) {
     switch (cp_event) {
     case CPEvent::EvseReplugStarted:
-        shared_context.current_state = EvseState::Replug;
+        transition_from_any_state<EvseState::Replug>();
         break;
     case CPEvent::EvseReplugFinished:
-        shared_context.current_state = EvseState::WaitingForAuthentication;
+        // the EV may have been unplugged or the EVSE disabled during the replug
+        if (shared_context.current_state == EvseState::Replug) {
+            transition<EvseState::Replug, EvseState::WaitingForAuthentication>();
+        }
         break;
     case CPEvent::CarRequestedStopPower:
         shared_context.iec_allow_close_contactor = false;
         break;
     case CPEvent::CarUnplugged:
         if (not shared_context.hlc_charging_active) {
-            shared_context.current_state = EvseState::StoppingCharging;
+            transition_from_any_state<EvseState::StoppingCharging>();
         } else {
-            shared_context.current_state = EvseState::Finished;
+            transition_from_any_state<EvseState::Finished>();
         }
         break;
 
@@ -935,6 +1017,7 @@ void Charger::update_pwm_now(float dc) {
             "Set PWM On ({}%) took {} ms", dc * 100.,
             (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)).count()));
     internal_context.last_pwm_update = std::chrono::steady_clock::now();
+    flight_recorder->record(FlightRecorder::Type::Pwm, FlightRecorder::Pwm::On, dc);
 
     bsp->set_pwm(dc);
 }
@@ -958,6 +1041,7 @@ void Charger::pwm_off() {
     shared_context.pwm_running = false;
     internal_context.update_pwm_last_dc = 1.;
     internal_context.pwm_set_last_ampere = 0.;
+    flight_recorder->record(FlightRecorder::Type::Pwm, FlightRecorder::Pwm::Off);
     bsp->set_pwm_off();
 }
 
@@ -966,12 +1050,24 @@ void Charger::pwm_F() {
     shared_context.pwm_running = false;
     internal_context.update_pwm_last_dc = 0.;
     internal_context.pwm_set_last_ampere = 0.;
+    flight_recorder->record(FlightRecorder::Type::Pwm, FlightRecorder::Pwm::F);
     bsp->set_pwm_F();
 }
 
 void Charger::run() {
-    // spawn new thread and return
-    main_thread_handle = std::thread(&Charger::main_thread, this);
+    // start the main loop on the shared scheduler and return, its first run enables the CP output
+    mainloop_timer = scheduler->every(MAINLOOP_UPDATE_RATE, [this, started = false]() mutable {
+        if (not started) {
+            started = true;
+            // Enable CP output
+            bsp->enable(true);
+
+            // publish initial values
+            signal_max_current(get_max_current_internal());
+            signal_state(shared_context.current_state);
+        }
+        mainloop();
+    });
 }
 
 float Charger::ampere_to_duty_cycle(float ampere) {
@@ -1010,6 +1106,7 @@ bool Charger::set_max_current(float c, std::chrono::time_point<date::utc_clock>
                 shared_context.max_current = c;
                 shared_context.max_current_valid_until = validUntil;
             }
+            flight_recorder->record(FlightRecorder::Type::MaxCurrent, 0, c);
             bsp->set_overcurrent_limit(c);
             signal_max_current(c);
             return true;
@@ -1023,7 +1120,7 @@ bool Charger::pause_charging() {
     Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_pause_charging);
     if (shared_context.current_state == EvseState::Charging) {
         shared_context.legacy_wakeup_done = false;
-        shared_context.current_state = EvseState::ChargingPausedEVSE;
+        transition<EvseState::Charging, EvseState::ChargingPausedEVSE>();
         return true;
     }
     return false;
@@ -1034,12 +1131,12 @@ bool Charger::resume_charging() {
 
     if (shared_context.hlc_charging_active and shared_context.transaction_active and
         shared_context.current_state == EvseState::ChargingPausedEVSE) {
-        shared_context.current_state = EvseState::PrepareCharging;
+        transition<EvseState::ChargingPausedEVSE, EvseState::PrepareCharging>();
         // wake up SLAC as well
         signal_slac_start();
         return true;
     } else if (shared_context.transaction_active and shared_context.current_state == EvseState::ChargingPausedEVSE) {
-        shared_context.current_state = EvseState::WaitingForEnergy;
+        transition<EvseState::ChargingPausedEVSE, EvseState::WaitingForEnergy>();
         return true;
     }
 
@@ -1055,7 +1152,7 @@ bool Charger::pause_charging_wait_for_power() {
 // pause charging since no power is available at the moment
 bool Charger::pause_charging_wait_for_power_internal() {
     if (shared_context.current_state == EvseState::Charging) {
-        shared_context.current_state = EvseState::WaitingForEnergy;
+        transition<EvseState::Charging, EvseState::WaitingForEnergy>();
         return true;
     }
     return false;
@@ -1067,7 +1164,7 @@ bool Charger::resume_charging_power_available() {
 
     if (shared_context.transaction_active and shared_context.current_state == EvseState::WaitingForEnergy and
         power_available()) {
-        shared_context.current_state = EvseState::PrepareCharging;
+        transition<EvseState::WaitingForEnergy, EvseState::PrepareCharging>();
         return true;
     }
     return false;
@@ -1090,10 +1187,10 @@ bool Charger::cancel_transaction(const types::evse_manager::StopTransactionReque
 
     if (shared_context.transaction_active) {
         if (shared_context.hlc_charging_active) {
-            shared_context.current_state = EvseState::StoppingCharging;
+            transition_from_any_state<EvseState::StoppingCharging>();
             signal_hlc_stop_charging();
         } else {
-            shared_context.current_state = EvseState::ChargingPausedEVSE;
+            checked_transition(EvseState::ChargingPausedEVSE);
             pwm_off();
         }
 
@@ -1265,8 +1362,8 @@ bool Charger::switch_three_phases_while_charging(bool n) {
     if (shared_context.current_state == EvseState::Charging) {
         // In charging state, we need to go via a helper state for the delay
         shared_context.switch_3ph1ph_threephase = n;
-        internal_context.switching_phases_return_state = EvseState::PrepareCharging;
-        shared_context.current_state = EvseState::SwitchPhases;
+        set_return_state<EvseState::SwitchPhases, EvseState::PrepareCharging>();
+        transition<EvseState::Charging, EvseState::SwitchPhases>();
     } else if (shared_context.current_state == EvseState::SwitchPhases) {
         shared_context.switch_3ph1ph_threephase = n;
     } else {
@@ -1306,6 +1403,11 @@ Charger::EvseState Charger::get_current_state() {
     return shared_context.current_state;
 }
 
+std::array<Charger::StateMetrics, Charger::STATE_COUNT> Charger::get_state_metrics() {
+    Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_get_state_metrics);
+    return state_metrics;
+}
+
 bool Charger::get_authorized_pnc() {
     Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_get_authorized_pnc);
     return (shared_context.authorized and shared_context.authorized_pnc);
@@ -1346,6 +1448,8 @@ std::string Charger::get_session_id() const {
 
 void Charger::authorize(bool a, const types::authorization::ProvidedIdToken& token) {
     Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_authorize);
+    flight_recorder->record(FlightRecorder::Type::Authorization,
+                            a ? AuthorizationEvents::authorized : AuthorizationEvents::authorization_revoked);
     if (a) {
         shared_context.id_token = token;
         // First user interaction was auth? Then start session already here and not at plug in
@@ -1370,6 +1474,7 @@ bool Charger::deauthorize() {
 }
 
 bool Charger::deauthorize_internal() {
+    flight_recorder->record(FlightRecorder::Type::Authorization, AuthorizationEvents::deauthorized);
     signal_simple_event(types::evse_manager::SessionEventEnum::Deauthorized);
     if (shared_context.session_active) {
         auto s = shared_context.current_state;
@@ -1418,7 +1523,7 @@ bool Charger::enable_disable(int connector_id, const types::evse_manager::Enable
         signal_simple_event(types::evse_manager::SessionEventEnum::Enabled);
         if (shared_context.current_state == EvseState::Disabled) {
             if (shared_context.connector_enabled) {
-                shared_context.current_state = EvseState::Idle;
+                transition<EvseState::Disabled, EvseState::Idle>();
             }
             return true;
         }
@@ -1426,7 +1531,7 @@ bool Charger::enable_disable(int connector_id, const types::evse_manager::Enable
         if (connector_id not_eq 0) {
             shared_context.connector_enabled = false;
         }
-        shared_context.current_state = EvseState::Disabled;
+        transition_from_any_state<EvseState::Disabled>();
         signal_simple_event(types::evse_manager::SessionEventEnum::Disabled);
     }
     return is_enabled;
@@ -1657,8 +1762,13 @@ void Charger::request_error_sequence() {
     Everest::scoped_lock_timeout lock(state_machine_mutex, Everest::MutexDescription::Charger_request_error_sequence);
     if (shared_context.current_state == EvseState::WaitingForAuthentication or
         shared_context.current_state == EvseState::PrepareCharging) {
-        internal_context.t_step_EF_return_state = shared_context.current_state;
-        shared_context.current_state = EvseState::T_step_EF;
+        if (shared_context.current_state == EvseState::WaitingForAuthentication) {
+            set_return_state<EvseState::T_step_EF, EvseState::WaitingForAuthentication>();
+            transition<EvseState::WaitingForAuthentication, EvseState::T_step_EF>();
+        } else {
+            set_return_state<EvseState::T_step_EF, EvseState::PrepareCharging>();
+            transition<EvseState::PrepareCharging, EvseState::T_step_EF>();
+        }
         signal_slac_reset();
         if (hlc_use_5percent_current_session) {
             internal_context.t_step_EF_return_pwm = PWM_5_PERCENT;
@@ -1678,7 +1788,7 @@ void Charger::notify_currentdemand_started() {
                                       Everest::MutexDescription::Charger_notify_currentdemand_started);
     if (shared_context.current_state == EvseState::PrepareCharging) {
         signal_simple_event(types::evse_manager::SessionEventEnum::ChargingStarted);
-        shared_context.current_state = EvseState::Charging;
+        transition<EvseState::PrepareCharging, EvseState::Charging>();
     }
 }
 
@@ -1735,12 +1845,12 @@ void Charger::dlink_error() {
             // Do t_step_X1 with a t_step_EF afterwards
             // [V2G3-M07-08] The state E/F shall be applied at least T_step_EF: This is already handled in
             // the t_step_EF state.
-            internal_context.t_step_X1_return_state = EvseState::T_step_EF;
+            set_return_state<EvseState::T_step_X1, EvseState::T_step_EF>();
             internal_context.t_step_X1_return_pwm = 0.;
-            shared_context.current_state = EvseState::T_step_X1;
+            checked_transition(EvseState::T_step_X1);
 
             // After returning from T_step_EF, go to Waiting for Auth (We are restarting the session)
-            internal_context.t_step_EF_return_state = EvseState::WaitingForAuthentication;
+            set_return_state<EvseState::T_step_EF, EvseState::WaitingForAuthentication>();
             // [V2G3-M07-09] After applying state E/F, the EVSE shall switch to contol pilot state X1 or X2
             // as soon as the EVSE is ready control for pilot incoming duty matching cycle requests: This is
             // already handled in the Auth step.
@@ -12,7 +12,7 @@
  *  1) Hi level state machine that is controlled by a) events from evse_board_support interface
  *     and b) by external commands from higher levels
  *
- * The state machine runs in its own (big) thread. After plugin,
+ * The state machine runs periodically on the shared Scheduler. After plugin,
  * The charger waits in state WaitingForAuthentication forever. Send
  * Authenticate()
  * from hi level to start charging. After car is unplugged, it waits in
@@ -26,7 +26,11 @@
 #include "SessionLog.hpp"
 #include "ld-ev.hpp"
 #include "utils/thread.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <date/date.h>
 #include <date/tz.h>
 #include <generated/interfaces/ISO15118_charger/Interface.hpp>
@@ -44,8 +48,10 @@
 
 #include "ErrorHandling.hpp"
 #include "EventQueue.hpp"
+#include "FlightRecorder.hpp"
 #include "IECStateMachine.hpp"
 #include "PersistentStore.hpp"
+#include "Scheduler.hpp"
 #include "scoped_lock_timeout.hpp"
 #include "utils.hpp"
 
@@ -58,7 +64,7 @@ class Charger {
 public:
     Charger(const std::unique_ptr<IECStateMachine>& bsp, const std::unique_ptr<ErrorHandling>& error_handling,
             const std::vector<std::unique_ptr<powermeterIntf>>& r_powermeter_billing,
-            const std::unique_ptr<PersistentStore>& store,
+            const std::unique_ptr<PersistentStore>& store, const std::unique_ptr<FlightRecorder>& flight_recorder,
             const types::evse_board_support::Connector_type& connector_type, const std::string& evse_id);
     ~Charger();
 
@@ -181,6 +187,24 @@ public:
     EvseState get_current_state();
     sigslot::signal<EvseState> signal_state;
 
+    // Replug is the last EvseState
+    static constexpr std::size_t STATE_COUNT = static_cast<std::size_t>(EvseState::Replug) + 1;
+
+    struct StateMetrics {
+        std::uint64_t runs{0};
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+
+        void add(std::chrono::nanoseconds duration) {
+            runs++;
+            total += duration;
+            max = std::max(max, duration);
+        }
+    };
+
+    // execution time of the state handlers since start, indexed by EvseState
+    std::array<StateMetrics, STATE_COUNT> get_state_metrics();
+
     void inform_new_evse_max_hlc_limits(const types::iso15118_charger::DcEvseMaximumLimits& l);
     types::iso15118_charger::DcEvseMaximumLimits get_evse_max_hlc_limits();
 
@@ -218,6 +242,11 @@ public:
     void cleanup_transactions_on_startup();
 
 private:
+#ifdef BUILD_TESTING_MODULE_EVSE_MANAGER
+    // ticks mainloop() directly instead of waiting for the timer started by run()
+    friend class SessionBenchmark;
+#endif
+
     utils::Stopwatch stopwatch;
 
     std::optional<types::units_signed::SignedMeterValue>
@@ -247,7 +276,164 @@ private:
     void process_cp_events_state(CPEvent cp_event);
     void run_state_machine();
 
-    void main_thread();
+    // One handler per state, run_state_machine() only calls the handler of the current state
+    using StateHandler = void (Charger::*)(bool initialize_state, std::chrono::system_clock::time_point now,
+                                           std::int64_t time_in_current_state);
+    static const std::array<StateHandler, STATE_COUNT> state_handlers;
+    void state_disabled(bool initialize_state, std::chrono::system_clock::time_point now,
+                        std::int64_t time_in_current_state);
+    void state_replug(bool initialize_state, std::chrono::system_clock::time_point now,
+                      std::int64_t time_in_current_state);
+    void state_idle(bool initialize_state, std::chrono::system_clock::time_point now,
+                    std::int64_t time_in_current_state);
+    void state_waiting_for_authentication(bool initialize_state, std::chrono::system_clock::time_point now,
+                                          std::int64_t time_in_current_state);
+    void state_switch_phases(bool initialize_state, std::chrono::system_clock::time_point now,
+                             std::int64_t time_in_current_state);
+    void state_t_step_EF(bool initialize_state, std::chrono::system_clock::time_point now,
+                         std::int64_t time_in_current_state);
+    void state_t_step_X1(bool initialize_state, std::chrono::system_clock::time_point now,
+                         std::int64_t time_in_current_state);
+    void state_prepare_charging(bool initialize_state, std::chrono::system_clock::time_point now,
+                                std::int64_t time_in_current_state);
+    void state_charging(bool initialize_state, std::chrono::system_clock::time_point now,
+                        std::int64_t time_in_current_state);
+    void state_charging_paused_EV(bool initialize_state, std::chrono::system_clock::time_point now,
+                                  std::int64_t time_in_current_state);
+    void state_charging_paused_EVSE(bool initialize_state, std::chrono::system_clock::time_point now,
+                                    std::int64_t time_in_current_state);
+    void state_waiting_for_energy(bool initialize_state, std::chrono::system_clock::time_point now,
+                                  std::int64_t time_in_current_state);
+    void state_stopping_charging(bool initialize_state, std::chrono::system_clock::time_point now,
+                                 std::int64_t time_in_current_state);
+    void state_finished(bool initialize_state, std::chrono::system_clock::time_point now,
+                        std::int64_t time_in_current_state);
+
+    struct Transition {
+        EvseState from;
+        EvseState to;
+    };
+
+    // All state changes go through transition(), which does not compile for a transition that is not listed here,
+    // or through checked_transition() where the current state is only known at runtime
+    static constexpr std::array<Transition, 42> TRANSITIONS{{
+        {EvseState::Disabled, EvseState::Idle},
+        {EvseState::Idle, EvseState::WaitingForAuthentication},
+        {EvseState::Replug, EvseState::WaitingForAuthentication},
+        {EvseState::WaitingForAuthentication, EvseState::PrepareCharging},
+        {EvseState::WaitingForAuthentication, EvseState::T_step_EF},
+        {EvseState::WaitingForAuthentication, EvseState::T_step_X1},
+        {EvseState::PrepareCharging, EvseState::WaitingForEnergy},
+        {EvseState::PrepareCharging, EvseState::Charging},
+        {EvseState::PrepareCharging, EvseState::ChargingPausedEV},
+        {EvseState::PrepareCharging, EvseState::T_step_EF},
+        {EvseState::WaitingForEnergy, EvseState::PrepareCharging},
+        {EvseState::Charging, EvseState::ChargingPausedEV},
+        {EvseState::Charging, EvseState::ChargingPausedEVSE},
+        {EvseState::Charging, EvseState::WaitingForEnergy},
+        {EvseState::Charging, EvseState::StoppingCharging},
+        {EvseState::Charging, EvseState::SwitchPhases},
+        {EvseState::ChargingPausedEV, EvseState::Charging},
+        {EvseState::ChargingPausedEV, EvseState::PrepareCharging},
+        {EvseState::ChargingPausedEV, EvseState::StoppingCharging},
+        {EvseState::ChargingPausedEVSE, EvseState::PrepareCharging},
+        {EvseState::ChargingPausedEVSE, EvseState::WaitingForEnergy},
+        {EvseState::StoppingCharging, EvseState::Finished},
+        {EvseState::StoppingCharging, EvseState::PrepareCharging},
+        {EvseState::Finished, EvseState::Idle},
+        {EvseState::T_step_EF, EvseState::PrepareCharging},
+        {EvseState::T_step_EF, EvseState::WaitingForAuthentication},
+        {EvseState::T_step_X1, EvseState::PrepareCharging},
+        {EvseState::T_step_X1, EvseState::T_step_EF},
+        {EvseState::SwitchPhases, EvseState::PrepareCharging},
+        // cancel_transaction() during basic charging
+        {EvseState::WaitingForAuthentication, EvseState::ChargingPausedEVSE},
+        {EvseState::PrepareCharging, EvseState::ChargingPausedEVSE},
+        {EvseState::WaitingForEnergy, EvseState::ChargingPausedEVSE},
+        {EvseState::ChargingPausedEV, EvseState::ChargingPausedEVSE},
+        {EvseState::SwitchPhases, EvseState::ChargingPausedEVSE},
+        {EvseState::T_step_EF, EvseState::ChargingPausedEVSE},
+        {EvseState::T_step_X1, EvseState::ChargingPausedEVSE},
+        // dlink_error() while the 5 percent PWM is on
+        {EvseState::PrepareCharging, EvseState::T_step_X1},
+        {EvseState::WaitingForEnergy, EvseState::T_step_X1},
+        {EvseState::Charging, EvseState::T_step_X1},
+        {EvseState::ChargingPausedEV, EvseState::T_step_X1},
+        {EvseState::ChargingPausedEVSE, EvseState::T_step_X1},
+        {EvseState::StoppingCharging, EvseState::T_step_X1},
+    }};
+
+    // States entered on external events (disable, replug, unplug, HLC cancel) regardless of the current state
+    static constexpr std::array<EvseState, 4> ANY_STATE_TRANSITIONS{{
+        EvseState::Disabled,
+        EvseState::Replug,
+        EvseState::StoppingCharging,
+        EvseState::Finished,
+    }};
+
+    static constexpr bool reachable_from_any_state(EvseState to) {
+        for (const auto state : ANY_STATE_TRANSITIONS) {
+            if (state == to) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static constexpr bool transition_allowed(EvseState from, EvseState to) {
+        for (const auto& transition : TRANSITIONS) {
+            if (transition.from == from and transition.to == to) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <EvseState FROM, EvseState TO> void transition() {
+        static_assert(transition_allowed(FROM, TO), "Charger state transition is not in TRANSITIONS");
+        shared_context.current_state = TO;
+    }
+
+    template <EvseState TO> void transition_from_any_state() {
+        static_assert(reachable_from_any_state(TO), "Charger state is not in ANY_STATE_TRANSITIONS");
+        shared_context.current_state = TO;
+    }
+
+    // Changes to \p to if the current state is \p to already or the transition is in TRANSITIONS, otherwise
+    // the state is kept and false returned
+    bool checked_transition(EvseState to);
+
+    // state to continue with after T_step_EF, T_step_X1 or SwitchPhases
+    template <EvseState STEP, EvseState TO> void set_return_state() {
+        static_assert(transition_allowed(STEP, TO), "Charger state transition is not in TRANSITIONS");
+        return_state<STEP>() = TO;
+    }
+
+    // leaves STEP to the state set with set_return_state(), call from the state handler of STEP
+    template <EvseState STEP> void transition_to_return_state() {
+        assert(shared_context.current_state == STEP);
+        const auto to = return_state<STEP>();
+        assert(transition_allowed(STEP, to));
+        checked_transition(to);
+    }
+
+    template <EvseState STEP> EvseState& return_state() {
+        if constexpr (STEP == EvseState::T_step_EF) {
+            return internal_context.t_step_EF_return_state;
+        } else if constexpr (STEP == EvseState::T_step_X1) {
+            return internal_context.t_step_X1_return_state;
+        } else {
+            static_assert(STEP == EvseState::SwitchPhases, "only T_step_EF, T_step_X1 and SwitchPhases return");
+            return internal_context.switching_phases_return_state;
+        }
+    }
+
+    std::array<StateMetrics, STATE_COUNT> state_metrics;
+    // names of the states for tracing, interned on first use
+    std::array<const char*, STATE_COUNT> state_trace_names{};
+
+    void mainloop();
+    void process_error_handling_events();
 
     void graceful_stop_charging();
 
@@ -356,15 +542,23 @@ private:
         bool pp_warning_printed{false};
         bool no_energy_warning_printed{false};
         float pwm_set_last_ampere{0};
+
+        // 5 percent PWM of the current WaitingForAuthentication is not on yet, hlc_pwm_timer switches it on
+        bool hlc_pwm_pending{false};
+        std::uint64_t hlc_pwm_generation{0};
     } internal_context;
 
-    // main Charger thread
-    Everest::Thread main_thread_handle;
+    // declared before the timers, they are stopped before the scheduler is released
+    const std::shared_ptr<Scheduler> scheduler{Scheduler::shared()};
+    // periodic main loop, started by run()
+    Scheduler::TimerHandle mainloop_timer;
+    Scheduler::TimerHandle hlc_pwm_timer;
 
     const std::unique_ptr<IECStateMachine>& bsp;
     const std::unique_ptr<ErrorHandling>& error_handling;
     const std::vector<std::unique_ptr<powermeterIntf>>& r_powermeter_billing;
     const std::unique_ptr<PersistentStore>& store;
+    const std::unique_ptr<FlightRecorder>& flight_recorder;
     std::atomic<types::evse_board_support::Connector_type> connector_type{
         types::evse_board_support::Connector_type::IEC62196Type2Cable};
     const std::string evse_id;
@@ -377,6 +571,13 @@ private:
 
     EventQueue<ErrorHandlingEvents> error_handling_event_queue;
 
+    // codes of FlightRecorder::Type::Authorization
+    enum class AuthorizationEvents : std::uint8_t {
+        authorized,
+        authorization_revoked,
+        deauthorized
+    };
+
     // constants
     static constexpr float CHARGER_ABSOLUTE_MAX_CURRENT{1000.};
     constexpr static int LEGACY_WAKEUP_TIMEOUT{30000};
@@ -41,10 +41,34 @@ inline static types::authorization::ProvidedIdToken create_autocharge_token(std:
     return autocharge_token;
 }
 
+EvseManager::~EvseManager() {
+    // stop the telemetry before anything it uses is destroyed
+    telemetry_timer.cancel();
+}
+
 void EvseManager::init() {
+    startup_profiler = std::make_unique<StartupProfiler>(info.id);
+    auto phase = startup_profiler->measure("init");
+    tracing::init(info.id);
 
     store = std::unique_ptr<PersistentStore>(new PersistentStore(r_store, info.id));
 
+    scheduler->reserve_workers(config.scheduler_worker_threads);
+
+    // the names of all channels are set before the dump directory, the Charger sets its own
+    flight_recorder = std::make_unique<FlightRecorder>(config.evse_id, config.flight_recorder_size);
+    std::vector<std::string> bsp_event_names;
+    for (const auto e : {types::board_support_common::Event::A, types::board_support_common::Event::B,
+                         types::board_support_common::Event::C, types::board_support_common::Event::D,
+                         types::board_support_common::Event::E, types::board_support_common::Event::F,
+                         types::board_support_common::Event::PowerOn, types::board_support_common::Event::PowerOff,
+                         types::board_support_common::Event::EvseReplugStarted,
+                         types::board_support_common::Event::EvseReplugFinished,
+                         types::board_support_common::Event::Disconnected}) {
+        bsp_event_names.push_back(types::board_support_common::event_to_string(e));
+    }
+    flight_recorder->set_names(FlightRecorder::Type::BspEvent, std::move(bsp_event_names));
+
     random_delay_enabled = config.uk_smartcharging_random_delay_enable;
     random_delay_max_duration = std::chrono::seconds(config.uk_smartcharging_random_delay_max_duration);
     if (random_delay_enabled) {
@@ -153,6 +177,8 @@ void EvseManager::init() {
 }
 
 void EvseManager::ready() {
+    auto phase = startup_profiler->measure("ready");
+
     bsp = std::unique_ptr<IECStateMachine>(new IECStateMachine(r_bsp));
 
     if (config.hack_simplified_mode_limit_10A) {
@@ -163,7 +189,24 @@ void EvseManager::ready() {
         std::unique_ptr<ErrorHandling>(new ErrorHandling(r_bsp, r_hlc, r_connector_lock, r_ac_rcd, p_evse, r_imd));
 
     charger = std::unique_ptr<Charger>(new Charger(bsp, error_handling, r_powermeter_billing(), store,
-                                                   hw_capabilities.connector_type, config.evse_id));
+                                                   flight_recorder, hw_capabilities.connector_type, config.evse_id));
+
+    flight_recorder->set_dump_limits(config.flight_recorder_max_dumps,
+                                     std::chrono::seconds(config.flight_recorder_min_error_dump_interval_s));
+    flight_recorder->set_dump_directory(config.flight_recorder_path);
+#ifdef EVEREST_USE_BACKTRACES
+    Everest::install_crash_handler(&FlightRecorder::dump_all_on_crash);
+#endif
+
+    r_bsp->subscribe_event([this](const types::board_support_common::BspEvent event) {
+        flight_recorder->record(FlightRecorder::Type::BspEvent, event.event);
+    });
+    mqtt.subscribe("everest_api/" + info.id + "/cmd/dump_flight_recorder", [this](const std::string& data) {
+        const auto path = flight_recorder->dump("command");
+        if (path.has_value()) {
+            EVLOG_info << "Flight recorder written to " << path.value();
+        }
+    });
 
     // Now incoming hardware capabilties can be processed
     hw_caps_mutex.unlock();
@@ -819,111 +862,125 @@ void EvseManager::ready() {
                        config.switch_3ph1ph_delay_s, config.switch_3ph1ph_cp_state);
     }
 
-    telemetryThreadHandle = std::thread([this]() {
-        while (not telemetryThreadHandle.shouldExit()) {
-            sleep(10);
-            auto p = get_latest_powermeter_data_billing();
-            Everest::TelemetryMap telemetry_data{{"timestamp", p.timestamp},
-                                                 {"type", "power_meter"},
-                                                 {"meter_id", p.meter_id.value_or("N/A")},
-                                                 {"energy_import_total_Wh", p.energy_Wh_import.total}};
-
-            if (p.energy_Wh_import.L1) {
-                telemetry_data["energy_import_L1_Wh"] = p.energy_Wh_import.L1.value();
-            }
-            if (p.energy_Wh_import.L2) {
-                telemetry_data["energy_import_L2_Wh"] = p.energy_Wh_import.L2.value();
-            }
-            if (p.energy_Wh_import.L3) {
-                telemetry_data["energy_import_L3_Wh"] = p.energy_Wh_import.L3.value();
-            }
+    telemetry_timer = scheduler->every(TELEMETRY_INTERVAL, [this]() {
+        auto p = get_latest_powermeter_data_billing();
+        Everest::TelemetryMap telemetry_data{{"timestamp", p.timestamp},
+                                             {"type", "power_meter"},
+                                             {"meter_id", p.meter_id.value_or("N/A")},
+                                             {"energy_import_total_Wh", p.energy_Wh_import.total}};
 
-            if (p.energy_Wh_export) {
-                telemetry_data["energy_export_total_Wh"] = p.energy_Wh_export.value().total;
-            }
-            if (p.energy_Wh_export and p.energy_Wh_export.value().L1) {
-                telemetry_data["energy_export_L1_Wh"] = p.energy_Wh_export.value().L1.value();
-            }
-            if (p.energy_Wh_export and p.energy_Wh_export.value().L2) {
-                telemetry_data["energy_export_L2_Wh"] = p.energy_Wh_export.value().L2.value();
-            }
-            if (p.energy_Wh_export and p.energy_Wh_export.value().L3) {
-                telemetry_data["energy_export_L3_Wh"] = p.energy_Wh_export.value().L3.value();
-            }
+        if (p.energy_Wh_import.L1) {
+            telemetry_data["energy_import_L1_Wh"] = p.energy_Wh_import.L1.value();
+        }
+        if (p.energy_Wh_import.L2) {
+            telemetry_data["energy_import_L2_Wh"] = p.energy_Wh_import.L2.value();
+        }
+        if (p.energy_Wh_import.L3) {
+            telemetry_data["energy_import_L3_Wh"] = p.energy_Wh_import.L3.value();
+        }
 
-            if (p.power_W) {
-                telemetry_data["power_total_W"] = p.power_W.value().total;
-            }
-            if (p.power_W and p.power_W.value().L1) {
-                telemetry_data["power_L1_W"] = p.power_W.value().L1.value();
-            }
-            if (p.power_W and p.power_W.value().L2) {
-                telemetry_data["power_L3_W"] = p.power_W.value().L2.value();
-            }
-            if (p.power_W and p.power_W.value().L3) {
-                telemetry_data["power_L3_W"] = p.power_W.value().L3.value();
-            }
+        if (p.energy_Wh_export) {
+            telemetry_data["energy_export_total_Wh"] = p.energy_Wh_export.value().total;
+        }
+        if (p.energy_Wh_export and p.energy_Wh_export.value().L1) {
+            telemetry_data["energy_export_L1_Wh"] = p.energy_Wh_export.value().L1.value();
+        }
+        if (p.energy_Wh_export and p.energy_Wh_export.value().L2) {
+            telemetry_data["energy_export_L2_Wh"] = p.energy_Wh_export.value().L2.value();
+        }
+        if (p.energy_Wh_export and p.energy_Wh_export.value().L3) {
+            telemetry_data["energy_export_L3_Wh"] = p.energy_Wh_export.value().L3.value();
+        }
 
-            if (p.VAR) {
-                telemetry_data["var_total"] = p.VAR.value().total;
-            }
-            if (p.VAR and p.VAR.value().L1) {
-                telemetry_data["var_L1"] = p.VAR.value().L1.value();
-            }
-            if (p.VAR and p.VAR.value().L2) {
-                telemetry_data["var_L1"] = p.VAR.value().L2.value();
-            }
-            if (p.VAR and p.VAR.value().L3) {
-                telemetry_data["var_L1"] = p.VAR.value().L3.value();
-            }
+        if (p.power_W) {
+            telemetry_data["power_total_W"] = p.power_W.value().total;
+        }
+        if (p.power_W and p.power_W.value().L1) {
+            telemetry_data["power_L1_W"] = p.power_W.value().L1.value();
+        }
+        if (p.power_W and p.power_W.value().L2) {
+            telemetry_data["power_L3_W"] = p.power_W.value().L2.value();
+        }
+        if (p.power_W and p.power_W.value().L3) {
+            telemetry_data["power_L3_W"] = p.power_W.value().L3.value();
+        }
 
-            if (p.voltage_V and p.voltage_V.value().L1) {
-                telemetry_data["voltage_L1_V"] = p.voltage_V.value().L1.value();
-            }
-            if (p.voltage_V and p.voltage_V.value().L2) {
-                telemetry_data["voltage_L2_V"] = p.voltage_V.value().L2.value();
-            }
-            if (p.voltage_V and p.voltage_V.value().L3) {
-                telemetry_data["voltage_L3_V"] = p.voltage_V.value().L3.value();
-            }
-            if (p.voltage_V and p.voltage_V.value().DC) {
-                telemetry_data["voltage_DC_V"] = p.voltage_V.value().DC.value();
-            }
+        if (p.VAR) {
+            telemetry_data["var_total"] = p.VAR.value().total;
+        }
+        if (p.VAR and p.VAR.value().L1) {
+            telemetry_data["var_L1"] = p.VAR.value().L1.value();
+        }
+        if (p.VAR and p.VAR.value().L2) {
+            telemetry_data["var_L1"] = p.VAR.value().L2.value();
+        }
+        if (p.VAR and p.VAR.value().L3) {
+            telemetry_data["var_L1"] = p.VAR.value().L3.value();
+        }
 
-            if (p.current_A and p.current_A.value().L1) {
-                telemetry_data["current_L1_A"] = p.current_A.value().L1.value();
-            }
-            if (p.current_A and p.current_A.value().L2) {
-                telemetry_data["current_L2_A"] = p.current_A.value().L2.value();
-            }
-            if (p.current_A and p.current_A.value().L3) {
-                telemetry_data["current_L3_A"] = p.current_A.value().L3.value();
-            }
-            if (p.current_A and p.current_A.value().DC) {
-                telemetry_data["current_DC_A"] = p.current_A.value().DC.value();
-            }
+        if (p.voltage_V and p.voltage_V.value().L1) {
+            telemetry_data["voltage_L1_V"] = p.voltage_V.value().L1.value();
+        }
+        if (p.voltage_V and p.voltage_V.value().L2) {
+            telemetry_data["voltage_L2_V"] = p.voltage_V.value().L2.value();
+        }
+        if (p.voltage_V and p.voltage_V.value().L3) {
+            telemetry_data["voltage_L3_V"] = p.voltage_V.value().L3.value();
+        }
+        if (p.voltage_V and p.voltage_V.value().DC) {
+            telemetry_data["voltage_DC_V"] = p.voltage_V.value().DC.value();
+        }
 
-            if (p.frequency_Hz) {
-                telemetry_data["frequency_L1_Hz"] = p.frequency_Hz.value().L1;
-            }
-            if (p.frequency_Hz and p.frequency_Hz.value().L2) {
-                telemetry_data["frequency_L2_Hz"] = p.frequency_Hz.value().L2.value();
-            }
-            if (p.frequency_Hz and p.frequency_Hz.value().L3) {
-                telemetry_data["frequency_L3_Hz"] = p.frequency_Hz.value().L3.value();
-            }
+        if (p.current_A and p.current_A.value().L1) {
+            telemetry_data["current_L1_A"] = p.current_A.value().L1.value();
+        }
+        if (p.current_A and p.current_A.value().L2) {
+            telemetry_data["current_L2_A"] = p.current_A.value().L2.value();
+        }
+        if (p.current_A and p.current_A.value().L3) {
+            telemetry_data["current_L3_A"] = p.current_A.value().L3.value();
+        }
+        if (p.current_A and p.current_A.value().DC) {
+            telemetry_data["current_DC_A"] = p.current_A.value().DC.value();
+        }
 
-            if (p.phase_seq_error) {
-                telemetry_data["phase_seq_error"] = p.phase_seq_error.value();
-            }
+        if (p.frequency_Hz) {
+            telemetry_data["frequency_L1_Hz"] = p.frequency_Hz.value().L1;
+        }
+        if (p.frequency_Hz and p.frequency_Hz.value().L2) {
+            telemetry_data["frequency_L2_Hz"] = p.frequency_Hz.value().L2.value();
+        }
+        if (p.frequency_Hz and p.frequency_Hz.value().L3) {
+            telemetry_data["frequency_L3_Hz"] = p.frequency_Hz.value().L3.value();
+        }
+
+        if (p.phase_seq_error) {
+            telemetry_data["phase_seq_error"] = p.phase_seq_error.value();
+        }
+
+        // Publish as external telemetry data
+        telemetry.publish("livedata", "power_meter", telemetry_data);
 
-            // Publish as external telemetry data
-            telemetry.publish("livedata", "power_meter", telemetry_data);
+        // Execution time of the Charger state handlers since start, only states that have run
+        Everest::TelemetryMap state_machine_data{{"timestamp", p.timestamp}, {"type", "charger_state_machine"}};
+        const auto metrics = charger->get_state_metrics();
+        for (std::size_t i = 0; i < metrics.size(); i++) {
+            const auto& m = metrics[i];
+            if (m.runs == 0) {
+                continue;
+            }
+            const auto name = charger->evse_state_to_string(static_cast<Charger::EvseState>(i));
+            state_machine_data[name + "_runs"] = static_cast<double>(m.runs);
+            state_machine_data[name + "_avg_us"] =
+                std::chrono::duration<double, std::micro>(m.total).count() / static_cast<double>(m.runs);
+            state_machine_data[name + "_max_us"] = std::chrono::duration<double, std::micro>(m.max).count();
         }
+        telemetry.publish("livedata", "charger_state_machine", state_machine_data);
     });
 
     {
         // wait for first powermeter value
+        auto wait_phase = startup_profiler->measure("wait_for_powermeter");
         std::unique_lock<std::mutex> lk(powermeter_mutex);
         this->powermeter_cv.wait_for(lk, std::chrono::milliseconds(this->config.initial_meter_value_timeout_ms),
                                      [this] { return initial_powermeter_value_received; });
@@ -948,6 +1005,9 @@ void EvseManager::ready() {
         // immediately ready, otherwise delay until we get the external signal
         this->ready_to_start_charging();
     }
+
+    phase.done();
+    startup_profiler->ready_done();
 }
 
 void EvseManager::ready_to_start_charging() {
@@ -965,6 +1025,7 @@ void EvseManager::ready_to_start_charging() {
     }
 
     this->p_evse->publish_ready(true);
+    startup_profiler->mark("ready_to_charge");
     EVLOG_info << fmt::format(fmt::emphasis::bold | fg(fmt::terminal_color::green), "🌀🌀🌀 Ready to start charging 🌀🌀🌀");
     if (!initial_powermeter_value_received) {
         EVLOG_warning << "No powermeter value received yet!";
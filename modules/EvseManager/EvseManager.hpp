@@ -42,8 +42,12 @@
 #include "CarManufacturer.hpp"
 #include "Charger.hpp"
 #include "ErrorHandling.hpp"
+#include "FlightRecorder.hpp"
 #include "PersistentStore.hpp"
+#include "Scheduler.hpp"
 #include "SessionLog.hpp"
+#include <startup_profiler/startup_profiler.hpp>
+#include <tracing/tracing.hpp>
 #include "VarContainer.hpp"
 #include "scoped_lock_timeout.hpp"
 // ev@4bf81b14-a215-475c-a1d3-0a484ae48918:v1
@@ -97,6 +101,11 @@ struct Conf {
     int initial_meter_value_timeout_ms;
     int switch_3ph1ph_delay_s;
     std::string switch_3ph1ph_cp_state;
+    int scheduler_worker_threads;
+    int flight_recorder_size;
+    std::string flight_recorder_path;
+    int flight_recorder_max_dumps;
+    int flight_recorder_min_error_dump_interval_s;
 };
 
 class EvseManager : public Everest::ModuleBase {
@@ -153,6 +162,9 @@ public:
 
     // ev@1fce4c5e-0ab8-41bb-90f7-14277703d2ac:v1
     // insert your public definitions here
+    ~EvseManager();
+    // declared before the charger, it records until the charger is gone
+    std::unique_ptr<FlightRecorder> flight_recorder;
     std::unique_ptr<Charger> charger;
     sigslot::signal<int> signalNrOfPhasesAvailable;
     types::powermeter::Powermeter get_latest_powermeter_data_billing();
@@ -256,6 +268,8 @@ private:
 
     // ev@211cfdbe-f69a-4cd6-a4ec-f8aaa3d1b6c8:v1
     // insert your private definitions here
+    std::unique_ptr<StartupProfiler> startup_profiler;
+
     std::mutex powersupply_capabilities_mutex;
     types::power_supply_DC::Capabilities powersupply_capabilities;
 
@@ -320,7 +334,8 @@ private:
 
     void imd_stop();
     void imd_start();
-    Everest::Thread telemetryThreadHandle;
+    const std::shared_ptr<Scheduler> scheduler{Scheduler::shared()};
+    Scheduler::TimerHandle telemetry_timer;
 
     void fail_cable_check();
 
@@ -329,6 +344,7 @@ private:
 
     bool check_isolation_resistance_in_range(double resistance);
 
+    static constexpr auto TELEMETRY_INTERVAL{std::chrono::seconds(10)};
     static constexpr auto CABLECHECK_CONTACTORS_CLOSE_TIMEOUT{std::chrono::seconds(5)};
     static constexpr double CABLECHECK_CURRENT_LIMIT{2};
     static constexpr double CABLECHECK_INSULATION_FAULT_RESISTANCE_OHM{100000.};
@@ -0,0 +1,432 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "FlightRecorder.hpp"
+
+#include <everest/logging.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace module {
+
+namespace {
+
+constexpr char MAGIC[] = {'E', 'V', 'F', 'R'};
+constexpr std::uint8_t VERSION = 1;
+constexpr std::size_t RECORD_SIZE = 8 + 8 + 1 + 1 + 4;
+// records encoded per write() while dumping
+constexpr std::size_t WRITE_BATCH = 64;
+
+// recorders the crash handler dumps, one per EVSE hosted in this process
+constexpr std::size_t MAX_RECORDERS = 16;
+std::array<std::atomic<FlightRecorder*>, MAX_RECORDERS> recorders{};
+
+constexpr std::array<const char*, FlightRecorder::TYPE_COUNT> TYPE_NAMES = {
+    "ChargerState", "CPEvent", "BspEvent", "Pwm", "MaxCurrent", "Authorization", "Error",
+};
+
+template <typename T> void put(std::uint8_t*& out, T value) {
+    for (std::size_t i = 0; i < sizeof(T); i++) {
+        *out++ = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i));
+    }
+}
+
+template <typename T> void put(std::vector<std::uint8_t>& out, T value) {
+    std::uint8_t bytes[sizeof(T)];
+    std::uint8_t* it = bytes;
+    put(it, value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename LENGTH> void put_string(std::vector<std::uint8_t>& out, std::string_view value) {
+    const auto length = std::min<std::size_t>(value.size(), std::numeric_limits<LENGTH>::max());
+    put(out, static_cast<LENGTH>(length));
+    out.insert(out.end(), value.begin(), value.begin() + length);
+}
+
+template <typename T> bool get(std::istream& in, T& value) {
+    std::uint8_t bytes[sizeof(T)];
+    if (not in.read(reinterpret_cast<char*>(bytes), sizeof(T))) {
+        return false;
+    }
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i < sizeof(T); i++) {
+        result |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    value = static_cast<T>(result);
+    return true;
+}
+
+template <typename LENGTH> bool get_string(std::istream& in, std::string& value) {
+    LENGTH length;
+    if (not get(in, length)) {
+        return false;
+    }
+    value.resize(length);
+    return static_cast<bool>(in.read(value.data(), length));
+}
+
+std::uint32_t float_bits(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bits_float(std::uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool write_all(int fd, const void* data, std::size_t size) noexcept {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    while (size > 0) {
+        const auto written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+std::string file_name_part(const std::string& value) {
+    std::string result;
+    for (const auto c : value) {
+        result += std::isalnum(static_cast<unsigned char>(c)) or c == '-' or c == '_' ? c : '_';
+    }
+    return result.empty() ? "evse" : result;
+}
+
+// <prefix>YYYYmmdd-... as written by dump(), not the crash dump and not the dumps of an EVSE whose id starts alike
+bool is_dump_of(const std::string& file_name, const std::string& prefix) {
+    constexpr std::size_t DATE_LENGTH = 8;
+    if (file_name.size() <= prefix.size() + DATE_LENGTH or file_name.compare(0, prefix.size(), prefix) != 0 or
+        file_name[prefix.size() + DATE_LENGTH] != '-' or std::filesystem::path(file_name).extension() != ".evfr") {
+        return false;
+    }
+    return std::all_of(file_name.begin() + prefix.size(), file_name.begin() + prefix.size() + DATE_LENGTH,
+                       [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+}
+
+} // namespace
+
+std::string FlightRecorder::Dump::type_name(const Record& record) const {
+    const auto type = static_cast<std::size_t>(record.type);
+    return type < TYPE_NAMES.size() ? TYPE_NAMES[type] : "Type" + std::to_string(type);
+}
+
+std::string FlightRecorder::Dump::code_name(const Record& record) const {
+    const auto type = static_cast<std::size_t>(record.type);
+    if (type < names.size() and record.code < names[type].size()) {
+        return names[type][record.code];
+    }
+    return std::to_string(record.code);
+}
+
+FlightRecorder::FlightRecorder(const std::string& evse_id, std::size_t capacity) :
+    evse_id(evse_id), capacity(capacity), slots(new Slot[capacity]) {
+    if (capacity == 0) {
+        throw std::invalid_argument("FlightRecorder needs a capacity of at least one record");
+    }
+    set_names(Type::Pwm, {"On", "Off", "F"});
+}
+
+FlightRecorder::~FlightRecorder() {
+    for (auto& slot : recorders) {
+        FlightRecorder* expected = this;
+        slot.compare_exchange_strong(expected, nullptr);
+    }
+}
+
+void FlightRecorder::set_names(Type type, std::vector<std::string> type_names) {
+    if (not dump_directory.empty()) {
+        // the header is read by dumps without a lock
+        throw std::logic_error("FlightRecorder names must be set before the dump directory");
+    }
+    names.at(static_cast<std::size_t>(type)) = std::move(type_names);
+
+    header.clear();
+    header.insert(header.end(), std::begin(MAGIC), std::end(MAGIC));
+    put(header, VERSION);
+    put_string<std::uint16_t>(header, evse_id);
+    put(header, static_cast<std::uint8_t>(names.size()));
+    for (const auto& codes : names) {
+        const auto count = std::min<std::size_t>(codes.size(), std::numeric_limits<std::uint8_t>::max());
+        put(header, static_cast<std::uint8_t>(count));
+        for (std::size_t code = 0; code < count; code++) {
+            put_string<std::uint8_t>(header, codes[code]);
+        }
+    }
+}
+
+void FlightRecorder::set_dump_directory(const std::string& directory) {
+    dump_directory = directory;
+    crash_path.fill(0);
+    if (directory.empty()) {
+        return;
+    }
+    const auto path = (std::filesystem::path(directory) / (file_name_part(evse_id) + "-crash.evfr")).string();
+    if (path.size() >= crash_path.size()) {
+        EVLOG_warning << "Flight recorder directory too long, no dump on crash: " << directory;
+        return;
+    }
+    std::copy(path.begin(), path.end(), crash_path.begin());
+
+    // the crash handler may dump it from now on
+    for (auto& slot : recorders) {
+        FlightRecorder* expected = nullptr;
+        if (slot.load() == this or slot.compare_exchange_strong(expected, this)) {
+            return;
+        }
+    }
+    EVLOG_warning << "Too many flight recorders in this process, " << evse_id << " is not dumped on crash";
+}
+
+void FlightRecorder::set_dump_limits(std::size_t max_dumps, std::chrono::seconds min_error_interval) {
+    std::scoped_lock lock(dump_mutex);
+    this->max_dumps = std::max<std::size_t>(max_dumps, 1);
+    this->min_error_interval = min_error_interval;
+}
+
+void FlightRecorder::record(Type type, std::uint8_t code, float value) noexcept {
+    const auto timestamp =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+    const auto sequence = next.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots[sequence % capacity];
+
+    // seqlock: readers drop the slot if the sequence changed while they copied it
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp_ns.store(timestamp.count(), std::memory_order_relaxed);
+    slot.payload.store(static_cast<std::uint64_t>(type) | static_cast<std::uint64_t>(code) << 8 |
+                           static_cast<std::uint64_t>(float_bits(value)) << 32,
+                       std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+bool FlightRecorder::read_slot(std::uint64_t sequence, Record& record) const noexcept {
+    const auto& slot = slots[sequence % capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != sequence + 1) {
+        return false; // not written yet, being written or already overwritten
+    }
+    const auto timestamp = slot.timestamp_ns.load(std::memory_order_relaxed);
+    const auto payload = slot.payload.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence + 1) {
+        return false;
+    }
+
+    record.sequence = sequence;
+    record.timestamp_ns = timestamp;
+    record.type = static_cast<Type>(payload & 0xff);
+    record.code = static_cast<std::uint8_t>(payload >> 8);
+    record.value = bits_float(static_cast<std::uint32_t>(payload >> 32));
+    return true;
+}
+
+std::vector<FlightRecorder::Record> FlightRecorder::snapshot() const {
+    const auto end = next.load(std::memory_order_acquire);
+    const auto begin = end > capacity ? end - capacity : 0;
+
+    std::vector<Record> records;
+    records.reserve(end - begin);
+    Record record;
+    for (auto sequence = begin; sequence < end; sequence++) {
+        if (read_slot(sequence, record)) {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+std::optional<std::string> FlightRecorder::dump(std::string_view reason) const {
+    if (dump_directory.empty()) {
+        return std::nullopt;
+    }
+    std::scoped_lock lock(dump_mutex);
+    return write_dump(reason);
+}
+
+std::optional<std::string> FlightRecorder::dump_on_error(std::string_view reason) const {
+    if (dump_directory.empty()) {
+        return std::nullopt;
+    }
+    std::scoped_lock lock(dump_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    if (last_error_dump.has_value() and now - last_error_dump.value() < min_error_interval) {
+        EVLOG_debug << "Flight recorder of " << evse_id << " was dumped on error recently, not dumped again";
+        return std::nullopt;
+    }
+    last_error_dump = now;
+    return write_dump(reason);
+}
+
+std::optional<std::string> FlightRecorder::write_dump(std::string_view reason) const {
+    std::error_code ec;
+    std::filesystem::create_directories(dump_directory, ec);
+
+    const auto now = std::chrono::system_clock::now();
+    const auto time = std::chrono::system_clock::to_time_t(now);
+    const auto milliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    std::tm utc{};
+    gmtime_r(&time, &utc);
+
+    // names sort by time, the count keeps dumps of the same millisecond apart, O_EXCL dumps of an earlier run
+    std::filesystem::path path;
+    int fd = -1;
+    do {
+        std::ostringstream name;
+        name << file_name_part(evse_id) << "-" << std::put_time(&utc, "%Y%m%d-%H%M%S") << "-" << std::setfill('0')
+             << std::setw(3) << milliseconds << "-" << std::setw(6) << dump_count++ << "-"
+             << file_name_part(std::string(reason)) << ".evfr";
+        path = std::filesystem::path(dump_directory) / name.str();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    } while (fd < 0 and errno == EEXIST);
+    if (fd < 0) {
+        EVLOG_error << "Could not open flight recorder dump " << path << ": " << std::strerror(errno);
+        return std::nullopt;
+    }
+    const auto written = write_to(fd, reason);
+    ::close(fd);
+    if (not written) {
+        EVLOG_error << "Could not write flight recorder dump " << path;
+        return std::nullopt;
+    }
+
+    remove_old_dumps();
+    return path.string();
+}
+
+void FlightRecorder::remove_old_dumps() const {
+    const auto prefix = file_name_part(evse_id) + "-";
+    std::vector<std::filesystem::path> dumps;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dump_directory, ec)) {
+        if (entry.is_regular_file(ec) and is_dump_of(entry.path().filename().string(), prefix)) {
+            dumps.push_back(entry.path());
+        }
+    }
+    if (dumps.size() <= max_dumps) {
+        return;
+    }
+    std::sort(dumps.begin(), dumps.end());
+    for (std::size_t i = 0; i < dumps.size() - max_dumps; i++) {
+        if (not std::filesystem::remove(dumps[i], ec) and ec) {
+            EVLOG_warning << "Could not remove old flight recorder dump " << dumps[i] << ": " << ec.message();
+        }
+    }
+}
+
+bool FlightRecorder::write_to(int fd, std::string_view reason) const noexcept {
+    if (not write_all(fd, header.data(), header.size())) {
+        return false;
+    }
+
+    std::uint8_t buffer[WRITE_BATCH * RECORD_SIZE];
+    std::uint8_t* out = buffer;
+    const auto reason_length = static_cast<std::uint16_t>(std::min<std::size_t>(reason.size(), 1024));
+    put(out, reason_length);
+    if (not write_all(fd, buffer, out - buffer) or not write_all(fd, reason.data(), reason_length)) {
+        return false;
+    }
+
+    const auto end = next.load(std::memory_order_acquire);
+    const auto begin = end > capacity ? end - capacity : 0;
+    out = buffer;
+    Record record;
+    for (auto sequence = begin; sequence < end; sequence++) {
+        if (not read_slot(sequence, record)) {
+            continue;
+        }
+        put(out, record.sequence);
+        put(out, record.timestamp_ns);
+        put(out, static_cast<std::uint8_t>(record.type));
+        put(out, record.code);
+        put(out, float_bits(record.value));
+        if (out == buffer + sizeof(buffer)) {
+            if (not write_all(fd, buffer, sizeof(buffer))) {
+                return false;
+            }
+            out = buffer;
+        }
+    }
+    return write_all(fd, buffer, out - buffer);
+}
+
+void FlightRecorder::dump_all_on_crash() noexcept {
+    for (const auto& slot : recorders) {
+        const auto* recorder = slot.load();
+        if (recorder == nullptr or recorder->crash_path[0] == '\0') {
+            continue;
+        }
+        const auto fd = ::open(recorder->crash_path.data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+            recorder->write_to(fd, "crash");
+            ::close(fd);
+        }
+    }
+}
+
+std::optional<FlightRecorder::Dump> FlightRecorder::read(std::istream& in) {
+    char magic[sizeof(MAGIC)];
+    std::uint8_t version;
+    if (not in.read(magic, sizeof(magic)) or std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 or not get(in, version) or
+        version != VERSION) {
+        return std::nullopt;
+    }
+
+    Dump dump;
+    std::uint8_t type_count;
+    if (not get_string<std::uint16_t>(in, dump.evse_id) or not get(in, type_count)) {
+        return std::nullopt;
+    }
+    for (std::size_t type = 0; type < type_count; type++) {
+        std::uint8_t code_count;
+        if (not get(in, code_count)) {
+            return std::nullopt;
+        }
+        std::vector<std::string> codes(code_count);
+        for (auto& code : codes) {
+            if (not get_string<std::uint8_t>(in, code)) {
+                return std::nullopt;
+            }
+        }
+        // types added by a newer writer are kept as numbers
+        if (type < dump.names.size()) {
+            dump.names[type] = std::move(codes);
+        }
+    }
+    if (not get_string<std::uint16_t>(in, dump.reason)) {
+        return std::nullopt;
+    }
+
+    Record record;
+    std::uint8_t type;
+    std::uint32_t value;
+    while (get(in, record.sequence) and get(in, record.timestamp_ns) and get(in, type) and get(in, record.code) and
+           get(in, value)) {
+        record.type = static_cast<Type>(type);
+        record.value = bits_float(value);
+        dump.records.push_back(record);
+    }
+    return dump;
+}
+
+} // namespace module
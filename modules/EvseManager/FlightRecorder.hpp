@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVSE_MANAGER_FLIGHT_RECORDER_HPP
+#define EVSE_MANAGER_FLIGHT_RECORDER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace module {
+
+/*
+ Always-on flight recorder of one EVSE.
+
+ Keeps the last events of the Charger (state changes, CP and BSP events, PWM, current limits, authorization and
+ errors) as fixed size binary records in a ring. Recording takes no lock and allocates nothing, so it can stay
+ enabled without changing the timing of the state machine.
+
+ The ring is written to a file on error, on request and on crash. Every dump carries the names of the recorded
+ codes, so evse_flight_recorder_decode can print it without knowing the enums of the build that wrote it. Only the
+ newest dumps of an EVSE are kept and dumps on error are rate limited, so a flapping error cannot fill the disk.
+
+ File format (little endian):
+   "EVFR" version:u8
+   evse_id:str16
+   type count:u8, per type: name count:u8, per name: str8
+   reason:str16
+   records until the end of the file: sequence:u64 timestamp_ns:i64 type:u8 code:u8 value:f32
+ strN is a length of N bits followed by the characters.
+*/
+class FlightRecorder {
+public:
+    enum class Type : std::uint8_t {
+        ChargerState,
+        CPEvent,
+        BspEvent,
+        Pwm,
+        MaxCurrent,
+        Authorization,
+        Error,
+    };
+    static constexpr std::size_t TYPE_COUNT = 7;
+
+    // codes of Type::Pwm, the duty cycle is the value
+    enum class Pwm : std::uint8_t {
+        On,
+        Off,
+        F,
+    };
+
+    struct Record {
+        std::uint64_t sequence;
+        std::int64_t timestamp_ns; // system clock
+        Type type;
+        std::uint8_t code;
+        float value;
+    };
+
+    struct Dump {
+        std::string evse_id;
+        std::string reason;
+        std::array<std::vector<std::string>, TYPE_COUNT> names;
+        std::vector<Record> records;
+
+        /// \brief name of the type and code of \p record
+        std::string type_name(const Record& record) const;
+        std::string code_name(const Record& record) const;
+    };
+
+    FlightRecorder(const std::string& evse_id, std::size_t capacity);
+    ~FlightRecorder();
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /// \brief names of the codes of \p type, written into every dump. Call before set_dump_directory(), throws
+    /// std::logic_error afterwards as the recorder may be dumped concurrently from then on.
+    void set_names(Type type, std::vector<std::string> names);
+    /// \brief directory of the dumps, also enables the dump on crash. Call once, after all set_names().
+    void set_dump_directory(const std::string& directory);
+    /// \brief keep at most \p max_dumps dumps of this EVSE in the dump directory, older ones are removed. Dumps on error
+    /// are written at most once per \p min_error_interval.
+    void set_dump_limits(std::size_t max_dumps, std::chrono::seconds min_error_interval);
+
+    void record(Type type, std::uint8_t code, float value = 0.f) noexcept;
+    template <typename E> void record(Type type, E code, float value = 0.f) noexcept {
+        record(type, static_cast<std::uint8_t>(code), value);
+    }
+
+    /// \brief records currently in the ring, oldest first
+    std::vector<Record> snapshot() const;
+
+    /// \brief write the ring to a new file in the dump directory, returns its path
+    std::optional<std::string> dump(std::string_view reason) const;
+    /// \brief like dump(), but nothing is written if the previous dump on error is less than min_error_interval ago
+    std::optional<std::string> dump_on_error(std::string_view reason) const;
+
+    /// \brief write the ring to \p fd in the dump format, async signal safe
+    bool write_to(int fd, std::string_view reason) const noexcept;
+
+    /// \brief dump all recorders of this process that have a dump directory, async signal safe
+    static void dump_all_on_crash() noexcept;
+
+    /// \brief parse a dump, a truncated last record is dropped
+    static std::optional<Dump> read(std::istream& in);
+
+private:
+    struct Slot {
+        // sequence + 1 of the record in the slot, 0 while it is written
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<std::int64_t> timestamp_ns{0};
+        // type, code and value packed
+        std::atomic<std::uint64_t> payload{0};
+    };
+
+    bool read_slot(std::uint64_t sequence, Record& record) const noexcept;
+    // expect dump_mutex to be held
+    std::optional<std::string> write_dump(std::string_view reason) const;
+    void remove_old_dumps() const;
+
+    const std::string evse_id;
+    const std::size_t capacity;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<std::uint64_t> next{0};
+
+    std::array<std::vector<std::string>, TYPE_COUNT> names;
+    std::vector<std::uint8_t> header;
+
+    std::string dump_directory;
+    std::array<char, 512> crash_path{};
+
+    std::size_t max_dumps{10};
+    std::chrono::seconds min_error_interval{60};
+    mutable std::mutex dump_mutex;
+    mutable std::uint64_t dump_count{0};
+    mutable std::optional<std::chrono::steady_clock::time_point> last_error_dump;
+};
+
+} // namespace module
+
+#endif // EVSE_MANAGER_FLIGHT_RECORDER_HPP
@@ -3,6 +3,7 @@
 
 #include "IECStateMachine.hpp"
 #include "everest/logging.hpp"
+#include <tracing/tracing.hpp>
 
 #include <cstdint>
 #include <math.h>
@@ -93,6 +94,7 @@ IECStateMachine::IECStateMachine(const std::unique_ptr<evse_board_supportIntf>&
 }
 
 void IECStateMachine::process_bsp_event(const types::board_support_common::BspEvent bsp_event) {
+    EVTRACE_SCOPE("IECStateMachine::process_bsp_event");
     auto event = from_bsp_event(bsp_event.event);
     std::visit(overloaded{[this](RawCPState& raw_state) {
                               // If it is a raw CP state, run it through the state machine
@@ -119,11 +121,11 @@ void IECStateMachine::process_bsp_event(const types::board_support_common::BspEv
 }
 
 void IECStateMachine::feed_state_machine() {
-    std::thread feed([this]() { feed_state_machine_no_thread(); });
-    feed.detach();
+    scheduler->post([this]() { feed_state_machine_no_thread(); });
 }
 
 void IECStateMachine::feed_state_machine_no_thread() {
+    EVTRACE_SCOPE("IECStateMachine::feed_state_machine");
     auto events = state_machine();
 
     // Process all events
@@ -29,6 +29,7 @@
 #include <generated/interfaces/evse_board_support/Interface.hpp>
 #include <sigslot/signal.hpp>
 
+#include "Scheduler.hpp"
 #include "Timeout.hpp"
 #include "utils/thread.hpp"
 
@@ -127,6 +128,7 @@ private:
     AsyncTimeout timeout_state_c1;
 
     Everest::timed_mutex_traceable state_machine_mutex;
+    const std::shared_ptr<Scheduler> scheduler{Scheduler::shared()};
     void feed_state_machine();
     void feed_state_machine_no_thread();
     std::queue<CPEvent> state_machine();
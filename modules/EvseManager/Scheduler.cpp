@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "Scheduler.hpp"
+
+#include <utility>
+
+#include <everest/logging.hpp>
+
+namespace module {
+
+namespace {
+// set on a worker whose task destroyed the scheduler, the worker must not touch the scheduler after the task
+thread_local bool scheduler_destroyed_by_task{false};
+} // namespace
+
+Scheduler::TimerHandle::TimerHandle(Scheduler* scheduler, TimerId id) : scheduler(scheduler), timer_id(id) {
+}
+
+Scheduler::TimerHandle::~TimerHandle() {
+    cancel();
+}
+
+Scheduler::TimerHandle::TimerHandle(TimerHandle&& other) noexcept :
+    scheduler(std::exchange(other.scheduler, nullptr)), timer_id(std::exchange(other.timer_id, 0)) {
+}
+
+Scheduler::TimerHandle& Scheduler::TimerHandle::operator=(TimerHandle&& other) noexcept {
+    if (this != &other) {
+        if (scheduler != nullptr) {
+            scheduler->stop(timer_id, false);
+        }
+        scheduler = std::exchange(other.scheduler, nullptr);
+        timer_id = std::exchange(other.timer_id, 0);
+    }
+    return *this;
+}
+
+void Scheduler::TimerHandle::cancel() {
+    if (scheduler != nullptr) {
+        scheduler->stop(timer_id, true);
+        scheduler = nullptr;
+        timer_id = 0;
+    }
+}
+
+Scheduler::TimerId Scheduler::TimerHandle::id() const {
+    return timer_id;
+}
+
+std::shared_ptr<Scheduler> Scheduler::shared() {
+    static std::mutex instance_mutex;
+    static std::weak_ptr<Scheduler> instance;
+
+    std::scoped_lock lock(instance_mutex);
+    auto scheduler = instance.lock();
+    if (scheduler == nullptr) {
+        scheduler = std::make_shared<Scheduler>(1);
+        instance = scheduler;
+    }
+    return scheduler;
+}
+
+Scheduler::Scheduler(std::size_t workers) {
+    reserve_workers(workers);
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::scoped_lock lock(mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) {
+        if (worker.get_id() == std::this_thread::get_id()) {
+            // the last user let go of the scheduler in a task, the worker exits when the task returns
+            scheduler_destroyed_by_task = true;
+            worker.detach();
+        } else {
+            worker.join();
+        }
+    }
+}
+
+void Scheduler::reserve_workers(std::size_t count) {
+    std::scoped_lock lock(mutex);
+    while (workers.size() < count) {
+        workers.emplace_back(&Scheduler::worker, this);
+    }
+}
+
+std::size_t Scheduler::worker_count() {
+    std::scoped_lock lock(mutex);
+    return workers.size();
+}
+
+void Scheduler::post(Task task) {
+    {
+        std::scoped_lock lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    work_available.notify_one();
+}
+
+Scheduler::TimerHandle Scheduler::every(std::chrono::milliseconds period, Task task) {
+    return add_timer(period, std::move(task), true);
+}
+
+Scheduler::TimerHandle Scheduler::after(std::chrono::milliseconds delay, Task task) {
+    return add_timer(delay, std::move(task), false);
+}
+
+Scheduler::TimerHandle Scheduler::add_timer(std::chrono::milliseconds period, Task task, bool repeat) {
+    TimerId id;
+    {
+        std::scoped_lock lock(mutex);
+        id = next_timer_id++;
+        timers.emplace(id, Timer{period, std::move(task), repeat, std::nullopt, false});
+        due.push({std::chrono::steady_clock::now() + period, id});
+    }
+    // the new timer may be due before the one the workers are waiting for
+    work_available.notify_all();
+    return TimerHandle(this, id);
+}
+
+void Scheduler::cancel(TimerId id) {
+    stop(id, true);
+}
+
+void Scheduler::stop(TimerId id, bool wait) {
+    std::unique_lock lock(mutex);
+    const auto timer = timers.find(id);
+    if (timer == timers.end()) {
+        return;
+    }
+    timer->second.cancelled = true;
+    if (not timer->second.running_on.has_value()) {
+        timers.erase(timer);
+        return;
+    }
+    if (not wait or timer->second.running_on == std::this_thread::get_id()) {
+        // the worker removes it when the run returns
+        return;
+    }
+    timer_finished.wait(lock, [this, id]() { return timers.find(id) == timers.end(); });
+}
+
+void Scheduler::run(const Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        EVLOG_error << "Scheduler task failed: " << e.what();
+    }
+}
+
+void Scheduler::worker() {
+    std::unique_lock lock(mutex);
+    while (not stopping) {
+        if (not tasks.empty()) {
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            run(task);
+            if (scheduler_destroyed_by_task) {
+                return;
+            }
+            lock.lock();
+            continue;
+        }
+
+        if (due.empty()) {
+            work_available.wait(lock);
+            continue;
+        }
+
+        const auto next = due.top();
+        if (next.time > std::chrono::steady_clock::now()) {
+            work_available.wait_until(lock, next.time);
+            continue;
+        }
+        due.pop();
+
+        auto timer = timers.find(next.id);
+        if (timer == timers.end()) {
+            continue;
+        }
+        timer->second.running_on = std::this_thread::get_id();
+        // run from the stack, the task may destroy the scheduler and its timers. The map node is stable, cancel()
+        // erases it only after the run
+        auto task = std::move(timer->second.task);
+        lock.unlock();
+        run(task);
+        if (scheduler_destroyed_by_task) {
+            return;
+        }
+        lock.lock();
+
+        timer->second.task = std::move(task);
+        timer->second.running_on.reset();
+        if (timer->second.cancelled or not timer->second.repeat) {
+            timers.erase(timer);
+            timer_finished.notify_all();
+        } else {
+            due.push({std::chrono::steady_clock::now() + timer->second.period, next.id});
+        }
+    }
+}
+
+} // namespace module
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVSE_MANAGER_SCHEDULER_HPP
+#define EVSE_MANAGER_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace module {
+
+/*
+ Worker threads and timers shared by all Chargers hosted in one process.
+
+ Replaces the per EVSE threads (main loop, error handling, telemetry, energy requests) and the short lived threads
+ that were spawned for every CP event. Tasks run concurrently on the workers, so they must neither sleep nor wait for
+ other tasks of the scheduler. Use after() to continue something later.
+
+ The shared scheduler lives as long as one of its users holds it. Timers are stopped when their TimerHandle is
+ destroyed, so a user keeps the scheduler and the handles of its timers as members, the scheduler first.
+*/
+class Scheduler {
+public:
+    using Task = std::function<void()>;
+    using TimerId = std::uint64_t;
+
+    /// \brief Stops its timer when it is destroyed, must not outlive the scheduler
+    class TimerHandle {
+    public:
+        TimerHandle() = default;
+        ~TimerHandle();
+        TimerHandle(TimerHandle&& other) noexcept;
+        /// \brief stops the previous timer, without waiting for a run in progress as that may wait for the caller
+        TimerHandle& operator=(TimerHandle&& other) noexcept;
+        TimerHandle(const TimerHandle&) = delete;
+        TimerHandle& operator=(const TimerHandle&) = delete;
+
+        /// \brief stop the timer, waits for a run in progress unless called from that run
+        void cancel();
+        TimerId id() const;
+
+    private:
+        friend class Scheduler;
+        TimerHandle(Scheduler* scheduler, TimerId id);
+
+        Scheduler* scheduler{nullptr};
+        TimerId timer_id{0};
+    };
+
+    /// \brief scheduler shared by everything in this process, created on first use and destroyed with its last user
+    static std::shared_ptr<Scheduler> shared();
+
+    explicit Scheduler(std::size_t workers);
+    ~Scheduler();
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /// \brief start additional workers until there are at least \p workers, never stops any
+    void reserve_workers(std::size_t workers);
+    std::size_t worker_count();
+
+    /// \brief run \p task once as soon as a worker is free
+    void post(Task task);
+
+    /// \brief run \p task every \p period, the next run is due \p period after the previous one returned
+    [[nodiscard]] TimerHandle every(std::chrono::milliseconds period, Task task);
+
+    /// \brief run \p task once after \p delay
+    [[nodiscard]] TimerHandle after(std::chrono::milliseconds delay, Task task);
+
+    /// \brief stop a timer, waits for a run in progress unless called from that run
+    void cancel(TimerId id);
+
+private:
+    struct Timer {
+        std::chrono::milliseconds period;
+        Task task;
+        bool repeat{true};
+        std::optional<std::thread::id> running_on;
+        bool cancelled{false};
+    };
+
+    struct Due {
+        std::chrono::steady_clock::time_point time;
+        TimerId id;
+        bool operator>(const Due& other) const {
+            return time > other.time;
+        }
+    };
+
+    TimerHandle add_timer(std::chrono::milliseconds period, Task task, bool repeat);
+    void stop(TimerId id, bool wait);
+    void worker();
+    void run(const Task& task);
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable timer_finished;
+    bool stopping{false};
+
+    std::deque<Task> tasks;
+    std::map<TimerId, Timer> timers;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> due;
+    TimerId next_timer_id{1};
+
+    std::vector<std::thread> workers;
+};
+
+} // namespace module
+
+#endif // EVSE_MANAGER_SCHEDULER_HPP
@@ -7,6 +7,7 @@
 
 #include <cstring>
 #include <execinfo.h>
+#include <initializer_list>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -43,5 +44,31 @@ void request_backtrace(pthread_t id) {
     pthread_kill(id, SIGUSR1);
 }
 
+static void (*crash_handler)() = nullptr;
+
+static void crash_signal_handler(int signo) {
+    signal_handler(signo);
+    if (crash_handler != nullptr) {
+        crash_handler();
+    }
+    // SA_RESETHAND restored the default action
+    raise(signo);
+}
+
+void install_crash_handler(void (*handler)()) {
+    crash_handler = handler;
+
+    struct sigaction crash_action;
+    memset(&crash_action, 0, sizeof(crash_action));
+    crash_action.sa_handler = crash_signal_handler;
+    crash_action.sa_flags = SA_RESETHAND;
+
+    for (const auto signo : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+        if (sigaction(signo, &crash_action, NULL) < 0) {
+            perror("sigaction");
+        }
+    }
+}
+
 } // namespace Everest
 #endif
\ No newline at end of file
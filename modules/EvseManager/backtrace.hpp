@@ -16,6 +16,8 @@ namespace Everest {
 void signal_handler(int signo);
 void install_backtrace_handler();
 void request_backtrace(pthread_t id);
+// print a backtrace and call handler on fatal signals, then terminate with the original signal
+void install_crash_handler(void (*handler)());
 } // namespace Everest
 #endif
 #endif
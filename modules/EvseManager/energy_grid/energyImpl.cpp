@@ -21,6 +21,11 @@ static bool voltage_changed(float a, float b) {
     return (fabs(a - b) > noise_voltage);
 }
 
+energyImpl::~energyImpl() {
+    // stop the energy requests before anything they use is destroyed
+    request_energy_timer.cancel();
+}
+
 void energyImpl::init() {
 
     charger_state = Charger::EvseState::Disabled;
@@ -111,20 +116,16 @@ void energyImpl::ready() {
     request_energy_from_energy_manager(true);
 
     // request energy every second
-    std::thread([this] {
-        while (true) {
-            hw_caps = mod->get_hw_capabilities();
-            request_energy_from_energy_manager(false);
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-    }).detach();
+    request_energy_timer = scheduler->every(std::chrono::seconds(1), [this] {
+        hw_caps = mod->get_hw_capabilities();
+        request_energy_from_energy_manager(false);
+    });
 
     // request energy at the start and end of a charging session
     mod->charger->signal_state.connect([this](Charger::EvseState s) {
         charger_state = s;
         if (s == Charger::EvseState::WaitingForAuthentication || s == Charger::EvseState::Finished) {
-            std::thread request_energy_thread([this]() { request_energy_from_energy_manager(true); });
-            request_energy_thread.detach();
+            scheduler->post([this]() { request_energy_from_energy_manager(true); });
         }
     });
 }
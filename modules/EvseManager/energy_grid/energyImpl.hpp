@@ -29,6 +29,7 @@ public:
 
     // ev@8ea32d28-373f-4c90-ae5e-b4fcc74e2a61:v1
     // insert your public definitions here
+    ~energyImpl();
     // ev@8ea32d28-373f-4c90-ae5e-b4fcc74e2a61:v1
 
 protected:
@@ -64,6 +65,8 @@ private:
     float limit_when_random_delay_started{0.};
     std::atomic<Charger::EvseState> charger_state;
     static constexpr std::chrono::seconds detect_startup_with_ev_attached_duration{5};
+    const std::shared_ptr<Scheduler> scheduler{Scheduler::shared()};
+    Scheduler::TimerHandle request_energy_timer;
     // ev@3370e4dd-95f4-47a9-aaec-ea76f34a66c9:v1
 };
 
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Prints a dump of the EvseManager flight recorder, one event per line.
+
+#include "FlightRecorder.hpp"
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+using namespace module;
+
+namespace {
+
+void usage(const char* name) {
+    std::cerr << "Usage: " << name << " <dump file>...\n";
+}
+
+std::string format_time(std::int64_t timestamp_ns) {
+    const std::time_t seconds = timestamp_ns / 1000000000;
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    std::ostringstream out;
+    out << std::put_time(&utc, "%Y-%m-%dT%H:%M:%S") << "." << std::setw(6) << std::setfill('0')
+        << (timestamp_ns % 1000000000) / 1000 << "Z";
+    return out.str();
+}
+
+void print(const FlightRecorder::Dump& dump) {
+    std::cout << "EVSE " << dump.evse_id << ", dumped on " << dump.reason << ", " << dump.records.size()
+              << " events\n";
+
+    std::optional<std::uint64_t> last_sequence;
+    for (const auto& record : dump.records) {
+        // records that were written during the dump are left out
+        if (last_sequence.has_value() and record.sequence != last_sequence.value() + 1) {
+            std::cout << "  ... " << record.sequence - last_sequence.value() - 1 << " events missing\n";
+        }
+        last_sequence = record.sequence;
+
+        std::cout << format_time(record.timestamp_ns) << " " << std::setw(10) << std::setfill(' ') << record.sequence
+                  << "  " << std::left << std::setw(14) << dump.type_name(record) << std::right
+                  << dump.code_name(record);
+        switch (record.type) {
+        case FlightRecorder::Type::Pwm:
+            if (record.code == static_cast<std::uint8_t>(FlightRecorder::Pwm::On)) {
+                std::cout << " " << record.value * 100. << "%";
+            }
+            break;
+        case FlightRecorder::Type::MaxCurrent:
+            std::cout << " " << record.value << "A";
+            break;
+        default:
+            break;
+        }
+        std::cout << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        const auto dump = file ? FlightRecorder::read(file) : std::nullopt;
+        if (not dump.has_value()) {
+            std::cerr << argv[i] << ": not a flight recorder dump" << std::endl;
+            result = 1;
+            continue;
+        }
+        print(dump.value());
+    }
+    return result;
+}
@@ -21,6 +21,7 @@ enum class MutexDescription {
     Charger_signal_error,
     Charger_signal_error_cleared,
     Charger_mainloop,
+    Charger_hlc_pwm_timer,
     Charger_process_event,
     Charger_pause_charging,
     Charger_resume_charging,
@@ -29,6 +30,7 @@ enum class MutexDescription {
     Charger_cancel_transaction,
     Charger_setup,
     Charger_get_current_state,
+    Charger_get_state_metrics,
     Charger_get_authorized_pnc,
     Charger_get_authorized_eim,
     Charger_get_authorized_pnc_ready_for_hlc,
@@ -104,6 +106,8 @@ static std::string to_string(MutexDescription d) {
         return "Charger.cpp: error_handling->signal_all_errors_cleared";
     case MutexDescription::Charger_mainloop:
         return "Charger.cpp: mainloop";
+    case MutexDescription::Charger_hlc_pwm_timer:
+        return "Charger.cpp: hlc_pwm_timer";
     case MutexDescription::Charger_process_event:
         return "Charger.cpp: process_event";
     case MutexDescription::Charger_pause_charging:
@@ -120,6 +124,8 @@ static std::string to_string(MutexDescription d) {
         return "Charger.cpp: setup";
     case MutexDescription::Charger_get_current_state:
         return "Charger.cpp: get_current_state";
+    case MutexDescription::Charger_get_state_metrics:
+        return "Charger.cpp: get_state_metrics";
     case MutexDescription::Charger_get_authorized_pnc:
         return "Charger.cpp: get_authorized_pnc";
     case MutexDescription::Charger_get_authorized_eim:
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <FlightRecorder.hpp>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Type = module::FlightRecorder::Type;
+
+TEST(FlightRecorder, keepsLastRecords) {
+    module::FlightRecorder recorder("DE*PNX*E1", 4);
+    for (int i = 0; i < 6; i++) {
+        recorder.record(Type::MaxCurrent, 0, static_cast<float>(i));
+    }
+
+    const auto records = recorder.snapshot();
+    ASSERT_EQ(records.size(), 4);
+    for (std::size_t i = 0; i < records.size(); i++) {
+        EXPECT_EQ(records[i].sequence, i + 2);
+        EXPECT_EQ(records[i].type, Type::MaxCurrent);
+        EXPECT_FLOAT_EQ(records[i].value, i + 2);
+    }
+    EXPECT_LE(records.front().timestamp_ns, records.back().timestamp_ns);
+}
+
+TEST(FlightRecorder, dumpRoundTrip) {
+    const auto directory = std::filesystem::temp_directory_path() / "FlightRecorderTest";
+    std::filesystem::remove_all(directory);
+
+    module::FlightRecorder recorder("DE*PNX*E1", 16);
+    recorder.set_names(Type::ChargerState, {"Disabled", "Idle", "Charging"});
+    recorder.set_dump_directory(directory.string());
+    recorder.record(Type::ChargerState, 2);
+    recorder.record(Type::Pwm, module::FlightRecorder::Pwm::On, 0.266f);
+    recorder.record(Type::Error, 7);
+
+    const auto path = recorder.dump("error");
+    ASSERT_TRUE(path.has_value());
+    std::ifstream file(path.value(), std::ios::binary);
+    const auto dump = module::FlightRecorder::read(file);
+    ASSERT_TRUE(dump.has_value());
+
+    EXPECT_EQ(dump->evse_id, "DE*PNX*E1");
+    EXPECT_EQ(dump->reason, "error");
+    ASSERT_EQ(dump->records.size(), 3);
+    EXPECT_EQ(dump->type_name(dump->records[0]), "ChargerState");
+    EXPECT_EQ(dump->code_name(dump->records[0]), "Charging");
+    EXPECT_EQ(dump->code_name(dump->records[1]), "On");
+    EXPECT_FLOAT_EQ(dump->records[1].value, 0.266f);
+    // codes without a name are printed as number
+    EXPECT_EQ(dump->code_name(dump->records[2]), "7");
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FlightRecorder, truncatedDump) {
+    module::FlightRecorder recorder("1", 16);
+    recorder.record(Type::CPEvent, 1);
+    recorder.record(Type::CPEvent, 2);
+
+    const auto directory = std::filesystem::temp_directory_path() / "FlightRecorderTest";
+    recorder.set_dump_directory(directory.string());
+    const auto path = recorder.dump("command");
+    ASSERT_TRUE(path.has_value());
+    std::ifstream file(path.value(), std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::filesystem::remove_all(directory);
+
+    std::istringstream truncated(data.substr(0, data.size() - 3));
+    const auto dump = module::FlightRecorder::read(truncated);
+    ASSERT_TRUE(dump.has_value());
+    EXPECT_EQ(dump->records.size(), 1);
+
+    std::istringstream garbage("EVSE");
+    EXPECT_FALSE(module::FlightRecorder::read(garbage).has_value());
+}
+
+TEST(FlightRecorder, keepsNewestDumps) {
+    const auto directory = std::filesystem::temp_directory_path() / "FlightRecorderTest";
+    std::filesystem::remove_all(directory);
+
+    module::FlightRecorder recorder("1", 16);
+    module::FlightRecorder other("10", 16);
+    recorder.set_dump_directory(directory.string());
+    other.set_dump_directory(directory.string());
+    recorder.set_dump_limits(3, std::chrono::seconds(0));
+    recorder.record(Type::CPEvent, 1);
+
+    ASSERT_TRUE(other.dump("command").has_value());
+    std::vector<std::string> paths;
+    for (int i = 0; i < 5; i++) {
+        // same reason within the same second, every dump gets its own file
+        const auto path = recorder.dump("command");
+        ASSERT_TRUE(path.has_value());
+        paths.push_back(path.value());
+    }
+    EXPECT_FALSE(std::filesystem::exists(paths[0]));
+    EXPECT_FALSE(std::filesystem::exists(paths[1]));
+    for (int i = 2; i < 5; i++) {
+        EXPECT_TRUE(std::filesystem::exists(paths[i]));
+    }
+
+    // the dumps of other EVSEs are not counted
+    std::size_t files = 0;
+    for ([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator(directory)) {
+        files++;
+    }
+    EXPECT_EQ(files, 4);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FlightRecorder, dumpsOnErrorRateLimited) {
+    const auto directory = std::filesystem::temp_directory_path() / "FlightRecorderTest";
+    std::filesystem::remove_all(directory);
+
+    module::FlightRecorder recorder("1", 16);
+    recorder.set_dump_directory(directory.string());
+    recorder.set_dump_limits(10, std::chrono::seconds(60));
+
+    EXPECT_TRUE(recorder.dump_on_error("error").has_value());
+    EXPECT_FALSE(recorder.dump_on_error("error").has_value());
+    // a dump on command is always written
+    EXPECT_TRUE(recorder.dump("command").has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FlightRecorder, namesBeforeDumpDirectory) {
+    module::FlightRecorder recorder("1", 16);
+    recorder.set_names(Type::BspEvent, {"A", "B"});
+    recorder.set_dump_directory((std::filesystem::temp_directory_path() / "FlightRecorderTest").string());
+    EXPECT_THROW(recorder.set_names(Type::BspEvent, {"A"}), std::logic_error);
+}
+
+TEST(FlightRecorder, concurrentWriters) {
+    constexpr int writers = 4;
+    constexpr int records_per_writer = 10000;
+    module::FlightRecorder recorder("1", 1024);
+
+    std::vector<std::thread> threads;
+    for (int writer = 0; writer < writers; writer++) {
+        threads.emplace_back([&recorder, writer]() {
+            for (int i = 0; i < records_per_writer; i++) {
+                recorder.record(Type::BspEvent, writer, static_cast<float>(i));
+            }
+        });
+    }
+    // read while writing, every record that is returned must be consistent
+    for (int i = 0; i < 100; i++) {
+        for (const auto& record : recorder.snapshot()) {
+            EXPECT_EQ(record.type, Type::BspEvent);
+            EXPECT_LT(record.code, writers);
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto records = recorder.snapshot();
+    ASSERT_EQ(records.size(), 1024);
+    EXPECT_EQ(records.back().sequence, writers * records_per_writer - 1);
+}
+
+} // namespace
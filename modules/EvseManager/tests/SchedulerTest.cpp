@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <Scheduler.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+using namespace std::chrono_literals;
+
+template <typename PREDICATE> bool wait_for(PREDICATE predicate, std::chrono::milliseconds timeout = 5s) {
+    const auto end = std::chrono::steady_clock::now() + timeout;
+    while (not predicate()) {
+        if (std::chrono::steady_clock::now() > end) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+TEST(Scheduler, post) {
+    module::Scheduler scheduler(2);
+    std::atomic<int> runs{0};
+    for (int i = 0; i < 1000; i++) {
+        scheduler.post([&runs]() { runs++; });
+    }
+    EXPECT_TRUE(wait_for([&runs]() { return runs == 1000; }));
+}
+
+TEST(Scheduler, failingTaskKeepsWorker) {
+    module::Scheduler scheduler(1);
+    std::atomic<bool> ran{false};
+    scheduler.post([]() { throw std::runtime_error("task failed"); });
+    scheduler.post([&ran]() { ran = true; });
+    EXPECT_TRUE(wait_for([&ran]() { return ran.load(); }));
+}
+
+TEST(Scheduler, periodic) {
+    module::Scheduler scheduler(2);
+    std::atomic<int> runs{0};
+    auto timer = scheduler.every(10ms, [&runs]() { runs++; });
+    EXPECT_TRUE(wait_for([&runs]() { return runs >= 5; }));
+    timer.cancel();
+
+    const int after_cancel = runs;
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(runs, after_cancel);
+}
+
+TEST(Scheduler, cancelFromOwnRun) {
+    module::Scheduler scheduler(1);
+    std::atomic<int> runs{0};
+    std::atomic<module::Scheduler::TimerId> timer_id{0};
+    const auto timer = scheduler.every(5ms, [&]() {
+        if (++runs == 3) {
+            scheduler.cancel(timer_id);
+        }
+    });
+    timer_id = timer.id();
+    EXPECT_TRUE(wait_for([&runs]() { return runs == 3; }));
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(runs, 3);
+}
+
+TEST(Scheduler, cancelWaitsForRun) {
+    module::Scheduler scheduler(2);
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    auto timer = scheduler.every(1ms, [&]() {
+        started = true;
+        std::this_thread::sleep_for(50ms);
+        finished = true;
+    });
+    ASSERT_TRUE(wait_for([&started]() { return started.load(); }));
+    timer.cancel();
+    EXPECT_TRUE(finished);
+}
+
+TEST(Scheduler, after) {
+    module::Scheduler scheduler(1);
+    std::atomic<int> runs{0};
+    const auto started = std::chrono::steady_clock::now();
+    std::atomic<std::chrono::steady_clock::time_point> ran_at{};
+    const auto timer = scheduler.after(20ms, [&]() {
+        ran_at = std::chrono::steady_clock::now();
+        runs++;
+    });
+    EXPECT_TRUE(wait_for([&runs]() { return runs == 1; }));
+    EXPECT_GE(ran_at.load() - started, 20ms);
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(Scheduler, handleStopsTimer) {
+    module::Scheduler scheduler(1);
+    std::atomic<int> runs{0};
+    {
+        const auto timer = scheduler.every(5ms, [&runs]() { runs++; });
+        EXPECT_TRUE(wait_for([&runs]() { return runs >= 2; }));
+    }
+    const int after_destruction = runs;
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(runs, after_destruction);
+
+    // assigning a new timer stops the previous one
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+    auto timer = scheduler.after(20ms, [&first]() { first++; });
+    timer = scheduler.after(1ms, [&second]() { second++; });
+    EXPECT_TRUE(wait_for([&second]() { return second == 1; }));
+    std::this_thread::sleep_for(40ms);
+    EXPECT_EQ(first, 0);
+}
+
+TEST(Scheduler, sharedLivesWithItsUsers) {
+    std::weak_ptr<module::Scheduler> released;
+    {
+        const auto user = module::Scheduler::shared();
+        const auto other_user = module::Scheduler::shared();
+        EXPECT_EQ(user, other_user);
+        released = user;
+    }
+    EXPECT_TRUE(released.expired());
+}
+
+TEST(Scheduler, destroyedInItsOwnTask) {
+    // e.g. a Charger holding the last reference, destroyed in a task
+    struct Owner {
+        std::mutex mutex;
+        std::shared_ptr<module::Scheduler> scheduler;
+        module::Scheduler::TimerHandle timer;
+    };
+
+    // build with -fsanitize=address, a worker that touches the destroyed scheduler shows up as use after free
+    for (const bool from_timer : {false, true}) {
+        auto owner = std::make_shared<Owner>();
+        owner->scheduler = std::make_shared<module::Scheduler>(2);
+        const std::weak_ptr<module::Scheduler> released = owner->scheduler;
+        std::atomic<bool> destroyed{false};
+
+        const auto release = [owner, &destroyed]() {
+            std::scoped_lock lock(owner->mutex);
+            owner->timer = {};
+            owner->scheduler.reset();
+            destroyed = true;
+        };
+        {
+            std::scoped_lock lock(owner->mutex);
+            if (from_timer) {
+                owner->timer = owner->scheduler->after(1ms, release);
+            } else {
+                owner->scheduler->post(release);
+            }
+        }
+
+        EXPECT_TRUE(wait_for([&destroyed]() { return destroyed.load(); }));
+        EXPECT_TRUE(released.expired());
+    }
+    // the detached workers return from their tasks
+    std::this_thread::sleep_for(50ms);
+}
+
+TEST(Scheduler, reserveWorkers) {
+    module::Scheduler scheduler(1);
+    scheduler.reserve_workers(3);
+    EXPECT_EQ(scheduler.worker_count(), 3);
+    scheduler.reserve_workers(2);
+    EXPECT_EQ(scheduler.worker_count(), 3);
+
+    // one blocked task does not hold back the others
+    std::atomic<bool> release{false};
+    std::atomic<bool> ran{false};
+    scheduler.post([&release]() { wait_for([&release]() { return release.load(); }); });
+    scheduler.post([&ran]() { ran = true; });
+    EXPECT_TRUE(wait_for([&ran]() { return ran.load(); }));
+    release = true;
+}
+
+} // namespace
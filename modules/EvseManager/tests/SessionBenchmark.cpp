@@ -0,0 +1,535 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Throughput benchmark of the charging session lifecycle without hardware: Charger, IECStateMachine and the
+// AuthHandler of the Auth module run as in the modules, the BSP and the powermeter are answered by a stub and the
+// session events are passed to the AuthHandler through JSON on one thread, like the MQTT connection would. Sessions
+// are driven as fast as the charger reacts and the time of every phase of a session is reported. All connectors share
+// the scheduler of the process, the thread count and resident memory of the process are reported as well.
+//
+// EVSE_MANAGER_BENCHMARK_SESSIONS       sessions per connector (default 200)
+// EVSE_MANAGER_BENCHMARK_CONNECTORS     connectors charging in parallel (default 1)
+// EVSE_MANAGER_BENCHMARK_MIN_SESSIONS_PER_SECOND
+//                                       fail below this throughput (default 0, only report)
+
+#include <EvseManagerStub.hpp>
+#include <gtest/gtest.h>
+
+#include <boost/log/core.hpp>
+#include <utils/date.hpp>
+
+#include <AuthHandler.hpp>
+#include <Charger.hpp>
+#include <EventQueue.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace module {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto STEP_TIMEOUT = 5s;
+// the charger main loop is run whenever nothing happened for this long, the module runs it every 100ms
+constexpr auto MAINLOOP_TICK = 200us;
+constexpr int CONNECTION_TIMEOUT = 10;
+
+enum class Phase {
+    PlugIn,        // B until the AuthHandler saw AuthRequired
+    Authorization, // token until PWM is on
+    ChargingStart, // C until the relais are closed and the transaction started
+    Stop,          // B, relais open, A until the AuthHandler saw SessionFinished
+};
+constexpr std::size_t PHASE_COUNT = 4;
+constexpr std::array<const char*, PHASE_COUNT> PHASE_NAMES = {"plug_in", "authorization", "charging_start", "stop"};
+
+using Durations = std::array<std::vector<std::chrono::nanoseconds>, PHASE_COUNT>;
+
+int env_or(const char* name, int default_value) {
+    const auto* value = std::getenv(name);
+    return value != nullptr ? std::atoi(value) : default_value;
+}
+
+// value of e.g. Threads or VmRSS (kB) in /proc/self/status, -1 if it is not there
+long process_status(const std::string& key) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind(key + ":", 0) == 0) {
+            return std::atol(line.c_str() + key.size() + 1);
+        }
+    }
+    return -1;
+}
+
+// One EvseManager as the module sets it up, the adapter answers the BSP and the powermeter
+class ConnectorUnderTest : public stub::EvseManagerModuleAdapter {
+public:
+    explicit ConnectorUnderTest(int connector_id) : connector_id(connector_id) {
+        r_bsp = std::make_unique<evse_board_supportIntf>(this, Requirement("bsp", 0), "EvseManager");
+        r_powermeter_billing.push_back(
+            std::make_unique<powermeterIntf>(this, Requirement("powermeter_grid_side", 0), "EvseManager"));
+        p_evse = std::make_unique<stub::evse_managerImplStub>();
+
+        bsp = std::make_unique<IECStateMachine>(r_bsp);
+        error_handling = std::make_unique<ErrorHandling>(r_bsp, r_hlc, r_connector_lock, r_ac_rcd, p_evse, r_imd);
+        store = std::make_unique<PersistentStore>(r_store, "connector_" + std::to_string(connector_id));
+        flight_recorder = std::make_unique<FlightRecorder>(std::to_string(connector_id), 100);
+        charger = std::make_unique<Charger>(bsp, error_handling, r_powermeter_billing, store, flight_recorder,
+                                            types::evse_board_support::Connector_type::IEC62196Type2Cable,
+                                            std::to_string(connector_id));
+
+        bsp->signal_event.connect([this](const CPEvent event) { charger->process_event(event); });
+    }
+
+    Result call_fn(const Requirement&, const std::string& cmd, Parameters p) override {
+        if (cmd == "start_transaction" or cmd == "stop_transaction") {
+            return json{{"status", "OK"}};
+        }
+        {
+            std::scoped_lock lock(mutex);
+            if (cmd == "pwm_on") {
+                pwm_running = p.at("value").get<double>() > 0;
+            } else if (cmd == "pwm_off" or cmd == "pwm_F") {
+                pwm_running = false;
+            } else if (cmd == "allow_power_on") {
+                power_on = p.at("value").at("allow_power_on").get<bool>();
+            }
+        }
+        changed.notify_all();
+        return std::nullopt;
+    }
+
+    void publish_fn(const std::string&, const std::string&, Value) override {
+    }
+
+    void subscribe_fn(const Requirement&, const std::string& var, ValueCallback cb) override {
+        if (var == "event") {
+            bsp_event = cb;
+        }
+    }
+
+    void raise(types::board_support_common::Event event) {
+        types::board_support_common::BspEvent bsp_event_value;
+        bsp_event_value.event = event;
+        bsp_event(json(bsp_event_value));
+    }
+
+    void delivered(types::evse_manager::SessionEventEnum event) {
+        {
+            std::scoped_lock lock(mutex);
+            delivered_events.push_back(event);
+        }
+        changed.notify_all();
+    }
+
+    bool was_delivered(types::evse_manager::SessionEventEnum event) {
+        return std::find(delivered_events.begin(), delivered_events.end(), event) != delivered_events.end();
+    }
+
+    const int connector_id;
+
+    // guards the BSP outputs and the delivered session events
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool pwm_running{false};
+    bool power_on{false};
+    std::vector<types::evse_manager::SessionEventEnum> delivered_events;
+
+    std::unique_ptr<evse_board_supportIntf> r_bsp;
+    std::vector<std::unique_ptr<powermeterIntf>> r_powermeter_billing;
+    const std::vector<std::unique_ptr<ISO15118_chargerIntf>> r_hlc;
+    const std::vector<std::unique_ptr<connector_lockIntf>> r_connector_lock;
+    const std::vector<std::unique_ptr<ac_rcdIntf>> r_ac_rcd;
+    const std::vector<std::unique_ptr<isolation_monitorIntf>> r_imd;
+    const std::vector<std::unique_ptr<kvsIntf>> r_store;
+    std::unique_ptr<evse_managerImplBase> p_evse;
+
+    std::unique_ptr<IECStateMachine> bsp;
+    std::unique_ptr<ErrorHandling> error_handling;
+    std::unique_ptr<PersistentStore> store;
+    std::unique_ptr<FlightRecorder> flight_recorder;
+    std::unique_ptr<Charger> charger;
+
+private:
+    ValueCallback bsp_event;
+};
+
+// Passes the session events of all connectors to the AuthHandler from one thread and in order, like the MQTT
+// connection of the Auth module. The signals of the charger fire under its lock, so they must not call into the
+// AuthHandler directly.
+class SessionEventLink {
+public:
+    SessionEventLink(AuthHandler& auth_handler,
+                     std::function<void(int, types::evse_manager::SessionEventEnum)> on_delivered) :
+        auth_handler(auth_handler), on_delivered(std::move(on_delivered)), thread(&SessionEventLink::run, this) {
+    }
+
+    ~SessionEventLink() {
+        stop();
+    }
+
+    // delivers the events published so far, later ones are dropped
+    void stop() {
+        if (thread.joinable()) {
+            queue.push({0, std::string()});
+            thread.join();
+        }
+    }
+
+    void publish(int connector_id, const types::evse_manager::SessionEvent& event) {
+        queue.push({connector_id, json(event).dump()});
+    }
+
+private:
+    void run() {
+        while (true) {
+            for (const auto& [connector_id, payload] : queue.wait()) {
+                if (payload.empty()) {
+                    return;
+                }
+                const types::evse_manager::SessionEvent event = json::parse(payload);
+                auth_handler.handle_session_event(connector_id, event);
+                on_delivered(connector_id, event.event);
+            }
+        }
+    }
+
+    AuthHandler& auth_handler;
+    std::function<void(int, types::evse_manager::SessionEventEnum)> on_delivered;
+    EventQueue<std::pair<int, std::string>> queue;
+    std::thread thread;
+};
+
+// Returns once every task posted to the scheduler so far has run. Every worker has to take one of the tasks posted
+// here and it only does so after the tasks queued before.
+void drain_scheduler() {
+    struct Barrier {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t started{0};
+    };
+    const auto scheduler = Scheduler::shared();
+    const auto workers = scheduler->worker_count();
+    auto barrier = std::make_shared<Barrier>();
+    for (std::size_t i = 0; i < workers; i++) {
+        scheduler->post([barrier, workers]() {
+            std::unique_lock lock(barrier->mutex);
+            barrier->started++;
+            barrier->cv.notify_all();
+            barrier->cv.wait(lock, [&]() { return barrier->started == workers; });
+        });
+    }
+    std::unique_lock lock(barrier->mutex);
+    barrier->cv.wait(lock, [&]() { return barrier->started == workers; });
+}
+
+} // namespace
+
+class SessionBenchmark : public testing::Test {
+protected:
+    void SetUp() override {
+        // logging of every state change would dominate the measurement
+        boost::log::core::get()->set_logging_enabled(false);
+
+        auth_handler = std::make_unique<AuthHandler>(SelectionAlgorithm::PlugEvents, CONNECTION_TIMEOUT, false, false);
+        auth_handler->register_notify_evse_callback(
+            [this](const int evse_index, const ProvidedIdToken& provided_token,
+                   const ValidationResult& validation_result) {
+                if (validation_result.authorization_status == AuthorizationStatus::Accepted) {
+                    connectors.at(evse_index)->charger->authorize(true, provided_token);
+                }
+            });
+        auth_handler->register_withdraw_authorization_callback(
+            [this](const int evse_index) { connectors.at(evse_index)->charger->deauthorize(); });
+        auth_handler->register_stop_transaction_callback(
+            [this](const int evse_index, const StopTransactionRequest& request) {
+                connectors.at(evse_index)->charger->cancel_transaction(request);
+            });
+        auth_handler->register_validate_token_callback([](const ProvidedIdToken&) {
+            ValidationResult result;
+            result.authorization_status = AuthorizationStatus::Accepted;
+            return std::vector<ValidationResult>{result};
+        });
+        auth_handler->register_reserved_callback([](const int&, const int&) {});
+        auth_handler->register_reservation_cancelled_callback([](const int&) {});
+        auth_handler->register_publish_token_validation_status_callback(
+            [](const ProvidedIdToken&, TokenValidationStatus) {});
+
+        link = std::make_unique<SessionEventLink>(
+            *auth_handler, [this](int connector_id, types::evse_manager::SessionEventEnum event) {
+                connectors.at(connector_id - 1)->delivered(event);
+            });
+    }
+
+    void TearDown() override {
+        link->stop();
+        // the IECStateMachines may still have tasks queued, they must not reach the chargers any more
+        for (auto& connector : connectors) {
+            connector->bsp->signal_event.disconnect_all();
+        }
+        drain_scheduler();
+        for (auto& connector : connectors) {
+            connector->charger.reset();
+        }
+        drain_scheduler();
+        link.reset();
+        connectors.clear();
+        auth_handler.reset();
+        boost::log::core::get()->set_logging_enabled(true);
+    }
+
+    void add_connectors(int count) {
+        for (int connector_id = 1; connector_id <= count; connector_id++) {
+            connectors.push_back(std::make_unique<ConnectorUnderTest>(connector_id));
+            auth_handler->init_connector(connector_id, connector_id - 1);
+            publish_session_events(*connectors.back());
+        }
+    }
+
+    // what evse_managerImpl publishes as session_event, without the powermeter values
+    void publish_session_events(ConnectorUnderTest& connector) {
+        auto& charger = *connector.charger;
+        const auto id = connector.connector_id;
+
+        charger.signal_session_started_event.connect(
+            [this, id, &charger](const types::evse_manager::StartSessionReason& reason,
+                                 const std::optional<types::authorization::ProvidedIdToken>& provided_id_token) {
+                types::evse_manager::SessionEvent se;
+                se.event = types::evse_manager::SessionEventEnum::SessionStarted;
+                se.timestamp = Everest::Date::to_rfc3339(date::utc_clock::now());
+                se.uuid = charger.get_session_id();
+                types::evse_manager::SessionStarted session_started;
+                session_started.reason = reason;
+                session_started.id_tag = provided_id_token;
+                se.session_started = session_started;
+                link->publish(id, se);
+            });
+        charger.signal_transaction_started_event.connect(
+            [this, id, &charger](const types::authorization::ProvidedIdToken& id_token) {
+                types::evse_manager::SessionEvent se;
+                se.event = types::evse_manager::SessionEventEnum::TransactionStarted;
+                se.timestamp = Everest::Date::to_rfc3339(date::utc_clock::now());
+                se.uuid = charger.get_session_id();
+                types::evse_manager::TransactionStarted transaction_started;
+                transaction_started.id_tag = id_token;
+                se.transaction_started = transaction_started;
+                link->publish(id, se);
+            });
+        charger.signal_transaction_finished_event.connect(
+            [this, id, &charger](const types::evse_manager::StopTransactionReason& reason,
+                                 std::optional<types::authorization::ProvidedIdToken> finish_token) {
+                types::evse_manager::SessionEvent se;
+                se.event = types::evse_manager::SessionEventEnum::TransactionFinished;
+                se.timestamp = Everest::Date::to_rfc3339(date::utc_clock::now());
+                se.uuid = charger.get_session_id();
+                types::evse_manager::TransactionFinished transaction_finished;
+                transaction_finished.reason.emplace(reason);
+                transaction_finished.id_tag = finish_token;
+                se.transaction_finished = transaction_finished;
+                link->publish(id, se);
+            });
+        charger.signal_simple_event.connect([this, id, &charger](const types::evse_manager::SessionEventEnum& e) {
+            types::evse_manager::SessionEvent se;
+            se.event = e;
+            se.timestamp = Everest::Date::to_rfc3339(date::utc_clock::now());
+            se.uuid = charger.get_session_id();
+            if (e == types::evse_manager::SessionEventEnum::SessionFinished) {
+                se.session_finished = types::evse_manager::SessionFinished();
+            }
+            link->publish(id, se);
+        });
+    }
+
+    // Waits for \p done, running the charger main loop whenever nothing happens as its timer would
+    template <typename Predicate> bool wait_for(ConnectorUnderTest& connector, Predicate done) {
+        const auto timeout = std::chrono::steady_clock::now() + STEP_TIMEOUT;
+        std::unique_lock lock(connector.mutex);
+        while (not done()) {
+            if (std::chrono::steady_clock::now() > timeout) {
+                return false;
+            }
+            if (connector.changed.wait_for(lock, MAINLOOP_TICK) == std::cv_status::timeout) {
+                lock.unlock();
+                connector.charger->mainloop();
+                lock.lock();
+            }
+        }
+        return true;
+    }
+
+    void start(ConnectorUnderTest& connector) {
+        connector.bsp->enable(true);
+        connector.charger->setup(false, Charger::ChargeMode::AC, false, false, false, false, 0, 0, 10, "X1");
+        connector.charger->set_max_current(16, date::utc_clock::now() + 24h);
+        connector.charger->enable_disable(
+            0, {types::evse_manager::Enable_source::Unspecified, types::evse_manager::Enable_state::Enable, 10000});
+        EXPECT_TRUE(wait_for(connector, [&]() {
+            return connector.was_delivered(types::evse_manager::SessionEventEnum::Enabled);
+        }));
+    }
+
+    // Runs \p sessions charging sessions of an EV that takes power right away, returns false on a stuck session
+    bool run_sessions(ConnectorUnderTest& connector, int sessions, Durations& durations) {
+        using types::board_support_common::Event;
+        using types::evse_manager::SessionEventEnum;
+
+        ProvidedIdToken token;
+        token.id_token = {"BENCHMARK_" + std::to_string(connector.connector_id),
+                          types::authorization::IdTokenType::ISO14443};
+        token.authorization_type = types::authorization::AuthorizationType::RFID;
+        token.connectors.emplace({connector.connector_id});
+
+        for (int session = 0; session < sessions; session++) {
+            {
+                std::scoped_lock lock(connector.mutex);
+                connector.delivered_events.clear();
+            }
+            auto phase_start = std::chrono::steady_clock::now();
+            const auto phase_done = [&](Phase phase, bool ok) {
+                if (not ok) {
+                    ADD_FAILURE() << "Connector " << connector.connector_id << " stuck in "
+                                  << PHASE_NAMES[static_cast<std::size_t>(phase)] << " of session " << session;
+                    return false;
+                }
+                const auto now = std::chrono::steady_clock::now();
+                durations[static_cast<std::size_t>(phase)].push_back(now - phase_start);
+                phase_start = now;
+                return true;
+            };
+
+            connector.raise(Event::B);
+            if (not phase_done(Phase::PlugIn, wait_for(connector, [&]() {
+                                   return connector.was_delivered(SessionEventEnum::AuthRequired);
+                               }))) {
+                return false;
+            }
+
+            EXPECT_EQ(auth_handler->on_token(token), TokenHandlingResult::ACCEPTED);
+            if (not phase_done(Phase::Authorization, wait_for(connector, [&]() { return connector.pwm_running; }))) {
+                return false;
+            }
+
+            connector.raise(Event::C);
+            if (not wait_for(connector, [&]() { return connector.power_on; })) {
+                return phase_done(Phase::ChargingStart, false);
+            }
+            connector.raise(Event::PowerOn);
+            if (not phase_done(Phase::ChargingStart, wait_for(connector, [&]() {
+                                   return connector.was_delivered(SessionEventEnum::ChargingStarted) and
+                                          connector.was_delivered(SessionEventEnum::TransactionStarted);
+                               }))) {
+                return false;
+            }
+
+            connector.raise(Event::B);
+            if (not wait_for(connector, [&]() { return not connector.power_on; })) {
+                return phase_done(Phase::Stop, false);
+            }
+            connector.raise(Event::PowerOff);
+            connector.raise(Event::A);
+            if (not phase_done(Phase::Stop, wait_for(connector, [&]() {
+                                   return connector.was_delivered(SessionEventEnum::SessionFinished);
+                               }))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<AuthHandler> auth_handler;
+    std::unique_ptr<SessionEventLink> link;
+    std::vector<std::unique_ptr<ConnectorUnderTest>> connectors;
+};
+
+TEST_F(SessionBenchmark, session_lifecycle) {
+    const auto sessions = env_or("EVSE_MANAGER_BENCHMARK_SESSIONS", 200);
+    const auto connector_count = env_or("EVSE_MANAGER_BENCHMARK_CONNECTORS", 1);
+    const auto min_sessions_per_second = env_or("EVSE_MANAGER_BENCHMARK_MIN_SESSIONS_PER_SECOND", 0);
+    ASSERT_GT(sessions, 0);
+    ASSERT_GT(connector_count, 0);
+
+    add_connectors(connector_count);
+    for (auto& connector : connectors) {
+        start(*connector);
+    }
+
+    const auto idle_threads = process_status("Threads");
+    std::atomic<long> peak_threads{idle_threads};
+    std::atomic<bool> done{false};
+    std::thread sampler([&peak_threads, &done]() {
+        while (not done) {
+            const auto threads = process_status("Threads");
+            if (threads > peak_threads) {
+                peak_threads = threads;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+
+    std::vector<Durations> durations(connectors.size());
+    std::vector<std::thread> drivers;
+    const auto started = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < connectors.size(); i++) {
+        drivers.emplace_back([this, i, sessions, &durations]() { run_sessions(*connectors[i], sessions, durations[i]); });
+    }
+    for (auto& driver : drivers) {
+        driver.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    done = true;
+    sampler.join();
+
+    std::size_t completed = 0;
+    for (const auto& connector_durations : durations) {
+        completed += connector_durations[static_cast<std::size_t>(Phase::Stop)].size();
+    }
+    const auto sessions_per_second = completed / elapsed.count();
+
+    std::printf("EvseManager session benchmark: %zu sessions on %zu connector(s) in %.3f s, %.1f sessions/s\n",
+                completed, connectors.size(), elapsed.count(), sessions_per_second);
+    // the peak includes the driver threads and the sampler
+    std::printf("process: %ld threads idle, %ld peak while charging (%zu driver threads and 1 sampler included), "
+                "%ld kB resident\n",
+                idle_threads, peak_threads.load(), drivers.size(), process_status("VmRSS"));
+    std::printf("%-16s %10s %10s %10s %10s %10s\n", "phase [us]", "min", "mean", "p50", "p99", "max");
+    for (std::size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        std::vector<std::chrono::nanoseconds> all;
+        for (const auto& connector_durations : durations) {
+            all.insert(all.end(), connector_durations[phase].begin(), connector_durations[phase].end());
+        }
+        if (all.empty()) {
+            continue;
+        }
+        std::sort(all.begin(), all.end());
+        std::chrono::nanoseconds total{0};
+        for (const auto& d : all) {
+            total += d;
+        }
+        const auto us = [](std::chrono::nanoseconds d) { return d.count() / 1000.; };
+        std::printf("%-16s %10.1f %10.1f %10.1f %10.1f %10.1f\n", PHASE_NAMES[phase], us(all.front()),
+                    us(total / all.size()), us(all[all.size() / 2]), us(all[all.size() * 99 / 100]), us(all.back()));
+    }
+
+    EXPECT_EQ(completed, static_cast<std::size_t>(sessions) * connectors.size());
+    if (min_sessions_per_second > 0) {
+        EXPECT_GE(sessions_per_second, min_sessions_per_second);
+    }
+}
+
+} // namespace module
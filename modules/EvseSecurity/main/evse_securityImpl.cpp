@@ -24,37 +24,48 @@ void evse_securityImpl::init() {
         private_key_password = this->mod->config.private_key_password;
     }
 
-    this->evse_security = std::make_unique<evse_security::EvseSecurity>(file_paths, private_key_password);
+    // scanning the certificate directories does not need to delay the init of the other modules, commands wait for it
+    this->evse_security_loaded =
+        this->mod->startup_profiler->run_concurrently("load_certificates", [this, file_paths, private_key_password]() {
+            this->evse_security = std::make_unique<evse_security::EvseSecurity>(file_paths, private_key_password);
+        });
 }
 
 void evse_securityImpl::ready() {
+    // a certificate store that cannot be loaded still fails the startup of the module
+    this->get_evse_security();
+}
+
+evse_security::EvseSecurity& evse_securityImpl::get_evse_security() {
+    this->evse_security_loaded.get();
+    return *this->evse_security;
 }
 
 types::evse_security::InstallCertificateResult
 evse_securityImpl::handle_install_ca_certificate(std::string& certificate,
                                                  types::evse_security::CaCertificateType& certificate_type) {
     return conversions::to_everest(
-        this->evse_security->install_ca_certificate(certificate, conversions::from_everest(certificate_type)));
+        this->get_evse_security().install_ca_certificate(certificate, conversions::from_everest(certificate_type)));
 }
 
 types::evse_security::DeleteCertificateResult
 evse_securityImpl::handle_delete_certificate(types::evse_security::CertificateHashData& certificate_hash_data) {
     return conversions::to_everest(
-        this->evse_security->delete_certificate(conversions::from_everest(certificate_hash_data)));
+        this->get_evse_security().delete_certificate(conversions::from_everest(certificate_hash_data)));
 }
 
 types::evse_security::InstallCertificateResult
 evse_securityImpl::handle_update_leaf_certificate(std::string& certificate_chain,
                                                   types::evse_security::LeafCertificateType& certificate_type) {
     return conversions::to_everest(
-        this->evse_security->update_leaf_certificate(certificate_chain, conversions::from_everest(certificate_type)));
+        this->get_evse_security().update_leaf_certificate(certificate_chain, conversions::from_everest(certificate_type)));
 }
 
 types::evse_security::CertificateValidationResult
 evse_securityImpl::handle_verify_certificate(std::string& certificate_chain,
                                              types::evse_security::LeafCertificateType& certificate_type) {
     return conversions::to_everest(
-        this->evse_security->verify_certificate(certificate_chain, conversions::from_everest(certificate_type)));
+        this->get_evse_security().verify_certificate(certificate_chain, conversions::from_everest(certificate_type)));
 }
 
 types::evse_security::GetInstalledCertificatesResult evse_securityImpl::handle_get_installed_certificates(
@@ -65,25 +76,25 @@ types::evse_security::GetInstalledCertificatesResult evse_securityImpl::handle_g
         _certificate_types.push_back(conversions::from_everest(certificate_type));
     }
 
-    return conversions::to_everest(this->evse_security->get_installed_certificates(_certificate_types));
+    return conversions::to_everest(this->get_evse_security().get_installed_certificates(_certificate_types));
 }
 
 types::evse_security::OCSPRequestDataList evse_securityImpl::handle_get_v2g_ocsp_request_data() {
-    return conversions::to_everest(this->evse_security->get_v2g_ocsp_request_data());
+    return conversions::to_everest(this->get_evse_security().get_v2g_ocsp_request_data());
 }
 
 types::evse_security::OCSPRequestDataList
 evse_securityImpl::handle_get_mo_ocsp_request_data(std::string& certificate_chain) {
-    return conversions::to_everest(this->evse_security->get_mo_ocsp_request_data(certificate_chain));
+    return conversions::to_everest(this->get_evse_security().get_mo_ocsp_request_data(certificate_chain));
 }
 
 void evse_securityImpl::handle_update_ocsp_cache(types::evse_security::CertificateHashData& certificate_hash_data,
                                                  std::string& ocsp_response) {
-    this->evse_security->update_ocsp_cache(conversions::from_everest(certificate_hash_data), ocsp_response);
+    this->get_evse_security().update_ocsp_cache(conversions::from_everest(certificate_hash_data), ocsp_response);
 }
 
 bool evse_securityImpl::handle_is_ca_certificate_installed(types::evse_security::CaCertificateType& certificate_type) {
-    return this->evse_security->is_ca_certificate_installed(conversions::from_everest(certificate_type));
+    return this->get_evse_security().is_ca_certificate_installed(conversions::from_everest(certificate_type));
 }
 
 types::evse_security::GetCertificateSignRequestResult evse_securityImpl::handle_generate_certificate_signing_request(
@@ -91,7 +102,7 @@ types::evse_security::GetCertificateSignRequestResult evse_securityImpl::handle_
     std::string& common, bool& use_tpm) {
     types::evse_security::GetCertificateSignRequestResult response;
 
-    auto csr_response = this->evse_security->generate_certificate_signing_request(
+    auto csr_response = this->get_evse_security().generate_certificate_signing_request(
         conversions::from_everest(certificate_type), country, organization, common, use_tpm);
 
     response.status = conversions::to_everest(csr_response.status);
@@ -109,7 +120,7 @@ evse_securityImpl::handle_get_leaf_certificate_info(types::evse_security::LeafCe
                                                     types::evse_security::EncodingFormat& encoding,
                                                     bool& include_ocsp) {
     types::evse_security::GetCertificateInfoResult response;
-    const auto leaf_info = this->evse_security->get_leaf_certificate_info(
+    const auto leaf_info = this->get_evse_security().get_leaf_certificate_info(
         conversions::from_everest(certificate_type), conversions::from_everest(encoding), include_ocsp);
 
     response.status = conversions::to_everest(leaf_info.status);
@@ -122,11 +133,11 @@ evse_securityImpl::handle_get_leaf_certificate_info(types::evse_security::LeafCe
 }
 
 std::string evse_securityImpl::handle_get_verify_file(types::evse_security::CaCertificateType& certificate_type) {
-    return this->evse_security->get_verify_file(conversions::from_everest(certificate_type));
+    return this->get_evse_security().get_verify_file(conversions::from_everest(certificate_type));
 }
 
 int evse_securityImpl::handle_get_leaf_expiry_days_count(types::evse_security::LeafCertificateType& certificate_type) {
-    return this->evse_security->get_leaf_expiry_days_count(conversions::from_everest(certificate_type));
+    return this->get_evse_security().get_leaf_expiry_days_count(conversions::from_everest(certificate_type));
 }
 
 bool evse_securityImpl::handle_verify_file_signature(std::string& file_path, std::string& signing_certificate,
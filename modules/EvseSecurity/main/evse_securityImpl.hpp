@@ -15,6 +15,7 @@
 // ev@75ac1216-19eb-4182-a85c-820f1fc2c091:v1
 // insert your custom include headers here
 #include <evse_security/evse_security.hpp>
+#include <future>
 // ev@75ac1216-19eb-4182-a85c-820f1fc2c091:v1
 
 namespace module {
@@ -78,7 +79,11 @@ private:
 
     // ev@3370e4dd-95f4-47a9-aaec-ea76f34a66c9:v1
     // insert your private definitions here
+    // waits until the certificate store has been loaded, rethrows if loading failed
+    evse_security::EvseSecurity& get_evse_security();
+
     std::unique_ptr<evse_security::EvseSecurity> evse_security;
+    std::shared_future<void> evse_security_loaded;
     // ev@3370e4dd-95f4-47a9-aaec-ea76f34a66c9:v1
 };
 
@@ -4,8 +4,11 @@
 #include "EvseV2G.hpp"
 #include "connection.hpp"
 #include "everest/logging.hpp"
+#include "exi_codec.hpp"
 #include "log.hpp"
 #include "sdp.hpp"
+#include "tls_connection.hpp"
+#include <tracing/tracing.hpp>
 
 #ifndef EVEREST_MBED_TLS
 #include <openssl_util.hpp>
@@ -32,12 +35,23 @@ struct v2g_context* v2g_ctx = nullptr;
 namespace module {
 
 void EvseV2G::init() {
+    tracing::init(info.id);
+
     /* create v2g context */
     v2g_ctx = v2g_ctx_create(&(*p_charger), &(*r_security));
 
     if (v2g_ctx == nullptr)
         return;
 
+    cert_install_cache = std::make_unique<CertificateInstallationCache>(
+        std::chrono::seconds(config.cert_install_cache_time_s),
+        std::chrono::seconds(config.cert_install_request_timeout_s));
+    v2g_ctx->cert_install_cache = cert_install_cache.get();
+
+    /* one session per EVSE, documents of further connections at the same time are freed after them. The documents are
+     * allocated now, so the EV is not waiting for their allocation */
+    ExiCodec::shared().set_pool_size(1);
+
 #ifndef EVEREST_MBED_TLS
     (void)openssl::set_log_handler(log_handler);
     v2g_ctx->tls_server = &tls_server;
@@ -80,14 +94,34 @@ void EvseV2G::ready() {
         goto err_out;
     }
 
+#ifndef EVEREST_MBED_TLS
+    if (config.tls_security != "prohibit") {
+        // keep the stapled OCSP responses fresh independent of handshakes, started last as it uses v2g_ctx which is
+        // freed on errors above
+        tls::OcspRefreshScheduler::config_t ocsp_config;
+        ocsp_config.lead_time = std::chrono::seconds(config.ocsp_refresh_lead_time_s);
+        ocsp_config.jitter = std::chrono::seconds(config.ocsp_refresh_jitter_s);
+        ocsp_refresh = std::make_unique<tls::OcspRefreshScheduler>(
+            tls_server.ocsp_cache(), []() { return tls::connection_update_ocsp_cache(v2g_ctx); }, ocsp_config);
+        ocsp_refresh->start();
+    }
+#endif // EVEREST_MBED_TLS
+
     return;
 
 err_out:
     v2g_ctx_free(v2g_ctx);
+    v2g_ctx = nullptr;
 }
 
 EvseV2G::~EvseV2G() {
+#ifndef EVEREST_MBED_TLS
+    if (ocsp_refresh) {
+        ocsp_refresh->stop();
+    }
+#endif // EVEREST_MBED_TLS
     v2g_ctx_free(v2g_ctx);
+    ExiCodec::shared().log_stats();
 }
 
 } // namespace module
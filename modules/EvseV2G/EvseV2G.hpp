@@ -35,9 +35,14 @@ struct Conf {
     bool tls_key_logging;
     std::string tls_key_logging_path;
     int tls_timeout;
+    bool tls_kernel_offload;
     bool verify_contract_cert_chain;
     int auth_timeout_pnc;
     int auth_timeout_eim;
+    int ocsp_refresh_lead_time_s;
+    int ocsp_refresh_jitter_s;
+    int cert_install_cache_time_s;
+    int cert_install_request_timeout_s;
 };
 
 class EvseV2G : public Everest::ModuleBase {
@@ -73,8 +78,10 @@ private:
 
     // ev@211cfdbe-f69a-4cd6-a4ec-f8aaa3d1b6c8:v1
     // insert your private definitions here
+    std::unique_ptr<CertificateInstallationCache> cert_install_cache;
 #ifndef EVEREST_MBED_TLS
     tls::Server tls_server;
+    std::unique_ptr<tls::OcspRefreshScheduler> ocsp_refresh;
 #endif // EVEREST_MBED_TLS
     // ev@211cfdbe-f69a-4cd6-a4ec-f8aaa3d1b6c8:v1
 };
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "cert_install_cache.hpp"
+
+#include <algorithm>
+
+CertificateInstallationCache::CertificateInstallationCache(std::chrono::seconds max_age,
+                                                           std::chrono::seconds request_timeout) :
+    max_age(max_age), request_timeout(request_timeout) {
+}
+
+bool CertificateInstallationCache::request(const std::string& ev_id, std::uint64_t session_id,
+                                           clock_t::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    expire(now);
+
+    auto it = entries.find(ev_id);
+    if (it != entries.end()) {
+        auto& entry = it->second;
+        if (entry.state == State::Available) {
+            entry.waiting = true;
+            return false;
+        }
+        if ((entry.state == State::Pending) && (now - entry.requested_at < request_timeout)) {
+            // the EV retried while the CSMS is still working on the first request
+            entry.waiting = true;
+            stats.requests_deduplicated++;
+            return false;
+        }
+    }
+
+    entries[ev_id] = Entry{State::Pending, session_id, true, now, {}, {}, {}};
+    in_flight = ev_id;
+    stats.requests_published++;
+    return true;
+}
+
+void CertificateInstallationCache::respond(const std::optional<std::string>& exi_b64, bool accepted,
+                                           clock_t::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!in_flight.has_value()) {
+        return;
+    }
+
+    auto it = entries.find(in_flight.value());
+    in_flight.reset();
+    if ((it == entries.end()) || (it->second.state != State::Pending)) {
+        return;
+    }
+
+    auto& entry = it->second;
+    entry.received_at = now;
+    stats.last_latency = std::chrono::duration_cast<std::chrono::milliseconds>(now - entry.requested_at);
+    stats.max_latency = std::max(stats.max_latency, stats.last_latency);
+    if (!entry.waiting) {
+        stats.late_responses++;
+    }
+
+    if (accepted && exi_b64.has_value() && !exi_b64->empty()) {
+        entry.state = State::Available;
+        entry.exi_b64 = exi_b64.value();
+    } else {
+        entry.state = State::Failed;
+        stats.failed_responses++;
+    }
+}
+
+void CertificateInstallationCache::timeout(const std::string& ev_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(ev_id);
+    if (it != entries.end()) {
+        it->second.waiting = false;
+    }
+}
+
+CertificateInstallationCache::State CertificateInstallationCache::state(const std::string& ev_id,
+                                                                        clock_t::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* entry = find(ev_id, now);
+    return (entry != nullptr) ? entry->state : State::None;
+}
+
+std::optional<CertificateInstallationCache::Response>
+CertificateInstallationCache::get(const std::string& ev_id, std::uint64_t session_id, clock_t::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* entry = find(ev_id, now);
+    if ((entry == nullptr) || (entry->state != State::Available)) {
+        return std::nullopt;
+    }
+
+    if (entry->session_id != session_id) {
+        stats.cache_hits++;
+    }
+    // the response is handed out, from now on it only lives until max_age
+    entries[ev_id].waiting = false;
+    return Response{entry->exi_b64, entry->emaid, entry->session_id, now - entry->received_at};
+}
+
+void CertificateInstallationCache::set_emaid(const std::string& ev_id, const std::string& emaid) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(ev_id);
+    if (it != entries.end()) {
+        it->second.emaid = emaid;
+    }
+}
+
+void CertificateInstallationCache::remove(const std::string& ev_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(ev_id);
+    if (in_flight == ev_id) {
+        in_flight.reset();
+    }
+}
+
+CertificateInstallationCache::Stats CertificateInstallationCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+const CertificateInstallationCache::Entry* CertificateInstallationCache::find(const std::string& ev_id,
+                                                                             clock_t::time_point now) const {
+    const auto it = entries.find(ev_id);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    const auto& entry = it->second;
+    // a waiting request always gets its own response, max_age only limits the reuse
+    if ((entry.state == State::Available) && !entry.waiting && (now - entry.received_at >= max_age)) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+void CertificateInstallationCache::expire(clock_t::time_point now) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        const auto& entry = it->second;
+        const bool expired = ((entry.state == State::Available) && !entry.waiting &&
+                              (now - entry.received_at >= max_age)) ||
+                             ((entry.state == State::Failed) && (now - entry.received_at >= request_timeout));
+        if (expired && (in_flight != it->first)) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
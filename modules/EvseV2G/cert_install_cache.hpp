@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef CERT_INSTALL_CACHE_HPP
+#define CERT_INSTALL_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/*!
+ * \brief CertificateInstallationCache keeps the CertificateInstallationRes messages received from the CSMS per EV.
+ *
+ * The EV has 5 s to receive a CertificateInstallationRes, while the CSMS round trip via OCPP Get15118EVCertificate
+ * can take longer on a slow backhaul. The EV then retries with the same CertificateInstallationReq, usually in a new
+ * V2G session. The cache keeps track of the request in flight, so a retry does not publish a second request, and
+ * keeps the response (even if it arrives after the EV gave up) so the retry is answered without another round trip.
+ *
+ * Entries are keyed by the OEM provisioning certificate of the EV, the eMAID of the contract is only known from the
+ * response and is kept alongside for logging. All methods are thread safe.
+ */
+class CertificateInstallationCache {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    enum class State {
+        None,      //!< no request known for the EV
+        Pending,   //!< request published, waiting for the CSMS
+        Available, //!< response received and not yet expired
+        Failed,    //!< CSMS rejected the request or did not provide a response
+    };
+
+    struct Response {
+        std::string exi_b64;      //!< Base64 encoded CertificateInstallationRes as received from the CSMS
+        std::string emaid;        //!< eMAID of the installed contract, empty until known
+        std::uint64_t session_id; //!< V2G session the request was received in
+        clock_t::duration age;    //!< time since the response was received
+    };
+
+    struct Stats {
+        std::uint32_t requests_published{0};   //!< requests sent to the CSMS
+        std::uint32_t requests_deduplicated{0}; //!< EV retries while a request was in flight
+        std::uint32_t cache_hits{0};            //!< responses served to a later request
+        std::uint32_t late_responses{0};        //!< responses received after the EV timed out
+        std::uint32_t failed_responses{0};      //!< responses that were rejected by the CSMS
+        std::chrono::milliseconds last_latency{0};
+        std::chrono::milliseconds max_latency{0};
+    };
+
+    /*!
+     * \param max_age time a response is served from the cache
+     * \param request_timeout time after which a request without response is published again
+     */
+    CertificateInstallationCache(std::chrono::seconds max_age, std::chrono::seconds request_timeout);
+
+    /*!
+     * \brief request registers a CertificateInstallationReq of the EV \p ev_id
+     * \return true if the request needs to be published to the CSMS, false if the same request is already in flight
+     * or a response is available
+     */
+    bool request(const std::string& ev_id, std::uint64_t session_id, clock_t::time_point now);
+
+    /*!
+     * \brief respond completes the request in flight
+     * \param exi_b64 the response of the CSMS, a response without EXI stream counts as failed
+     * \param accepted false if the CSMS rejected the request
+     */
+    void respond(const std::optional<std::string>& exi_b64, bool accepted, clock_t::time_point now);
+
+    /*!
+     * \brief timeout marks that the EV \p ev_id stopped waiting for its request, a response arriving afterwards is
+     * still cached but counted as late
+     */
+    void timeout(const std::string& ev_id);
+
+    //! \brief state returns the state of the request of \p ev_id
+    State state(const std::string& ev_id, clock_t::time_point now) const;
+
+    /*!
+     * \brief get returns the available response of \p ev_id
+     * \param session_id the current V2G session, a response requested in another session counts as cache hit
+     */
+    std::optional<Response> get(const std::string& ev_id, std::uint64_t session_id, clock_t::time_point now);
+
+    //! \brief set_emaid records the eMAID of the response of \p ev_id once it has been decoded
+    void set_emaid(const std::string& ev_id, const std::string& emaid);
+
+    //! \brief remove drops the request or response of \p ev_id, e.g. because it could not be used
+    void remove(const std::string& ev_id);
+
+    Stats get_stats() const;
+
+private:
+    struct Entry {
+        State state;
+        std::uint64_t session_id;
+        bool waiting;
+        clock_t::time_point requested_at;
+        clock_t::time_point received_at;
+        std::string exi_b64;
+        std::string emaid;
+    };
+
+    const Entry* find(const std::string& ev_id, clock_t::time_point now) const;
+    void expire(clock_t::time_point now);
+
+    mutable std::mutex mutex;
+    std::chrono::seconds max_age;
+    std::chrono::seconds request_timeout;
+    std::map<std::string, Entry> entries;
+    std::optional<std::string> in_flight;
+    Stats stats;
+};
+
+#endif // CERT_INSTALL_CACHE_HPP
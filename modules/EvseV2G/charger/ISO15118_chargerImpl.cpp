@@ -53,14 +53,15 @@ void ISO15118_chargerImpl::init() {
     }
 
     v2g_ctx->network_read_timeout_tls = mod->config.tls_timeout;
+    v2g_ctx->tls_kernel_offload = mod->config.tls_kernel_offload;
 
     v2g_ctx->certs_path = mod->info.paths.etc / CERTS_SUB_DIR;
 
     /* Configure if the contract certificate chain should be verified locally */
-    v2g_ctx->session.verify_contract_cert_chain = mod->config.verify_contract_cert_chain;
+    v2g_ctx->basic_config.verify_contract_cert_chain = mod->config.verify_contract_cert_chain;
 
-    v2g_ctx->session.auth_timeout_eim = mod->config.auth_timeout_eim;
-    v2g_ctx->session.auth_timeout_pnc = mod->config.auth_timeout_pnc;
+    v2g_ctx->basic_config.auth_timeout_eim = mod->config.auth_timeout_eim;
+    v2g_ctx->basic_config.auth_timeout_pnc = mod->config.auth_timeout_pnc;
 }
 
 void ISO15118_chargerImpl::ready() {
@@ -208,11 +209,10 @@ void ISO15118_chargerImpl::handle_session_setup(std::vector<types::iso15118_char
 void ISO15118_chargerImpl::handle_certificate_response(
     types::iso15118_charger::ResponseExiStreamStatus& exi_stream_status) {
     pthread_mutex_lock(&v2g_ctx->mqtt_lock);
-    if (exi_stream_status.exi_response.has_value()) {
-        v2g_ctx->evse_v2g_data.cert_install_res_b64_buffer = std::string(exi_stream_status.exi_response.value());
-    }
-    v2g_ctx->evse_v2g_data.cert_install_status =
-        (exi_stream_status.status == types::iso15118_charger::Status::Accepted) ? true : false;
+    // kept even if the EV stopped waiting, a retry of the EV is answered from the cache
+    v2g_ctx->cert_install_cache->respond(exi_stream_status.exi_response,
+                                         exi_stream_status.status == types::iso15118_charger::Status::Accepted,
+                                         CertificateInstallationCache::clock_t::now());
     pthread_cond_signal(&v2g_ctx->mqtt_cond);
     /* unlock */
     pthread_mutex_unlock(&v2g_ctx->mqtt_lock);
@@ -224,11 +224,11 @@ void ISO15118_chargerImpl::handle_authorization_response(
 
     if (v2g_ctx->session.iso_selected_payment_option == iso2_paymentOptionType_ExternalPayment) {
         if (authorization_status == types::authorization::AuthorizationStatus::Accepted) {
-            v2g_ctx->evse_v2g_data.evse_processing[PHASE_AUTH] = (uint8_t)iso2_EVSEProcessingType_Finished;
+            v2g_ctx->session.evse_processing[PHASE_AUTH] = (uint8_t)iso2_EVSEProcessingType_Finished;
         }
     } else if (v2g_ctx->session.iso_selected_payment_option == iso2_paymentOptionType_Contract) {
         v2g_ctx->session.certificate_status = certificate_status;
-        v2g_ctx->evse_v2g_data.evse_processing[PHASE_AUTH] = static_cast<uint8_t>(iso2_EVSEProcessingType_Finished);
+        v2g_ctx->session.evse_processing[PHASE_AUTH] = static_cast<uint8_t>(iso2_EVSEProcessingType_Finished);
 
         if (authorization_status != types::authorization::AuthorizationStatus::Accepted) {
             v2g_ctx->session.authorization_rejected = true;
@@ -255,14 +255,14 @@ void ISO15118_chargerImpl::handle_dlink_ready(bool& value) {
 
 void ISO15118_chargerImpl::handle_cable_check_finished(bool& status) {
     if (status == true) {
-        v2g_ctx->evse_v2g_data.evse_processing[PHASE_ISOLATION] = (uint8_t)iso2_EVSEProcessingType_Finished;
+        v2g_ctx->session.evse_processing[PHASE_ISOLATION] = (uint8_t)iso2_EVSEProcessingType_Finished;
     } else {
-        v2g_ctx->evse_v2g_data.evse_processing[PHASE_ISOLATION] = (uint8_t)iso2_EVSEProcessingType_Ongoing;
+        v2g_ctx->session.evse_processing[PHASE_ISOLATION] = (uint8_t)iso2_EVSEProcessingType_Ongoing;
     }
 }
 
 void ISO15118_chargerImpl::handle_receipt_is_required(bool& receipt_required) {
-    v2g_ctx->evse_v2g_data.receipt_required = (int)receipt_required;
+    v2g_ctx->session.receipt_required = (int)receipt_required;
 }
 
 void ISO15118_chargerImpl::handle_stop_charging(bool& stop) {
@@ -272,9 +272,9 @@ void ISO15118_chargerImpl::handle_stop_charging(bool& stop) {
         // spawn new thread to not block command handler
         std::thread([this, stop] {
             // try to gracefully shutdown charging session
-            v2g_ctx->evse_v2g_data.evse_notification = iso2_EVSENotificationType_StopCharging;
-            memset(v2g_ctx->evse_v2g_data.evse_status_code, iso2_DC_EVSEStatusCodeType_EVSE_Shutdown,
-                   sizeof(v2g_ctx->evse_v2g_data.evse_status_code));
+            v2g_ctx->session.evse_notification = iso2_EVSENotificationType_StopCharging;
+            memset(v2g_ctx->session.evse_status_code, iso2_DC_EVSEStatusCodeType_EVSE_Shutdown,
+                   sizeof(v2g_ctx->session.evse_status_code));
 
             int i;
             bool timeout_reached = true;
@@ -360,17 +360,17 @@ void ISO15118_chargerImpl::handle_update_dc_minimum_limits(
 }
 
 void ISO15118_chargerImpl::handle_update_isolation_status(types::iso15118_charger::IsolationStatus& isolation_status) {
-    v2g_ctx->evse_v2g_data.evse_isolation_status = (uint8_t)isolation_status;
-    v2g_ctx->evse_v2g_data.evse_isolation_status_is_used = 1;
+    v2g_ctx->session.evse_isolation_status = (uint8_t)isolation_status;
+    v2g_ctx->session.evse_isolation_status_is_used = 1;
 }
 
 void ISO15118_chargerImpl::handle_update_dc_present_values(
     types::iso15118_charger::DcEvsePresentVoltageCurrent& present_voltage_current) {
-    populate_physical_value_float(&v2g_ctx->evse_v2g_data.evse_present_voltage,
+    populate_physical_value_float(&v2g_ctx->session.evse_present_voltage,
                                   present_voltage_current.evse_present_voltage, 1, iso2_unitSymbolType_V);
 
     if (present_voltage_current.evse_present_current.has_value()) {
-        populate_physical_value_float(&v2g_ctx->evse_v2g_data.evse_present_current,
+        populate_physical_value_float(&v2g_ctx->session.evse_present_current,
                                       static_cast<float>(present_voltage_current.evse_present_current.value()), 1,
                                       iso2_unitSymbolType_A);
     }
@@ -378,7 +378,7 @@ void ISO15118_chargerImpl::handle_update_dc_present_values(
 
 void ISO15118_chargerImpl::handle_update_meter_info(types::powermeter::Powermeter& powermeter) {
     // Signal for ChargingStatus and CurrentDemand that MeterInfo is used
-    v2g_ctx->meter_info.meter_info_is_used = 1;
+    v2g_ctx->session.meter_info_is_used = 1;
     v2g_ctx->meter_info.meter_reading = powermeter.energy_Wh_import.total;
 
     if (powermeter.meter_id) {
@@ -398,15 +398,15 @@ void ISO15118_chargerImpl::handle_send_error(types::iso15118_charger::EvseError&
     case types::iso15118_charger::EvseError::Error_Contactor:
         break;
     case types::iso15118_charger::EvseError::Error_RCD:
-        v2g_ctx->evse_v2g_data.rcd = 1;
+        v2g_ctx->session.rcd = 1;
         break;
     case types::iso15118_charger::EvseError::Error_UtilityInterruptEvent:
-        memset(v2g_ctx->evse_v2g_data.evse_status_code, (int)iso2_DC_EVSEStatusCodeType_EVSE_UtilityInterruptEvent,
-               sizeof(v2g_ctx->evse_v2g_data.evse_status_code));
+        memset(v2g_ctx->session.evse_status_code, (int)iso2_DC_EVSEStatusCodeType_EVSE_UtilityInterruptEvent,
+               sizeof(v2g_ctx->session.evse_status_code));
         break;
     case types::iso15118_charger::EvseError::Error_Malfunction:
-        memset(v2g_ctx->evse_v2g_data.evse_status_code, (int)iso2_DC_EVSEStatusCodeType_EVSE_Malfunction,
-               sizeof(v2g_ctx->evse_v2g_data.evse_status_code));
+        memset(v2g_ctx->session.evse_status_code, (int)iso2_DC_EVSEStatusCodeType_EVSE_Malfunction,
+               sizeof(v2g_ctx->session.evse_status_code));
         break;
     case types::iso15118_charger::EvseError::Error_EmergencyShutdown:
         /* signal changes to possible waiters, according to man page, it never returns an error code */
@@ -422,17 +422,17 @@ void ISO15118_chargerImpl::handle_send_error(types::iso15118_charger::EvseError&
 }
 
 void ISO15118_chargerImpl::handle_reset_error() {
-    v2g_ctx->evse_v2g_data.rcd = 0;
+    v2g_ctx->session.rcd = 0;
 
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_INIT] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_AUTH] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_PARAMETER] = iso2_DC_EVSEStatusCodeType_EVSE_Ready; // [V2G-DC-453]
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_ISOLATION] =
+    v2g_ctx->session.evse_status_code[PHASE_INIT] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    v2g_ctx->session.evse_status_code[PHASE_AUTH] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    v2g_ctx->session.evse_status_code[PHASE_PARAMETER] = iso2_DC_EVSEStatusCodeType_EVSE_Ready; // [V2G-DC-453]
+    v2g_ctx->session.evse_status_code[PHASE_ISOLATION] =
         iso2_DC_EVSEStatusCodeType_EVSE_IsolationMonitoringActive;
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_PRECHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_CHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_WELDING] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    v2g_ctx->evse_v2g_data.evse_status_code[PHASE_STOP] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    v2g_ctx->session.evse_status_code[PHASE_PRECHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
+    v2g_ctx->session.evse_status_code[PHASE_CHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
+    v2g_ctx->session.evse_status_code[PHASE_WELDING] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    v2g_ctx->session.evse_status_code[PHASE_STOP] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
 
     // Todo(sl): check if emergency should be cleared here?
 }
@@ -778,7 +778,7 @@ static void* connection_handle_tls(void* data) {
         if (v2g_ctx->tls_log_ctx.file != NULL) {
             fclose(v2g_ctx->tls_log_ctx.file);
         }
-        memset(&v2g_ctx->tls_log_ctx, 0, sizeof(v2g_ctx->tls_log_ctx));
+        v2g_ctx->tls_log_ctx = keylogDebugCtx{};
 
         std::string tls_log_path(v2g_ctx->tls_key_logging_path);
         tls_log_path.append("/tls_session_keys.log");
@@ -871,7 +871,7 @@ static void* connection_handle_tls(void* data) {
         mbedtls_debug_set_threshold(MBEDTLS_DEBUG_LEVEL_NO_DEBUG);
         fclose(conn->ctx->tls_log_ctx.file);
         close(conn->ctx->udp_socket);
-        memset(&conn->ctx->tls_log_ctx, 0, sizeof(conn->ctx->tls_log_ctx));
+        conn->ctx->tls_log_ctx = keylogDebugCtx{};
     }
 
     /* check if the v2g-session is already running in another thread, if not handle v2g-connection */
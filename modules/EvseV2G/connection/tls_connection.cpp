@@ -10,6 +10,7 @@
 
 #include <cassert>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <ctime>
 #include <iostream>
@@ -31,6 +32,9 @@ ssize_t connection_read(struct v2g_connection* conn, unsigned char* buf, std::si
 ssize_t connection_write(struct v2g_connection* conn, unsigned char* buf, std::size_t count) {
     return -1;
 }
+bool connection_update_ocsp_cache(struct v2g_context* ctx) {
+    return false;
+}
 } // namespace tls
 
 #else // EVEREST_MBED_TLS
@@ -55,6 +59,11 @@ void process_connection_thread(std::shared_ptr<tls::ServerConnection> con, struc
     if (con->accept()) {
         // TODO(james-ctc) v2g_ctx->tls_key_logging
 
+        if (ctx->tls_kernel_offload) {
+            dlog(DLOG_LEVEL_INFO, "Kernel TLS send: %s, receive: %s", con->ktls_send() ? "yes" : "no",
+                 con->ktls_recv() ? "yes" : "no");
+        }
+
         if (ctx->state == 0) {
             const auto rv = ::v2g_handle_connection(connection.get());
             dlog(DLOG_LEVEL_INFO, "v2g_dispatch_connection exited with %d", rv);
@@ -117,6 +126,7 @@ bool build_config(tls::Server::config_t& config, struct v2g_context* ctx) {
     //                  may be issues with reinitialisation
     config.socket = ctx->tls_socket.fd;
     config.io_timeout_ms = static_cast<std::int32_t>(ctx->network_read_timeout_tls);
+    config.enable_ktls = ctx->tls_kernel_offload;
 
     // information from libevse-security
     const auto cert_info =
@@ -132,6 +142,7 @@ bool build_config(tls::Server::config_t& config, struct v2g_context* ctx) {
             // workaround (see above libevse-security comment)
             const auto key_password = info.password.value_or("");
 
+            // ConfigItem keeps a copy, config stays valid after cert_info is gone and can be used by the OCSP refresh
             config.certificate_chain_file = cert_path.c_str();
             config.private_key_file = key_path.c_str();
             config.private_key_password = key_password.c_str();
@@ -223,6 +234,32 @@ int connection_start_server(struct v2g_context* ctx) {
     return res;
 }
 
+bool connection_update_ocsp_cache(struct v2g_context* ctx) {
+    assert(ctx != nullptr);
+    assert(ctx->tls_server != nullptr);
+
+    tls::Server::config_t config;
+    bool bResult{false};
+
+    // EvseSecurity reports the current OCSP response files of the V2G chain
+    if (build_config(config, ctx)) {
+        bResult = ctx->tls_server->update_ocsp_cache(config);
+    }
+
+    const auto next_update = ctx->tls_server->ocsp_cache().next_update();
+    if (next_update) {
+        const auto remaining =
+            std::chrono::duration_cast<std::chrono::minutes>(next_update.value() - std::chrono::system_clock::now());
+        dlog(DLOG_LEVEL_INFO, "OCSP cache reloaded: %zu responses, earliest nextUpdate in %ld minutes",
+             ctx->tls_server->ocsp_cache().status().size(), static_cast<long>(remaining.count()));
+    } else {
+        dlog(DLOG_LEVEL_INFO, "OCSP cache reloaded: %zu responses, no nextUpdate",
+             ctx->tls_server->ocsp_cache().status().size());
+    }
+
+    return bResult;
+}
+
 ssize_t connection_read(struct v2g_connection* conn, unsigned char* buf, const std::size_t count) {
     assert(conn != nullptr);
     assert(conn->tls_connection != nullptr);
@@ -24,6 +24,14 @@ int connection_init(struct v2g_context* ctx);
  */
 int connection_start_server(struct v2g_context* ctx);
 
+/*!
+ * \brief connection_update_ocsp_cache reloads the OCSP responses of the V2G certificate chain
+ * from EvseSecurity into the TLS server without touching certificates, keys or open connections
+ * \param ctx v2g connection context
+ * \return returns true on success
+ */
+bool connection_update_ocsp_cache(struct v2g_context* ctx);
+
 /*!
  * \brief connection_read This abstracts a read from the connection socket, so that higher level functions
  * are not required to distinguish between TCP and TLS connections.
@@ -292,8 +292,8 @@ bool load_contract_root_cert(Certificate_ptr& contract_root_crt, const char* V2G
 }
 
 void free_connection_crypto_data(v2g_connection* conn) {
-    mbedtls_ecdsa_free(&conn->ctx->session.contract.pubkey);
-    mbedtls_ecdsa_init(&conn->ctx->session.contract.pubkey);
+    mbedtls_ecdsa_free(&conn->ctx->contract.pubkey);
+    mbedtls_ecdsa_init(&conn->ctx->contract.pubkey);
 }
 
 int load_certificate(Certificate_ptr& crt, const std::uint8_t* bytes, std::uint16_t bytesLen) {
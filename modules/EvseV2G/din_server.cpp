@@ -100,7 +100,7 @@ static v2g_event din_validate_response_code(din_responseCodeType* const din_resp
 
     /* [V2G-DC-391]: check whether the session id matches the expected one of the active session */
     *din_response_code = ((conn->ctx->current_v2g_msg != V2G_SESSION_SETUP_MSG) &&
-                          (conn->ctx->evse_v2g_data.session_id != conn->ctx->ev_v2g_data.received_session_id))
+                          (conn->ctx->evse_v2g_data.session_id != conn->ctx->session.ev_v2g_data.received_session_id))
                              ? din_responseCodeType_FAILED_UnknownSession
                              : *din_response_code;
 
@@ -125,12 +125,12 @@ static v2g_event din_validate_response_code(din_responseCodeType* const din_resp
  * \param din_ev_status the structure the holds the EV Status elements.
  */
 static void publish_DIN_DcEvStatus(struct v2g_context* ctx, const struct din_DC_EVStatusType& din_ev_status) {
-    if ((ctx->ev_v2g_data.din_dc_ev_status.EVErrorCode != din_ev_status.EVErrorCode) ||
-        (ctx->ev_v2g_data.din_dc_ev_status.EVReady != din_ev_status.EVReady) ||
-        (ctx->ev_v2g_data.din_dc_ev_status.EVRESSSOC != din_ev_status.EVRESSSOC)) {
-        ctx->ev_v2g_data.din_dc_ev_status.EVErrorCode = din_ev_status.EVErrorCode;
-        ctx->ev_v2g_data.din_dc_ev_status.EVReady = din_ev_status.EVReady;
-        ctx->ev_v2g_data.din_dc_ev_status.EVRESSSOC = din_ev_status.EVRESSSOC;
+    if ((ctx->session.ev_v2g_data.din_dc_ev_status.EVErrorCode != din_ev_status.EVErrorCode) ||
+        (ctx->session.ev_v2g_data.din_dc_ev_status.EVReady != din_ev_status.EVReady) ||
+        (ctx->session.ev_v2g_data.din_dc_ev_status.EVRESSSOC != din_ev_status.EVRESSSOC)) {
+        ctx->session.ev_v2g_data.din_dc_ev_status.EVErrorCode = din_ev_status.EVErrorCode;
+        ctx->session.ev_v2g_data.din_dc_ev_status.EVReady = din_ev_status.EVReady;
+        ctx->session.ev_v2g_data.din_dc_ev_status.EVRESSSOC = din_ev_status.EVRESSSOC;
 
         types::iso15118_charger::DcEvStatus ev_status;
         ev_status.dc_ev_error_code = static_cast<types::iso15118_charger::DcEvErrorCode>(din_ev_status.EVErrorCode);
@@ -252,13 +252,13 @@ static void publish_din_precharge_req(struct v2g_context* ctx,
 static void publish_din_current_demand_req(struct v2g_context* ctx,
                                            struct din_CurrentDemandReqType const* const v2g_current_demand_req) {
     if ((v2g_current_demand_req->BulkChargingComplete_isUsed == (unsigned int)1) &&
-        (ctx->ev_v2g_data.bulk_charging_complete != v2g_current_demand_req->BulkChargingComplete)) {
+        (ctx->session.ev_v2g_data.bulk_charging_complete != v2g_current_demand_req->BulkChargingComplete)) {
         ctx->p_charger->publish_dc_bulk_charging_complete(v2g_current_demand_req->BulkChargingComplete);
-        ctx->ev_v2g_data.bulk_charging_complete = v2g_current_demand_req->BulkChargingComplete;
+        ctx->session.ev_v2g_data.bulk_charging_complete = v2g_current_demand_req->BulkChargingComplete;
     }
-    if (ctx->ev_v2g_data.charging_complete != v2g_current_demand_req->ChargingComplete) {
+    if (ctx->session.ev_v2g_data.charging_complete != v2g_current_demand_req->ChargingComplete) {
         ctx->p_charger->publish_dc_charging_complete(v2g_current_demand_req->ChargingComplete);
-        ctx->ev_v2g_data.charging_complete = v2g_current_demand_req->ChargingComplete;
+        ctx->session.ev_v2g_data.charging_complete = v2g_current_demand_req->ChargingComplete;
     }
 
     publish_DIN_DcEvStatus(ctx, v2g_current_demand_req->DC_EVStatus);
@@ -463,7 +463,7 @@ static enum v2g_event handle_din_contract_authentication(struct v2g_connection*
 
     /* Fill the EVSE response message */
     res->ResponseCode = din_responseCodeType_OK; // [V2G-DC-388]
-    res->EVSEProcessing = (conn->ctx->evse_v2g_data.evse_processing[PHASE_AUTH] == (uint8_t)0)
+    res->EVSEProcessing = (conn->ctx->session.evse_processing[PHASE_AUTH] == (uint8_t)0)
                               ? din_EVSEProcessingType_Finished
                               : din_EVSEProcessingType_Ongoing;
 
@@ -515,17 +515,17 @@ static enum v2g_event handle_din_charge_parameter(struct v2g_connection* conn) {
 
     /* DC_EVSEChargeParameter */
     res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSEIsolationStatus =
-        (din_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
+        (din_isolationLevelType)conn->ctx->session.evse_isolation_status;
     res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSEIsolationStatus_isUsed =
-        conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+        conn->ctx->session.evse_isolation_status_is_used;
 
     res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSENotification =
-        (din_EVSENotificationType)conn->ctx->evse_v2g_data.evse_notification;
+        (din_EVSENotificationType)conn->ctx->session.evse_notification;
     res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSEStatusCode =
         (true == conn->ctx->intl_emergency_shutdown)
             ? din_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown
-            : (din_DC_EVSEStatusCodeType)conn->ctx->evse_v2g_data.evse_status_code[PHASE_PARAMETER];
-    res->DC_EVSEChargeParameter.DC_EVSEStatus.NotificationMaxDelay = conn->ctx->evse_v2g_data.notification_max_delay;
+            : (din_DC_EVSEStatusCodeType)conn->ctx->session.evse_status_code[PHASE_PARAMETER];
+    res->DC_EVSEChargeParameter.DC_EVSEStatus.NotificationMaxDelay = conn->ctx->session.notification_max_delay;
 
     if (conn->ctx->evse_v2g_data.evse_current_regulation_tolerance_is_used) {
         load_din_physical_value(&res->DC_EVSEChargeParameter.EVSECurrentRegulationTolerance,
@@ -563,7 +563,7 @@ static enum v2g_event handle_din_charge_parameter(struct v2g_connection* conn) {
 
     // res->EVSEChargeParameter.noContent
     res->EVSEChargeParameter_isUsed = (unsigned int)0;
-    res->EVSEProcessing = ((uint8_t)0 == conn->ctx->evse_v2g_data.evse_processing[PHASE_PARAMETER])
+    res->EVSEProcessing = ((uint8_t)0 == conn->ctx->session.evse_processing[PHASE_PARAMETER])
                               ? din_EVSEProcessingType_Finished
                               : din_EVSEProcessingType_Ongoing;
 
@@ -643,14 +643,14 @@ static enum v2g_event handle_din_power_delivery(struct v2g_connection* conn) {
     res->ResponseCode = din_responseCodeType_OK; // [V2G-DC-388]
 
     res->AC_EVSEStatus_isUsed = (unsigned int)0;
-    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
-    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->evse_v2g_data.evse_notification;
-    res->DC_EVSEStatus.NotificationMaxDelay = conn->ctx->evse_v2g_data.notification_max_delay;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->session.evse_notification;
+    res->DC_EVSEStatus.NotificationMaxDelay = conn->ctx->session.notification_max_delay;
     res->DC_EVSEStatus.EVSEStatusCode =
         (conn->ctx->intl_emergency_shutdown == true)
             ? din_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown
-            : (din_DC_EVSEStatusCodeType)conn->ctx->evse_v2g_data.evse_status_code[PHASE_CHARGE];
+            : (din_DC_EVSEStatusCodeType)conn->ctx->session.evse_status_code[PHASE_CHARGE];
     res->DC_EVSEStatus_isUsed = (unsigned int)1;
     res->EVSEStatus_isUsed = (unsigned int)0;
     // res->EVSEStatus.noContent
@@ -721,12 +721,12 @@ static enum v2g_event handle_din_cable_check(struct v2g_connection* conn) {
     /* Now fill the evse response message */
     res->ResponseCode = din_responseCodeType_OK; // [V2G-DC-388]
 
-    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
     res->DC_EVSEStatus.EVSENotification =
-        static_cast<din_EVSENotificationType>(conn->ctx->evse_v2g_data.evse_notification);
-    res->DC_EVSEStatus.NotificationMaxDelay = static_cast<uint32_t>(conn->ctx->evse_v2g_data.notification_max_delay);
-    res->EVSEProcessing = (conn->ctx->evse_v2g_data.evse_processing[PHASE_ISOLATION] == (uint8_t)0)
+        static_cast<din_EVSENotificationType>(conn->ctx->session.evse_notification);
+    res->DC_EVSEStatus.NotificationMaxDelay = static_cast<uint32_t>(conn->ctx->session.notification_max_delay);
+    res->EVSEProcessing = (conn->ctx->session.evse_processing[PHASE_ISOLATION] == (uint8_t)0)
                               ? din_EVSEProcessingType_Finished
                               : din_EVSEProcessingType_Ongoing;
 
@@ -736,7 +736,7 @@ static enum v2g_event handle_din_cable_check(struct v2g_connection* conn) {
         res->DC_EVSEStatus.EVSEStatusCode = din_DC_EVSEStatusCodeType_EVSE_Ready;
     } else {
         res->DC_EVSEStatus.EVSEStatusCode =
-            static_cast<din_DC_EVSEStatusCodeType>(conn->ctx->evse_v2g_data.evse_status_code[PHASE_ISOLATION]);
+            static_cast<din_DC_EVSEStatusCodeType>(conn->ctx->session.evse_status_code[PHASE_ISOLATION]);
     }
 
     /* Check the current response code and check if no external error has occurred */
@@ -782,16 +782,16 @@ static enum v2g_event handle_din_pre_charge(struct v2g_connection* conn) {
     /* Now fill the EVSE response message */
     res->ResponseCode = din_responseCodeType_OK; // [V2G-DC-388]
 
-    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
-    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->evse_v2g_data.evse_notification;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->session.evse_notification;
     res->DC_EVSEStatus.EVSEStatusCode =
         (conn->ctx->intl_emergency_shutdown == true)
             ? din_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown
-            : (din_DC_EVSEStatusCodeType)conn->ctx->evse_v2g_data.evse_status_code[PHASE_PRECHARGE];
-    res->DC_EVSEStatus.NotificationMaxDelay = conn->ctx->evse_v2g_data.notification_max_delay;
+            : (din_DC_EVSEStatusCodeType)conn->ctx->session.evse_status_code[PHASE_PRECHARGE];
+    res->DC_EVSEStatus.NotificationMaxDelay = conn->ctx->session.notification_max_delay;
 
-    load_din_physical_value(&res->EVSEPresentVoltage, &conn->ctx->evse_v2g_data.evse_present_voltage);
+    load_din_physical_value(&res->EVSEPresentVoltage, &conn->ctx->session.evse_present_voltage);
 
     /* Check the current response code and check if no external error has occurred */
     nextEvent = din_validate_response_code(&res->ResponseCode, conn);
@@ -820,14 +820,14 @@ static enum v2g_event handle_din_current_demand(struct v2g_connection* conn) {
     /* Now fill the evse response message */
     res->ResponseCode = din_responseCodeType_OK; // [V2G-DC-388]
 
-    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
-    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->evse_v2g_data.evse_notification;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->session.evse_notification;
     res->DC_EVSEStatus.EVSEStatusCode =
         (conn->ctx->intl_emergency_shutdown == true)
             ? din_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown
-            : (din_DC_EVSEStatusCodeType)conn->ctx->evse_v2g_data.evse_status_code[PHASE_CHARGE];
-    res->DC_EVSEStatus.NotificationMaxDelay = (uint32_t)conn->ctx->evse_v2g_data.notification_max_delay;
+            : (din_DC_EVSEStatusCodeType)conn->ctx->session.evse_status_code[PHASE_CHARGE];
+    res->DC_EVSEStatus.NotificationMaxDelay = (uint32_t)conn->ctx->session.notification_max_delay;
 
     res->EVSECurrentLimitAchieved = conn->ctx->evse_v2g_data.evse_current_limit_achieved;
 
@@ -842,8 +842,8 @@ static enum v2g_event handle_din_current_demand(struct v2g_connection* conn) {
 
     res->EVSEPowerLimitAchieved = conn->ctx->evse_v2g_data.evse_power_limit_achieved;
 
-    load_din_physical_value(&res->EVSEPresentCurrent, &conn->ctx->evse_v2g_data.evse_present_current);
-    load_din_physical_value(&res->EVSEPresentVoltage, &conn->ctx->evse_v2g_data.evse_present_voltage);
+    load_din_physical_value(&res->EVSEPresentCurrent, &conn->ctx->session.evse_present_current);
+    load_din_physical_value(&res->EVSEPresentVoltage, &conn->ctx->session.evse_present_voltage);
 
     res->EVSEVoltageLimitAchieved = conn->ctx->evse_v2g_data.evse_voltage_limit_achieved;
 
@@ -876,16 +876,16 @@ static enum v2g_event handle_din_welding_detection(struct v2g_connection* conn)
     /* Now fill the evse response message */
     res->ResponseCode = din_responseCodeType_OK; // [V2G-DC-388]
 
-    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
-    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->evse_v2g_data.evse_notification;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (din_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSENotification = (din_EVSENotificationType)conn->ctx->session.evse_notification;
     res->DC_EVSEStatus.EVSEStatusCode =
         (conn->ctx->intl_emergency_shutdown == true)
             ? din_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown
-            : (din_DC_EVSEStatusCodeType)conn->ctx->evse_v2g_data.evse_status_code[PHASE_WELDING];
-    res->DC_EVSEStatus.NotificationMaxDelay = (uint32_t)conn->ctx->evse_v2g_data.notification_max_delay;
+            : (din_DC_EVSEStatusCodeType)conn->ctx->session.evse_status_code[PHASE_WELDING];
+    res->DC_EVSEStatus.NotificationMaxDelay = (uint32_t)conn->ctx->session.notification_max_delay;
 
-    load_din_physical_value(&res->EVSEPresentVoltage, &conn->ctx->evse_v2g_data.evse_present_voltage);
+    load_din_physical_value(&res->EVSEPresentVoltage, &conn->ctx->session.evse_present_voltage);
 
     /* Check the current response code and check if no external error has occurred */
     nextEvent = din_validate_response_code(&res->ResponseCode, conn);
@@ -928,7 +928,7 @@ enum v2g_event din_handle_request(v2g_connection* conn) {
     enum v2g_event next_v2g_event = V2G_EVENT_TERMINATE_CONNECTION; // ERROR_UNEXPECTED_REQUEST_MESSAGE;
 
     /* extract session id */
-    conn->ctx->ev_v2g_data.received_session_id = v2g_session_id_from_exi(false, exi_in);
+    conn->ctx->session.ev_v2g_data.received_session_id = v2g_session_id_from_exi(false, exi_in);
 
     /* init V2G structure (document, header, body) */
     init_din_exiDocument(exi_out);
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "exi_codec.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <new>
+
+#include "log.hpp"
+
+#include <cbv2g/app_handshake/appHand_Decoder.h>
+#include <cbv2g/app_handshake/appHand_Encoder.h>
+#include <cbv2g/din/din_msgDefDecoder.h>
+#include <cbv2g/din/din_msgDefEncoder.h>
+#include <cbv2g/iso_2/iso2_msgDefDecoder.h>
+#include <cbv2g/iso_2/iso2_msgDefEncoder.h>
+
+namespace {
+
+template <typename Element> void clear_if_used(Element& element, unsigned int is_used) {
+    if (is_used) {
+        memset(&element, 0, sizeof(element));
+    }
+}
+
+bool uses_iso2(enum v2g_protocol protocol) {
+    return protocol == V2G_PROTO_ISO15118_2013;
+}
+
+template <typename Body> void check_cleared(Body& body, const char* schema) {
+#ifndef NDEBUG
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&body);
+    if (std::all_of(bytes, bytes + sizeof(body), [](unsigned char byte) { return byte == 0; })) {
+        return;
+    }
+    dlog(DLOG_LEVEL_ERROR, "%s response body was not cleared, an element was written without setting its _isUsed flag",
+         schema);
+    memset(&body, 0, sizeof(body));
+#endif
+}
+
+double average_us(const ExiCodec::Timing& timing) {
+    return timing.count ? std::chrono::duration<double, std::micro>(timing.total).count() / timing.count : 0.0;
+}
+
+double max_us(const ExiCodec::Timing& timing) {
+    return std::chrono::duration<double, std::micro>(timing.max).count();
+}
+
+} // namespace
+
+ExiCodec& ExiCodec::shared() {
+    // never destroyed, connection threads are detached and may still release their documents during static destruction
+    static ExiCodec* codec = new ExiCodec();
+    return *codec;
+}
+
+void ExiCodec::set_pool_size(std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pool_size = size;
+    while (free_documents.size() > pool_size) {
+        discard(free_documents.back());
+        free_documents.pop_back();
+    }
+    while (free_documents.size() < pool_size) {
+        auto* allocated = allocate();
+        if (allocated == nullptr) {
+            return;
+        }
+        free_documents.push_back(allocated);
+    }
+}
+
+exi_documents* ExiCodec::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_documents.empty()) {
+        return allocate();
+    }
+    auto* acquired = free_documents.back();
+    free_documents.pop_back();
+    return acquired;
+}
+
+void ExiCodec::release(exi_documents* released) {
+    if (released == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_documents.size() >= pool_size) {
+        discard(released);
+        return;
+    }
+    free_documents.push_back(released);
+}
+
+void ExiCodec::select_protocol(exi_documents* selected, enum v2g_protocol protocol) {
+    if (selected->protocol != V2G_UNKNOWN_PROTOCOL && uses_iso2(selected->protocol) == uses_iso2(protocol)) {
+        selected->protocol = protocol;
+        return;
+    }
+
+    /* the din and iso2 documents share their memory, what one left behind is garbage for the other */
+    memset(&selected->in, 0, sizeof(selected->in));
+    memset(&selected->out, 0, sizeof(selected->out));
+    selected->protocol = protocol;
+}
+
+void ExiCodec::clear_response(struct din_exiDocument* document) {
+    /* the responses din_server.cpp sends */
+    struct din_BodyType& body = document->V2G_Message.Body;
+
+    clear_if_used(body.SessionSetupRes, body.SessionSetupRes_isUsed);
+    clear_if_used(body.ServiceDiscoveryRes, body.ServiceDiscoveryRes_isUsed);
+    clear_if_used(body.ServicePaymentSelectionRes, body.ServicePaymentSelectionRes_isUsed);
+    clear_if_used(body.ContractAuthenticationRes, body.ContractAuthenticationRes_isUsed);
+    clear_if_used(body.ChargeParameterDiscoveryRes, body.ChargeParameterDiscoveryRes_isUsed);
+    clear_if_used(body.PowerDeliveryRes, body.PowerDeliveryRes_isUsed);
+    clear_if_used(body.ChargingStatusRes, body.ChargingStatusRes_isUsed);
+    clear_if_used(body.MeteringReceiptRes, body.MeteringReceiptRes_isUsed);
+    clear_if_used(body.CableCheckRes, body.CableCheckRes_isUsed);
+    clear_if_used(body.PreChargeRes, body.PreChargeRes_isUsed);
+    clear_if_used(body.CurrentDemandRes, body.CurrentDemandRes_isUsed);
+    clear_if_used(body.WeldingDetectionRes, body.WeldingDetectionRes_isUsed);
+    clear_if_used(body.SessionStopRes, body.SessionStopRes_isUsed);
+
+    init_din_BodyType(&body);
+    check_cleared(body, "DIN");
+}
+
+void ExiCodec::clear_response(struct iso2_exiDocument* document) {
+    /* the responses iso_server.cpp sends */
+    struct iso2_BodyType& body = document->V2G_Message.Body;
+
+    clear_if_used(body.SessionSetupRes, body.SessionSetupRes_isUsed);
+    clear_if_used(body.ServiceDiscoveryRes, body.ServiceDiscoveryRes_isUsed);
+    clear_if_used(body.ServiceDetailRes, body.ServiceDetailRes_isUsed);
+    clear_if_used(body.PaymentServiceSelectionRes, body.PaymentServiceSelectionRes_isUsed);
+    clear_if_used(body.PaymentDetailsRes, body.PaymentDetailsRes_isUsed);
+    clear_if_used(body.AuthorizationRes, body.AuthorizationRes_isUsed);
+    clear_if_used(body.ChargeParameterDiscoveryRes, body.ChargeParameterDiscoveryRes_isUsed);
+    clear_if_used(body.PowerDeliveryRes, body.PowerDeliveryRes_isUsed);
+    clear_if_used(body.MeteringReceiptRes, body.MeteringReceiptRes_isUsed);
+    clear_if_used(body.CertificateUpdateRes, body.CertificateUpdateRes_isUsed);
+    clear_if_used(body.CertificateInstallationRes, body.CertificateInstallationRes_isUsed);
+    clear_if_used(body.ChargingStatusRes, body.ChargingStatusRes_isUsed);
+    clear_if_used(body.CableCheckRes, body.CableCheckRes_isUsed);
+    clear_if_used(body.PreChargeRes, body.PreChargeRes_isUsed);
+    clear_if_used(body.CurrentDemandRes, body.CurrentDemandRes_isUsed);
+    clear_if_used(body.WeldingDetectionRes, body.WeldingDetectionRes_isUsed);
+    clear_if_used(body.SessionStopRes, body.SessionStopRes_isUsed);
+
+    init_iso2_BodyType(&body);
+    check_cleared(body, "ISO 15118-2");
+}
+
+void ExiCodec::Counter::add(std::chrono::nanoseconds duration, bool failed) {
+    count++;
+    if (failed) {
+        errors++;
+    }
+    total_ns += duration.count();
+
+    auto max = max_ns.load();
+    while (duration.count() > max && !max_ns.compare_exchange_weak(max, duration.count())) {
+    }
+}
+
+ExiCodec::Timing ExiCodec::Counter::get() const {
+    Timing timing;
+    timing.count = count;
+    timing.errors = errors;
+    timing.total = std::chrono::nanoseconds(total_ns);
+    timing.max = std::chrono::nanoseconds(max_ns);
+    return timing;
+}
+
+template <typename Document>
+int ExiCodec::timed(Counter& counter, int (*codec)(exi_bitstream_t*, Document*), exi_bitstream_t* stream,
+                    Document* document) {
+    const auto start = std::chrono::steady_clock::now();
+    const int rv = codec(stream, document);
+    counter.add(std::chrono::steady_clock::now() - start, rv != 0);
+    return rv;
+}
+
+int ExiCodec::decode(exi_bitstream_t* stream, struct appHand_exiDocument* document) {
+    return timed(decoded, decode_appHand_exiDocument, stream, document);
+}
+
+int ExiCodec::decode(exi_bitstream_t* stream, struct din_exiDocument* document) {
+    return timed(decoded, decode_din_exiDocument, stream, document);
+}
+
+int ExiCodec::decode(exi_bitstream_t* stream, struct iso2_exiDocument* document) {
+    return timed(decoded, decode_iso2_exiDocument, stream, document);
+}
+
+int ExiCodec::encode(exi_bitstream_t* stream, struct appHand_exiDocument* document) {
+    return timed(encoded, encode_appHand_exiDocument, stream, document);
+}
+
+int ExiCodec::encode(exi_bitstream_t* stream, struct din_exiDocument* document) {
+    return timed(encoded, encode_din_exiDocument, stream, document);
+}
+
+int ExiCodec::encode(exi_bitstream_t* stream, struct iso2_exiDocument* document) {
+    return timed(encoded, encode_iso2_exiDocument, stream, document);
+}
+
+exi_documents* ExiCodec::allocate() {
+    auto* allocated = new (std::nothrow) exi_documents();
+    if (allocated == nullptr) {
+        return nullptr;
+    }
+    allocated->protocol = V2G_UNKNOWN_PROTOCOL;
+    documents.emplace_back(allocated);
+    return allocated;
+}
+
+void ExiCodec::discard(exi_documents* discarded) {
+    documents.erase(std::find_if(documents.begin(), documents.end(),
+                                 [discarded](const auto& allocated) { return allocated.get() == discarded; }));
+}
+
+ExiCodec::Stats ExiCodec::get_stats() const {
+    Stats stats;
+    stats.decode = decoded.get();
+    stats.encode = encoded.get();
+    return stats;
+}
+
+void ExiCodec::log_stats() const {
+    const auto stats = get_stats();
+    dlog(DLOG_LEVEL_INFO,
+         "EXI documents decoded: %" PRIu64 " (%" PRIu64 " failed, %.1f us average, %.1f us max), encoded: %" PRIu64
+         " (%" PRIu64 " failed, %.1f us average, %.1f us max)",
+         stats.decode.count, stats.decode.errors, average_us(stats.decode), max_us(stats.decode), stats.encode.count,
+         stats.encode.errors, average_us(stats.encode), max_us(stats.encode));
+}
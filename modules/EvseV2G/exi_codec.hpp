@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EXI_CODEC_HPP
+#define EXI_CODEC_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "v2g.hpp"
+
+/*!
+ * \brief EXI documents of one V2G connection
+ */
+struct exi_documents {
+    struct appHand_exiDocument handshake_req;
+    struct appHand_exiDocument handshake_resp;
+
+    union {
+        struct din_exiDocument din; // DIN 70121 and ISO 15118-2:2010
+        struct iso2_exiDocument iso2;
+    } in, out;
+
+    enum v2g_protocol protocol; // protocol in and out were used with last
+};
+
+/*!
+ * \brief ExiCodec decodes and encodes the EXI documents of all V2G connections of the process.
+ *
+ * The documents are allocated once and handed from one connection to the next instead of being allocated and zeroed
+ * for every connection and message. The decoders initialize everything they fill in, so a request document is used as
+ * it is. Of a response document only the body elements the previous response used are cleared. At most pool_size
+ * documents are kept, documents of further connections at the same time are freed when they are released. Decoding
+ * and encoding is timed.
+ */
+class ExiCodec {
+public:
+    struct Timing {
+        std::uint64_t count{0};
+        std::uint64_t errors{0};
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+    };
+
+    struct Stats {
+        Timing decode;
+        Timing encode;
+    };
+
+    ExiCodec() = default;
+    ExiCodec(const ExiCodec&) = delete;
+    ExiCodec& operator=(const ExiCodec&) = delete;
+
+    /*!
+     * \brief shared codec of the process, its documents are used by the connections of all EvseV2G instances
+     */
+    static ExiCodec& shared();
+
+    /*!
+     * \brief keeps documents for \p size connections, they are allocated up front
+     */
+    void set_pool_size(std::size_t size);
+
+    /*!
+     * \brief hands out documents for one connection, they are only allocated if all others are in use
+     * \return the documents, nullptr if they could not be allocated
+     */
+    exi_documents* acquire();
+
+    /*!
+     * \brief returns \p documents of a closed connection for the next one
+     */
+    void release(exi_documents* documents);
+
+    /*!
+     * \brief prepares the in and out documents for \p protocol, they are only cleared if they were used with the
+     * other schema before
+     */
+    static void select_protocol(exi_documents* documents, enum v2g_protocol protocol);
+
+    /*!
+     * \brief clears the body elements the previous response used, call before the next response is filled in
+     *
+     * Relies on every body element that was written having its _isUsed flag set, as the encoder does not send it
+     * otherwise. The body is all zero afterwards, debug builds check this and clear the whole body if it is not.
+     */
+    static void clear_response(struct din_exiDocument* document);
+    static void clear_response(struct iso2_exiDocument* document);
+
+    int decode(exi_bitstream_t* stream, struct appHand_exiDocument* document);
+    int decode(exi_bitstream_t* stream, struct din_exiDocument* document);
+    int decode(exi_bitstream_t* stream, struct iso2_exiDocument* document);
+
+    int encode(exi_bitstream_t* stream, struct appHand_exiDocument* document);
+    int encode(exi_bitstream_t* stream, struct din_exiDocument* document);
+    int encode(exi_bitstream_t* stream, struct iso2_exiDocument* document);
+
+    Stats get_stats() const;
+
+    /*!
+     * \brief logs the count and timing of everything decoded and encoded since start
+     */
+    void log_stats() const;
+
+private:
+    struct Counter {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> errors{0};
+        std::atomic<std::int64_t> total_ns{0};
+        std::atomic<std::int64_t> max_ns{0};
+
+        void add(std::chrono::nanoseconds duration, bool failed);
+        Timing get() const;
+    };
+
+    // expect mutex to be held
+    exi_documents* allocate();
+    void discard(exi_documents* discarded);
+
+    template <typename Document>
+    static int timed(Counter& counter, int (*codec)(exi_bitstream_t*, Document*), exi_bitstream_t* stream,
+                     Document* document);
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<exi_documents>> documents;
+    std::vector<exi_documents*> free_documents;
+    std::size_t pool_size{1};
+
+    Counter decoded;
+    Counter encoded;
+};
+
+#endif // EXI_CODEC_HPP
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <inttypes.h>
+#include <optional>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,6 +28,7 @@ using namespace openssl;
 using namespace crypto::openssl;
 #endif // EVEREST_MBED_TLS
 
+#include "exi_codec.hpp"
 #include "iso_server.hpp"
 #include "log.hpp"
 #include "tools.hpp"
@@ -95,7 +97,7 @@ static v2g_event iso_validate_response_code(iso2_responseCodeType* const v2g_res
 
     /* [V2G2-460]: check whether the session id matches the expected one of the active session */
     *v2g_response_code = ((conn->ctx->current_v2g_msg != V2G_SESSION_SETUP_MSG) &&
-                          (conn->ctx->evse_v2g_data.session_id != conn->ctx->ev_v2g_data.received_session_id))
+                          (conn->ctx->evse_v2g_data.session_id != conn->ctx->session.ev_v2g_data.received_session_id))
                              ? iso2_responseCodeType_FAILED_UnknownSession
                              : *v2g_response_code;
 
@@ -120,9 +122,9 @@ static v2g_event iso_validate_response_code(iso2_responseCodeType* const v2g_res
  * \param evse_status is the destination struct
  */
 static void populate_ac_evse_status(struct v2g_context* ctx, struct iso2_AC_EVSEStatusType* evse_status) {
-    evse_status->EVSENotification = (iso2_EVSENotificationType)ctx->evse_v2g_data.evse_notification;
-    evse_status->NotificationMaxDelay = ctx->evse_v2g_data.notification_max_delay;
-    evse_status->RCD = ctx->evse_v2g_data.rcd;
+    evse_status->EVSENotification = (iso2_EVSENotificationType)ctx->session.evse_notification;
+    evse_status->NotificationMaxDelay = ctx->session.notification_max_delay;
+    evse_status->RCD = ctx->session.rcd;
 }
 
 /*!
@@ -211,12 +213,12 @@ static void check_iso2_charging_profile_values(iso2_PowerDeliveryReqType* req, i
 }
 
 static void publish_DcEvStatus(struct v2g_context* ctx, const struct iso2_DC_EVStatusType& iso2_ev_status) {
-    if ((ctx->ev_v2g_data.iso2_dc_ev_status.EVErrorCode != iso2_ev_status.EVErrorCode) ||
-        (ctx->ev_v2g_data.iso2_dc_ev_status.EVReady != iso2_ev_status.EVReady) ||
-        (ctx->ev_v2g_data.iso2_dc_ev_status.EVRESSSOC != iso2_ev_status.EVRESSSOC)) {
-        ctx->ev_v2g_data.iso2_dc_ev_status.EVErrorCode = iso2_ev_status.EVErrorCode;
-        ctx->ev_v2g_data.iso2_dc_ev_status.EVReady = iso2_ev_status.EVReady;
-        ctx->ev_v2g_data.iso2_dc_ev_status.EVRESSSOC = iso2_ev_status.EVRESSSOC;
+    if ((ctx->session.ev_v2g_data.iso2_dc_ev_status.EVErrorCode != iso2_ev_status.EVErrorCode) ||
+        (ctx->session.ev_v2g_data.iso2_dc_ev_status.EVReady != iso2_ev_status.EVReady) ||
+        (ctx->session.ev_v2g_data.iso2_dc_ev_status.EVRESSSOC != iso2_ev_status.EVRESSSOC)) {
+        ctx->session.ev_v2g_data.iso2_dc_ev_status.EVErrorCode = iso2_ev_status.EVErrorCode;
+        ctx->session.ev_v2g_data.iso2_dc_ev_status.EVReady = iso2_ev_status.EVReady;
+        ctx->session.ev_v2g_data.iso2_dc_ev_status.EVRESSSOC = iso2_ev_status.EVRESSSOC;
 
         types::iso15118_charger::DcEvStatus ev_status;
         ev_status.dc_ev_error_code = static_cast<types::iso15118_charger::DcEvErrorCode>(iso2_ev_status.EVErrorCode);
@@ -230,7 +232,7 @@ static auto get_emergency_status_code(const struct v2g_context* ctx, uint8_t pha
     if (ctx->intl_emergency_shutdown)
         return iso2_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown;
     else
-        return static_cast<iso2_DC_EVSEStatusCodeType>(ctx->evse_v2g_data.evse_status_code[phase_type]);
+        return static_cast<iso2_DC_EVSEStatusCodeType>(ctx->session.evse_status_code[phase_type]);
 }
 
 //=============================================
@@ -388,13 +390,13 @@ static void publish_iso_power_delivery_req(struct v2g_context* ctx,
 static void publish_iso_current_demand_req(struct v2g_context* ctx,
                                            struct iso2_CurrentDemandReqType const* const v2g_current_demand_req) {
     if ((v2g_current_demand_req->BulkChargingComplete_isUsed == (unsigned int)1) &&
-        (ctx->ev_v2g_data.bulk_charging_complete != v2g_current_demand_req->BulkChargingComplete)) {
+        (ctx->session.ev_v2g_data.bulk_charging_complete != v2g_current_demand_req->BulkChargingComplete)) {
         ctx->p_charger->publish_dc_bulk_charging_complete(v2g_current_demand_req->BulkChargingComplete);
-        ctx->ev_v2g_data.bulk_charging_complete = v2g_current_demand_req->BulkChargingComplete;
+        ctx->session.ev_v2g_data.bulk_charging_complete = v2g_current_demand_req->BulkChargingComplete;
     }
-    if (ctx->ev_v2g_data.charging_complete != v2g_current_demand_req->ChargingComplete) {
+    if (ctx->session.ev_v2g_data.charging_complete != v2g_current_demand_req->ChargingComplete) {
         ctx->p_charger->publish_dc_charging_complete(v2g_current_demand_req->ChargingComplete);
-        ctx->ev_v2g_data.charging_complete = v2g_current_demand_req->ChargingComplete;
+        ctx->session.ev_v2g_data.charging_complete = v2g_current_demand_req->ChargingComplete;
     }
 
     publish_DcEvStatus(ctx, v2g_current_demand_req->DC_EVStatus);
@@ -549,7 +551,7 @@ static enum v2g_event handle_iso_session_setup(struct v2g_connection* conn) {
     /* If no session id is configured, generate one */
     srand((unsigned int)time(NULL));
     if (conn->ctx->evse_v2g_data.session_id == (uint64_t)0 ||
-        conn->ctx->evse_v2g_data.session_id != conn->ctx->ev_v2g_data.received_session_id) {
+        conn->ctx->evse_v2g_data.session_id != conn->ctx->session.ev_v2g_data.received_session_id) {
         conn->ctx->evse_v2g_data.session_id =
             ((uint64_t)rand() << 48) | ((uint64_t)rand() << 32) | ((uint64_t)rand() << 16) | (uint64_t)rand();
         dlog(
@@ -631,7 +633,7 @@ static enum v2g_event handle_iso_service_discovery(struct v2g_connection* conn)
     /* Find requested scope id within evse service list */
     if (req->ServiceScope_isUsed) {
         /* Check if ServiceScope is in evse ServiceList */
-        for (uint8_t idx = 0; idx < conn->ctx->evse_v2g_data.evse_service_list_len; idx++) {
+        for (uint8_t idx = 0; idx < conn->ctx->session.evse_service_list_len; idx++) {
             if ((conn->ctx->evse_v2g_data.evse_service_list[idx].ServiceScope_isUsed == (unsigned int)1) &&
                 (strcmp(conn->ctx->evse_v2g_data.evse_service_list[idx].ServiceScope.characters,
                         req->ServiceScope.characters) == 0)) {
@@ -645,8 +647,8 @@ static enum v2g_event handle_iso_service_discovery(struct v2g_connection* conn)
         indicated in request message. */
     if (scope_idx == (int8_t)-1) {
         memcpy(res->ServiceList.Service.array, conn->ctx->evse_v2g_data.evse_service_list,
-               sizeof(struct iso2_ServiceType) * conn->ctx->evse_v2g_data.evse_service_list_len);
-        res->ServiceList.Service.arrayLen = conn->ctx->evse_v2g_data.evse_service_list_len;
+               sizeof(struct iso2_ServiceType) * conn->ctx->session.evse_service_list_len);
+        res->ServiceList.Service.arrayLen = conn->ctx->session.evse_service_list_len;
     } else {
         /* Offer only the requested ServiceScope entry */
         res->ServiceList.Service.array[0] = conn->ctx->evse_v2g_data.evse_service_list[scope_idx];
@@ -654,7 +656,7 @@ static enum v2g_event handle_iso_service_discovery(struct v2g_connection* conn)
     }
 
     res->ServiceList_isUsed =
-        ((uint16_t)0 < conn->ctx->evse_v2g_data.evse_service_list_len) ? (unsigned int)1 : (unsigned int)0;
+        ((uint16_t)0 < conn->ctx->session.evse_service_list_len) ? (unsigned int)1 : (unsigned int)0;
 
     /* Check the current response code and check if no external error has occurred */
     nextEvent = (v2g_event)iso_validate_response_code(&res->ResponseCode, conn);
@@ -687,19 +689,19 @@ static enum v2g_event handle_iso_service_detail(struct v2g_connection* conn) {
 
     bool service_id_found = false;
 
-    for (uint8_t idx = 0; idx < conn->ctx->evse_v2g_data.evse_service_list_len; idx++) {
+    for (uint8_t idx = 0; idx < conn->ctx->session.evse_service_list_len; idx++) {
 
         if (req->ServiceID == conn->ctx->evse_v2g_data.evse_service_list[idx].ServiceID) {
             service_id_found = true;
 
             /* Fill parameter list of the requested service id [V2G2-549] */
-            for (uint8_t idx2 = 0; idx2 < conn->ctx->evse_v2g_data.service_parameter_list[idx].ParameterSet.arrayLen;
+            for (uint8_t idx2 = 0; idx2 < conn->ctx->session.service_parameter_list[idx].ParameterSet.arrayLen;
                  idx2++) {
                 res->ServiceParameterList.ParameterSet.array[idx2] =
-                    conn->ctx->evse_v2g_data.service_parameter_list[idx].ParameterSet.array[idx2];
+                    conn->ctx->session.service_parameter_list[idx].ParameterSet.array[idx2];
             }
             res->ServiceParameterList.ParameterSet.arrayLen =
-                conn->ctx->evse_v2g_data.service_parameter_list[idx].ParameterSet.arrayLen;
+                conn->ctx->session.service_parameter_list[idx].ParameterSet.arrayLen;
             res->ServiceParameterList_isUsed = (res->ServiceParameterList.ParameterSet.arrayLen != 0) ? 1 : 0;
         }
     }
@@ -771,7 +773,7 @@ static enum v2g_event handle_iso_payment_service_selection(struct v2g_connection
         else {
             bool entry_found = false;
             for (uint8_t ci_idx = 0;
-                 (ci_idx < conn->ctx->evse_v2g_data.evse_service_list_len) && (entry_found == false); ci_idx++) {
+                 (ci_idx < conn->ctx->session.evse_service_list_len) && (entry_found == false); ci_idx++) {
 
                 if (req->SelectedServiceList.SelectedService.array[req_idx].ServiceID ==
                     conn->ctx->evse_v2g_data.evse_service_list[ci_idx].ServiceID) {
@@ -780,12 +782,12 @@ static enum v2g_event handle_iso_payment_service_selection(struct v2g_connection
                          conn->ctx->evse_v2g_data.evse_service_list[ci_idx].ServiceID);
 
                     if (conn->ctx->evse_v2g_data.evse_service_list[ci_idx].ServiceID == SAE_V2H) {
-                        conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2h = true;
-                        conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2g = false;
+                        conn->ctx->session.sae_bidi_data.enabled_sae_v2h = true;
+                        conn->ctx->session.sae_bidi_data.enabled_sae_v2g = false;
                         conn->ctx->p_charger->publish_sae_bidi_mode_active(nullptr);
                     } else if (conn->ctx->evse_v2g_data.evse_service_list[ci_idx].ServiceID == SAE_V2G) {
-                        conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2h = false;
-                        conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2g = true;
+                        conn->ctx->session.sae_bidi_data.enabled_sae_v2h = false;
+                        conn->ctx->session.sae_bidi_data.enabled_sae_v2g = true;
                         conn->ctx->p_charger->publish_sae_bidi_mode_active(nullptr);
                     }
                     entry_found = true;
@@ -817,7 +819,7 @@ static enum v2g_event handle_iso_payment_service_selection(struct v2g_connection
                                                                             // only the ac case... )
     } else {
         dlog(DLOG_LEVEL_INFO, "SelectedPaymentOption: ExternalPayment");
-        conn->ctx->evse_v2g_data.evse_processing[PHASE_AUTH] =
+        conn->ctx->session.evse_processing[PHASE_AUTH] =
             (uint8_t)iso2_EVSEProcessingType_Ongoing_WaitingForCustomerInteraction; // [V2G2-854]
         /* Set next expected req msg */
         conn->ctx->state = (int)
@@ -891,7 +893,7 @@ static enum v2g_event handle_iso_payment_details(struct v2g_connection* conn) {
         // This also verifies that it's an ECDSA key and not an RSA key
 
 #ifdef EVEREST_MBED_TLS
-        err = get_public_key(&conn->ctx->session.contract.pubkey, contract_crt.get()->pk);
+        err = get_public_key(&conn->ctx->contract.pubkey, contract_crt.get()->pk);
 #else
         assert(conn->pubkey != nullptr);
         *conn->pubkey = certificate_public_key(contract_crt.get());
@@ -931,7 +933,7 @@ static enum v2g_event handle_iso_payment_details(struct v2g_connection* conn) {
         std::optional<std::vector<types::iso15118_charger::CertificateHashDataInfo>> iso15118_certificate_hash_data;
 
         /* Only if certificate chain verification should be done locally by the EVSE */
-        if (conn->ctx->session.verify_contract_cert_chain == true) {
+        if (conn->ctx->basic_config.verify_contract_cert_chain == true) {
             std::string v2g_root_cert_path =
                 conn->ctx->r_security->call_get_verify_file(types::evse_security::CaCertificateType::V2G);
             std::string mo_root_cert_path =
@@ -1056,7 +1058,7 @@ static enum v2g_event handle_iso_authorization(struct v2g_connection* conn) {
 
 #ifdef EVEREST_MBED_TLS
         const bool bSigRes = check_iso2_signature(&conn->exi_in.iso2EXIDocument->V2G_Message.Header.Signature,
-                                                  conn->ctx->session.contract.pubkey, &iso2_fragment);
+                                                  conn->ctx->contract.pubkey, &iso2_fragment);
 #else
         assert(conn->pubkey != nullptr);
         const bool bSigRes = check_iso2_signature(&conn->exi_in.iso2EXIDocument->V2G_Message.Header.Signature,
@@ -1068,15 +1070,15 @@ static enum v2g_event handle_iso_authorization(struct v2g_connection* conn) {
             goto error_out;
         }
     }
-    res->EVSEProcessing = (iso2_EVSEProcessingType)conn->ctx->evse_v2g_data.evse_processing[PHASE_AUTH];
+    res->EVSEProcessing = (iso2_EVSEProcessingType)conn->ctx->session.evse_processing[PHASE_AUTH];
 
-    if (conn->ctx->evse_v2g_data.evse_processing[PHASE_AUTH] != iso2_EVSEProcessingType_Finished) {
-        if (((is_payment_option_contract == false) && (conn->ctx->session.auth_timeout_eim == 0)) ||
-            ((is_payment_option_contract == true) && (conn->ctx->session.auth_timeout_pnc == 0))) {
+    if (conn->ctx->session.evse_processing[PHASE_AUTH] != iso2_EVSEProcessingType_Finished) {
+        if (((is_payment_option_contract == false) && (conn->ctx->basic_config.auth_timeout_eim == 0)) ||
+            ((is_payment_option_contract == true) && (conn->ctx->basic_config.auth_timeout_pnc == 0))) {
             dlog(DLOG_LEVEL_DEBUG, "Waiting for authorization forever!");
         } else if ((getmonotonictime() - conn->ctx->session.auth_start_timeout) >=
-                   1000 * (is_payment_option_contract ? conn->ctx->session.auth_timeout_pnc
-                                                      : conn->ctx->session.auth_timeout_eim)) {
+                   1000 * (is_payment_option_contract ? conn->ctx->basic_config.auth_timeout_pnc
+                                                      : conn->ctx->basic_config.auth_timeout_eim)) {
             conn->ctx->session.auth_start_timeout = getmonotonictime();
             res->ResponseCode = iso2_responseCodeType_FAILED;
         }
@@ -1127,7 +1129,7 @@ static enum v2g_event handle_iso_charge_parameter_discovery(struct v2g_connectio
     }
 
     res->EVSEChargeParameter_isUsed = 0;
-    res->EVSEProcessing = (iso2_EVSEProcessingType)conn->ctx->evse_v2g_data.evse_processing[PHASE_PARAMETER];
+    res->EVSEProcessing = (iso2_EVSEProcessingType)conn->ctx->session.evse_processing[PHASE_PARAMETER];
 
     /* Configure SA-schedules*/
     if (res->EVSEProcessing == iso2_EVSEProcessingType_Finished) {
@@ -1243,7 +1245,7 @@ static enum v2g_event handle_iso_charge_parameter_discovery(struct v2g_connectio
         }
     } else {
 
-        if (conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2h == true) {
+        if (conn->ctx->session.sae_bidi_data.enabled_sae_v2h == true) {
             static bool first_req = true;
 
             if (first_req == true) {
@@ -1257,7 +1259,7 @@ static enum v2g_event handle_iso_charge_parameter_discovery(struct v2g_connectio
                     req->DC_EVChargeParameter.EVMaximumPowerLimit_isUsed == 1 &&
                     req->DC_EVChargeParameter.EVMaximumPowerLimit.Value < 0) {
                     // Save bulk soc for minimal soc to stop
-                    conn->ctx->evse_v2g_data.sae_bidi_data.sae_v2h_minimal_soc = req->DC_EVChargeParameter.BulkSOC;
+                    conn->ctx->session.sae_bidi_data.sae_v2h_minimal_soc = req->DC_EVChargeParameter.BulkSOC;
                 } else {
                     res->ResponseCode = iso2_responseCodeType::iso2_responseCodeType_FAILED_WrongEnergyTransferMode;
                 }
@@ -1272,15 +1274,15 @@ static enum v2g_event handle_iso_charge_parameter_discovery(struct v2g_connectio
         res->AC_EVSEChargeParameter_isUsed = 0;
 
         res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSEIsolationStatus =
-            (iso2_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
+            (iso2_isolationLevelType)conn->ctx->session.evse_isolation_status;
         res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSEIsolationStatus_isUsed =
-            conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+            conn->ctx->session.evse_isolation_status_is_used;
         res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSENotification =
-            (iso2_EVSENotificationType)conn->ctx->evse_v2g_data.evse_notification;
+            (iso2_EVSENotificationType)conn->ctx->session.evse_notification;
         res->DC_EVSEChargeParameter.DC_EVSEStatus.EVSEStatusCode =
             get_emergency_status_code(conn->ctx, PHASE_PARAMETER);
         res->DC_EVSEChargeParameter.DC_EVSEStatus.NotificationMaxDelay =
-            (uint16_t)conn->ctx->evse_v2g_data.notification_max_delay;
+            (uint16_t)conn->ctx->session.notification_max_delay;
 
         res->DC_EVSEChargeParameter.EVSECurrentRegulationTolerance =
             conn->ctx->evse_v2g_data.evse_current_regulation_tolerance;
@@ -1406,12 +1408,12 @@ static enum v2g_event handle_iso_power_delivery(struct v2g_connection* conn) {
         res->DC_EVSEStatus_isUsed = 1;
         res->AC_EVSEStatus_isUsed = 0;
         res->DC_EVSEStatus.EVSEIsolationStatus =
-            (iso2_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-        res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+            (iso2_isolationLevelType)conn->ctx->session.evse_isolation_status;
+        res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
         res->DC_EVSEStatus.EVSENotification =
-            static_cast<iso2_EVSENotificationType>(conn->ctx->evse_v2g_data.evse_notification);
+            static_cast<iso2_EVSENotificationType>(conn->ctx->session.evse_notification);
         res->DC_EVSEStatus.EVSEStatusCode = get_emergency_status_code(conn->ctx, PHASE_CHARGE);
-        res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->evse_v2g_data.notification_max_delay;
+        res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->session.notification_max_delay;
 
         res->ResponseCode = (req->ChargeProgress == iso2_chargeProgressType_Start) &&
                                     (res->DC_EVSEStatus.EVSEStatusCode != iso2_DC_EVSEStatusCodeType_EVSE_Ready)
@@ -1449,18 +1451,18 @@ static enum v2g_event handle_iso_power_delivery(struct v2g_connection* conn) {
 
         if (conn->ctx->is_dc_charger == false) {
             // Reset AC relevant parameter to start the renegotation process
-            conn->ctx->evse_v2g_data.evse_notification =
-                (conn->ctx->evse_v2g_data.evse_notification == iso2_EVSENotificationType_ReNegotiation)
+            conn->ctx->session.evse_notification =
+                (conn->ctx->session.evse_notification == iso2_EVSENotificationType_ReNegotiation)
                     ? iso2_EVSENotificationType_None
-                    : conn->ctx->evse_v2g_data.evse_notification;
+                    : conn->ctx->session.evse_notification;
         } else {
             // Reset DC relevant parameter to start the renegotation process
-            conn->ctx->evse_v2g_data.evse_processing[PHASE_ISOLATION] = iso2_EVSEProcessingType_Ongoing;
-            conn->ctx->evse_v2g_data.evse_notification =
-                (iso2_EVSENotificationType_ReNegotiation == conn->ctx->evse_v2g_data.evse_notification)
+            conn->ctx->session.evse_processing[PHASE_ISOLATION] = iso2_EVSEProcessingType_Ongoing;
+            conn->ctx->session.evse_notification =
+                (iso2_EVSENotificationType_ReNegotiation == conn->ctx->session.evse_notification)
                     ? iso2_EVSENotificationType_None
-                    : conn->ctx->evse_v2g_data.evse_notification;
-            conn->ctx->evse_v2g_data.evse_isolation_status = iso2_isolationLevelType_Invalid;
+                    : conn->ctx->session.evse_notification;
+            conn->ctx->session.evse_isolation_status = iso2_isolationLevelType_Invalid;
         }
     } else if ((req->ChargeProgress == iso2_chargeProgressType_Start) &&
                (conn->ctx->last_v2g_msg != V2G_CURRENT_DEMAND_MSG) &&
@@ -1494,18 +1496,18 @@ static enum v2g_event handle_iso_charging_status(struct v2g_connection* conn) {
     /* build up response */
     res->ResponseCode = iso2_responseCodeType_OK;
 
-    res->ReceiptRequired = conn->ctx->evse_v2g_data.receipt_required;
+    res->ReceiptRequired = conn->ctx->session.receipt_required;
     res->ReceiptRequired_isUsed =
         (conn->ctx->session.iso_selected_payment_option == iso2_paymentOptionType_Contract) ? 1U : 0U;
 
-    if (conn->ctx->meter_info.meter_info_is_used == true) {
+    if (conn->ctx->session.meter_info_is_used == true) {
         res->MeterInfo.MeterID.charactersLen = conn->ctx->meter_info.meter_id.bytesLen;
         memcpy(res->MeterInfo.MeterID.characters, conn->ctx->meter_info.meter_id.bytes, iso2_MeterID_CHARACTER_SIZE);
         res->MeterInfo.MeterReading = conn->ctx->meter_info.meter_reading;
         res->MeterInfo.MeterReading_isUsed = 1;
         res->MeterInfo_isUsed = 1;
         // Reset the signal for the next time handle_set_MeterInfo is signaled
-        conn->ctx->meter_info.meter_info_is_used = false;
+        conn->ctx->session.meter_info_is_used = false;
     } else {
         res->MeterInfo_isUsed = 0;
     }
@@ -1611,68 +1613,110 @@ static enum v2g_event handle_iso_certificate_update(struct v2g_connection* conn)
  * \return Returns the next V2G-event.
  */
 static enum v2g_event handle_iso_certificate_installation(struct v2g_connection* conn) {
+    struct iso2_CertificateInstallationReqType* req =
+        &conn->exi_in.iso2EXIDocument->V2G_Message.Body.CertificateInstallationReq;
     struct iso2_CertificateInstallationResType* res =
         &conn->exi_out.iso2EXIDocument->V2G_Message.Body.CertificateInstallationRes;
     enum v2g_event nextEvent = V2G_EVENT_SEND_AND_TERMINATE;
+    CertificateInstallationCache* cache = conn->ctx->cert_install_cache;
+    const uint64_t session_id = conn->ctx->evse_v2g_data.session_id;
+    /* The EV is identified by its OEM provisioning certificate, the eMAID is only known from the response */
+    const std::string ev_id(reinterpret_cast<const char*>(req->OEMProvisioningCert.bytes),
+                            req->OEMProvisioningCert.bytesLen);
+    std::optional<CertificateInstallationCache::Response> response;
+    exi_bitstream_t stream;
+    size_t exi_size = 0;
     struct timespec ts_abs_timeout;
     int rv = 0;
-    /* At first, publish the received EV request message to the customer MQTT interface */
-    if (publish_iso_certificate_installation_exi_req(conn->ctx, conn->buffer + V2GTP_HEADER_LENGTH,
-                                                     conn->stream.data_size - V2GTP_HEADER_LENGTH) == false) {
-        dlog(DLOG_LEVEL_ERROR, "Failed to send CertificateInstallationExiReq");
-        goto exit;
+
+    /* At first, publish the received EV request message to the customer MQTT interface. A retry of the EV is
+     * answered from the cache or waits for the request that is already in flight */
+    if (cache->request(ev_id, session_id, CertificateInstallationCache::clock_t::now()) == true) {
+        if (publish_iso_certificate_installation_exi_req(conn->ctx, conn->buffer + V2GTP_HEADER_LENGTH,
+                                                         conn->stream.data_size - V2GTP_HEADER_LENGTH) == false) {
+            dlog(DLOG_LEVEL_ERROR, "Failed to send CertificateInstallationExiReq");
+            cache->remove(ev_id);
+            goto exit;
+        }
+    } else {
+        dlog(DLOG_LEVEL_INFO, "CertificateInstallationReq of this EV was already sent to the CSMS");
     }
+
     /* Waiting for the CertInstallationExiRes msg */
     clock_gettime(CLOCK_MONOTONIC, &ts_abs_timeout);
     timespec_add_ms(&ts_abs_timeout, V2G_SECC_MSG_CERTINSTALL_TIME);
     dlog(DLOG_LEVEL_INFO, "Waiting for the CertInstallationExiRes msg");
-    while ((rv == 0) && (conn->ctx->evse_v2g_data.cert_install_res_b64_buffer.empty() == true) &&
+    pthread_mutex_lock(&conn->ctx->mqtt_lock);
+    while ((rv == 0) &&
+           (cache->state(ev_id, CertificateInstallationCache::clock_t::now()) ==
+            CertificateInstallationCache::State::Pending) &&
            (conn->ctx->intl_emergency_shutdown == false) && (conn->ctx->stop_hlc == false) &&
            (conn->ctx->is_connection_terminated == false)) { // [V2G2-917]
-        pthread_mutex_lock(&conn->ctx->mqtt_lock);
         rv = pthread_cond_timedwait(&conn->ctx->mqtt_cond, &conn->ctx->mqtt_lock, &ts_abs_timeout);
         if (rv == EINTR)
             rv = 0; /* restart */
         if (rv == ETIMEDOUT) {
             dlog(DLOG_LEVEL_ERROR, "CertificateInstallationRes timeout occured");
+            /* A response arriving later is kept for the retry of the EV */
+            cache->timeout(ev_id);
             conn->ctx->intl_emergency_shutdown = true; // [V2G2-918] Initiating emergency shutdown, response code faild
                                                        // will be set in iso_validate_response_code() function
         }
-        pthread_mutex_unlock(&conn->ctx->mqtt_lock);
+    }
+    pthread_mutex_unlock(&conn->ctx->mqtt_lock);
+
+    response = cache->get(ev_id, session_id, CertificateInstallationCache::clock_t::now());
+    if (response.has_value() == false) {
+        res->ResponseCode = iso2_responseCodeType_FAILED;
+        goto exit;
     }
 
-    if ((conn->ctx->evse_v2g_data.cert_install_res_b64_buffer.empty() == false) &&
-        (conn->ctx->evse_v2g_data.cert_install_status == true)) {
+    /* Decode the base64 stream directly into the connection buffer */
 #ifdef EVEREST_MBED_TLS
-        size_t buffer_pos = 0;
-        if ((rv = mbedtls_base64_decode(
-                 conn->buffer + V2GTP_HEADER_LENGTH, DEFAULT_BUFFER_SIZE, &buffer_pos,
-                 reinterpret_cast<unsigned char*>(conn->ctx->evse_v2g_data.cert_install_res_b64_buffer.data()),
-                 conn->ctx->evse_v2g_data.cert_install_res_b64_buffer.size())) != 0) {
-            char strerr[256];
-            mbedtls_strerror(rv, strerr, 256);
-            dlog(DLOG_LEVEL_ERROR, "Failed to decode base64 stream (-0x%04x) %s", rv, strerr);
-            goto exit;
-        }
-        conn->stream.byte_pos = buffer_pos;
+    if ((rv = mbedtls_base64_decode(conn->buffer + V2GTP_HEADER_LENGTH, DEFAULT_BUFFER_SIZE - V2GTP_HEADER_LENGTH,
+                                    &exi_size, reinterpret_cast<const unsigned char*>(response->exi_b64.data()),
+                                    response->exi_b64.size())) != 0) {
+        char strerr[256];
+        mbedtls_strerror(rv, strerr, 256);
+        dlog(DLOG_LEVEL_ERROR, "Failed to decode base64 stream (-0x%04x) %s", rv, strerr);
+        cache->remove(ev_id);
+        goto exit;
+    }
 #else
-        const auto data = openssl::base64_decode(conn->ctx->evse_v2g_data.cert_install_res_b64_buffer.data(),
-                                                 conn->ctx->evse_v2g_data.cert_install_res_b64_buffer.size());
-        if (data.empty() || (data.size() > DEFAULT_BUFFER_SIZE)) {
-            dlog(DLOG_LEVEL_ERROR, "Failed to decode base64 stream");
-            goto exit;
-        } else {
-            std::memcpy(conn->buffer + V2GTP_HEADER_LENGTH, data.data(), data.size());
-            conn->stream.byte_pos = data.size();
-        }
+    exi_size = DEFAULT_BUFFER_SIZE - V2GTP_HEADER_LENGTH;
+    if (openssl::base64_decode(response->exi_b64.data(), response->exi_b64.size(), conn->buffer + V2GTP_HEADER_LENGTH,
+                               exi_size) == false) {
+        dlog(DLOG_LEVEL_ERROR, "Failed to decode base64 stream");
+        cache->remove(ev_id);
+        goto exit;
+    }
 #endif // EVEREST_MBED_TLS
+
+    /* Decode the EXI stream in place to learn the eMAID and to be able to re-encode it for another session */
+    exi_bitstream_init(&stream, conn->buffer + V2GTP_HEADER_LENGTH, exi_size, 0, nullptr);
+    if ((ExiCodec::shared().decode(&stream, conn->exi_out.iso2EXIDocument) != 0) ||
+        (conn->exi_out.iso2EXIDocument->V2G_Message.Body.CertificateInstallationRes_isUsed == 0)) {
+        dlog(DLOG_LEVEL_ERROR, "Failed to decode CertificateInstallationRes of the CSMS");
+        cache->remove(ev_id);
+        init_iso2_CertificateInstallationResType(res);
+        res->ResponseCode = iso2_responseCodeType_FAILED;
+        goto exit;
+    }
+    response->emaid = std::string(res->eMAID.CONTENT.characters, res->eMAID.CONTENT.charactersLen);
+    cache->set_emaid(ev_id, response->emaid);
+
+    if (response->session_id == session_id) {
+        dlog(DLOG_LEVEL_INFO, "Received CertificateInstallationRes for eMAID %s within %lld ms",
+             response->emaid.c_str(), static_cast<long long>(cache->get_stats().last_latency.count()));
         nextEvent = V2G_EVENT_SEND_RECV_EXI_MSG;
-        res->ResponseCode =
-            iso2_responseCodeType_OK; // Is irrelevant but must be valid to serve the internal validation
-        conn->stream.byte_pos +=
-            V2GTP_HEADER_LENGTH; // byte_pos had only the payload, so increase it to be header + payload
+        conn->stream.byte_pos =
+            exi_size + V2GTP_HEADER_LENGTH; // byte_pos had only the payload, so increase it to be header + payload
     } else {
-        res->ResponseCode = iso2_responseCodeType_FAILED;
+        /* The response was requested in a previous session, it is re-encoded with the current session id */
+        dlog(DLOG_LEVEL_INFO, "Serving cached CertificateInstallationRes for eMAID %s (received %lld s ago)",
+             response->emaid.c_str(),
+             static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(response->age).count()));
+        nextEvent = V2G_EVENT_NO_EVENT;
     }
 
 exit:
@@ -1680,8 +1724,9 @@ exit:
         /* Check the current response code and check if no external error has occurred */
         nextEvent = (enum v2g_event)iso_validate_response_code(&res->ResponseCode, conn);
     } else {
-        /* Reset v2g-msg If there, in case of an error */
-        init_iso2_CertificateInstallationResType(res);
+        /* The decoded response is kept for debugging, the raw EXI stream is sent */
+        res->ResponseCode =
+            iso2_responseCodeType_OK; // Is irrelevant but must be valid to serve the internal validation
     }
 
     /* Set next expected req msg */
@@ -1710,13 +1755,13 @@ static enum v2g_event handle_iso_cable_check(struct v2g_connection* conn) {
 
     /* Fill the CableCheckRes */
     res->ResponseCode = iso2_responseCodeType_OK;
-    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
     res->DC_EVSEStatus.EVSENotification =
-        static_cast<iso2_EVSENotificationType>(conn->ctx->evse_v2g_data.evse_notification);
-    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->evse_v2g_data.notification_max_delay;
+        static_cast<iso2_EVSENotificationType>(conn->ctx->session.evse_notification);
+    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->session.notification_max_delay;
     res->EVSEProcessing =
-        static_cast<iso2_EVSEProcessingType>(conn->ctx->evse_v2g_data.evse_processing[PHASE_ISOLATION]);
+        static_cast<iso2_EVSEProcessingType>(conn->ctx->session.evse_processing[PHASE_ISOLATION]);
 
     if (conn->ctx->intl_emergency_shutdown == false && res->EVSEProcessing == iso2_EVSEProcessingType_Finished) {
         res->DC_EVSEStatus.EVSEStatusCode = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
@@ -1751,13 +1796,13 @@ static enum v2g_event handle_iso_pre_charge(struct v2g_connection* conn) {
     publish_iso_pre_charge_req(conn->ctx, req);
 
     /* Fill the PreChargeRes*/
-    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
     res->DC_EVSEStatus.EVSENotification =
-        static_cast<iso2_EVSENotificationType>(conn->ctx->evse_v2g_data.evse_notification);
+        static_cast<iso2_EVSENotificationType>(conn->ctx->session.evse_notification);
     res->DC_EVSEStatus.EVSEStatusCode = get_emergency_status_code(conn->ctx, PHASE_PRECHARGE);
-    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->evse_v2g_data.notification_max_delay;
-    res->EVSEPresentVoltage = (iso2_PhysicalValueType)conn->ctx->evse_v2g_data.evse_present_voltage;
+    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->session.notification_max_delay;
+    res->EVSEPresentVoltage = (iso2_PhysicalValueType)conn->ctx->session.evse_present_voltage;
     res->ResponseCode = iso2_responseCodeType_OK;
 
     /* Check the current response code and check if no external error has occurred */
@@ -1784,12 +1829,12 @@ static enum v2g_event handle_iso_current_demand(struct v2g_connection* conn) {
     /* At first, publish the received EV request message to the MQTT interface */
     publish_iso_current_demand_req(conn->ctx, req);
 
-    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
     res->DC_EVSEStatus.EVSENotification =
-        static_cast<iso2_EVSENotificationType>(conn->ctx->evse_v2g_data.evse_notification);
+        static_cast<iso2_EVSENotificationType>(conn->ctx->session.evse_notification);
     res->DC_EVSEStatus.EVSEStatusCode = get_emergency_status_code(conn->ctx, PHASE_CHARGE);
-    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->evse_v2g_data.notification_max_delay;
+    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->session.notification_max_delay;
     if ((conn->ctx->evse_v2g_data.evse_maximum_current_limit_is_used == 1) &&
         (calc_physical_value(req->EVTargetCurrent.Value, req->EVTargetCurrent.Multiplier) >=
          calc_physical_value(conn->ctx->evse_v2g_data.evse_maximum_current_limit.Value,
@@ -1817,8 +1862,8 @@ static enum v2g_event handle_iso_current_demand(struct v2g_connection* conn) {
         conn->ctx->evse_v2g_data.evse_power_limit_achieved = (int)0;
     }
     res->EVSEPowerLimitAchieved = conn->ctx->evse_v2g_data.evse_power_limit_achieved;
-    res->EVSEPresentCurrent = conn->ctx->evse_v2g_data.evse_present_current;
-    res->EVSEPresentVoltage = conn->ctx->evse_v2g_data.evse_present_voltage;
+    res->EVSEPresentCurrent = conn->ctx->session.evse_present_current;
+    res->EVSEPresentVoltage = conn->ctx->session.evse_present_voltage;
     if ((conn->ctx->evse_v2g_data.evse_maximum_voltage_limit_is_used == 1) &&
         (calc_physical_value(req->EVTargetVoltage.Value, req->EVTargetVoltage.Multiplier) >=
          calc_physical_value(conn->ctx->evse_v2g_data.evse_maximum_voltage_limit.Value,
@@ -1828,31 +1873,31 @@ static enum v2g_event handle_iso_current_demand(struct v2g_connection* conn) {
         conn->ctx->evse_v2g_data.evse_voltage_limit_achieved = (int)0;
     }
     res->EVSEVoltageLimitAchieved = conn->ctx->evse_v2g_data.evse_voltage_limit_achieved;
-    if (conn->ctx->meter_info.meter_info_is_used == true) {
+    if (conn->ctx->session.meter_info_is_used == true) {
         res->MeterInfo.MeterID.charactersLen = conn->ctx->meter_info.meter_id.bytesLen;
         memcpy(res->MeterInfo.MeterID.characters, conn->ctx->meter_info.meter_id.bytes, iso2_MeterID_CHARACTER_SIZE);
         res->MeterInfo.MeterReading = conn->ctx->meter_info.meter_reading;
         res->MeterInfo.MeterReading_isUsed = 1;
         res->MeterInfo_isUsed = 1;
         // Reset the signal for the next time handle_set_MeterInfo is signaled
-        conn->ctx->meter_info.meter_info_is_used = false;
+        conn->ctx->session.meter_info_is_used = false;
     } else {
         res->MeterInfo_isUsed = 0;
     }
-    res->ReceiptRequired = conn->ctx->evse_v2g_data.receipt_required; // TODO: PNC only
+    res->ReceiptRequired = conn->ctx->session.receipt_required; // TODO: PNC only
     res->ReceiptRequired_isUsed = (conn->ctx->session.iso_selected_payment_option == iso2_paymentOptionType_Contract)
-                                      ? (unsigned int)conn->ctx->evse_v2g_data.receipt_required
+                                      ? (unsigned int)conn->ctx->session.receipt_required
                                       : (unsigned int)0;
     res->ResponseCode = iso2_responseCodeType_OK;
     res->SAScheduleTupleID = conn->ctx->session.sa_schedule_tuple_id;
 
     static uint8_t req_pos_value_count = 0;
 
-    if (conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2g == true) {
+    if (conn->ctx->session.sae_bidi_data.enabled_sae_v2g == true) {
 
         // case: evse initiated -> Negative PresentCurrent, EvseMaxCurrentLimit, EvseMaxCurrentLimit
-        if (conn->ctx->evse_v2g_data.sae_bidi_data.discharging == false &&
-            conn->ctx->evse_v2g_data.evse_present_current.Value < 0 &&
+        if (conn->ctx->session.sae_bidi_data.discharging == false &&
+            conn->ctx->session.evse_present_current.Value < 0 &&
             conn->ctx->evse_v2g_data.evse_maximum_current_limit_is_used == true &&
             conn->ctx->evse_v2g_data.evse_maximum_current_limit.Value < 0 &&
             conn->ctx->evse_v2g_data.evse_maximum_power_limit_is_used == true &&
@@ -1864,11 +1909,11 @@ static enum v2g_event handle_iso_current_demand(struct v2g_connection* conn) {
                     req_pos_value_count = 0;
                 } else {
                     req_pos_value_count = 0;
-                    conn->ctx->evse_v2g_data.sae_bidi_data.discharging = true;
+                    conn->ctx->session.sae_bidi_data.discharging = true;
                 }
             }
-        } else if (conn->ctx->evse_v2g_data.sae_bidi_data.discharging == true &&
-                   conn->ctx->evse_v2g_data.evse_present_current.Value > 0 &&
+        } else if (conn->ctx->session.sae_bidi_data.discharging == true &&
+                   conn->ctx->session.evse_present_current.Value > 0 &&
                    conn->ctx->evse_v2g_data.evse_maximum_current_limit_is_used == true &&
                    conn->ctx->evse_v2g_data.evse_maximum_current_limit.Value > 0 &&
                    conn->ctx->evse_v2g_data.evse_maximum_power_limit_is_used == true &&
@@ -1880,7 +1925,7 @@ static enum v2g_event handle_iso_current_demand(struct v2g_connection* conn) {
                     req_pos_value_count = 0;
                 } else {
                     req_pos_value_count = 0;
-                    conn->ctx->evse_v2g_data.sae_bidi_data.discharging = false;
+                    conn->ctx->session.sae_bidi_data.discharging = false;
                 }
             }
         }
@@ -1889,8 +1934,8 @@ static enum v2g_event handle_iso_current_demand(struct v2g_connection* conn) {
         // Todo(SL): Is it necessary to notify the evse_manager that the ev want to give power/current?
         // Or is it obvious because of the negative target current request.
 
-    } else if (conn->ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2h == true) {
-        if (req->DC_EVStatus.EVRESSSOC <= conn->ctx->evse_v2g_data.sae_bidi_data.sae_v2h_minimal_soc) {
+    } else if (conn->ctx->session.sae_bidi_data.enabled_sae_v2h == true) {
+        if (req->DC_EVStatus.EVRESSSOC <= conn->ctx->session.sae_bidi_data.sae_v2h_minimal_soc) {
             res->DC_EVSEStatus.EVSEStatusCode = iso2_DC_EVSEStatusCodeType_EVSE_Shutdown;
         }
     }
@@ -1924,13 +1969,13 @@ static enum v2g_event handle_iso_welding_detection(struct v2g_connection* conn)
     // TODO: Wait for CP state B, before transmitting of the response, or signal intl_emergency_shutdown in conn->ctx
     // ([V2G2-920], [V2G2-921]).
 
-    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->evse_v2g_data.evse_isolation_status;
-    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->evse_v2g_data.evse_isolation_status_is_used;
+    res->DC_EVSEStatus.EVSEIsolationStatus = (iso2_isolationLevelType)conn->ctx->session.evse_isolation_status;
+    res->DC_EVSEStatus.EVSEIsolationStatus_isUsed = conn->ctx->session.evse_isolation_status_is_used;
     res->DC_EVSEStatus.EVSENotification =
-        static_cast<iso2_EVSENotificationType>(conn->ctx->evse_v2g_data.evse_notification);
+        static_cast<iso2_EVSENotificationType>(conn->ctx->session.evse_notification);
     res->DC_EVSEStatus.EVSEStatusCode = get_emergency_status_code(conn->ctx, PHASE_WELDING);
-    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->evse_v2g_data.notification_max_delay;
-    res->EVSEPresentVoltage = conn->ctx->evse_v2g_data.evse_present_voltage;
+    res->DC_EVSEStatus.NotificationMaxDelay = (uint16_t)conn->ctx->session.notification_max_delay;
+    res->EVSEPresentVoltage = conn->ctx->session.evse_present_voltage;
     res->ResponseCode = iso2_responseCodeType_OK;
 
     /* Check the current response code and check if no external error has occurred */
@@ -2000,7 +2045,7 @@ enum v2g_event iso_handle_request(v2g_connection* conn) {
     enum v2g_event next_v2g_event = V2G_EVENT_TERMINATE_CONNECTION;
 
     /* extract session id */
-    conn->ctx->ev_v2g_data.received_session_id = v2g_session_id_from_exi(true, exi_in);
+    conn->ctx->session.ev_v2g_data.received_session_id = v2g_session_id_from_exi(true, exi_in);
 
     /* init V2G structure (document, header, body) */
     init_iso2_exiDocument(exi_out);
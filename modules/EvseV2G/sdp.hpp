@@ -6,7 +6,22 @@
 
 #include "v2g.hpp"
 
+/*!
+ * \brief sdp_init registers the interface of the context at the shared SDP responder of the process
+ * \return 0 on success, -1 on error
+ */
 int sdp_init(struct v2g_context* v2g_ctx);
+
+/*!
+ * \brief sdp_listen starts announcing the V2G servers of the context, must be called after they have been started.
+ * Requests are answered by the thread of the shared SDP responder, so this function does not block.
+ * \return 0 on success, -1 on error
+ */
 int sdp_listen(struct v2g_context* v2g_ctx);
 
+/*!
+ * \brief sdp_close stops answering SDP requests on the interface of the context
+ */
+void sdp_close(struct v2g_context* v2g_ctx);
+
 #endif /* SDP_H */
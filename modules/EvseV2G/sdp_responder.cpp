@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "sdp_responder.hpp"
+#include "log.hpp"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <net/if.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* defines for V2G SDP implementation */
+#define SDP_VERSION         0x01
+#define SDP_INVERSE_VERSION 0xfe
+
+#define SDP_HEADER_LEN           8
+#define SDP_REQUEST_PAYLOAD_LEN  2
+#define SDP_RESPONSE_PAYLOAD_LEN 20
+
+#define SDP_REQUEST_TYPE  0x9000
+#define SDP_RESPONSE_TYPE 0x9001
+
+#define MAX_EVENTS 16
+
+enum sdp_security {
+    SDP_SECURITY_TLS = 0x00,
+    SDP_SECURITY_NONE = 0x10,
+};
+
+enum sdp_transport_protocol {
+    SDP_TRANSPORT_PROTOCOL_TCP = 0x00,
+    SDP_TRANSPORT_PROTOCOL_UDP = 0x10,
+};
+
+/* link-local multicast address ff02::1 aka ip6-allnodes */
+#define IN6ADDR_ALLNODES                                                                                               \
+    { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 }
+
+static_assert(SDP_HEADER_LEN + SDP_RESPONSE_PAYLOAD_LEN == 28, "SdpResponder::RESPONSE_LEN does not match");
+
+/*
+ * Fills the SDP header into a given buffer
+ */
+static int sdp_write_header(uint8_t* buffer, uint16_t payload_type, uint32_t payload_len) {
+    int offset = 0;
+
+    buffer[offset++] = SDP_VERSION;
+    buffer[offset++] = SDP_INVERSE_VERSION;
+
+    /* payload is network byte order */
+    buffer[offset++] = (payload_type >> 8) & 0xff;
+    buffer[offset++] = payload_type & 0xff;
+
+    /* payload_length is network byte order */
+    buffer[offset++] = (payload_len >> 24) & 0xff;
+    buffer[offset++] = (payload_len >> 16) & 0xff;
+    buffer[offset++] = (payload_len >> 8) & 0xff;
+    buffer[offset++] = payload_len & 0xff;
+
+    return offset;
+}
+
+static int sdp_validate_header(const uint8_t* buffer, uint16_t expected_payload_type, uint32_t expected_payload_len) {
+    uint16_t payload_type;
+    uint32_t payload_len;
+
+    if (buffer[0] != SDP_VERSION) {
+        dlog(DLOG_LEVEL_ERROR, "Invalid SDP version");
+        return -1;
+    }
+
+    if (buffer[1] != SDP_INVERSE_VERSION) {
+        dlog(DLOG_LEVEL_ERROR, "Invalid SDP inverse version");
+        return -1;
+    }
+
+    payload_type = (buffer[2] << 8) + buffer[3];
+    if (payload_type != expected_payload_type) {
+        dlog(DLOG_LEVEL_ERROR, "Invalid payload type: expected %" PRIu16 ", received %" PRIu16, expected_payload_type,
+             payload_type);
+        return -1;
+    }
+
+    payload_len = (buffer[4] << 24) + (buffer[5] << 16) + (buffer[6] << 8) + buffer[7];
+    if (payload_len != expected_payload_len) {
+        dlog(DLOG_LEVEL_ERROR, "Invalid payload length: expected %" PRIu32 ", received %" PRIu32, expected_payload_len,
+             payload_len);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sdp_create_response(uint8_t* buffer, const struct sockaddr_in6* addr, enum sdp_security security,
+                               enum sdp_transport_protocol proto) {
+    int offset = SDP_HEADER_LEN;
+
+    /* fill in first the payload */
+
+    /* address is already network byte order */
+    memcpy(&buffer[offset], &addr->sin6_addr, sizeof(addr->sin6_addr));
+    offset += sizeof(addr->sin6_addr);
+
+    memcpy(&buffer[offset], &addr->sin6_port, sizeof(addr->sin6_port));
+    offset += sizeof(addr->sin6_port);
+
+    buffer[offset++] = security;
+    buffer[offset++] = proto;
+
+    /* now fill in the header with payload length */
+    sdp_write_header(buffer, SDP_RESPONSE_TYPE, offset - SDP_HEADER_LEN);
+
+    return offset;
+}
+
+static bool same_address(const std::optional<sockaddr_in6>& current, const sockaddr_in6* addr) {
+    if (!current.has_value() || addr == nullptr) {
+        return !current.has_value() && addr == nullptr;
+    }
+    return memcmp(&current->sin6_addr, &addr->sin6_addr, sizeof(addr->sin6_addr)) == 0 &&
+           current->sin6_port == addr->sin6_port;
+}
+
+SdpResponder::SdpResponder() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        dlog(DLOG_LEVEL_ERROR, "epoll_create1() failed: %s", strerror(errno));
+        return;
+    }
+
+    wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd == -1) {
+        dlog(DLOG_LEVEL_ERROR, "eventfd() failed: %s", strerror(errno));
+        return;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = wakeup_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "epoll_ctl() failed: %s", strerror(errno));
+    }
+}
+
+SdpResponder::~SdpResponder() {
+    if (running.exchange(false)) {
+        const uint64_t wakeup = 1;
+        if (write(wakeup_fd, &wakeup, sizeof(wakeup)) == -1) {
+            dlog(DLOG_LEVEL_ERROR, "write() to eventfd failed: %s", strerror(errno));
+        }
+        loop.join();
+    }
+
+    for (const auto& [socket, interface] : interfaces) {
+        close(socket);
+    }
+    if (wakeup_fd != -1) {
+        close(wakeup_fd);
+    }
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+    }
+}
+
+SdpResponder& SdpResponder::shared() {
+    // never destroyed, the EvseV2G instances may remove their interface during static destruction
+    static SdpResponder* responder = new SdpResponder();
+    return *responder;
+}
+
+int SdpResponder::add_interface(const std::string& if_name, std::uint16_t port) {
+    struct sockaddr_in6 sdp_addr = {AF_INET6, htons(port)};
+    struct ipv6_mreq mreq = {{IN6ADDR_ALLNODES}, 0};
+    int enable = 1;
+
+    if (epoll_fd == -1 || wakeup_fd == -1) {
+        return -1;
+    }
+
+    mreq.ipv6mr_interface = if_nametoindex(if_name.c_str());
+    if (!mreq.ipv6mr_interface) {
+        dlog(DLOG_LEVEL_ERROR, "No such interface: %s", if_name.c_str());
+        return -1;
+    }
+
+    /* create receiving socket, non blocking to read bursts until the queue is empty */
+    int sdp_socket = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (sdp_socket == -1) {
+        dlog(DLOG_LEVEL_ERROR, "socket() failed: %s", strerror(errno));
+        return -1;
+    }
+
+    if (setsockopt(sdp_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "setsockopt(SO_REUSEPORT) failed: %s", strerror(errno));
+        close(sdp_socket);
+        return -1;
+    }
+
+    /* bind only to specified device, before bind() so that no request of another device is queued */
+    if (setsockopt(sdp_socket, SOL_SOCKET, SO_BINDTODEVICE, if_name.c_str(), if_name.size()) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "setsockopt(SO_BINDTODEVICE) failed: %s", strerror(errno));
+        close(sdp_socket);
+        return -1;
+    }
+
+    sdp_addr.sin6_addr = in6addr_any;
+
+    if (bind(sdp_socket, (struct sockaddr*)&sdp_addr, sizeof(sdp_addr)) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "bind() failed: %s", strerror(errno));
+        close(sdp_socket);
+        return -1;
+    }
+
+    /* join multicast group */
+    if (setsockopt(sdp_socket, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mreq, sizeof(mreq)) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "setsockopt(IPV6_JOIN_GROUP) failed: %s", strerror(errno));
+        close(sdp_socket);
+        return -1;
+    }
+
+    {
+        /* the socket is added to the epoll set by set_addresses(), requests are queued until then */
+        std::lock_guard<std::mutex> lock(mutex);
+        interfaces[sdp_socket].name = if_name;
+    }
+
+    dlog(DLOG_LEVEL_INFO, "SDP socket setup on %s succeeded", if_name.c_str());
+
+    start();
+    return sdp_socket;
+}
+
+void SdpResponder::set_addresses(int id, const sockaddr_in6* tcp_addr, const sockaddr_in6* tls_addr) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = interfaces.find(id);
+    if (it == interfaces.end()) {
+        return;
+    }
+
+    auto& interface = it->second;
+    if (!same_address(interface.tcp_addr, tcp_addr) || !same_address(interface.tls_addr, tls_addr)) {
+        interface.tcp_addr = tcp_addr ? std::make_optional(*tcp_addr) : std::nullopt;
+        interface.tls_addr = tls_addr ? std::make_optional(*tls_addr) : std::nullopt;
+        build_responses(interface);
+    }
+
+    if (interface.listening) {
+        return;
+    }
+
+    /* answer the requests queued since add_interface() with the responses just built */
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, id, &event) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "epoll_ctl() failed: %s", strerror(errno));
+        return;
+    }
+    interface.listening = true;
+}
+
+void SdpResponder::remove_interface(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (interfaces.erase(id) == 0) {
+        return;
+    }
+    // closing the socket also removes it from the epoll set
+    if (close(id) == -1) {
+        dlog(DLOG_LEVEL_ERROR, "close() failed: %s", strerror(errno));
+    }
+}
+
+SdpResponder::Stats SdpResponder::get_stats(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = interfaces.find(id);
+    return it != interfaces.end() ? it->second.stats : Stats{};
+}
+
+void SdpResponder::build_responses(Interface& interface) {
+    const auto build = [](const sockaddr_in6& addr, sdp_security security) {
+        Response response;
+        sdp_create_response(response.data(), &addr, security, SDP_TRANSPORT_PROTOCOL_TCP);
+        return response;
+    };
+
+    std::optional<Response> tls;
+    std::optional<Response> no_tls;
+    if (interface.tls_addr.has_value()) {
+        tls = build(interface.tls_addr.value(), SDP_SECURITY_TLS);
+    }
+    if (interface.tcp_addr.has_value()) {
+        no_tls = build(interface.tcp_addr.value(), SDP_SECURITY_NONE);
+    }
+
+    /* announce the requested security if available, the other one otherwise */
+    interface.responses[0] = tls.has_value() ? tls : no_tls;
+    interface.responses[1] = no_tls.has_value() ? no_tls : tls;
+}
+
+void SdpResponder::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    loop = std::thread(&SdpResponder::run, this);
+}
+
+void SdpResponder::run() {
+    struct epoll_event events[MAX_EVENTS];
+
+    while (running) {
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (count == -1) {
+            if (errno != EINTR) {
+                dlog(DLOG_LEVEL_ERROR, "epoll_wait() failed: %s", strerror(errno));
+            }
+            continue;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd != wakeup_fd) {
+                handle_requests(events[i].data.fd);
+            }
+        }
+    }
+}
+
+void SdpResponder::handle_requests(int socket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = interfaces.find(socket);
+    if (it == interfaces.end()) {
+        /* removed while the event was pending */
+        return;
+    }
+    auto& interface = it->second;
+
+    /* read until the queue is empty, so a burst of requests is answered in one wakeup */
+    while (true) {
+        uint8_t buffer[SDP_HEADER_LEN + SDP_REQUEST_PAYLOAD_LEN];
+        struct sockaddr_in6 remote_addr;
+        socklen_t addrlen = sizeof(remote_addr);
+
+        ssize_t len = recvfrom(socket, buffer, sizeof(buffer), 0, (struct sockaddr*)&remote_addr, &addrlen);
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                dlog(DLOG_LEVEL_ERROR, "recvfrom() failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        char addrbuf[INET6_ADDRSTRLEN] = {0};
+        const char* addr = inet_ntop(AF_INET6, &remote_addr.sin6_addr, addrbuf, sizeof(addrbuf));
+
+        if (len != sizeof(buffer)) {
+            dlog(DLOG_LEVEL_WARNING, "Discarded packet from [%s]:%" PRIu16 " due to unexpected length %zd", addr,
+                 ntohs(remote_addr.sin6_port), len);
+            interface.stats.discarded++;
+            continue;
+        }
+
+        if (sdp_validate_header(buffer, SDP_REQUEST_TYPE, SDP_REQUEST_PAYLOAD_LEN)) {
+            dlog(DLOG_LEVEL_WARNING, "Packet with invalid SDP header received from [%s]:%" PRIu16, addr,
+                 ntohs(remote_addr.sin6_port));
+            interface.stats.discarded++;
+            continue;
+        }
+
+        interface.stats.requests++;
+        const uint8_t security = buffer[SDP_HEADER_LEN + 0];
+        const uint8_t proto = buffer[SDP_HEADER_LEN + 1];
+
+        /* at the moment we only understand TCP protocol */
+        const std::optional<Response>* response = nullptr;
+        if (proto == SDP_TRANSPORT_PROTOCOL_TCP) {
+            if (security == SDP_SECURITY_TLS) {
+                response = &interface.responses[0];
+            } else if (security == SDP_SECURITY_NONE) {
+                response = &interface.responses[1];
+            }
+        }
+
+        if (response == nullptr || !response->has_value()) {
+            dlog(DLOG_LEVEL_ERROR,
+                 "SDP request from [%s]:%" PRIu16 " on %s with security 0x%02x and protocol 0x%02x, announcing nothing",
+                 addr, ntohs(remote_addr.sin6_port), interface.name.c_str(), security, proto);
+            interface.stats.discarded++;
+            continue;
+        }
+
+        const auto& packet = response->value();
+        if (sendto(socket, packet.data(), packet.size(), 0, (struct sockaddr*)&remote_addr, sizeof(remote_addr)) !=
+            static_cast<ssize_t>(packet.size())) {
+            dlog(DLOG_LEVEL_ERROR, "sendto([%s]:%" PRIu16 ") failed: %s", addr, ntohs(remote_addr.sin6_port),
+                 strerror(errno));
+            interface.stats.discarded++;
+            continue;
+        }
+        interface.stats.responses++;
+
+        dlog(DLOG_LEVEL_INFO,
+             "SDP request from [%s]:%" PRIu16 " on %s with security 0x%02x and protocol 0x%02x, announced %s", addr,
+             ntohs(remote_addr.sin6_port), interface.name.c_str(), security, proto,
+             packet[SDP_HEADER_LEN + 18] == SDP_SECURITY_TLS ? "TLS" : "NO-TLS");
+    }
+}
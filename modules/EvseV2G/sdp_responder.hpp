@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef SDP_RESPONDER_HPP
+#define SDP_RESPONDER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <netinet/in.h>
+
+/*!
+ * \brief SdpResponder answers the SECC Discovery Protocol requests of all interfaces registered in the process from
+ * one epoll loop.
+ *
+ * Every interface has its own UDP socket bound to the device, so requests are answered with the addresses of the V2G
+ * servers of the interface they came in on. The responses are built when the addresses are set, a request is answered
+ * with a single sendto() and logged afterwards.
+ */
+class SdpResponder {
+public:
+    static constexpr std::uint16_t SDP_SERVER_PORT = 15118;
+
+    struct Stats {
+        std::uint64_t requests{0}; //!< valid requests received
+        std::uint64_t responses{0};
+        std::uint64_t discarded{0}; //!< invalid requests and requests that could not be answered
+    };
+
+    SdpResponder();
+    ~SdpResponder();
+    SdpResponder(const SdpResponder&) = delete;
+    SdpResponder& operator=(const SdpResponder&) = delete;
+
+    /*!
+     * \brief shared responder of the process, all EvseV2G instances in one process register their interface there
+     */
+    static SdpResponder& shared();
+
+    /*!
+     * \brief opens the SDP socket on \p if_name, requests are queued and answered once addresses are set
+     * \param port UDP port, SDP_SERVER_PORT except in tests
+     * \return id of the interface for the other calls, -1 on error
+     */
+    int add_interface(const std::string& if_name, std::uint16_t port = SDP_SERVER_PORT);
+
+    /*!
+     * \brief sets the addresses of the V2G servers announced on interface \p id, nullptr for a server that is not
+     * running. The responses are only rebuilt if an address changed. The first call starts answering requests.
+     */
+    void set_addresses(int id, const sockaddr_in6* tcp_addr, const sockaddr_in6* tls_addr);
+
+    /*!
+     * \brief closes the SDP socket of interface \p id, no request of it is answered after this returns
+     */
+    void remove_interface(int id);
+
+    Stats get_stats(int id);
+
+private:
+    static constexpr std::size_t RESPONSE_LEN = 28;
+    using Response = std::array<std::uint8_t, RESPONSE_LEN>;
+
+    struct Interface {
+        std::string name;
+        std::optional<sockaddr_in6> tcp_addr;
+        std::optional<sockaddr_in6> tls_addr;
+        // prebuilt responses, index 0 for requests of TLS, 1 for requests without TLS
+        std::array<std::optional<Response>, 2> responses;
+        bool listening{false}; //!< socket is in the epoll set
+        Stats stats;
+    };
+
+    void start();
+    void run();
+    void handle_requests(int socket);
+    static void build_responses(Interface& interface);
+
+    std::mutex mutex;
+    // keyed by socket
+    std::map<int, Interface> interfaces;
+
+    int epoll_fd{-1};
+    int wakeup_fd{-1};
+    std::atomic<bool> running{false};
+    std::thread loop;
+};
+
+#endif // SDP_RESPONDER_HPP
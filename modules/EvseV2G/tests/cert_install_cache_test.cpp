@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "gtest/gtest.h"
+#include <cert_install_cache.hpp>
+
+namespace {
+
+using State = CertificateInstallationCache::State;
+using namespace std::chrono_literals;
+
+constexpr std::uint64_t session_a = 0x1122334455667788;
+constexpr std::uint64_t session_b = 0x8877665544332211;
+
+TEST(CertificateInstallationCache, responseInSameSession) {
+    CertificateInstallationCache cache(3600s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    EXPECT_TRUE(cache.request("ev1", session_a, t0));
+    EXPECT_EQ(cache.state("ev1", t0), State::Pending);
+
+    cache.respond(std::string("AAEC"), true, t0 + 1200ms);
+    EXPECT_EQ(cache.state("ev1", t0 + 1200ms), State::Available);
+
+    const auto response = cache.get("ev1", session_a, t0 + 1200ms);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->exi_b64, "AAEC");
+    EXPECT_EQ(response->session_id, session_a);
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.requests_published, 1);
+    EXPECT_EQ(stats.cache_hits, 0);
+    EXPECT_EQ(stats.late_responses, 0);
+    EXPECT_EQ(stats.last_latency, 1200ms);
+}
+
+TEST(CertificateInstallationCache, lateResponseServesRetry) {
+    CertificateInstallationCache cache(3600s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    ASSERT_TRUE(cache.request("ev1", session_a, t0));
+    // the EV gives up after 5 s, the CSMS answers after 8 s
+    cache.timeout("ev1");
+    cache.respond(std::string("AAEC"), true, t0 + 8s);
+
+    // the retry in a new session is neither published nor does it wait
+    EXPECT_FALSE(cache.request("ev1", session_b, t0 + 20s));
+    EXPECT_EQ(cache.state("ev1", t0 + 20s), State::Available);
+    const auto response = cache.get("ev1", session_b, t0 + 20s);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->session_id, session_a);
+    EXPECT_EQ(response->age, 12s);
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.requests_published, 1);
+    EXPECT_EQ(stats.cache_hits, 1);
+    EXPECT_EQ(stats.late_responses, 1);
+    EXPECT_EQ(stats.max_latency, 8000ms);
+}
+
+TEST(CertificateInstallationCache, retryWhileInFlight) {
+    CertificateInstallationCache cache(3600s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    ASSERT_TRUE(cache.request("ev1", session_a, t0));
+    cache.timeout("ev1");
+    EXPECT_FALSE(cache.request("ev1", session_b, t0 + 10s));
+    EXPECT_EQ(cache.get_stats().requests_deduplicated, 1);
+
+    // the EV waits again, so the response is not late anymore
+    cache.respond(std::string("AAEC"), true, t0 + 12s);
+    EXPECT_EQ(cache.get_stats().late_responses, 0);
+
+    // a request without response is published again after the request timeout
+    ASSERT_TRUE(cache.request("ev2", session_a, t0));
+    EXPECT_TRUE(cache.request("ev2", session_b, t0 + 61s));
+    EXPECT_EQ(cache.get_stats().requests_published, 3);
+}
+
+TEST(CertificateInstallationCache, failedResponse) {
+    CertificateInstallationCache cache(3600s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    ASSERT_TRUE(cache.request("ev1", session_a, t0));
+    cache.respond(std::nullopt, false, t0 + 1s);
+    EXPECT_EQ(cache.state("ev1", t0 + 1s), State::Failed);
+    EXPECT_FALSE(cache.get("ev1", session_a, t0 + 1s).has_value());
+    EXPECT_EQ(cache.get_stats().failed_responses, 1);
+
+    // an accepted response without EXI stream can not be used either
+    EXPECT_TRUE(cache.request("ev1", session_b, t0 + 2s));
+    cache.respond(std::string(), true, t0 + 3s);
+    EXPECT_EQ(cache.state("ev1", t0 + 3s), State::Failed);
+}
+
+TEST(CertificateInstallationCache, expiry) {
+    CertificateInstallationCache cache(600s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    ASSERT_TRUE(cache.request("ev1", session_a, t0));
+    cache.respond(std::string("AAEC"), true, t0 + 1s);
+    ASSERT_TRUE(cache.get("ev1", session_a, t0 + 1s).has_value());
+    cache.set_emaid("ev1", "DEPNXC12345678");
+
+    const auto cached = cache.get("ev1", session_b, t0 + 600s);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->emaid, "DEPNXC12345678");
+
+    EXPECT_EQ(cache.state("ev1", t0 + 601s), State::None);
+    EXPECT_TRUE(cache.request("ev1", session_b, t0 + 601s));
+}
+
+TEST(CertificateInstallationCache, disabledCacheStillServesWaitingRequest) {
+    CertificateInstallationCache cache(0s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    ASSERT_TRUE(cache.request("ev1", session_a, t0));
+    cache.respond(std::string("AAEC"), true, t0 + 2s);
+    ASSERT_TRUE(cache.get("ev1", session_a, t0 + 2s).has_value());
+    EXPECT_FALSE(cache.get("ev1", session_b, t0 + 2s).has_value());
+    EXPECT_TRUE(cache.request("ev1", session_b, t0 + 3s));
+}
+
+TEST(CertificateInstallationCache, remove) {
+    CertificateInstallationCache cache(3600s, 60s);
+    const auto t0 = CertificateInstallationCache::clock_t::now();
+
+    ASSERT_TRUE(cache.request("ev1", session_a, t0));
+    cache.remove("ev1");
+    // a response for a removed request is dropped
+    cache.respond(std::string("AAEC"), true, t0 + 1s);
+    EXPECT_EQ(cache.state("ev1", t0 + 1s), State::None);
+    EXPECT_EQ(cache.get_stats().last_latency, 0ms);
+}
+
+} // namespace
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// CPU time of a CurrentDemandReq/Res round trip: decode the request, fill in the response like iso_server.cpp does and
+// encode it. Compared are documents zeroed for every message, as v2g_server.cpp did before, and the documents of the
+// ExiCodec, of which only the previous response is cleared.
+//
+// EXI_CODEC_BENCHMARK_ITERATIONS        round trips per variant (default 20000)
+// EXI_CODEC_BENCHMARK_MIN_SPEEDUP_PERCENT
+//                                       fail if the codec documents are not this much faster, 100 is as fast as
+//                                       before (default 0, only report)
+
+#include "gtest/gtest.h"
+
+#include <exi_codec.hpp>
+
+#include <cbv2g/common/exi_bitstream.h>
+#include <cbv2g/iso_2/iso2_msgDefDecoder.h>
+#include <cbv2g/iso_2/iso2_msgDefEncoder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t SESSION_ID = 0x0102030405060708;
+constexpr char EVSE_ID[] = "DE*PNX*E12345*1";
+
+int env_or(const char* name, int default_value) {
+    const auto* value = std::getenv(name);
+    return value != nullptr ? std::atoi(value) : default_value;
+}
+
+template <typename Function> std::chrono::nanoseconds cpu_time(Function&& function) {
+    timespec start{};
+    timespec end{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    function();
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+    return std::chrono::seconds(end.tv_sec - start.tv_sec) + std::chrono::nanoseconds(end.tv_nsec - start.tv_nsec);
+}
+
+void set_physical_value(iso2_PhysicalValueType& value, std::int16_t number, iso2_unitSymbolType unit) {
+    value.Multiplier = 0;
+    value.Unit = unit;
+    value.Value = number;
+}
+
+void fill_header(iso2_MessageHeaderType& header) {
+    init_iso2_MessageHeaderType(&header);
+    std::memcpy(header.SessionID.bytes, &SESSION_ID, sizeof(SESSION_ID));
+    header.SessionID.bytesLen = sizeof(SESSION_ID);
+}
+
+// EV charging with 100 A at 400 V
+std::vector<std::uint8_t> current_demand_req() {
+    auto document = std::make_unique<iso2_exiDocument>();
+    init_iso2_exiDocument(document.get());
+    fill_header(document->V2G_Message.Header);
+    init_iso2_BodyType(&document->V2G_Message.Body);
+    document->V2G_Message.Body.CurrentDemandReq_isUsed = 1;
+
+    auto& req = document->V2G_Message.Body.CurrentDemandReq;
+    init_iso2_CurrentDemandReqType(&req);
+    req.DC_EVStatus.EVReady = 1;
+    req.DC_EVStatus.EVErrorCode = iso2_DC_EVErrorCodeType_NO_ERROR;
+    req.DC_EVStatus.EVRESSSOC = 42;
+    set_physical_value(req.EVTargetCurrent, 100, iso2_unitSymbolType_A);
+    set_physical_value(req.EVTargetVoltage, 400, iso2_unitSymbolType_V);
+    req.ChargingComplete = 0;
+
+    std::vector<std::uint8_t> buffer(DEFAULT_BUFFER_SIZE);
+    exi_bitstream_t stream;
+    exi_bitstream_init(&stream, buffer.data(), buffer.size(), 0, nullptr);
+    EXPECT_EQ(encode_iso2_exiDocument(&stream, document.get()), 0);
+    buffer.resize(exi_bitstream_get_length(&stream));
+    return buffer;
+}
+
+// the response handle_iso_current_demand() sends while charging
+void fill_current_demand_res(iso2_exiDocument* out, const iso2_CurrentDemandReqType& req) {
+    init_iso2_exiDocument(out);
+    fill_header(out->V2G_Message.Header);
+    init_iso2_BodyType(&out->V2G_Message.Body);
+    out->V2G_Message.Body.CurrentDemandRes_isUsed = 1;
+
+    auto& res = out->V2G_Message.Body.CurrentDemandRes;
+    init_iso2_CurrentDemandResType(&res);
+    res.ResponseCode = iso2_responseCodeType_OK;
+    res.DC_EVSEStatus.EVSEIsolationStatus = iso2_isolationLevelType_Valid;
+    res.DC_EVSEStatus.EVSEIsolationStatus_isUsed = 1;
+    res.DC_EVSEStatus.EVSEStatusCode = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
+    res.DC_EVSEStatus.NotificationMaxDelay = 0;
+    res.DC_EVSEStatus.EVSENotification = iso2_EVSENotificationType_None;
+    res.EVSEPresentCurrent = req.EVTargetCurrent;
+    res.EVSEPresentVoltage = req.EVTargetVoltage;
+    res.EVSECurrentLimitAchieved = 0;
+    res.EVSEVoltageLimitAchieved = 0;
+    res.EVSEPowerLimitAchieved = 0;
+    std::memcpy(res.EVSEID.characters, EVSE_ID, sizeof(EVSE_ID) - 1);
+    res.EVSEID.charactersLen = sizeof(EVSE_ID) - 1;
+    res.SAScheduleTupleID = 1;
+}
+
+struct RoundTrip {
+    std::vector<std::uint8_t> request;
+    std::vector<std::uint8_t> response = std::vector<std::uint8_t>(DEFAULT_BUFFER_SIZE);
+    std::size_t response_len{0};
+};
+
+// as v2g_server.cpp handled a message before, both documents are zeroed
+int round_trip_zeroed(RoundTrip& round_trip, iso2_exiDocument* in, iso2_exiDocument* out) {
+    exi_bitstream_t stream;
+    exi_bitstream_init(&stream, round_trip.request.data(), round_trip.request.size(), 0, nullptr);
+    std::memset(in, 0, sizeof(*in));
+    if (decode_iso2_exiDocument(&stream, in) != 0) {
+        return -1;
+    }
+
+    std::memset(out, 0, sizeof(*out));
+    fill_current_demand_res(out, in->V2G_Message.Body.CurrentDemandReq);
+
+    exi_bitstream_init(&stream, round_trip.response.data(), round_trip.response.size(), 0, nullptr);
+    const int rv = encode_iso2_exiDocument(&stream, out);
+    round_trip.response_len = exi_bitstream_get_length(&stream);
+    return rv;
+}
+
+int round_trip_codec(RoundTrip& round_trip, exi_documents* documents) {
+    auto& codec = ExiCodec::shared();
+
+    exi_bitstream_t stream;
+    exi_bitstream_init(&stream, round_trip.request.data(), round_trip.request.size(), 0, nullptr);
+    if (codec.decode(&stream, &documents->in.iso2) != 0) {
+        return -1;
+    }
+
+    ExiCodec::clear_response(&documents->out.iso2);
+    fill_current_demand_res(&documents->out.iso2, documents->in.iso2.V2G_Message.Body.CurrentDemandReq);
+
+    exi_bitstream_init(&stream, round_trip.response.data(), round_trip.response.size(), 0, nullptr);
+    const int rv = codec.encode(&stream, &documents->out.iso2);
+    round_trip.response_len = exi_bitstream_get_length(&stream);
+    return rv;
+}
+
+bool same_response(const RoundTrip& a, const RoundTrip& b) {
+    return a.response_len == b.response_len && std::memcmp(a.response.data(), b.response.data(), a.response_len) == 0;
+}
+
+TEST(ExiCodecBenchmark, current_demand_round_trip) {
+    const auto iterations = env_or("EXI_CODEC_BENCHMARK_ITERATIONS", 20000);
+    const auto min_speedup_percent = env_or("EXI_CODEC_BENCHMARK_MIN_SPEEDUP_PERCENT", 0);
+    ASSERT_GT(iterations, 0);
+
+    auto& codec = ExiCodec::shared();
+    auto* documents = codec.acquire();
+    ASSERT_NE(documents, nullptr);
+    ExiCodec::select_protocol(documents, V2G_PROTO_ISO15118_2013);
+    auto in = std::make_unique<iso2_exiDocument>();
+    auto out = std::make_unique<iso2_exiDocument>();
+
+    RoundTrip zeroed{current_demand_req()};
+    RoundTrip pooled{zeroed.request};
+
+    // warms up both and checks that they answer the same
+    ASSERT_EQ(round_trip_zeroed(zeroed, in.get(), out.get()), 0);
+    ASSERT_EQ(round_trip_codec(pooled, documents), 0);
+    ASSERT_TRUE(same_response(zeroed, pooled));
+
+    int failed = 0;
+    const auto zeroed_time = cpu_time([&]() {
+        for (int i = 0; i < iterations; i++) {
+            failed += round_trip_zeroed(zeroed, in.get(), out.get()) != 0;
+        }
+    });
+    const auto before = codec.get_stats();
+    const auto pooled_time = cpu_time([&]() {
+        for (int i = 0; i < iterations; i++) {
+            failed += round_trip_codec(pooled, documents) != 0;
+        }
+    });
+    const auto after = codec.get_stats();
+    codec.release(documents);
+
+    const auto us = [](std::chrono::nanoseconds d) { return d.count() / 1000.; };
+    const auto speedup_percent = 100. * zeroed_time.count() / std::max<std::int64_t>(pooled_time.count(), 1);
+    std::printf("CurrentDemand round trip, CPU time of %d messages, request %zu bytes, response %zu bytes\n",
+                iterations, zeroed.request.size(), zeroed.response_len);
+    std::printf("%-24s %10s\n", "documents", "us/message");
+    std::printf("%-24s %10.2f\n", "zeroed per message", us(zeroed_time) / iterations);
+    std::printf("%-24s %10.2f (decode %.2f, encode %.2f)\n", "ExiCodec", us(pooled_time) / iterations,
+                us(after.decode.total - before.decode.total) / iterations,
+                us(after.encode.total - before.encode.total) / iterations);
+    std::printf("speedup %.0f %%\n", speedup_percent);
+
+    EXPECT_EQ(failed, 0);
+    EXPECT_EQ(after.decode.count - before.decode.count, static_cast<std::uint64_t>(iterations));
+    EXPECT_EQ(after.encode.count - before.encode.count, static_cast<std::uint64_t>(iterations));
+    EXPECT_EQ(after.decode.errors + after.encode.errors, before.decode.errors + before.encode.errors);
+    EXPECT_TRUE(same_response(zeroed, pooled));
+    if (min_speedup_percent > 0) {
+        EXPECT_GE(speedup_percent, min_speedup_percent);
+    }
+}
+
+TEST(ExiCodec, response_does_not_depend_on_previous_response) {
+    auto& codec = ExiCodec::shared();
+    auto* documents = codec.acquire();
+    ASSERT_NE(documents, nullptr);
+    ExiCodec::select_protocol(documents, V2G_PROTO_ISO15118_2013);
+    auto in = std::make_unique<iso2_exiDocument>();
+    auto out = std::make_unique<iso2_exiDocument>();
+
+    RoundTrip zeroed{current_demand_req()};
+    RoundTrip pooled{zeroed.request};
+    ASSERT_EQ(round_trip_zeroed(zeroed, in.get(), out.get()), 0);
+
+    // a previous response that filled every field, e.g. the optional meter info
+    auto& body = documents->out.iso2.V2G_Message.Body;
+    body.CurrentDemandRes_isUsed = 1;
+    std::memset(&body.CurrentDemandRes, 0xa5, sizeof(body.CurrentDemandRes));
+
+    ASSERT_EQ(round_trip_codec(pooled, documents), 0);
+    EXPECT_TRUE(same_response(zeroed, pooled));
+    codec.release(documents);
+}
+
+TEST(ExiCodec, element_written_without_is_used_is_cleared) {
+#ifdef NDEBUG
+    GTEST_SKIP() << "only debug builds check the cleared response";
+#endif
+    auto& codec = ExiCodec::shared();
+    auto* documents = codec.acquire();
+    ASSERT_NE(documents, nullptr);
+    ExiCodec::select_protocol(documents, V2G_PROTO_ISO15118_2013);
+
+    auto& body = documents->out.iso2.V2G_Message.Body;
+    std::memset(&body.CurrentDemandRes, 0xa5, sizeof(body.CurrentDemandRes));
+
+    ExiCodec::clear_response(&documents->out.iso2);
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&body);
+    EXPECT_TRUE(std::all_of(bytes, bytes + sizeof(body), [](unsigned char byte) { return byte == 0; }));
+    codec.release(documents);
+}
+
+TEST(ExiCodec, documents_are_reused) {
+    auto& codec = ExiCodec::shared();
+
+    auto* first = codec.acquire();
+    ASSERT_NE(first, nullptr);
+    codec.release(first);
+    EXPECT_EQ(codec.acquire(), first);
+
+    // a second connection in parallel gets its own documents
+    auto* second = codec.acquire();
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(second, first);
+
+    codec.release(second);
+    codec.release(first);
+}
+
+TEST(ExiCodec, only_a_schema_change_clears_documents) {
+    auto& codec = ExiCodec::shared();
+    auto* documents = codec.acquire();
+    ASSERT_NE(documents, nullptr);
+
+    ExiCodec::select_protocol(documents, V2G_PROTO_DIN70121);
+    auto* in = reinterpret_cast<std::uint8_t*>(&documents->in);
+    in[0] = 0x5a;
+
+    ExiCodec::select_protocol(documents, V2G_PROTO_ISO15118_2010);
+    EXPECT_EQ(in[0], 0x5a);
+
+    ExiCodec::select_protocol(documents, V2G_PROTO_ISO15118_2013);
+    EXPECT_EQ(in[0], 0);
+
+    codec.release(documents);
+}
+
+} // namespace
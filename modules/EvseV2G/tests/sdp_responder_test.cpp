@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "gtest/gtest.h"
+#include <sdp_responder.hpp>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// the loopback device stands in for the PLC interfaces, every registration gets its own port
+constexpr const char* interface_name = "lo";
+constexpr std::uint16_t base_port = 25118;
+
+constexpr std::uint8_t security_tls = 0x00;
+constexpr std::uint8_t security_none = 0x10;
+
+std::array<std::uint8_t, 10> request(std::uint8_t security) {
+    return {0x01, 0xfe, 0x90, 0x00, 0x00, 0x00, 0x00, 0x02, security, 0x00};
+}
+
+sockaddr_in6 server_address(std::uint16_t port) {
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_loopback;
+    addr.sin6_port = htons(port);
+    return addr;
+}
+
+class Client {
+public:
+    Client() : fd(socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP)) {
+    }
+    ~Client() {
+        close(fd);
+    }
+
+    void send(std::uint16_t port, const std::uint8_t* data, std::size_t len) {
+        const auto addr = server_address(port);
+        ASSERT_EQ(sendto(fd, data, len, 0, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)),
+                  static_cast<ssize_t>(len));
+    }
+
+    // returns the response or an empty vector on timeout
+    std::vector<std::uint8_t> receive(int timeout_ms = 2000) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) != 1) {
+            return {};
+        }
+        std::vector<std::uint8_t> buffer(64);
+        const auto len = recv(fd, buffer.data(), buffer.size(), 0);
+        buffer.resize(len > 0 ? len : 0);
+        return buffer;
+    }
+
+private:
+    int fd;
+};
+
+std::uint16_t announced_port(const std::vector<std::uint8_t>& response) {
+    return (response.at(24) << 8) | response.at(25);
+}
+
+std::uint8_t announced_security(const std::vector<std::uint8_t>& response) {
+    return response.at(26);
+}
+
+TEST(SdpResponder, answersWithAddressesOfInterface) {
+    SdpResponder responder;
+    constexpr int interface_count = 4;
+    std::vector<int> ids;
+
+    for (int i = 0; i < interface_count; i++) {
+        const int id = responder.add_interface(interface_name, base_port + i);
+        ASSERT_NE(id, -1);
+        const auto tcp = server_address(61000 + i);
+        const auto tls = server_address(62000 + i);
+        responder.set_addresses(id, &tcp, &tls);
+        ids.push_back(id);
+    }
+
+    // every interface gets a burst from several clients at the same time
+    constexpr int clients_per_interface = 3;
+    constexpr int requests_per_client = 20;
+    std::vector<std::thread> clients;
+    std::atomic<int> answered{0};
+
+    for (int i = 0; i < interface_count; i++) {
+        for (int c = 0; c < clients_per_interface; c++) {
+            clients.emplace_back([i, c, &answered]() {
+                Client client;
+                const auto security = c % 2 ? security_none : security_tls;
+                const auto packet = request(security);
+                for (int r = 0; r < requests_per_client; r++) {
+                    client.send(base_port + i, packet.data(), packet.size());
+                }
+                for (int r = 0; r < requests_per_client; r++) {
+                    const auto response = client.receive();
+                    ASSERT_EQ(response.size(), 28);
+                    EXPECT_EQ(announced_security(response), security);
+                    EXPECT_EQ(announced_port(response), (security == security_tls ? 62000 : 61000) + i);
+                    answered++;
+                }
+            });
+        }
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    EXPECT_EQ(answered, interface_count * clients_per_interface * requests_per_client);
+    for (const auto id : ids) {
+        const auto stats = responder.get_stats(id);
+        EXPECT_EQ(stats.requests, clients_per_interface * requests_per_client);
+        EXPECT_EQ(stats.responses, clients_per_interface * requests_per_client);
+        EXPECT_EQ(stats.discarded, 0);
+    }
+}
+
+TEST(SdpResponder, fallsBackToAvailableSecurity) {
+    SdpResponder responder;
+    const int id = responder.add_interface(interface_name, base_port);
+    ASSERT_NE(id, -1);
+
+    const auto tcp = server_address(61000);
+    responder.set_addresses(id, &tcp, nullptr);
+
+    Client client;
+    const auto packet = request(security_tls);
+    client.send(base_port, packet.data(), packet.size());
+    const auto response = client.receive();
+    ASSERT_EQ(response.size(), 28);
+    EXPECT_EQ(announced_security(response), security_none);
+    EXPECT_EQ(announced_port(response), 61000);
+}
+
+TEST(SdpResponder, discardsInvalidAndUnanswerableRequests) {
+    SdpResponder responder;
+    const int id = responder.add_interface(interface_name, base_port);
+    ASSERT_NE(id, -1);
+
+    Client client;
+    const auto packet = request(security_tls);
+
+    // no servers running
+    responder.set_addresses(id, nullptr, nullptr);
+    client.send(base_port, packet.data(), packet.size());
+    EXPECT_TRUE(client.receive(200).empty());
+
+    const auto tcp = server_address(61000);
+    const auto tls = server_address(62000);
+    responder.set_addresses(id, &tcp, &tls);
+
+    // short packet, wrong version and unsupported transport protocol
+    client.send(base_port, packet.data(), packet.size() - 1);
+    auto invalid = packet;
+    invalid[0] = 0x02;
+    client.send(base_port, invalid.data(), invalid.size());
+    auto udp = packet;
+    udp[9] = 0x10;
+    client.send(base_port, udp.data(), udp.size());
+    EXPECT_TRUE(client.receive(200).empty());
+
+    client.send(base_port, packet.data(), packet.size());
+    EXPECT_EQ(client.receive().size(), 28);
+
+    const auto stats = responder.get_stats(id);
+    EXPECT_EQ(stats.requests, 3);
+    EXPECT_EQ(stats.responses, 1);
+    EXPECT_EQ(stats.discarded, 4);
+}
+
+TEST(SdpResponder, answersRequestsQueuedBeforeAddresses) {
+    SdpResponder responder;
+    const int id = responder.add_interface(interface_name, base_port);
+    ASSERT_NE(id, -1);
+
+    Client client;
+    const auto packet = request(security_tls);
+    client.send(base_port, packet.data(), packet.size());
+    EXPECT_TRUE(client.receive(200).empty());
+
+    const auto tcp = server_address(61000);
+    const auto tls = server_address(62000);
+    responder.set_addresses(id, &tcp, &tls);
+
+    const auto response = client.receive();
+    ASSERT_EQ(response.size(), 28);
+    EXPECT_EQ(announced_port(response), 62000);
+
+    const auto stats = responder.get_stats(id);
+    EXPECT_EQ(stats.requests, 1);
+    EXPECT_EQ(stats.discarded, 0);
+}
+
+TEST(SdpResponder, stopsAnsweringRemovedInterface) {
+    SdpResponder responder;
+    const int first = responder.add_interface(interface_name, base_port);
+    const int second = responder.add_interface(interface_name, base_port + 1);
+    ASSERT_NE(first, -1);
+    ASSERT_NE(second, -1);
+
+    const auto tcp = server_address(61000);
+    responder.set_addresses(first, &tcp, nullptr);
+    responder.set_addresses(second, &tcp, nullptr);
+    responder.remove_interface(first);
+
+    Client client;
+    const auto packet = request(security_none);
+    client.send(base_port, packet.data(), packet.size());
+    EXPECT_TRUE(client.receive(200).empty());
+
+    client.send(base_port + 1, packet.data(), packet.size());
+    EXPECT_EQ(client.receive().size(), 28);
+}
+
+} // namespace
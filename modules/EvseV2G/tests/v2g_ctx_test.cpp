@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "gtest/gtest.h"
+
+#include "ISO15118_chargerImplStub.hpp"
+#include "evse_securityIntfStub.hpp"
+
+#include <v2g_ctx.hpp>
+
+#include <cstring>
+
+namespace {
+
+// build with -fsanitize=address, a member that is not constructed, destroyed or reset shows up in these cycles
+constexpr int session_cycles = 1000;
+
+class V2gCtxTest : public testing::Test {
+protected:
+    module::stub::ISO15118_chargerImplStub charger;
+    module::stub::evse_securityIntfStub security;
+    v2g_context* ctx{nullptr};
+
+    void SetUp() override {
+        ctx = v2g_ctx_create(&charger, &security);
+        ASSERT_NE(ctx, nullptr);
+    }
+
+    void TearDown() override {
+        v2g_ctx_free(ctx);
+    }
+
+    // changes the values a charging session leaves behind
+    void run_session(int cycle) {
+        ctx->evse_v2g_data.session_id = 0x1122334455667788 + cycle;
+        ctx->session.evse_notification = 2;
+        ctx->session.evse_status_code[PHASE_CHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_EmergencyShutdown;
+        ctx->session.evse_processing[PHASE_AUTH] = iso2_EVSEProcessingType_Finished;
+        ctx->session.evse_service_list_len = 3;
+        ctx->session.meter_info_is_used = true;
+        ctx->session.rcd = 1;
+        ctx->session.evse_present_voltage.Value = 400;
+        ctx->session.iso_selected_payment_option = iso2_paymentOptionType_Contract;
+        ctx->session.auth_start_timeout = 1234;
+        std::memset(ctx->session.gen_challenge, 0x5a, sizeof(ctx->session.gen_challenge));
+        ctx->session.certificate_status = types::authorization::CertificateStatus::CertChainError;
+        ctx->session.authorization_rejected = true;
+        ctx->session.is_charging = true;
+        ctx->session.sa_schedule_tuple_id = 7;
+        ctx->session.ev_v2g_data.received_session_id = cycle;
+        ctx->session.ev_v2g_data.v2g_target_current = 16.0f;
+        ctx->contactor_is_closed = true;
+    }
+
+    // values of the messages of a session, they are reset for a resumed session as well
+    void expect_message_values_reset() {
+        EXPECT_EQ(ctx->session.evse_notification, 0);
+        EXPECT_EQ(ctx->session.evse_status_code[PHASE_CHARGE], iso2_DC_EVSEStatusCodeType_EVSE_Ready);
+        EXPECT_EQ(ctx->session.evse_processing[PHASE_AUTH], iso2_EVSEProcessingType_Ongoing);
+        EXPECT_EQ(ctx->session.evse_processing[PHASE_PARAMETER], iso2_EVSEProcessingType_Finished);
+        EXPECT_EQ(ctx->session.evse_service_list_len, 0);
+        EXPECT_FALSE(ctx->session.meter_info_is_used);
+        EXPECT_EQ(ctx->session.rcd, 0);
+        EXPECT_EQ(ctx->session.evse_present_voltage.Value, 0);
+        EXPECT_EQ(ctx->session.evse_present_voltage.Unit, iso2_unitSymbolType_V);
+        EXPECT_EQ(ctx->session.gen_challenge[0], 0);
+        EXPECT_FALSE(ctx->session.authorization_rejected);
+        EXPECT_FALSE(ctx->session.is_charging);
+        EXPECT_EQ(ctx->session.sae_bidi_data.sae_v2h_minimal_soc, 20);
+        EXPECT_EQ(ctx->session.ev_v2g_data.received_session_id, UINT64_MAX);
+        EXPECT_FALSE(ctx->contactor_is_closed);
+    }
+
+    void expect_session_reset() {
+        expect_message_values_reset();
+        EXPECT_EQ(ctx->session.auth_start_timeout, 0);
+        EXPECT_EQ(ctx->session.certificate_status, types::authorization::CertificateStatus{});
+        EXPECT_EQ(ctx->session.sa_schedule_tuple_id, 0);
+    }
+};
+
+TEST_F(V2gCtxTest, SessionValuesAreResetEverySession) {
+    ctx->basic_config.auth_timeout_eim = 300;
+    ctx->basic_config.verify_contract_cert_chain = true;
+    ctx->evse_v2g_data.evse_id.bytesLen = 4;
+    std::memcpy(ctx->evse_v2g_data.evse_id.bytes, "TEST", 4);
+
+    for (int cycle = 0; cycle < session_cycles; cycle++) {
+        run_session(cycle);
+        v2g_ctx_init_charging_session(ctx, true);
+
+        expect_session_reset();
+        EXPECT_EQ(ctx->evse_v2g_data.session_id, 0);
+        EXPECT_EQ(ctx->session.iso_selected_payment_option, iso2_paymentOptionType_ExternalPayment);
+        if (testing::Test::HasFailure()) {
+            FAIL() << "session " << cycle << " was not reset";
+        }
+    }
+
+    // configuration outlives the sessions
+    EXPECT_EQ(ctx->basic_config.auth_timeout_eim, 300);
+    EXPECT_TRUE(ctx->basic_config.verify_contract_cert_chain);
+    EXPECT_EQ(ctx->evse_v2g_data.evse_id.bytesLen, 4);
+    EXPECT_EQ(std::memcmp(ctx->evse_v2g_data.evse_id.bytes, "TEST", 4), 0);
+}
+
+TEST_F(V2gCtxTest, PausedSessionIsResumed) {
+    run_session(0);
+
+    // the EV pauses, the next connection resumes the session
+    ctx->hlc_pause_active = true;
+    v2g_ctx_init_charging_session(ctx, true);
+
+    expect_message_values_reset();
+    EXPECT_EQ(ctx->evse_v2g_data.session_id, 0x1122334455667788);
+    EXPECT_EQ(ctx->session.iso_selected_payment_option, iso2_paymentOptionType_Contract);
+    EXPECT_EQ(ctx->session.auth_start_timeout, 1234);
+    EXPECT_EQ(ctx->session.certificate_status, types::authorization::CertificateStatus::CertChainError);
+    EXPECT_EQ(ctx->session.sa_schedule_tuple_id, 7);
+    EXPECT_EQ(ctx->evse_v2g_data.payment_option_list[0], iso2_paymentOptionType_Contract);
+    EXPECT_EQ(ctx->evse_v2g_data.payment_option_list_len, 1);
+    EXPECT_TRUE(ctx->evse_v2g_data.evse_sa_schedule_list_is_used);
+
+    // a resume that is paused again keeps the values as well
+    ctx->session.is_charging = true;
+    v2g_ctx_init_charging_session(ctx, true);
+    EXPECT_FALSE(ctx->session.is_charging);
+    EXPECT_EQ(ctx->session.sa_schedule_tuple_id, 7);
+    EXPECT_EQ(ctx->session.iso_selected_payment_option, iso2_paymentOptionType_Contract);
+
+    // the resumed session ends, the next one starts from the defaults
+    ctx->hlc_pause_active = false;
+    v2g_ctx_init_charging_session(ctx, true);
+
+    expect_session_reset();
+    EXPECT_EQ(ctx->evse_v2g_data.session_id, 0);
+    EXPECT_EQ(ctx->session.iso_selected_payment_option, iso2_paymentOptionType_ExternalPayment);
+    EXPECT_FALSE(ctx->evse_v2g_data.evse_sa_schedule_list_is_used);
+}
+
+TEST(V2gCtx, CreateAndFree) {
+    module::stub::ISO15118_chargerImplStub charger;
+    module::stub::evse_securityIntfStub security;
+
+    // LeakSanitizer reports every context member that is not destroyed
+    for (int i = 0; i < 5; i++) {
+        auto* ctx = v2g_ctx_create(&charger, &security);
+        ASSERT_NE(ctx, nullptr);
+        ctx->if_name = "eth_test";
+        v2g_ctx_free(ctx);
+    }
+    v2g_ctx_free(nullptr);
+}
+
+} // namespace
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <type_traits>
 
 #ifdef EVEREST_MBED_TLS
 #include <mbedtls/certs.h>
@@ -39,6 +40,8 @@
 #include <event2/event.h>
 #include <event2/thread.h>
 
+#include "cert_install_cache.hpp"
+
 /* timeouts in milliseconds */
 #define V2G_SEQUENCE_TIMEOUT_60S              60000 /* [V2G2-443] et.al. */
 #define V2G_SEQUENCE_TIMEOUT_10S              10000
@@ -176,12 +179,72 @@ struct SAE_Bidi_Data {
     bool discharging;
 };
 
+/**
+ * Values of one V2G charging session. v2g_ctx_init_charging_values() resets them with a single assignment from
+ * defaults built once, so a new session neither allocates nor sees values of the previous one.
+ */
+struct v2g_session {
+    /* EVSE V2G values */
+    uint32_t notification_max_delay;
+    uint8_t evse_isolation_status;
+    unsigned int evse_isolation_status_is_used;
+    uint8_t evse_notification;
+    uint8_t evse_status_code[PHASE_LENGTH];
+    uint8_t evse_processing[PHASE_LENGTH];
+    struct iso2_ServiceParameterListType service_parameter_list[iso2_ServiceType_8_ARRAY_SIZE];
+    uint16_t evse_service_list_len;
+    bool meter_info_is_used;
+
+    // AC parameter
+    int rcd;
+    int receipt_required;
+
+    struct iso2_PhysicalValueType evse_present_voltage;
+    struct iso2_PhysicalValueType evse_present_current;
+
+    // Specific SAE J2847 bidi values
+    struct SAE_Bidi_Data sae_bidi_data;
+
+    /* V2G session values */
+    iso2_paymentOptionType iso_selected_payment_option;
+    long long int auth_start_timeout;
+    uint8_t gen_challenge[16];                                  // for PnC
+    types::authorization::CertificateStatus certificate_status; // for PnC
+    bool authorization_rejected;                                // for PnC
+
+    bool renegotiation_required;  /* Is set to true if renegotiation is required. Only relevant for ISO */
+    bool is_charging;             /* set to true if ChargeProgress is set to Start */
+    uint8_t sa_schedule_tuple_id; /* selected SA schedule tuple ID*/
+
+    struct {
+        /* EV V2G values */
+        int bulk_charging_complete;
+        int charging_complete;
+        uint64_t received_session_id; // Is the received ev session id transmitted over the v2g header. This id shall
+                                      // not change during a V2G Communication Session.
+
+        union {
+            struct din_DC_EVStatusType din_dc_ev_status;
+            struct iso2_DC_EVStatusType iso2_dc_ev_status;
+        };
+        float ev_maximum_current_limit;
+        float ev_maximum_power_limit;
+        float ev_maximum_voltage_limit;
+        float v2g_target_current;
+        float v2g_target_voltage;
+        float remaining_time_to_bulk_soc;
+        float remaining_time_to_full_soc;
+    } ev_v2g_data;
+};
+
+// the reset at session start is a plain copy
+static_assert(std::is_trivially_copyable_v<v2g_session>);
+
 /**
  * Abstracts a charging port, i.e. a power outlet in this daemon.
  *
- * **** NOTE ****
- * Be very careful about adding C++ objects since constructors and
- * destructors are not called. (see v2g_ctx_create() and calloc)
+ * Created by v2g_ctx_create() with new and value initialization, members without an initializer start out zeroed.
+ * Everything that belongs to one charging session goes into v2g_session.
  */
 struct v2g_context {
     std::atomic_bool shutdown;
@@ -191,6 +254,7 @@ struct v2g_context {
 
     struct event_base* event_base;
     pthread_t event_thread;
+    struct event* shutdown_event; /* ends the event loop in v2g_ctx_free() */
 
     struct event* com_setup_timeout;
 
@@ -206,7 +270,7 @@ struct v2g_context {
 
     enum tls_security_level tls_security;
 
-    int sdp_socket;
+    int sdp_socket; /* id of the interface at the shared SDP responder */
     int tcp_socket;
 
     int udp_port;
@@ -233,14 +297,21 @@ struct v2g_context {
 #endif // EVEREST_MBED_TLS
 
     bool tls_key_logging;
+    bool tls_kernel_offload;
 
     pthread_mutex_t mqtt_lock;
     pthread_cond_t mqtt_cond;
     pthread_condattr_t mqtt_attr;
 
+    CertificateInstallationCache* cert_install_cache; /* CertificateInstallationRes messages per EV, owned by the
+                                                          module and guarded by mqtt_lock for waiting */
+
     struct {
-        float evse_ac_current_limit; // default is 0
-    } basic_config;                  // This config will not reseted after beginning of a new charging session
+        float evse_ac_current_limit;     // default is 0
+        int auth_timeout_eim;
+        int auth_timeout_pnc;            // for PnC
+        bool verify_contract_cert_chain; // for PnC
+    } basic_config;                      // This config will not reseted after beginning of a new charging session
 
     /* actual charging state */
     enum V2gMsgTypeId last_v2g_msg;    /* holds the current v2g msg type */
@@ -262,7 +333,6 @@ struct v2g_context {
     std::atomic<bool> contactor_is_closed; /* Actual contactor state */
 
     struct {
-        bool meter_info_is_used;
         uint64_t meter_reading;
         struct v2g_meter_id meter_id;
     } meter_info;
@@ -271,18 +341,10 @@ struct v2g_context {
         /* EVSE V2G values */
         uint64_t session_id; // Is the evse session id, generated by the evse. This id shall not change during a V2G
                              // Communication Session.
-        uint32_t notification_max_delay;
-        uint8_t evse_isolation_status;
-        unsigned int evse_isolation_status_is_used;
-        uint8_t evse_notification;
-        uint8_t evse_status_code[PHASE_LENGTH];
-        uint8_t evse_processing[PHASE_LENGTH];
         struct v2g_evse_id evse_id;
         unsigned int date_time_now_is_used;
         struct iso2_ChargeServiceType charge_service;
         struct iso2_ServiceType evse_service_list[iso2_ServiceType_8_ARRAY_SIZE];
-        struct iso2_ServiceParameterListType service_parameter_list[iso2_ServiceType_8_ARRAY_SIZE];
-        uint16_t evse_service_list_len;
 
         struct iso2_SAScheduleListType evse_sa_schedule_list;
         bool evse_sa_schedule_list_is_used;
@@ -290,12 +352,6 @@ struct v2g_context {
         iso2_paymentOptionType payment_option_list[iso2_paymentOptionType_2_ARRAY_SIZE];
         uint8_t payment_option_list_len;
 
-        bool cert_install_status;
-        std::string cert_install_res_b64_buffer;
-
-        // AC parameter
-        int rcd;
-        int receipt_required;
 
         // evse power electronic values
         struct iso2_PhysicalValueType evse_current_regulation_tolerance;
@@ -314,60 +370,21 @@ struct v2g_context {
         struct iso2_PhysicalValueType evse_minimum_current_limit;
         struct iso2_PhysicalValueType evse_minimum_voltage_limit;
         struct iso2_PhysicalValueType evse_peak_current_ripple;
-        struct iso2_PhysicalValueType evse_present_voltage;
-        struct iso2_PhysicalValueType evse_present_current;
 
         /* AC only power electronic values */
         struct iso2_PhysicalValueType evse_nominal_voltage;
 
-        // Specific SAE J2847 bidi values
-        struct SAE_Bidi_Data sae_bidi_data;
-
     } evse_v2g_data;
 
-    struct {
-        /* V2G session values */
-        iso2_paymentOptionType iso_selected_payment_option;
-        long long int auth_start_timeout;
-        int auth_timeout_eim;
-        int auth_timeout_pnc;                                       // for PnC
-        uint8_t gen_challenge[16];                                  // for PnC
-        bool verify_contract_cert_chain;                            // for PnC
-        types::authorization::CertificateStatus certificate_status; // for PnC
-        bool authorization_rejected;                                // for PnC
-
 #ifdef EVEREST_MBED_TLS
-        // needed by iso_server.cpp
-        // for OpenSSL the key is part of v2g_connection
-        struct {
-            mbedtls_ecdsa_context pubkey;
-        } contract; // for PnC
-#endif              // EVEREST_MBED_TLS
-
-        bool renegotiation_required;  /* Is set to true if renegotiation is required. Only relevant for ISO */
-        bool is_charging;             /* set to true if ChargeProgress is set to Start */
-        uint8_t sa_schedule_tuple_id; /* selected SA schedule tuple ID*/
-    } session;
-
+    // needed by iso_server.cpp
+    // for OpenSSL the key is part of v2g_connection
     struct {
-        /* EV V2G values */
-        int bulk_charging_complete;
-        int charging_complete;
-        uint64_t received_session_id; // Is the received ev session id transmitted over the v2g header. This id shall
-                                      // not change during a V2G Communication Session.
+        mbedtls_ecdsa_context pubkey;
+    } contract; // for PnC
+#endif          // EVEREST_MBED_TLS
 
-        union {
-            struct din_DC_EVStatusType din_dc_ev_status;
-            struct iso2_DC_EVStatusType iso2_dc_ev_status;
-        };
-        float ev_maximum_current_limit;
-        float ev_maximum_power_limit;
-        float ev_maximum_voltage_limit;
-        float v2g_target_current;
-        float v2g_target_voltage;
-        float remaining_time_to_bulk_soc;
-        float remaining_time_to_full_soc;
-    } ev_v2g_data;
+    struct v2g_session session;
 
     bool hlc_pause_active;
 };
@@ -381,6 +398,8 @@ enum mqtt_dlink_action {
 /**
  * High-level abstraction of an incoming TCP/TLS connection on a certain charging port.
  */
+struct exi_documents;
+
 struct v2g_connection {
     pthread_t thread_id;
     struct v2g_context* ctx;
@@ -414,8 +433,10 @@ struct v2g_connection {
     uint32_t payload_len;
     exi_bitstream_t stream;
 
-    struct appHand_exiDocument handshake_req;
-    struct appHand_exiDocument handshake_resp;
+    /* documents of the connection, owned by ExiCodec and kept for the next connection */
+    struct exi_documents* exi_documents;
+    struct appHand_exiDocument* handshake_req;
+    struct appHand_exiDocument* handshake_resp;
 
     union {
         struct din_exiDocument* dinEXIDocument;
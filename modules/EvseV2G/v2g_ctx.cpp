@@ -7,9 +7,11 @@
 #include <dirent.h>
 #include <errno.h>
 #include <math.h>
-#include <unistd.h> // sleep
+#include <mutex>
+#include <new>
 
 #include "log.hpp"
+#include "sdp.hpp"
 #include "v2g_ctx.hpp"
 
 #include <cbv2g/iso_2/iso2_msgDefDatatypes.h>
@@ -81,39 +83,28 @@ void setMinPhysicalValue(struct iso2_PhysicalValueType* ADstPhyValue, const stru
     }
 }
 
+static void v2g_ctx_shutdown_cb(evutil_socket_t fd, short what, void* arg) {
+    struct v2g_context* ctx = static_cast<struct v2g_context*>(arg);
+
+    /* called from within the loop, so the break cannot be lost before the loop is entered */
+    event_base_loopbreak(ctx->event_base);
+}
+
 static void* v2g_ctx_eventloop(void* data) {
     struct v2g_context* ctx = static_cast<struct v2g_context*>(data);
 
     while (!ctx->shutdown) {
-        int rv;
-
-        rv = event_base_loop(ctx->event_base, 0);
-        if (rv == -1)
+        /* keeps running without registered events, only the shutdown event ends it */
+        if (event_base_loop(ctx->event_base, EVLOOP_NO_EXIT_ON_EMPTY) == -1)
             break;
-
-        /* if no events are registered, restart looping */
-        if (rv == 1)
-            sleep(1); /* FIXME this is bad since we actually do busy-waiting here */
     }
 
     return NULL;
 }
 
 static int v2g_ctx_start_events(struct v2g_context* ctx) {
-    pthread_attr_t attr;
-    int rv;
-
-    /* create the thread in detached state so we don't need to join it later */
-    if (pthread_attr_init(&attr) != 0) {
-        dlog(DLOG_LEVEL_ERROR, "pthread_attr_init failed: %s", strerror(errno));
-        return -1;
-    }
-    if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) != 0) {
-        dlog(DLOG_LEVEL_ERROR, "pthread_attr_setdetachstate failed: %s", strerror(errno));
-        return -1;
-    }
-
-    rv = pthread_create(&ctx->event_thread, NULL, v2g_ctx_eventloop, ctx);
+    /* joined by v2g_ctx_free(), the loop uses the context until then */
+    int rv = pthread_create(&ctx->event_thread, NULL, v2g_ctx_eventloop, ctx);
     return rv ? -1 : 0;
 }
 
@@ -140,30 +131,115 @@ void v2g_ctx_init_charging_state(struct v2g_context* const ctx, bool is_connecti
     }
 }
 
+/* defaults of the values of a charging session, built once by v2g_ctx_create() */
+static struct v2g_session session_defaults;
+static std::once_flag session_defaults_built;
+
+static void v2g_ctx_build_session_defaults() {
+    struct v2g_session* const session = &session_defaults;
+
+    session->notification_max_delay = (uint32_t)0;
+    session->evse_isolation_status = (uint8_t)iso2_isolationLevelType_Invalid;
+    session->evse_isolation_status_is_used = (unsigned int)1; // Shall be used in DIN
+    session->evse_notification = (uint8_t)0;
+    session->evse_status_code[PHASE_INIT] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    session->evse_status_code[PHASE_AUTH] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    session->evse_status_code[PHASE_PARAMETER] = iso2_DC_EVSEStatusCodeType_EVSE_Ready; // [V2G-DC-453]
+    session->evse_status_code[PHASE_ISOLATION] = iso2_DC_EVSEStatusCodeType_EVSE_IsolationMonitoringActive;
+    session->evse_status_code[PHASE_PRECHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
+    session->evse_status_code[PHASE_CHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
+    session->evse_status_code[PHASE_WELDING] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    session->evse_status_code[PHASE_STOP] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
+    memset(session->evse_processing, iso2_EVSEProcessingType_Ongoing, PHASE_LENGTH);
+    session->evse_processing[PHASE_PARAMETER] = iso2_EVSEProcessingType_Finished; // Skip parameter phase
+
+    session->meter_info_is_used = false;
+    session->evse_service_list_len = (uint16_t)0;
+    memset(&session->service_parameter_list, 0,
+           sizeof(struct iso2_ServiceParameterListType) * iso2_ServiceType_8_ARRAY_SIZE);
+
+    init_physical_value(&session->evse_present_voltage, iso2_unitSymbolType_V);
+    init_physical_value(&session->evse_present_current, iso2_unitSymbolType_A);
+
+    // AC paramter
+    session->rcd = (int)0; // 0 if RCD has not detected an error
+    session->receipt_required = (int)0;
+
+    // Specific SAE J2847 bidi values
+    session->sae_bidi_data.enabled_sae_v2g = false;
+    session->sae_bidi_data.enabled_sae_v2h = false;
+    session->sae_bidi_data.sae_v2h_minimal_soc = 20;
+    session->sae_bidi_data.discharging = false;
+
+    /* Init session values */
+    session->iso_selected_payment_option = iso2_paymentOptionType_ExternalPayment;
+    memset(session->gen_challenge, 0, sizeof(session->gen_challenge));
+    session->authorization_rejected = false;
+    session->renegotiation_required = false;
+    session->is_charging = false;
+
+    // Init EV received v2g-data to an invalid state
+    memset(&session->ev_v2g_data, 0xff, sizeof(session->ev_v2g_data));
+}
+
+/* EVSE values that are configured once, the charger interface changes them later on */
+static void v2g_ctx_init_evse_values(struct v2g_context* const ctx) {
+    ctx->evse_v2g_data.charge_service.FreeService = 0;
+    std::string evse_id = std::string("DE*CBY*ETE1*234");
+    strcpy(reinterpret_cast<char*>(ctx->evse_v2g_data.evse_id.bytes), evse_id.data());
+    ctx->evse_v2g_data.evse_id.bytesLen = evse_id.size();
+    ctx->evse_v2g_data.charge_service.SupportedEnergyTransferMode.EnergyTransferMode.array[0] =
+        iso2_EnergyTransferModeType_AC_single_phase_core;
+    ctx->evse_v2g_data.charge_service.SupportedEnergyTransferMode.EnergyTransferMode.arrayLen = 1;
+    ctx->evse_v2g_data.date_time_now_is_used = (unsigned int)0;
+
+    // evse power values
+    init_physical_value(&ctx->evse_v2g_data.evse_current_regulation_tolerance, iso2_unitSymbolType_A);
+    ctx->evse_v2g_data.evse_current_regulation_tolerance_is_used = (unsigned int)0; // optional in din
+    init_physical_value(&ctx->evse_v2g_data.evse_energy_to_be_delivered, iso2_unitSymbolType_Wh);
+    ctx->evse_v2g_data.evse_energy_to_be_delivered_is_used = (unsigned int)0; // optional in din
+    init_physical_value(&ctx->evse_v2g_data.evse_maximum_current_limit, iso2_unitSymbolType_A);
+    ctx->evse_v2g_data.evse_maximum_current_limit_is_used = (unsigned int)0;
+    ctx->evse_v2g_data.evse_current_limit_achieved = (int)0;
+    init_physical_value(&ctx->evse_v2g_data.evse_maximum_power_limit, iso2_unitSymbolType_W);
+    ctx->evse_v2g_data.evse_maximum_power_limit_is_used = (unsigned int)0;
+    ctx->evse_v2g_data.evse_power_limit_achieved = (int)0;
+    init_physical_value(&ctx->evse_v2g_data.evse_maximum_voltage_limit, iso2_unitSymbolType_V);
+
+    ctx->evse_v2g_data.evse_maximum_voltage_limit_is_used = (unsigned int)0; // mandatory
+    ctx->evse_v2g_data.evse_voltage_limit_achieved = (int)0;
+    init_physical_value(&ctx->evse_v2g_data.evse_minimum_current_limit, iso2_unitSymbolType_A);
+    init_physical_value(&ctx->evse_v2g_data.evse_minimum_voltage_limit, iso2_unitSymbolType_V);
+    init_physical_value(&ctx->evse_v2g_data.evse_peak_current_ripple, iso2_unitSymbolType_A);
+    // AC evse power values
+    init_physical_value(&ctx->evse_v2g_data.evse_nominal_voltage, iso2_unitSymbolType_V);
+
+    ctx->evse_v2g_data.payment_option_list[0] = iso2_paymentOptionType_ExternalPayment;
+    ctx->evse_v2g_data.payment_option_list_len = (uint8_t)1; // One option must be set
+
+    ctx->evse_v2g_data.evse_service_list[0].FreeService = (int)0;
+    ctx->evse_v2g_data.evse_service_list[0].ServiceID =
+        4; // 4 (UseCaseInformation) A list containing information on all other services than charging services. The
+           // EVCC and the SECC shall use the ServiceIDs in the range from 1 to 4 as defined in this
+    // ctx->evse_v2g_data.evse_service_list[0].ServiceCategory Not needed at the moment, because it is a fixed value
+    // in din and iso
+}
+
 void v2g_ctx_init_charging_values(struct v2g_context* const ctx) {
-    static bool initialize_once = false;
     const char init_service_name[] = {"EVCharging_Service"};
 
+    // a paused session is resumed with what was selected and authorized before the pause
+    const auto selected_payment_option = ctx->session.iso_selected_payment_option;
+    const auto auth_start_timeout = ctx->session.auth_start_timeout;
+    const auto certificate_status = ctx->session.certificate_status;
+    const auto sa_schedule_tuple_id = ctx->session.sa_schedule_tuple_id;
+    ctx->session = session_defaults;
+    ctx->contactor_is_closed = false;
+
     if (ctx->hlc_pause_active != true) {
         ctx->evse_v2g_data.session_id =
             (uint64_t)0; /* store associated session id, this is zero until SessionSetupRes is sent */
-    }
-    ctx->evse_v2g_data.notification_max_delay = (uint32_t)0;
-    ctx->evse_v2g_data.evse_isolation_status = (uint8_t)iso2_isolationLevelType_Invalid;
-    ctx->evse_v2g_data.evse_isolation_status_is_used = (unsigned int)1; // Shall be used in DIN
-    ctx->evse_v2g_data.evse_notification = (uint8_t)0;
-    ctx->evse_v2g_data.evse_status_code[PHASE_INIT] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    ctx->evse_v2g_data.evse_status_code[PHASE_AUTH] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    ctx->evse_v2g_data.evse_status_code[PHASE_PARAMETER] = iso2_DC_EVSEStatusCodeType_EVSE_Ready; // [V2G-DC-453]
-    ctx->evse_v2g_data.evse_status_code[PHASE_ISOLATION] = iso2_DC_EVSEStatusCodeType_EVSE_IsolationMonitoringActive;
-    ctx->evse_v2g_data.evse_status_code[PHASE_PRECHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
-    ctx->evse_v2g_data.evse_status_code[PHASE_CHARGE] = iso2_DC_EVSEStatusCodeType_EVSE_Ready;
-    ctx->evse_v2g_data.evse_status_code[PHASE_WELDING] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    ctx->evse_v2g_data.evse_status_code[PHASE_STOP] = iso2_DC_EVSEStatusCodeType_EVSE_NotReady;
-    memset(ctx->evse_v2g_data.evse_processing, iso2_EVSEProcessingType_Ongoing, PHASE_LENGTH);
-    ctx->evse_v2g_data.evse_processing[PHASE_PARAMETER] = iso2_EVSEProcessingType_Finished; // Skip parameter phase
 
-    if (ctx->hlc_pause_active != true) {
         ctx->evse_v2g_data.charge_service.ServiceCategory = iso2_serviceCategoryType_EVCharging;
         ctx->evse_v2g_data.charge_service.ServiceID = (uint16_t)1;
         memcpy(ctx->evse_v2g_data.charge_service.ServiceName.characters, init_service_name, sizeof(init_service_name));
@@ -172,61 +248,7 @@ void v2g_ctx_init_charging_values(struct v2g_context* const ctx) {
         // ctx->evse_v2g_data.chargeService.ServiceScope.characters
         // ctx->evse_v2g_data.chargeService.ServiceScope.charactersLen
         ctx->evse_v2g_data.charge_service.ServiceScope_isUsed = (unsigned int)0;
-    }
-    ctx->meter_info.meter_info_is_used = false;
-
-    ctx->evse_v2g_data.evse_service_list_len = (uint16_t)0;
-    memset(&ctx->evse_v2g_data.service_parameter_list, 0,
-           sizeof(struct iso2_ServiceParameterListType) * iso2_ServiceType_8_ARRAY_SIZE);
-
-    if (initialize_once == false) {
-        ctx->evse_v2g_data.charge_service.FreeService = 0;
-        std::string evse_id = std::string("DE*CBY*ETE1*234");
-        strcpy(reinterpret_cast<char*>(ctx->evse_v2g_data.evse_id.bytes), evse_id.data());
-        ctx->evse_v2g_data.evse_id.bytesLen = evse_id.size();
-        ctx->evse_v2g_data.charge_service.SupportedEnergyTransferMode.EnergyTransferMode.array[0] =
-            iso2_EnergyTransferModeType_AC_single_phase_core;
-        ctx->evse_v2g_data.charge_service.SupportedEnergyTransferMode.EnergyTransferMode.arrayLen = 1;
-        ctx->evse_v2g_data.date_time_now_is_used = (unsigned int)0;
-
-        // evse power values
-        init_physical_value(&ctx->evse_v2g_data.evse_current_regulation_tolerance, iso2_unitSymbolType_A);
-        ctx->evse_v2g_data.evse_current_regulation_tolerance_is_used = (unsigned int)0; // optional in din
-        init_physical_value(&ctx->evse_v2g_data.evse_energy_to_be_delivered, iso2_unitSymbolType_Wh);
-        ctx->evse_v2g_data.evse_energy_to_be_delivered_is_used = (unsigned int)0; // optional in din
-        init_physical_value(&ctx->evse_v2g_data.evse_maximum_current_limit, iso2_unitSymbolType_A);
-        ctx->evse_v2g_data.evse_maximum_current_limit_is_used = (unsigned int)0;
-        ctx->evse_v2g_data.evse_current_limit_achieved = (int)0;
-        init_physical_value(&ctx->evse_v2g_data.evse_maximum_power_limit, iso2_unitSymbolType_W);
-        ctx->evse_v2g_data.evse_maximum_power_limit_is_used = (unsigned int)0;
-        ctx->evse_v2g_data.evse_power_limit_achieved = (int)0;
-        init_physical_value(&ctx->evse_v2g_data.evse_maximum_voltage_limit, iso2_unitSymbolType_V);
-
-        ctx->evse_v2g_data.evse_maximum_voltage_limit_is_used = (unsigned int)0; // mandatory
-        ctx->evse_v2g_data.evse_voltage_limit_achieved = (int)0;
-        init_physical_value(&ctx->evse_v2g_data.evse_minimum_current_limit, iso2_unitSymbolType_A);
-        init_physical_value(&ctx->evse_v2g_data.evse_minimum_voltage_limit, iso2_unitSymbolType_V);
-        init_physical_value(&ctx->evse_v2g_data.evse_peak_current_ripple, iso2_unitSymbolType_A);
-        // AC evse power values
-        init_physical_value(&ctx->evse_v2g_data.evse_nominal_voltage, iso2_unitSymbolType_V);
-        ctx->evse_v2g_data.rcd = (int)0; // 0 if RCD has not detected an error
-        ctx->contactor_is_closed = false;
-
-        ctx->evse_v2g_data.payment_option_list[0] = iso2_paymentOptionType_ExternalPayment;
-        ctx->evse_v2g_data.payment_option_list_len = (uint8_t)1; // One option must be set
 
-        ctx->evse_v2g_data.evse_service_list[0].FreeService = (int)0;
-        ctx->evse_v2g_data.evse_service_list[0].ServiceID =
-            4; // 4 (UseCaseInformation) A list containing information on all other services than charging services. The
-               // EVCC and the SECC shall use the ServiceIDs in the range from 1 to 4 as defined in this
-        // ctx->evse_v2g_data.evse_service_list[0].ServiceCategory Not needed at the moment, because it is a fixed value
-        // in din and iso
-    }
-
-    init_physical_value(&ctx->evse_v2g_data.evse_present_voltage, iso2_unitSymbolType_V);
-    init_physical_value(&ctx->evse_v2g_data.evse_present_current, iso2_unitSymbolType_A);
-
-    if (ctx->hlc_pause_active != true) {
         // SAScheduleTupleID#PMaxScheduleTupleID#Start#Duration#PMax#
         init_physical_value(&ctx->evse_v2g_data.evse_sa_schedule_list.SAScheduleTuple.array[0]
                                  .PMaxSchedule.PMaxScheduleEntry.array[0]
@@ -259,45 +281,21 @@ void v2g_ctx_init_charging_values(struct v2g_context* const ctx) {
             (unsigned int)0; // Not supported in DIN
     } else {
         ctx->evse_v2g_data.evse_sa_schedule_list_is_used = true;
-    }
-    if (ctx->evse_v2g_data.cert_install_res_b64_buffer.empty() == false) {
-        ctx->evse_v2g_data.cert_install_res_b64_buffer.clear();
-    }
-
-    // AC paramter
-    ctx->evse_v2g_data.rcd = (int)0; // 0 if RCD has not detected an error
-    ctx->contactor_is_closed = false;
-    ctx->evse_v2g_data.receipt_required = (int)0;
-
-    // Specific SAE J2847 bidi values
-    ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2g = false;
-    ctx->evse_v2g_data.sae_bidi_data.enabled_sae_v2h = false;
-    ctx->evse_v2g_data.sae_bidi_data.sae_v2h_minimal_soc = 20;
-    ctx->evse_v2g_data.sae_bidi_data.discharging = false;
-
-    // Init EV received v2g-data to an invalid state
-    memset(&ctx->ev_v2g_data, 0xff, sizeof(ctx->ev_v2g_data));
 
-    /* Init session values */
-    if (ctx->hlc_pause_active != true) {
-        ctx->session.iso_selected_payment_option = iso2_paymentOptionType_ExternalPayment;
-    } else {
-        ctx->evse_v2g_data.payment_option_list[0] = ctx->session.iso_selected_payment_option;
+        ctx->session.iso_selected_payment_option = selected_payment_option;
+        ctx->session.auth_start_timeout = auth_start_timeout;
+        ctx->session.certificate_status = certificate_status;
+        ctx->session.sa_schedule_tuple_id = sa_schedule_tuple_id;
+        ctx->evse_v2g_data.payment_option_list[0] = selected_payment_option;
         ctx->evse_v2g_data.payment_option_list_len = (uint8_t)1; // One option must be set
     }
-    memset(ctx->session.gen_challenge, 0, sizeof(ctx->session.gen_challenge));
-
-    ctx->session.authorization_rejected = false;
-
-    initialize_once = true;
 }
 
 struct v2g_context* v2g_ctx_create(ISO15118_chargerImplBase* p_chargerImplBase, evse_securityIntf* r_security) {
-    struct v2g_context* ctx;
+    std::call_once(session_defaults_built, v2g_ctx_build_session_defaults);
 
-    // TODO There are c++ objects within v2g_context and calloc doesn't call initialisers.
-    //      free() will not call destructors
-    ctx = static_cast<v2g_context*>(calloc(1, sizeof(*ctx)));
+    // value initialization: members without an initializer start zeroed, as with the calloc() before
+    struct v2g_context* ctx = new (std::nothrow) v2g_context();
     if (!ctx)
         return NULL;
 
@@ -314,6 +312,7 @@ struct v2g_context* v2g_ctx_create(ISO15118_chargerImplBase* p_chargerImplBase,
 
     ctx->is_dc_charger = true;
 
+    v2g_ctx_init_evse_values(ctx);
     v2g_ctx_init_charging_session(ctx, true);
 
     /* interface from config file or options */
@@ -325,10 +324,8 @@ struct v2g_context* v2g_ctx_create(ISO15118_chargerImplBase* p_chargerImplBase,
     ctx->sdp_socket = -1;
     ctx->tcp_socket = -1;
     ctx->tls_socket.fd = -1;
-#ifdef EVEREST_MBED_TLS
-    memset(&ctx->tls_log_ctx, 0, sizeof(keylogDebugCtx));
-#endif // EVEREST_MBED_TLS
     ctx->tls_key_logging = false;
+    ctx->tls_kernel_offload = false;
     ctx->debugMode = false;
 
     /* according to man page, both functions never return an error */
@@ -344,6 +341,12 @@ struct v2g_context* v2g_ctx_create(ISO15118_chargerImplBase* p_chargerImplBase,
         goto free_out;
     }
 
+    ctx->shutdown_event = event_new(ctx->event_base, -1, 0, v2g_ctx_shutdown_cb, ctx);
+    if (!ctx->shutdown_event) {
+        dlog(DLOG_LEVEL_ERROR, "event_new failed");
+        goto free_out;
+    }
+
     if (v2g_ctx_start_events(ctx) != 0)
         goto free_out;
 
@@ -354,13 +357,18 @@ struct v2g_context* v2g_ctx_create(ISO15118_chargerImplBase* p_chargerImplBase,
     return ctx;
 
 free_out:
+    if (ctx->shutdown_event) {
+        event_free(ctx->shutdown_event);
+    }
     if (ctx->event_base) {
-        event_base_loopbreak(ctx->event_base);
         event_base_free(ctx->event_base);
     }
+    pthread_cond_destroy(&ctx->mqtt_cond);
+    pthread_condattr_destroy(&ctx->mqtt_attr);
+    pthread_mutex_destroy(&ctx->mqtt_lock);
     free(ctx->local_tls_addr);
     free(ctx->local_tcp_addr);
-    free(ctx);
+    delete ctx;
     return NULL;
 }
 
@@ -383,18 +391,35 @@ static void v2g_ctx_free_tls(struct v2g_context* ctx) {
 
     if (NULL != ctx->tls_log_ctx.file) {
         fclose(ctx->tls_log_ctx.file);
-        memset(&ctx->tls_log_ctx, 0, sizeof(ctx->tls_log_ctx));
+        ctx->tls_log_ctx = keylogDebugCtx{};
     }
 #endif // EVEREST_MBED_TLS
 }
 
 void v2g_ctx_free(struct v2g_context* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+
+    /* stop announcing the servers before their addresses are freed */
+    sdp_close(ctx);
+
     if (ctx->event_base) {
-        event_base_loopbreak(ctx->event_base);
+        /* an active event stays active until the loop runs it, even if the loop has not been entered yet */
+        ctx->shutdown = true;
+        event_active(ctx->shutdown_event, 0, 0);
+        pthread_join(ctx->event_thread, NULL);
+
+        if (ctx->com_setup_timeout != NULL) {
+            event_free(ctx->com_setup_timeout);
+            ctx->com_setup_timeout = NULL;
+        }
+        event_free(ctx->shutdown_event);
         event_base_free(ctx->event_base);
     }
 
     pthread_cond_destroy(&ctx->mqtt_cond);
+    pthread_condattr_destroy(&ctx->mqtt_attr);
     pthread_mutex_destroy(&ctx->mqtt_lock);
 
     v2g_ctx_free_tls(ctx);
@@ -403,7 +428,7 @@ void v2g_ctx_free(struct v2g_context* ctx) {
     ctx->local_tls_addr = NULL;
     free(ctx->local_tcp_addr);
     ctx->local_tcp_addr = NULL;
-    free(ctx);
+    delete ctx;
 }
 
 void stop_timer(struct event** event_timer, char const* const timer_name, struct v2g_context* ctx) {
@@ -429,22 +454,24 @@ void publish_dc_ev_maximum_limits(struct v2g_context* ctx, const float& v2g_dc_e
 
     if (v2g_dc_ev_max_current_limit_is_used == (unsigned int)1) {
         dc_ev_maximum_limits.dc_ev_maximum_current_limit = v2g_dc_ev_max_current_limit;
-        if (ctx->ev_v2g_data.ev_maximum_current_limit != dc_ev_maximum_limits.dc_ev_maximum_current_limit.value()) {
-            ctx->ev_v2g_data.ev_maximum_current_limit = v2g_dc_ev_max_current_limit;
+        if (ctx->session.ev_v2g_data.ev_maximum_current_limit !=
+            dc_ev_maximum_limits.dc_ev_maximum_current_limit.value()) {
+            ctx->session.ev_v2g_data.ev_maximum_current_limit = v2g_dc_ev_max_current_limit;
             publish_message = true;
         }
     }
     if (v2g_dc_ev_max_power_limit_is_used == (unsigned int)1) {
         dc_ev_maximum_limits.dc_ev_maximum_power_limit = v2g_dc_ev_max_power_limit;
-        if (ctx->ev_v2g_data.ev_maximum_power_limit != v2g_dc_ev_max_power_limit) {
-            ctx->ev_v2g_data.ev_maximum_power_limit = v2g_dc_ev_max_power_limit;
+        if (ctx->session.ev_v2g_data.ev_maximum_power_limit != v2g_dc_ev_max_power_limit) {
+            ctx->session.ev_v2g_data.ev_maximum_power_limit = v2g_dc_ev_max_power_limit;
             publish_message = true;
         }
     }
     if (v2g_dc_ev_max_voltage_limit_is_used == (unsigned int)1) {
         dc_ev_maximum_limits.dc_ev_maximum_voltage_limit = v2g_dc_ev_max_voltage_limit;
-        if (ctx->ev_v2g_data.ev_maximum_voltage_limit != dc_ev_maximum_limits.dc_ev_maximum_voltage_limit.value()) {
-            ctx->ev_v2g_data.ev_maximum_voltage_limit = v2g_dc_ev_max_voltage_limit;
+        if (ctx->session.ev_v2g_data.ev_maximum_voltage_limit !=
+            dc_ev_maximum_limits.dc_ev_maximum_voltage_limit.value()) {
+            ctx->session.ev_v2g_data.ev_maximum_voltage_limit = v2g_dc_ev_max_voltage_limit;
             publish_message = true;
         }
     }
@@ -456,14 +483,14 @@ void publish_dc_ev_maximum_limits(struct v2g_context* ctx, const float& v2g_dc_e
 
 void publish_dc_ev_target_voltage_current(struct v2g_context* ctx, const float& v2g_dc_ev_target_voltage,
                                           const float& v2g_dc_ev_target_current) {
-    if ((ctx->ev_v2g_data.v2g_target_voltage != v2g_dc_ev_target_voltage) ||
-        (ctx->ev_v2g_data.v2g_target_current != v2g_dc_ev_target_current)) {
+    if ((ctx->session.ev_v2g_data.v2g_target_voltage != v2g_dc_ev_target_voltage) ||
+        (ctx->session.ev_v2g_data.v2g_target_current != v2g_dc_ev_target_current)) {
         types::iso15118_charger::DcEvTargetValues dc_ev_target_values;
         dc_ev_target_values.dc_ev_target_voltage = v2g_dc_ev_target_voltage;
         dc_ev_target_values.dc_ev_target_current = v2g_dc_ev_target_current;
 
-        ctx->ev_v2g_data.v2g_target_voltage = v2g_dc_ev_target_voltage;
-        ctx->ev_v2g_data.v2g_target_current = v2g_dc_ev_target_current;
+        ctx->session.ev_v2g_data.v2g_target_voltage = v2g_dc_ev_target_voltage;
+        ctx->session.ev_v2g_data.v2g_target_current = v2g_dc_ev_target_current;
 
         ctx->p_charger->publish_dc_ev_target_voltage_current(dc_ev_target_values);
     }
@@ -480,20 +507,20 @@ void publish_dc_ev_remaining_time(struct v2g_context* ctx, const float& v2g_dc_e
     bool publish_message = false;
 
     if (v2g_dc_ev_remaining_time_to_full_soc_is_used == (unsigned int)1) {
-        if (ctx->ev_v2g_data.remaining_time_to_full_soc != v2g_dc_ev_remaining_time_to_full_soc) {
+        if (ctx->session.ev_v2g_data.remaining_time_to_full_soc != v2g_dc_ev_remaining_time_to_full_soc) {
             std::time_t time_to_full_soc = time_now_in_sec + v2g_dc_ev_remaining_time_to_full_soc;
             std::strftime(buffer, sizeof(buffer), format, std::gmtime(&time_to_full_soc));
             dc_ev_remaining_time.ev_remaining_time_to_full_soc = std::string(buffer);
-            ctx->ev_v2g_data.remaining_time_to_full_soc = v2g_dc_ev_remaining_time_to_full_soc;
+            ctx->session.ev_v2g_data.remaining_time_to_full_soc = v2g_dc_ev_remaining_time_to_full_soc;
             publish_message = true;
         }
     }
     if (v2g_dc_ev_remaining_time_to_bulk_soc_is_used == (unsigned int)1) {
-        if (ctx->ev_v2g_data.remaining_time_to_bulk_soc != v2g_dc_ev_remaining_time_to_bulk_soc) {
+        if (ctx->session.ev_v2g_data.remaining_time_to_bulk_soc != v2g_dc_ev_remaining_time_to_bulk_soc) {
             std::time_t time_to_bulk_soc = time_now_in_sec + v2g_dc_ev_remaining_time_to_bulk_soc;
             std::strftime(buffer, sizeof(buffer), format, std::gmtime(&time_to_bulk_soc));
             dc_ev_remaining_time.ev_remaining_time_to_full_bulk_soc = std::string(buffer);
-            ctx->ev_v2g_data.remaining_time_to_bulk_soc = v2g_dc_ev_remaining_time_to_bulk_soc;
+            ctx->session.ev_v2g_data.remaining_time_to_bulk_soc = v2g_dc_ev_remaining_time_to_bulk_soc;
             publish_message = true;
         }
     }
@@ -524,7 +551,7 @@ bool add_service_to_service_list(struct v2g_context* v2g_ctx, const struct iso2_
     bool service_found = false;
 
     /* Try to find service in service list */
-    for (uint8_t idx = 0; idx < v2g_ctx->evse_v2g_data.evse_service_list_len; idx++) {
+    for (uint8_t idx = 0; idx < v2g_ctx->session.evse_service_list_len; idx++) {
         if (v2g_ctx->evse_v2g_data.evse_service_list[idx].ServiceID == evse_service.ServiceID) {
             write_idx = idx;
             service_found = true;
@@ -532,10 +559,10 @@ bool add_service_to_service_list(struct v2g_context* v2g_ctx, const struct iso2_
         }
     }
 
-    if (service_found == false && (v2g_ctx->evse_v2g_data.evse_service_list_len < iso2_ServiceType_8_ARRAY_SIZE)) {
-        write_idx = v2g_ctx->evse_v2g_data.evse_service_list_len;
-        v2g_ctx->evse_v2g_data.evse_service_list_len++;
-    } else if (v2g_ctx->evse_v2g_data.evse_service_list_len == iso2_ServiceType_8_ARRAY_SIZE) {
+    if (service_found == false && (v2g_ctx->session.evse_service_list_len < iso2_ServiceType_8_ARRAY_SIZE)) {
+        write_idx = v2g_ctx->session.evse_service_list_len;
+        v2g_ctx->session.evse_service_list_len++;
+    } else if (v2g_ctx->session.evse_service_list_len == iso2_ServiceType_8_ARRAY_SIZE) {
         dlog(DLOG_LEVEL_ERROR, "Maximum service list size reached. Unable to add service ID %u",
              evse_service.ServiceID);
         return false;
@@ -546,7 +573,7 @@ bool add_service_to_service_list(struct v2g_context* v2g_ctx, const struct iso2_
 
     // Configure parameter-set-id if requiered
     for (uint8_t idx = 0; idx < parameter_set_id_len; idx++) {
-        configure_parameter_set(&v2g_ctx->evse_v2g_data.service_parameter_list[write_idx], parameter_set_id[idx],
+        configure_parameter_set(&v2g_ctx->session.service_parameter_list[write_idx], parameter_set_id[idx],
                                 evse_service.ServiceID);
     }
 
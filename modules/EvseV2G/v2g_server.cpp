@@ -13,20 +13,16 @@
 #include <mbedtls/base64.h>
 #endif // EVEREST_MBED_TLS
 
-#include <cbv2g/app_handshake/appHand_Decoder.h>
-#include <cbv2g/app_handshake/appHand_Encoder.h>
 #include <cbv2g/common/exi_basetypes.h>
-#include <cbv2g/din/din_msgDefDecoder.h>
-#include <cbv2g/din/din_msgDefEncoder.h>
 #include <cbv2g/exi_v2gtp.h>
-#include <cbv2g/iso_2/iso2_msgDefDecoder.h>
-#include <cbv2g/iso_2/iso2_msgDefEncoder.h>
 
 #include "connection.hpp"
 #include "din_server.hpp"
+#include "exi_codec.hpp"
 #include "iso_server.hpp"
 #include "log.hpp"
 #include "tools.hpp"
+#include <tracing/tracing.hpp>
 
 #define MAX_RES_TIME 98
 
@@ -248,15 +244,15 @@ static enum v2g_event v2g_handle_apphandshake(struct v2g_connection* conn) {
     uint8_t ev_app_priority = 20; // lowest priority
 
     /* validate handshake request and create response */
-    init_appHand_exiDocument(&conn->handshake_resp);
-    conn->handshake_resp.supportedAppProtocolRes_isUsed = 1;
-    conn->handshake_resp.supportedAppProtocolRes.ResponseCode =
+    init_appHand_exiDocument(conn->handshake_resp);
+    conn->handshake_resp->supportedAppProtocolRes_isUsed = 1;
+    conn->handshake_resp->supportedAppProtocolRes.ResponseCode =
         appHand_responseCodeType_Failed_NoNegotiation; // [V2G2-172]
 
     dlog(DLOG_LEVEL_INFO, "Handling SupportedAppProtocolReq");
     conn->ctx->current_v2g_msg = V2G_SUPPORTED_APP_PROTOCOL_MSG;
 
-    if (decode_appHand_exiDocument(&conn->stream, &conn->handshake_req) != 0) {
+    if (ExiCodec::shared().decode(&conn->stream, conn->handshake_req) != 0) {
         dlog(DLOG_LEVEL_ERROR, "decode_appHandExiDocument() failed");
         return V2G_EVENT_TERMINATE_CONNECTION; // If the mesage can't be decoded we have to terminate the tcp-connection
                                                // (e.g. after an unexpected message)
@@ -264,8 +260,8 @@ static enum v2g_event v2g_handle_apphandshake(struct v2g_connection* conn) {
 
     types::iso15118_charger::AppProtocols app_protocols; // to publish supported app protocol array
 
-    for (i = 0; i < conn->handshake_req.supportedAppProtocolReq.AppProtocol.arrayLen; i++) {
-        struct appHand_AppProtocolType* app_proto = &conn->handshake_req.supportedAppProtocolReq.AppProtocol.array[i];
+    for (i = 0; i < conn->handshake_req->supportedAppProtocolReq.AppProtocol.arrayLen; i++) {
+        struct appHand_AppProtocolType* app_proto = &conn->handshake_req->supportedAppProtocolReq.AppProtocol.array[i];
         char* proto_ns = strndup(static_cast<const char*>(app_proto->ProtocolNamespace.characters),
                                  app_proto->ProtocolNamespace.charactersLen);
 
@@ -282,20 +278,20 @@ static enum v2g_event v2g_handle_apphandshake(struct v2g_connection* conn) {
         if ((conn->ctx->supported_protocols & (1 << V2G_PROTO_DIN70121)) &&
             (strcmp(proto_ns, DIN_70121_MSG_DEF) == 0) && (app_proto->VersionNumberMajor == DIN_70121_MAJOR) &&
             (ev_app_priority >= app_proto->Priority)) {
-            conn->handshake_resp.supportedAppProtocolRes.ResponseCode =
+            conn->handshake_resp->supportedAppProtocolRes.ResponseCode =
                 appHand_responseCodeType_OK_SuccessfulNegotiation;
             ev_app_priority = app_proto->Priority;
-            conn->handshake_resp.supportedAppProtocolRes.SchemaID = app_proto->SchemaID;
+            conn->handshake_resp->supportedAppProtocolRes.SchemaID = app_proto->SchemaID;
             conn->ctx->selected_protocol = V2G_PROTO_DIN70121;
         } else if ((conn->ctx->supported_protocols & (1 << V2G_PROTO_ISO15118_2013)) &&
                    (strcmp(proto_ns, ISO_15118_2013_MSG_DEF) == 0) &&
                    (app_proto->VersionNumberMajor == ISO_15118_2013_MAJOR) &&
                    (ev_app_priority >= app_proto->Priority)) {
 
-            conn->handshake_resp.supportedAppProtocolRes.ResponseCode =
+            conn->handshake_resp->supportedAppProtocolRes.ResponseCode =
                 appHand_responseCodeType_OK_SuccessfulNegotiation;
             ev_app_priority = app_proto->Priority;
-            conn->handshake_resp.supportedAppProtocolRes.SchemaID = app_proto->SchemaID;
+            conn->handshake_resp->supportedAppProtocolRes.SchemaID = app_proto->SchemaID;
             conn->ctx->selected_protocol = V2G_PROTO_ISO15118_2013;
         }
 
@@ -319,9 +315,9 @@ static enum v2g_event v2g_handle_apphandshake(struct v2g_connection* conn) {
     }
 
     std::string selected_protocol_str;
-    if (conn->handshake_resp.supportedAppProtocolRes.ResponseCode ==
+    if (conn->handshake_resp->supportedAppProtocolRes.ResponseCode ==
         appHand_responseCodeType_OK_SuccessfulNegotiation) {
-        conn->handshake_resp.supportedAppProtocolRes.SchemaID_isUsed = (unsigned int)1;
+        conn->handshake_resp->supportedAppProtocolRes.SchemaID_isUsed = (unsigned int)1;
         if (V2G_PROTO_DIN70121 == conn->ctx->selected_protocol) {
             dlog(DLOG_LEVEL_INFO, "Protocol negotiation was successful. Selected protocol is DIN70121");
             selected_protocol_str = "DIN70121";
@@ -350,7 +346,7 @@ static enum v2g_event v2g_handle_apphandshake(struct v2g_connection* conn) {
     /* Validate response code */
     if ((conn->ctx->intl_emergency_shutdown == true) || (conn->ctx->stop_hlc == true) ||
         (V2G_EVENT_SEND_AND_TERMINATE == next_event)) {
-        conn->handshake_resp.supportedAppProtocolRes.ResponseCode = appHand_responseCodeType_Failed_NoNegotiation;
+        conn->handshake_resp->supportedAppProtocolRes.ResponseCode = appHand_responseCodeType_Failed_NoNegotiation;
         dlog(DLOG_LEVEL_ERROR, "Abort charging session");
 
         if (conn->ctx->terminate_connection_on_failed_response == true) {
@@ -362,7 +358,7 @@ static enum v2g_event v2g_handle_apphandshake(struct v2g_connection* conn) {
     conn->stream.byte_pos = V2GTP_HEADER_LENGTH;
     conn->stream.bit_count = 0;
 
-    if (encode_appHand_exiDocument(&conn->stream, &conn->handshake_resp) != 0) {
+    if (ExiCodec::shared().encode(&conn->stream, conn->handshake_resp) != 0) {
         dlog(DLOG_LEVEL_ERROR, "Encoding of the protocol handshake message failed");
         next_event = V2G_EVENT_SEND_AND_TERMINATE;
     }
@@ -382,6 +378,16 @@ int v2g_handle_connection(struct v2g_connection* conn) {
     if (!conn->buffer)
         return -1;
 
+    conn->exi_documents = ExiCodec::shared().acquire();
+    if (conn->exi_documents == NULL) {
+        dlog(DLOG_LEVEL_ERROR, "out-of-memory");
+        free(conn->buffer);
+        conn->buffer = NULL;
+        return -1;
+    }
+    conn->handshake_req = &conn->exi_documents->handshake_req;
+    conn->handshake_resp = &conn->exi_documents->handshake_resp;
+
     /* static setup */
     conn->stream.data = conn->buffer;
 
@@ -411,7 +417,10 @@ int v2g_handle_connection(struct v2g_connection* conn) {
         }
 
         /* next call return -1 on non-recoverable errors, 1 on recoverable errors, 0 on success */
-        rvAppHandshake = v2g_handle_apphandshake(conn);
+        {
+            EVTRACE_SCOPE("EvseV2G::handle_apphandshake");
+            rvAppHandshake = v2g_handle_apphandshake(conn);
+        }
 
         if (rvAppHandshake == V2G_EVENT_IGNORE_MSG) {
             dlog(DLOG_LEVEL_WARNING, "v2g_handle_apphandshake() failed, ignoring packet");
@@ -443,34 +452,17 @@ int v2g_handle_connection(struct v2g_connection* conn) {
     /* Backup the selected protocol, because this value is shared and can be reseted while unplugging. */
     selected_protocol = conn->ctx->selected_protocol;
 
-    /* allocate in/out documents dynamically */
+    /* the documents are kept from the previous connection, they are only cleared if it used the other schema */
+    ExiCodec::select_protocol(conn->exi_documents, selected_protocol);
     switch (selected_protocol) {
     case V2G_PROTO_DIN70121:
     case V2G_PROTO_ISO15118_2010:
-        conn->exi_in.dinEXIDocument = static_cast<struct din_exiDocument*>(calloc(1, sizeof(struct din_exiDocument)));
-        if (conn->exi_in.dinEXIDocument == NULL) {
-            dlog(DLOG_LEVEL_ERROR, "out-of-memory");
-            goto error_out;
-        }
-        conn->exi_out.dinEXIDocument = static_cast<struct din_exiDocument*>(calloc(1, sizeof(struct din_exiDocument)));
-        if (conn->exi_out.dinEXIDocument == NULL) {
-            dlog(DLOG_LEVEL_ERROR, "out-of-memory");
-            goto error_out;
-        }
+        conn->exi_in.dinEXIDocument = &conn->exi_documents->in.din;
+        conn->exi_out.dinEXIDocument = &conn->exi_documents->out.din;
         break;
     case V2G_PROTO_ISO15118_2013:
-        conn->exi_in.iso2EXIDocument =
-            static_cast<struct iso2_exiDocument*>(calloc(1, sizeof(struct iso2_exiDocument)));
-        if (conn->exi_in.iso2EXIDocument == NULL) {
-            dlog(DLOG_LEVEL_ERROR, "out-of-memory");
-            goto error_out;
-        }
-        conn->exi_out.iso2EXIDocument =
-            static_cast<struct iso2_exiDocument*>(calloc(1, sizeof(struct iso2_exiDocument)));
-        if (conn->exi_out.iso2EXIDocument == NULL) {
-            dlog(DLOG_LEVEL_ERROR, "out-of-memory");
-            goto error_out;
-        }
+        conn->exi_in.iso2EXIDocument = &conn->exi_documents->in.iso2;
+        conn->exi_out.iso2EXIDocument = &conn->exi_documents->out.iso2;
         break;
     default:
         goto error_out; //     if protocol is unknown
@@ -502,8 +494,7 @@ int v2g_handle_connection(struct v2g_connection* conn) {
         switch (selected_protocol) {
         case V2G_PROTO_DIN70121:
         case V2G_PROTO_ISO15118_2010:
-            memset(conn->exi_in.dinEXIDocument, 0, sizeof(struct din_exiDocument));
-            rv = decode_din_exiDocument(&conn->stream, conn->exi_in.dinEXIDocument);
+            rv = ExiCodec::shared().decode(&conn->stream, conn->exi_in.dinEXIDocument);
             if (rv != 0) {
                 dlog(DLOG_LEVEL_ERROR, "decode_dinExiDocument() (previous message \"%s\") failed: %d",
                      v2g_msg_type[conn->ctx->last_v2g_msg], rv);
@@ -513,14 +504,16 @@ int v2g_handle_connection(struct v2g_connection* conn) {
                 break;
             }
 
-            memset(conn->exi_out.dinEXIDocument, 0, sizeof(struct din_exiDocument));
+            ExiCodec::clear_response(conn->exi_out.dinEXIDocument);
 
-            v2gEvent = din_handle_request(conn);
+            {
+                EVTRACE_SCOPE("EvseV2G::din_handle_request");
+                v2gEvent = din_handle_request(conn);
+            }
             break;
 
         case V2G_PROTO_ISO15118_2013:
-            memset(conn->exi_in.iso2EXIDocument, 0, sizeof(struct iso2_exiDocument));
-            rv = decode_iso2_exiDocument(&conn->stream, conn->exi_in.iso2EXIDocument);
+            rv = ExiCodec::shared().decode(&conn->stream, conn->exi_in.iso2EXIDocument);
             if (rv != 0) {
                 dlog(DLOG_LEVEL_ERROR, "decode_iso2_exiDocument() (previous message \"%s\") failed: %d",
                      v2g_msg_type[conn->ctx->last_v2g_msg], rv);
@@ -530,9 +523,12 @@ int v2g_handle_connection(struct v2g_connection* conn) {
                 break;
             }
             conn->stream.byte_pos = 0; // Reset pos for the case if exi msg will be configured over mqtt
-            memset(conn->exi_out.iso2EXIDocument, 0, sizeof(struct iso2_exiDocument));
+            ExiCodec::clear_response(conn->exi_out.iso2EXIDocument);
 
-            v2gEvent = iso_handle_request(conn);
+            {
+                EVTRACE_SCOPE("EvseV2G::iso_handle_request");
+                v2gEvent = iso_handle_request(conn);
+            }
 
             break;
         default:
@@ -558,13 +554,13 @@ int v2g_handle_connection(struct v2g_connection* conn) {
             switch (selected_protocol) {
             case V2G_PROTO_DIN70121:
             case V2G_PROTO_ISO15118_2010:
-                if ((rv = encode_din_exiDocument(&conn->stream, conn->exi_out.dinEXIDocument)) != 0) {
+                if ((rv = ExiCodec::shared().encode(&conn->stream, conn->exi_out.dinEXIDocument)) != 0) {
                     dlog(DLOG_LEVEL_ERROR, "encode_dinExiDocument() (message \"%s\") failed: %d",
                          v2g_msg_type[conn->ctx->current_v2g_msg], rv);
                 }
                 break;
             case V2G_PROTO_ISO15118_2013:
-                if ((rv = encode_iso2_exiDocument(&conn->stream, conn->exi_out.iso2EXIDocument)) != 0) {
+                if ((rv = ExiCodec::shared().encode(&conn->stream, conn->exi_out.iso2EXIDocument)) != 0) {
                     dlog(DLOG_LEVEL_ERROR, "encode_iso2_exiDocument() (message \"%s\") failed: %d",
                          v2g_msg_type[conn->ctx->current_v2g_msg], rv);
                 }
@@ -611,23 +607,12 @@ int v2g_handle_connection(struct v2g_connection* conn) {
     } while ((rv == 0) && (stop_receiving_loop == false));
 
 error_out:
-    switch (selected_protocol) {
-    case V2G_PROTO_DIN70121:
-    case V2G_PROTO_ISO15118_2010:
-        if (conn->exi_in.dinEXIDocument != NULL)
-            free(conn->exi_in.dinEXIDocument);
-        if (conn->exi_out.dinEXIDocument != NULL)
-            free(conn->exi_out.dinEXIDocument);
-        break;
-    case V2G_PROTO_ISO15118_2013:
-        if (conn->exi_in.iso2EXIDocument != NULL)
-            free(conn->exi_in.iso2EXIDocument);
-        if (conn->exi_out.iso2EXIDocument != NULL)
-            free(conn->exi_out.iso2EXIDocument);
-        break;
-    default:
-        break;
-    }
+    ExiCodec::shared().release(conn->exi_documents);
+    conn->exi_documents = NULL;
+    conn->handshake_req = NULL;
+    conn->handshake_resp = NULL;
+    conn->exi_in.iso2EXIDocument = NULL;
+    conn->exi_out.iso2EXIDocument = NULL;
 
     if (conn->buffer != NULL) {
         free(conn->buffer);
@@ -5,11 +5,17 @@
 namespace module {
 
 void GenericPowermeter::init() {
+    this->startup_profiler = std::make_unique<StartupProfiler>(this->info.id);
+    auto phase = this->startup_profiler->measure("init");
     invoke_init(*p_main);
 }
 
 void GenericPowermeter::ready() {
-    invoke_ready(*p_main);
+    {
+        auto phase = this->startup_profiler->measure("ready");
+        invoke_ready(*p_main);
+    }
+    this->startup_profiler->ready_done();
 }
 
 } // namespace module
@@ -18,6 +18,7 @@
 
 // ev@4bf81b14-a215-475c-a1d3-0a484ae48918:v1
 // insert your custom include headers here
+#include <startup_profiler/startup_profiler.hpp>
 // ev@4bf81b14-a215-475c-a1d3-0a484ae48918:v1
 
 namespace module {
@@ -37,6 +38,7 @@ public:
 
     // ev@1fce4c5e-0ab8-41bb-90f7-14277703d2ac:v1
     // insert your public definitions here
+    std::unique_ptr<StartupProfiler> startup_profiler;
     // ev@1fce4c5e-0ab8-41bb-90f7-14277703d2ac:v1
 
 protected:
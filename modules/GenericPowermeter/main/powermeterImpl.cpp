@@ -23,19 +23,25 @@ void powermeterImpl::init() {
         // FIXME (aw): path validation?
         auto model = this->mod->info.paths.share / MODELS_SUB_DIR / fmt::format("{}.yaml", config.model);
 
-        try {
-            json powermeter_registers = Everest::load_yaml(model);
-            this->init_register_assignments(std::move(powermeter_registers));
-            this->init_default_values();
-        } catch (const std::exception& e) {
-            EVLOG_error << "opening file \"" << config.model << ".yaml\" from path " << model
-                        << "\" failed: " << e.what();
-            throw std::runtime_error("Module \"GenericPowermeter\" could not be initialized!");
-        }
+        // parsing the model does not need to delay the init of the other modules, the readout starts in ready()
+        this->model_loaded = this->mod->startup_profiler->run_concurrently("load_model", [this, model]() {
+            try {
+                json powermeter_registers = Everest::load_yaml(model);
+                this->init_register_assignments(std::move(powermeter_registers));
+                this->init_default_values();
+            } catch (const std::exception& e) {
+                EVLOG_error << "opening file \"" << config.model << ".yaml\" from path " << model
+                            << "\" failed: " << e.what();
+                throw std::runtime_error("Module \"GenericPowermeter\" could not be initialized!");
+            }
+        });
     }
 }
 
 void powermeterImpl::ready() {
+    if (this->model_loaded.valid()) {
+        this->model_loaded.get();
+    }
     if (this->config_loaded_successfully) {
         std::thread t([this] {
             while (true) {
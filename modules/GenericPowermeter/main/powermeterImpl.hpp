@@ -103,6 +103,7 @@ private:
 
     std::vector<RegisterData> pm_configuration;
     bool config_loaded_successfully = {false};
+    std::shared_future<void> model_loaded;
 
     types::powermeter::Powermeter pm_last_values;
 
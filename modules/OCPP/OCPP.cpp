@@ -17,6 +17,8 @@ namespace module {
 const std::string CERTS_SUB_DIR = "certs";
 const std::string SQL_CORE_MIGRTATIONS = "core_migrations";
 const std::string INOPERATIVE_ERROR_TYPE = "evse_manager/Inoperative";
+// composite schedules are requested for this many times the published duration and served from the cache meanwhile
+constexpr int COMPOSITE_SCHEDULE_HORIZON_FACTOR = 2;
 
 namespace fs = std::filesystem;
 
@@ -75,45 +77,61 @@ void create_empty_user_config(const fs::path& user_config_path) {
 void OCPP::set_external_limits(const std::map<int32_t, ocpp::v16::EnhancedChargingSchedule>& charging_schedules) {
     const auto start_time = ocpp::DateTime();
 
+    std::lock_guard<std::mutex> lock(this->external_limits_mutex);
+
     // iterate over all schedules reported by the libocpp to create ExternalLimits
-    // for each connector
+    // for each connector whose effective schedule changed since it was last sent
     for (auto const& [connector_id, schedule] : charging_schedules) {
-        types::energy::ExternalLimits limits;
-        std::vector<types::energy::ScheduleReqEntry> schedule_import;
-        for (const auto period : schedule.chargingSchedulePeriod) {
-            types::energy::ScheduleReqEntry schedule_req_entry;
-            types::energy::LimitsReq limits_req;
-            const auto timestamp = start_time.to_time_point() + std::chrono::seconds(period.startPeriod);
-            schedule_req_entry.timestamp = ocpp::DateTime(timestamp).to_rfc3339();
-            if (schedule.chargingRateUnit == ocpp::v16::ChargingRateUnit::A) {
-                limits_req.ac_max_current_A = period.limit;
-                if (period.numberPhases.has_value()) {
-                    limits_req.ac_max_phase_count = period.numberPhases.value();
-                }
-                if (schedule.minChargingRate.has_value()) {
-                    limits_req.ac_min_current_A = schedule.minChargingRate.value();
-                }
-            } else {
-                limits_req.total_power_W = period.limit;
-            }
-            schedule_req_entry.limits_to_leaves = limits_req;
-            schedule_import.push_back(schedule_req_entry);
+        const auto limits = this->external_limits_cache->update(connector_id, schedule, start_time);
+        if (!limits.has_value()) {
+            continue;
         }
-        limits.schedule_import.emplace(schedule_import);
 
         if (connector_id == 0) {
             if (!this->r_connector_zero_sink.empty()) {
-                EVLOG_debug << "OCPP sets the following external limits for connector 0: \n" << limits;
-                this->r_connector_zero_sink.at(0)->call_set_external_limits(limits);
+                EVLOG_debug << "OCPP sets the following external limits for connector 0: \n" << limits.value();
+                this->r_connector_zero_sink.at(0)->call_set_external_limits(limits.value());
             } else {
                 EVLOG_debug << "OCPP cannot set external limits for connector 0. No "
                                "sink is configured.";
             }
         } else {
-            EVLOG_debug << "OCPP sets the following external limits for connector " << connector_id << ": \n" << limits;
-            this->r_evse_manager.at(connector_id - 1)->call_set_external_limits(limits);
+            EVLOG_debug << "OCPP sets the following external limits for connector " << connector_id << ": \n"
+                        << limits.value();
+            this->r_evse_manager.at(connector_id - 1)->call_set_external_limits(limits.value());
         }
     }
+
+    const auto& stats = this->external_limits_cache->get_stats();
+    EVLOG_debug << "External limits updates sent: " << stats.updates_sent
+                << ", suppressed as unchanged: " << stats.updates_suppressed;
+}
+
+void OCPP::invalidate_external_limits(int32_t connector_id) {
+    std::lock_guard<std::mutex> lock(this->external_limits_mutex);
+    this->external_limits_cache->invalidate(connector_id);
+}
+
+std::map<int32_t, ocpp::v16::EnhancedChargingSchedule> OCPP::get_charging_schedules() {
+    const auto duration = std::chrono::seconds(this->config.PublishChargingScheduleDurationS);
+    const auto now = ocpp::DateTime();
+
+    std::lock_guard<std::mutex> lock(this->composite_schedule_mutex);
+    if (!this->composite_schedule_cache.covers(now.to_time_point() + duration)) {
+        // request a longer horizon from libocpp so that the following publish intervals can slide over the cached
+        // composite schedules without recalculating them
+        const auto horizon = duration * COMPOSITE_SCHEDULE_HORIZON_FACTOR;
+        const auto start_time = ocpp::DateTime();
+        const auto charging_schedules =
+            this->charge_point->get_all_enhanced_composite_charging_schedules(horizon.count());
+        this->composite_schedule_cache.update(charging_schedules, start_time, horizon);
+    }
+    return this->composite_schedule_cache.get_schedules(now, duration);
+}
+
+void OCPP::invalidate_charging_schedules() {
+    std::lock_guard<std::mutex> lock(this->composite_schedule_mutex);
+    this->composite_schedule_cache.invalidate();
 }
 
 void OCPP::publish_charging_schedules(
@@ -133,10 +151,12 @@ void OCPP::process_session_event(int32_t evse_id, const types::evse_manager::Ses
     auto ocpp_connector_id = this->evse_connector_map[evse_id][everest_connector_id];
 
     if (session_event.event == types::evse_manager::SessionEventEnum::Enabled) {
+        this->invalidate_external_limits(ocpp_connector_id);
         this->charge_point->on_enabled(evse_id);
     } else if (session_event.event == types::evse_manager::SessionEventEnum::Disabled) {
         EVLOG_debug << "EVSE#" << evse_id << ": "
                     << "Received Disabled";
+        this->invalidate_external_limits(ocpp_connector_id);
         this->charge_point->on_disabled(evse_id);
     } else if (session_event.event == types::evse_manager::SessionEventEnum::TransactionStarted) {
         EVLOG_info << "EVSE#" << evse_id << ": "
@@ -160,6 +180,8 @@ void OCPP::process_session_event(int32_t evse_id, const types::evse_manager::Ses
         }
         this->charge_point->on_transaction_started(ocpp_connector_id, session_event.uuid, id_token, energy_Wh_import,
                                                    reservation_id_opt, timestamp, signed_meter_data);
+        // TxProfiles and TxDefaultProfiles now apply to this connector
+        this->invalidate_charging_schedules();
     } else if (session_event.event == types::evse_manager::SessionEventEnum::ChargingPausedEV) {
         EVLOG_debug << "Connector#" << ocpp_connector_id << ": "
                     << "Received ChargingPausedEV";
@@ -177,6 +199,7 @@ void OCPP::process_session_event(int32_t evse_id, const types::evse_manager::Ses
     } else if (session_event.event == types::evse_manager::SessionEventEnum::TransactionFinished) {
         EVLOG_debug << "Connector#" << ocpp_connector_id << ": "
                     << "Received TransactionFinished";
+        this->flush_meter_value(evse_id);
 
         const auto transaction_finished = session_event.transaction_finished.value();
         const auto timestamp = ocpp::DateTime(session_event.timestamp);
@@ -199,6 +222,7 @@ void OCPP::process_session_event(int32_t evse_id, const types::evse_manager::Ses
         }
         this->charge_point->on_transaction_stopped(ocpp_connector_id, session_event.uuid, reason, timestamp,
                                                    energy_Wh_import, id_tag_opt, signed_meter_data);
+        this->invalidate_charging_schedules();
         // always triggered by libocpp
     } else if (session_event.event == types::evse_manager::SessionEventEnum::SessionStarted) {
         EVLOG_info << "Connector#" << ocpp_connector_id << ": "
@@ -212,7 +236,8 @@ void OCPP::process_session_event(int32_t evse_id, const types::evse_manager::Ses
         EVLOG_debug << "Connector#" << ocpp_connector_id << ": "
                     << "Received SessionFinished";
         // ev side disconnect
-        this->evse_soc_map[evse_id].reset();
+        this->flush_meter_value(evse_id);
+        this->evse_states->reset_soc(evse_id);
         this->charge_point->on_session_stopped(ocpp_connector_id, session_event.uuid);
     } else if (session_event.event == types::evse_manager::SessionEventEnum::ReservationStart) {
         this->charge_point->on_reservation_start(ocpp_connector_id);
@@ -226,19 +251,21 @@ void OCPP::process_session_event(int32_t evse_id, const types::evse_manager::Ses
 void OCPP::init_evse_subscriptions() {
     int32_t evse_id = 1;
     for (auto& evse : this->r_evse_manager) {
-        evse->subscribe_powermeter([this, evse_id](types::powermeter::Powermeter powermeter) {
-            ocpp::Measurement measurement;
-            measurement.power_meter = conversions::to_ocpp_power_meter(powermeter);
-            if (this->evse_soc_map[evse_id].has_value()) {
-                // soc is present, so add this to the measurement
-                measurement.soc_Percent = ocpp::StateOfCharge{this->evse_soc_map[evse_id].value()};
+        evse->subscribe_powermeter([this, evse_id](const types::powermeter::Powermeter& power_meter) {
+            if (this->meter_value_aggregators.empty()) {
+                this->send_meter_value(evse_id, power_meter);
+                return;
+            }
+            const auto aggregated =
+                this->meter_value_aggregators.at(evse_id - 1)->add(power_meter, std::chrono::system_clock::now());
+            if (aggregated.has_value()) {
+                this->send_meter_value(evse_id, aggregated.value());
             }
-            this->charge_point->on_meter_values(evse_id, measurement);
         });
 
         evse->subscribe_ev_info([this, evse_id](const types::evse_manager::EVInfo& ev_info) {
             if (ev_info.soc.has_value()) {
-                this->evse_soc_map[evse_id] = ev_info.soc.value();
+                this->evse_states->set_soc(evse_id, ev_info.soc.value());
             }
         });
 
@@ -309,19 +336,53 @@ void OCPP::init_evse_connector_map() {
     }
 }
 
-void OCPP::init_evse_maps() {
-    std::lock_guard<std::mutex> lk(this->evse_ready_mutex);
-    for (size_t evse_id = 1; evse_id <= this->r_evse_manager.size(); evse_id++) {
-        this->evse_ready_map[evse_id] = false;
-        this->evse_soc_map[evse_id] = std::nullopt;
+void OCPP::init_evse_states() {
+    this->evse_states = std::make_unique<EvseStateTable>(this->r_evse_manager.size());
+
+    if (this->config.MeterValueAggregationInterval > 0) {
+        const auto reduction = meter_value_reduction_from_string(this->config.MeterValueAggregationReduction);
+        for (size_t evse_id = 1; evse_id <= this->r_evse_manager.size(); evse_id++) {
+            this->meter_value_aggregators.push_back(std::make_unique<MeterValueAggregator>(
+                std::chrono::seconds(this->config.MeterValueAggregationInterval), reduction));
+        }
+        // sends an interval at its end, even if the next sample is late
+        this->meter_value_aggregation_timer = std::make_unique<Everest::SteadyTimer>([this]() {
+            const auto now = std::chrono::system_clock::now();
+            for (size_t i = 0; i < this->meter_value_aggregators.size(); i++) {
+                const auto aggregated = this->meter_value_aggregators.at(i)->close_if_due(now);
+                if (aggregated.has_value()) {
+                    this->send_meter_value(static_cast<int32_t>(i + 1), aggregated.value());
+                }
+            }
+        });
+        this->meter_value_aggregation_timer->interval(std::chrono::seconds(1));
+    }
+}
+
+void OCPP::flush_meter_value(const int32_t evse_id) {
+    if (this->meter_value_aggregators.empty()) {
+        return;
     }
+    const auto aggregated = this->meter_value_aggregators.at(evse_id - 1)->flush();
+    if (aggregated.has_value()) {
+        this->send_meter_value(evse_id, aggregated.value());
+    }
+}
+
+void OCPP::send_meter_value(const int32_t evse_id, const types::powermeter::Powermeter& power_meter) {
+    ocpp::Measurement measurement;
+    measurement.power_meter = conversions::to_ocpp_power_meter(power_meter);
+    const auto soc = this->evse_states->get_soc(evse_id);
+    if (soc.has_value()) {
+        // soc is present, so add this to the measurement
+        measurement.soc_Percent = ocpp::StateOfCharge{soc.value()};
+    }
+    this->charge_point->on_meter_values(evse_id, measurement);
 }
 
 bool OCPP::all_evse_ready() {
-    for (auto const& [evse, ready] : this->evse_ready_map) {
-        if (!ready) {
-            return false;
-        }
+    if (!this->evse_states->all_ready()) {
+        return false;
     }
     EVLOG_info << "All EVSE ready. Starting OCPP1.6 service";
     return true;
@@ -356,13 +417,13 @@ void OCPP::init() {
 
     subscribe_global_all_errors(error_handler, error_cleared_handler);
 
-    this->init_evse_maps();
+    this->init_evse_states();
 
     for (size_t evse_id = 1; evse_id <= this->r_evse_manager.size(); evse_id++) {
         this->r_evse_manager.at(evse_id - 1)->subscribe_waiting_for_external_ready([this, evse_id](bool ready) {
             std::lock_guard<std::mutex> lk(this->evse_ready_mutex);
             if (ready) {
-                this->evse_ready_map[evse_id] = true;
+                this->evse_states->set_ready(evse_id);
                 this->evse_ready_cv.notify_one();
             }
         });
@@ -371,12 +432,12 @@ void OCPP::init() {
         this->r_evse_manager.at(evse_id - 1)->subscribe_ready([this, evse_id](bool ready) {
             std::lock_guard<std::mutex> lk(this->evse_ready_mutex);
             if (ready) {
-                if (!this->evse_ready_map[evse_id]) {
+                if (!this->evse_states->is_ready(evse_id)) {
                     EVLOG_error << "Received EVSE ready without receiving waiting_for_external_ready first, this is "
                                    "probably a bug in your evse_manager implementation / configuration. evse_id: "
                                 << evse_id;
                 }
-                this->evse_ready_map[evse_id] = true;
+                this->evse_states->set_ready(evse_id);
                 this->evse_ready_cv.notify_one();
             }
         });
@@ -663,15 +724,17 @@ void OCPP::ready() {
                              [this](const std::string& data) { this->charge_point->disconnect_websocket(); });
     }
 
+    // refresh unchanged limits once half of the published schedule duration has passed
+    this->external_limits_cache =
+        std::make_unique<ExternalLimitsCache>(std::chrono::seconds(this->config.PublishChargingScheduleDurationS / 2));
+
     // publish charging schedules at least once on startup
-    const auto charging_schedules = this->charge_point->get_all_enhanced_composite_charging_schedules(
-        this->config.PublishChargingScheduleDurationS);
+    const auto charging_schedules = this->get_charging_schedules();
     this->set_external_limits(charging_schedules);
     this->publish_charging_schedules(charging_schedules);
 
     this->charging_schedules_timer = std::make_unique<Everest::SteadyTimer>([this]() {
-        const auto charging_schedules = this->charge_point->get_all_enhanced_composite_charging_schedules(
-            this->config.PublishChargingScheduleDurationS);
+        const auto charging_schedules = this->get_charging_schedules();
         this->set_external_limits(charging_schedules);
         this->publish_charging_schedules(charging_schedules);
     });
@@ -683,8 +746,8 @@ void OCPP::ready() {
         // this is executed when CSMS sends new ChargingProfile that is accepted by
         // the ChargePoint
         EVLOG_info << "Received new Charging Schedules from CSMS";
-        const auto charging_schedules = this->charge_point->get_all_enhanced_composite_charging_schedules(
-            this->config.PublishChargingScheduleDurationS);
+        this->invalidate_charging_schedules();
+        const auto charging_schedules = this->get_charging_schedules();
         this->set_external_limits(charging_schedules);
         this->publish_charging_schedules(charging_schedules);
     });
@@ -43,6 +43,11 @@
 #include <ocpp/v16/types.hpp>
 #include <ocpp/v201/ocpp_types.hpp>
 
+#include "composite_schedule_cache.hpp"
+#include "external_limits_cache.hpp"
+#include <evse_state_table.hpp>
+#include <meter_value_aggregator.hpp>
+
 using EvseConnectorMap = std::map<int32_t, std::map<int32_t, int32_t>>;
 using ClearedErrorId = std::string;
 using EventQueue =
@@ -61,6 +66,8 @@ struct Conf {
     int PublishChargingScheduleDurationS;
     std::string MessageLogPath;
     int MessageQueueResumeDelay;
+    int MeterValueAggregationInterval;
+    std::string MeterValueAggregationReduction;
 };
 
 class OCPP : public Everest::ModuleBase {
@@ -130,17 +137,31 @@ private:
     // ev@211cfdbe-f69a-4cd6-a4ec-f8aaa3d1b6c8:v1
     // insert your private definitions here
     std::filesystem::path ocpp_share_path;
+    CompositeScheduleCache composite_schedule_cache;
+    std::mutex composite_schedule_mutex;
+    std::map<int32_t, ocpp::v16::EnhancedChargingSchedule> get_charging_schedules();
+    void invalidate_charging_schedules();
+    std::unique_ptr<ExternalLimitsCache> external_limits_cache;
+    std::mutex external_limits_mutex;
     void set_external_limits(const std::map<int32_t, ocpp::v16::EnhancedChargingSchedule>& charging_schedules);
+    // the next limits of an EVSE that became (un)available are sent even if its schedule did not change
+    void invalidate_external_limits(int32_t connector_id);
     void publish_charging_schedules(const std::map<int32_t, ocpp::v16::EnhancedChargingSchedule>& charging_schedules);
 
     void init_evse_subscriptions(); // initialize subscriptions to all EVSEs provided by r_evse_manager
     void init_evse_connector_map();
-    void init_evse_maps();
+    void init_evse_states();
     EvseConnectorMap evse_connector_map; // provides access to OCPP connector id by using EVerests evse and connector id
     std::map<int32_t, int32_t>
         connector_evse_index_map; // provides access to r_evse_manager index by using OCPP connector id
-    std::map<int32_t, bool> evse_ready_map;
-    std::map<int32_t, std::optional<float>> evse_soc_map;
+    std::unique_ptr<EvseStateTable> evse_states;
+    // one per EVSE, empty if meter values are not aggregated
+    std::vector<std::unique_ptr<MeterValueAggregator>> meter_value_aggregators;
+    // declared after the aggregators, so it is stopped before they are destroyed
+    std::unique_ptr<Everest::SteadyTimer> meter_value_aggregation_timer;
+    void send_meter_value(const int32_t evse_id, const types::powermeter::Powermeter& power_meter);
+    // sends the samples of the current interval, so they are part of the transaction that ends
+    void flush_meter_value(const int32_t evse_id);
     std::set<std::string> resuming_session_ids;
     std::mutex evse_ready_mutex;
     std::condition_variable evse_ready_cv;
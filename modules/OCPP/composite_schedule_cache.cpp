@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "composite_schedule_cache.hpp"
+
+#include <iterator>
+
+namespace module {
+
+static bool is_same_limit(const CompositeScheduleCache::Limit& a, const CompositeScheduleCache::Limit& b) {
+    return a.unit == b.unit and a.limit == b.limit and a.number_phases == b.number_phases;
+}
+
+void CompositeScheduleCache::update(int32_t connector_id, const ocpp::v16::EnhancedChargingSchedule& schedule,
+                                    const ocpp::DateTime& start_time, std::chrono::seconds horizon) {
+    ConnectorSchedule connector;
+    connector.unit = schedule.chargingRateUnit;
+    connector.min_charging_rate = schedule.minChargingRate;
+    connector.has_start_schedule = schedule.startSchedule.has_value();
+    connector.start = start_time.to_time_point();
+    connector.end = connector.start + horizon;
+
+    // periods are sorted by startPeriod, so every insertion goes to the end of the map
+    for (const auto& period : schedule.chargingSchedulePeriod) {
+        const auto start = connector.start + std::chrono::seconds(period.startPeriod);
+        if (start >= connector.end) {
+            break;
+        }
+        connector.periods.insert_or_assign(
+            connector.periods.end(), start,
+            Period{period.limit, period.numberPhases, period.stackLevel, period.periodTransformed});
+
+        const Limit limit{connector.unit, period.limit, period.numberPhases};
+        if (connector.changes.empty() or not is_same_limit(std::prev(connector.changes.end())->second, limit)) {
+            connector.changes.insert_or_assign(connector.changes.end(), start, limit);
+        }
+    }
+
+    this->connectors.insert_or_assign(connector_id, std::move(connector));
+}
+
+void CompositeScheduleCache::update(const std::map<int32_t, ocpp::v16::EnhancedChargingSchedule>& schedules,
+                                    const ocpp::DateTime& start_time, std::chrono::seconds horizon) {
+    for (const auto& [connector_id, schedule] : schedules) {
+        this->update(connector_id, schedule, start_time, horizon);
+    }
+    // connectors libocpp does not report anymore must not be served from the cache
+    for (auto it = this->connectors.begin(); it != this->connectors.end();) {
+        if (schedules.count(it->first) == 0) {
+            it = this->connectors.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    this->valid = true;
+}
+
+void CompositeScheduleCache::invalidate() {
+    this->valid = false;
+}
+
+bool CompositeScheduleCache::covers(const TimePoint& time) const {
+    if (not this->valid or this->connectors.empty()) {
+        return false;
+    }
+    for (const auto& [connector_id, connector] : this->connectors) {
+        if (connector.end < time) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<CompositeScheduleCache::Limit> CompositeScheduleCache::limit_at(int32_t connector_id,
+                                                                              const TimePoint& time) const {
+    const auto connector = this->connectors.find(connector_id);
+    if (connector == this->connectors.end()) {
+        return std::nullopt;
+    }
+    const auto& changes = connector->second.changes;
+    if (time < connector->second.start or time >= connector->second.end or changes.empty()) {
+        return std::nullopt;
+    }
+
+    auto it = changes.upper_bound(time);
+    if (it == changes.begin()) {
+        return std::nullopt;
+    }
+    return std::prev(it)->second;
+}
+
+std::optional<CompositeScheduleCache::TimePoint> CompositeScheduleCache::next_change(int32_t connector_id,
+                                                                                     const TimePoint& time) const {
+    const auto connector = this->connectors.find(connector_id);
+    if (connector == this->connectors.end()) {
+        return std::nullopt;
+    }
+    const auto it = connector->second.changes.upper_bound(time);
+    if (it == connector->second.changes.end() or it->first >= connector->second.end) {
+        return std::nullopt;
+    }
+    return it->first;
+}
+
+std::map<int32_t, ocpp::v16::EnhancedChargingSchedule>
+CompositeScheduleCache::get_schedules(const ocpp::DateTime& start_time, std::chrono::seconds duration) const {
+    std::map<int32_t, ocpp::v16::EnhancedChargingSchedule> schedules;
+
+    const auto window_start = start_time.to_time_point();
+    const auto window_end = window_start + duration;
+
+    for (const auto& [connector_id, connector] : this->connectors) {
+        ocpp::v16::EnhancedChargingSchedule schedule;
+        schedule.chargingRateUnit = connector.unit;
+        schedule.minChargingRate = connector.min_charging_rate;
+        schedule.duration = static_cast<int32_t>(duration.count());
+        if (connector.has_start_schedule) {
+            schedule.startSchedule = start_time;
+        }
+
+        // begin with the period that is active at the start of the window
+        auto it = connector.periods.upper_bound(window_start);
+        if (it != connector.periods.begin()) {
+            it = std::prev(it);
+        }
+
+        for (; it != connector.periods.end() and it->first < window_end and it->first < connector.end; ++it) {
+            ocpp::v16::EnhancedChargingSchedulePeriod period;
+            period.startPeriod =
+                it->first <= window_start
+                    ? 0
+                    : static_cast<int32_t>(
+                          std::chrono::duration_cast<std::chrono::seconds>(it->first - window_start).count());
+            period.limit = it->second.limit;
+            period.numberPhases = it->second.number_phases;
+            period.stackLevel = it->second.stack_level;
+            period.periodTransformed = it->second.period_transformed;
+
+            // a period starting less than a second after the previous one replaces it
+            if (not schedule.chargingSchedulePeriod.empty() and
+                schedule.chargingSchedulePeriod.back().startPeriod >= period.startPeriod) {
+                schedule.chargingSchedulePeriod.back() = period;
+            } else {
+                schedule.chargingSchedulePeriod.push_back(period);
+            }
+        }
+
+        schedules.emplace(connector_id, std::move(schedule));
+    }
+
+    return schedules;
+}
+
+} // namespace module
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef OCPP_COMPOSITE_SCHEDULE_CACHE_HPP
+#define OCPP_COMPOSITE_SCHEDULE_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+
+#include <ocpp/common/types.hpp>
+#include <ocpp/v16/types.hpp>
+
+namespace module {
+
+/// \brief Keeps the composite schedules reported by libocpp as sorted absolute intervals per connector.
+///
+/// libocpp recalculates the composite schedule of all stacked profiles over the whole requested horizon on every
+/// call. The cache is filled with a horizon longer than the published duration and then serves the sliding
+/// publishing window from the absolute intervals, until the window reaches the end of the cached horizon or the
+/// cache is invalidated because profiles or transactions changed. Connectors are updated independently.
+/// Looking up the limit at a point in time and the next change after it are O(log n) in the number of periods.
+class CompositeScheduleCache {
+public:
+    using TimePoint = std::chrono::time_point<date::utc_clock>;
+
+    /// \brief The effective limit of a connector at a point in time
+    struct Limit {
+        ocpp::v16::ChargingRateUnit unit;
+        float limit;
+        std::optional<int32_t> number_phases;
+    };
+
+    /// \brief Replace the cached composite schedule of \p connector_id
+    /// \param start_time the point in time the periods of \p schedule are relative to
+    /// \param horizon the duration the schedule was requested for
+    void update(int32_t connector_id, const ocpp::v16::EnhancedChargingSchedule& schedule,
+                const ocpp::DateTime& start_time, std::chrono::seconds horizon);
+
+    /// \brief Replace the cached composite schedules of all connectors in \p schedules, this also marks the cache as
+    /// valid again
+    void update(const std::map<int32_t, ocpp::v16::EnhancedChargingSchedule>& schedules,
+                const ocpp::DateTime& start_time, std::chrono::seconds horizon);
+
+    /// \brief Marks the cache as outdated, e.g. because the set of installed profiles or transactions changed
+    void invalidate();
+
+    /// \brief Returns true if the cache is valid and holds schedules for all connectors up to \p time
+    bool covers(const TimePoint& time) const;
+
+    /// \brief Returns the limit of \p connector_id at \p time, std::nullopt if \p time is outside of the cached horizon
+    std::optional<Limit> limit_at(int32_t connector_id, const TimePoint& time) const;
+
+    /// \brief Returns the first point in time after \p time at which the limit of \p connector_id changes,
+    /// std::nullopt if it does not change within the cached horizon
+    std::optional<TimePoint> next_change(int32_t connector_id, const TimePoint& time) const;
+
+    /// \brief Returns the composite schedules of all connectors for the window [\p start_time, \p start_time +
+    /// \p duration) in the same relative form libocpp reports them
+    std::map<int32_t, ocpp::v16::EnhancedChargingSchedule> get_schedules(const ocpp::DateTime& start_time,
+                                                                          std::chrono::seconds duration) const;
+
+private:
+    struct Period {
+        float limit;
+        std::optional<int32_t> number_phases;
+        int32_t stack_level;
+        bool period_transformed;
+    };
+
+    struct ConnectorSchedule {
+        ocpp::v16::ChargingRateUnit unit;
+        std::optional<float> min_charging_rate;
+        bool has_start_schedule;
+        TimePoint start;
+        TimePoint end;
+        /// all periods as reported by libocpp, keyed by their absolute start
+        std::map<TimePoint, Period> periods;
+        /// only the points in time at which the effective limit changes
+        std::map<TimePoint, Limit> changes;
+    };
+
+    std::map<int32_t, ConnectorSchedule> connectors;
+    bool valid{false};
+};
+
+} // namespace module
+
+#endif // OCPP_COMPOSITE_SCHEDULE_CACHE_HPP
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "external_limits_cache.hpp"
+
+#include <cmath>
+
+namespace module {
+
+// libocpp calculates period offsets in whole seconds against its own notion of "now", so the same absolute period
+// start can move by up to a second between two calculations
+constexpr auto PERIOD_START_TOLERANCE = std::chrono::seconds(2);
+constexpr float LIMIT_TOLERANCE = 0.001F;
+
+ExternalLimitsCache::ExternalLimitsCache(std::chrono::seconds max_age) : max_age(max_age) {
+}
+
+std::optional<types::energy::ExternalLimits>
+ExternalLimitsCache::update(int32_t connector_id, const ocpp::v16::EnhancedChargingSchedule& schedule,
+                            const ocpp::DateTime& start_time) {
+    const auto now = start_time.to_time_point();
+
+    Entry entry;
+    entry.unit = schedule.chargingRateUnit;
+    entry.min_charging_rate = schedule.minChargingRate;
+    entry.periods.reserve(schedule.chargingSchedulePeriod.size());
+    for (const auto& period : schedule.chargingSchedulePeriod) {
+        entry.periods.push_back({now + std::chrono::seconds(period.startPeriod), period.limit, period.numberPhases});
+    }
+    entry.sent_at = now;
+
+    auto last = this->entries.find(connector_id);
+    if (last != this->entries.end() and now - last->second.sent_at < this->max_age and is_equal(last->second, entry)) {
+        this->stats.updates_suppressed++;
+        return std::nullopt;
+    }
+
+    auto limits = to_external_limits(entry);
+    this->entries.insert_or_assign(connector_id, std::move(entry));
+    this->stats.updates_sent++;
+    return limits;
+}
+
+void ExternalLimitsCache::invalidate(int32_t connector_id) {
+    this->entries.erase(connector_id);
+}
+
+const ExternalLimitsCacheStats& ExternalLimitsCache::get_stats() const {
+    return this->stats;
+}
+
+bool ExternalLimitsCache::is_equal(const Entry& a, const Entry& b) {
+    if (a.unit != b.unit or a.periods.size() != b.periods.size()) {
+        return false;
+    }
+
+    if (a.min_charging_rate.has_value() != b.min_charging_rate.has_value() or
+        (a.min_charging_rate.has_value() and
+         std::fabs(a.min_charging_rate.value() - b.min_charging_rate.value()) > LIMIT_TOLERANCE)) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.periods.size(); i++) {
+        const auto& pa = a.periods[i];
+        const auto& pb = b.periods[i];
+        if (std::fabs(pa.limit - pb.limit) > LIMIT_TOLERANCE or pa.number_phases != pb.number_phases) {
+            return false;
+        }
+        // the first period is active now in both schedules
+        if (i == 0) {
+            continue;
+        }
+        const auto diff = pa.start > pb.start ? pa.start - pb.start : pb.start - pa.start;
+        if (diff > PERIOD_START_TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+types::energy::ExternalLimits ExternalLimitsCache::to_external_limits(const Entry& entry) {
+    types::energy::ExternalLimits limits;
+    std::vector<types::energy::ScheduleReqEntry> schedule_import;
+    schedule_import.reserve(entry.periods.size());
+    for (const auto& period : entry.periods) {
+        types::energy::ScheduleReqEntry schedule_req_entry;
+        types::energy::LimitsReq limits_req;
+        schedule_req_entry.timestamp = ocpp::DateTime(period.start).to_rfc3339();
+        if (entry.unit == ocpp::v16::ChargingRateUnit::A) {
+            limits_req.ac_max_current_A = period.limit;
+            if (period.number_phases.has_value()) {
+                limits_req.ac_max_phase_count = period.number_phases.value();
+            }
+            if (entry.min_charging_rate.has_value()) {
+                limits_req.ac_min_current_A = entry.min_charging_rate.value();
+            }
+        } else {
+            limits_req.total_power_W = period.limit;
+        }
+        schedule_req_entry.limits_to_leaves = limits_req;
+        schedule_import.push_back(std::move(schedule_req_entry));
+    }
+    limits.schedule_import.emplace(std::move(schedule_import));
+    return limits;
+}
+
+} // namespace module
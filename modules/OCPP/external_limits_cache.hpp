@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef OCPP_EXTERNAL_LIMITS_CACHE_HPP
+#define OCPP_EXTERNAL_LIMITS_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <generated/types/energy.hpp>
+
+#include <ocpp/common/types.hpp>
+#include <ocpp/v16/types.hpp>
+
+namespace module {
+
+/// \brief Counters describing how many ExternalLimits updates have been sent or suppressed
+struct ExternalLimitsCacheStats {
+    std::uint64_t updates_sent{0};
+    std::uint64_t updates_suppressed{0};
+};
+
+/// \brief Remembers the effective charging schedule last sent to each connector, so that only connectors whose
+/// schedule actually changed receive new ExternalLimits.
+///
+/// libocpp reports composite schedules relative to the time they were computed, so two schedules are compared on
+/// absolute period start times. The first period is active "now" in both cases and therefore only compared by its
+/// limit. A connector is refreshed after \p max_age even if its schedule did not change, so that the horizon known
+/// to the energy tree never runs out.
+class ExternalLimitsCache {
+public:
+    explicit ExternalLimitsCache(std::chrono::seconds max_age);
+
+    /// \brief Returns the ExternalLimits for \p connector_id if they have to be sent, std::nullopt if the effective
+    /// schedule is identical to the one sent last.
+    /// \param schedule the composite schedule as reported by libocpp
+    /// \param start_time the point in time the schedule periods are relative to
+    std::optional<types::energy::ExternalLimits> update(int32_t connector_id,
+                                                        const ocpp::v16::EnhancedChargingSchedule& schedule,
+                                                        const ocpp::DateTime& start_time);
+
+    /// \brief Forget what has been sent to \p connector_id, the next update for it is sent in any case
+    void invalidate(int32_t connector_id);
+
+    const ExternalLimitsCacheStats& get_stats() const;
+
+private:
+    using TimePoint = std::chrono::time_point<date::utc_clock>;
+
+    struct Period {
+        TimePoint start;
+        float limit;
+        std::optional<int32_t> number_phases;
+    };
+
+    struct Entry {
+        ocpp::v16::ChargingRateUnit unit;
+        std::optional<float> min_charging_rate;
+        std::vector<Period> periods;
+        TimePoint sent_at;
+    };
+
+    static bool is_equal(const Entry& a, const Entry& b);
+    static types::energy::ExternalLimits to_external_limits(const Entry& entry);
+
+    const std::chrono::seconds max_age;
+    std::map<int32_t, Entry> entries;
+    ExternalLimitsCacheStats stats;
+};
+
+} // namespace module
+
+#endif // OCPP_EXTERNAL_LIMITS_CACHE_HPP
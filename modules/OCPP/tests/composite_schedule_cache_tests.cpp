@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <composite_schedule_cache.hpp>
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace {
+
+using module::CompositeScheduleCache;
+using ocpp::v16::ChargingRateUnit;
+using ocpp::v16::EnhancedChargingSchedule;
+using ocpp::v16::EnhancedChargingSchedulePeriod;
+
+constexpr auto HORIZON = std::chrono::seconds(1200);
+
+EnhancedChargingSchedulePeriod make_period(int32_t start_period, float limit, int32_t stack_level = 0) {
+    EnhancedChargingSchedulePeriod period;
+    period.startPeriod = start_period;
+    period.limit = limit;
+    period.stackLevel = stack_level;
+    return period;
+}
+
+EnhancedChargingSchedule make_schedule(const std::vector<EnhancedChargingSchedulePeriod>& periods) {
+    EnhancedChargingSchedule schedule;
+    schedule.chargingRateUnit = ChargingRateUnit::A;
+    schedule.chargingSchedulePeriod = periods;
+    schedule.duration = HORIZON.count();
+    return schedule;
+}
+
+// minute level periods as produced by stacked TxDefault, TxProfile and ChargePointMax profiles
+EnhancedChargingSchedule make_random_schedule(std::mt19937& rng) {
+    std::vector<EnhancedChargingSchedulePeriod> periods;
+    int32_t start = 0;
+    while (start < HORIZON.count()) {
+        auto period = make_period(start, static_cast<float>(6 + rng() % 4 * 2), rng() % 3);
+        if (rng() % 4 == 0) {
+            period.numberPhases = 1 + rng() % 3;
+        }
+        periods.push_back(period);
+        start += 60 * (1 + rng() % 3);
+    }
+    return make_schedule(periods);
+}
+
+// what the current conversion path does: a linear scan over the relative periods of the schedule
+const EnhancedChargingSchedulePeriod* reference_period_at(const EnhancedChargingSchedule& schedule, int32_t offset) {
+    const EnhancedChargingSchedulePeriod* active = nullptr;
+    for (const auto& period : schedule.chargingSchedulePeriod) {
+        if (period.startPeriod <= offset) {
+            active = &period;
+        }
+    }
+    return active;
+}
+
+// the schedule libocpp would report if asked for the same composite \p shift seconds later
+EnhancedChargingSchedule reference_shifted(const EnhancedChargingSchedule& schedule, int32_t shift,
+                                           std::chrono::seconds duration) {
+    auto shifted = schedule;
+    shifted.duration = duration.count();
+    shifted.chargingSchedulePeriod.clear();
+    for (const auto& period : schedule.chargingSchedulePeriod) {
+        if (period.startPeriod >= shift + duration.count()) {
+            break;
+        }
+        auto p = period;
+        p.startPeriod = std::max(0, period.startPeriod - shift);
+        if (!shifted.chargingSchedulePeriod.empty() && shifted.chargingSchedulePeriod.back().startPeriod == 0 &&
+            p.startPeriod == 0) {
+            shifted.chargingSchedulePeriod.back() = p;
+        } else {
+            shifted.chargingSchedulePeriod.push_back(p);
+        }
+    }
+    return shifted;
+}
+
+void expect_equal(const EnhancedChargingSchedule& a, const EnhancedChargingSchedule& b) {
+    EXPECT_EQ(a.chargingRateUnit, b.chargingRateUnit);
+    EXPECT_EQ(a.duration, b.duration);
+    ASSERT_EQ(a.chargingSchedulePeriod.size(), b.chargingSchedulePeriod.size());
+    for (std::size_t i = 0; i < a.chargingSchedulePeriod.size(); i++) {
+        EXPECT_EQ(a.chargingSchedulePeriod[i].startPeriod, b.chargingSchedulePeriod[i].startPeriod);
+        EXPECT_FLOAT_EQ(a.chargingSchedulePeriod[i].limit, b.chargingSchedulePeriod[i].limit);
+        EXPECT_EQ(a.chargingSchedulePeriod[i].numberPhases, b.chargingSchedulePeriod[i].numberPhases);
+        EXPECT_EQ(a.chargingSchedulePeriod[i].stackLevel, b.chargingSchedulePeriod[i].stackLevel);
+    }
+}
+
+TEST(CompositeScheduleCache, empty) {
+    CompositeScheduleCache cache;
+    const ocpp::DateTime now;
+    EXPECT_FALSE(cache.covers(now.to_time_point()));
+    EXPECT_FALSE(cache.limit_at(1, now.to_time_point()).has_value());
+    EXPECT_FALSE(cache.next_change(1, now.to_time_point()).has_value());
+    EXPECT_TRUE(cache.get_schedules(now, std::chrono::seconds(600)).empty());
+}
+
+TEST(CompositeScheduleCache, limit_and_next_change) {
+    CompositeScheduleCache cache;
+    const ocpp::DateTime now;
+    const auto t0 = now.to_time_point();
+    // two periods with the same limit are a single change
+    cache.update({{1, make_schedule({make_period(0, 32), make_period(60, 16, 1), make_period(120, 16, 2),
+                                     make_period(300, 10)})}},
+                 now, HORIZON);
+
+    EXPECT_FLOAT_EQ(cache.limit_at(1, t0)->limit, 32);
+    EXPECT_FLOAT_EQ(cache.limit_at(1, t0 + std::chrono::seconds(59))->limit, 32);
+    EXPECT_FLOAT_EQ(cache.limit_at(1, t0 + std::chrono::seconds(60))->limit, 16);
+    EXPECT_FLOAT_EQ(cache.limit_at(1, t0 + std::chrono::seconds(200))->limit, 16);
+    EXPECT_FLOAT_EQ(cache.limit_at(1, t0 + std::chrono::seconds(1199))->limit, 10);
+    EXPECT_FALSE(cache.limit_at(1, t0 + HORIZON).has_value());
+    EXPECT_FALSE(cache.limit_at(2, t0).has_value());
+
+    EXPECT_EQ(cache.next_change(1, t0), t0 + std::chrono::seconds(60));
+    EXPECT_EQ(cache.next_change(1, t0 + std::chrono::seconds(60)), t0 + std::chrono::seconds(300));
+    EXPECT_FALSE(cache.next_change(1, t0 + std::chrono::seconds(300)).has_value());
+}
+
+TEST(CompositeScheduleCache, covers_and_invalidate) {
+    CompositeScheduleCache cache;
+    const ocpp::DateTime now;
+    const auto t0 = now.to_time_point();
+    cache.update({{0, make_schedule({make_period(0, 32)})}, {1, make_schedule({make_period(0, 16)})}}, now, HORIZON);
+
+    EXPECT_TRUE(cache.covers(t0 + HORIZON));
+    EXPECT_FALSE(cache.covers(t0 + HORIZON + std::chrono::seconds(1)));
+
+    // a single connector update keeps the cache valid but can shorten its horizon
+    cache.update(1, make_schedule({make_period(0, 10)}), now, std::chrono::seconds(600));
+    EXPECT_TRUE(cache.covers(t0 + std::chrono::seconds(600)));
+    EXPECT_FALSE(cache.covers(t0 + std::chrono::seconds(601)));
+    EXPECT_FLOAT_EQ(cache.limit_at(0, t0)->limit, 32);
+    EXPECT_FLOAT_EQ(cache.limit_at(1, t0)->limit, 10);
+
+    cache.invalidate();
+    EXPECT_FALSE(cache.covers(t0));
+
+    // connectors that are not reported anymore are removed
+    cache.update({{0, make_schedule({make_period(0, 32)})}}, now, HORIZON);
+    EXPECT_TRUE(cache.covers(t0));
+    EXPECT_FALSE(cache.limit_at(1, t0).has_value());
+}
+
+TEST(CompositeScheduleCache, matches_conversion_path) {
+    std::mt19937 rng(42);
+    const ocpp::DateTime now;
+    const auto t0 = now.to_time_point();
+    const auto duration = std::chrono::seconds(600);
+
+    for (int round = 0; round < 20; round++) {
+        std::map<int32_t, EnhancedChargingSchedule> schedules;
+        for (int32_t connector = 0; connector < 3; connector++) {
+            schedules[connector] = make_random_schedule(rng);
+        }
+
+        CompositeScheduleCache cache;
+        cache.update(schedules, now, HORIZON);
+
+        for (const auto& [connector, schedule] : schedules) {
+            for (int32_t offset = 0; offset < HORIZON.count(); offset += 7) {
+                const auto time = t0 + std::chrono::seconds(offset);
+                const auto* expected = reference_period_at(schedule, offset);
+                const auto limit = cache.limit_at(connector, time);
+                ASSERT_TRUE(limit.has_value());
+                EXPECT_FLOAT_EQ(limit->limit, expected->limit);
+                EXPECT_EQ(limit->number_phases, expected->numberPhases);
+
+                // the limit stays the same until the next change and differs right at it
+                const auto next = cache.next_change(connector, time);
+                if (next.has_value()) {
+                    const auto next_offset =
+                        std::chrono::duration_cast<std::chrono::seconds>(next.value() - t0).count();
+                    const auto* before = reference_period_at(schedule, next_offset - 1);
+                    const auto* after = reference_period_at(schedule, next_offset);
+                    EXPECT_FLOAT_EQ(before->limit, expected->limit);
+                    EXPECT_EQ(before->numberPhases, expected->numberPhases);
+                    EXPECT_TRUE(after->limit != before->limit || after->numberPhases != before->numberPhases);
+                }
+            }
+        }
+
+        // sliding the publish window over the cache gives the same schedules as a recalculation
+        for (int32_t shift = 0; shift + duration.count() <= HORIZON.count(); shift += 30) {
+            const auto published = cache.get_schedules(ocpp::DateTime(t0 + std::chrono::seconds(shift)), duration);
+            ASSERT_EQ(published.size(), schedules.size());
+            for (const auto& [connector, schedule] : schedules) {
+                expect_equal(published.at(connector), reference_shifted(schedule, shift, duration));
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <external_limits_cache.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+using module::ExternalLimitsCache;
+using ocpp::v16::ChargingRateUnit;
+using ocpp::v16::EnhancedChargingSchedule;
+using ocpp::v16::EnhancedChargingSchedulePeriod;
+
+EnhancedChargingSchedulePeriod make_period(int32_t start_period, float limit) {
+    EnhancedChargingSchedulePeriod period;
+    period.startPeriod = start_period;
+    period.limit = limit;
+    period.stackLevel = 0;
+    return period;
+}
+
+EnhancedChargingSchedule make_schedule(const std::vector<EnhancedChargingSchedulePeriod>& periods) {
+    EnhancedChargingSchedule schedule;
+    schedule.chargingRateUnit = ChargingRateUnit::A;
+    schedule.chargingSchedulePeriod = periods;
+    return schedule;
+}
+
+ocpp::DateTime at(const ocpp::DateTime& base, int seconds) {
+    return ocpp::DateTime(base.to_time_point() + std::chrono::seconds(seconds));
+}
+
+TEST(ExternalLimitsCache, first_update_is_sent) {
+    ExternalLimitsCache cache(std::chrono::seconds(3600));
+    const ocpp::DateTime now;
+
+    const auto limits = cache.update(1, make_schedule({make_period(0, 32), make_period(600, 16)}), now);
+    ASSERT_TRUE(limits.has_value());
+    ASSERT_TRUE(limits->schedule_import.has_value());
+    ASSERT_EQ(limits->schedule_import->size(), 2);
+    EXPECT_EQ(limits->schedule_import->at(0).timestamp, now.to_rfc3339());
+    EXPECT_EQ(limits->schedule_import->at(1).timestamp, at(now, 600).to_rfc3339());
+    EXPECT_FLOAT_EQ(limits->schedule_import->at(1).limits_to_leaves.ac_max_current_A.value(), 16);
+    EXPECT_EQ(cache.get_stats().updates_sent, 1);
+}
+
+TEST(ExternalLimitsCache, unchanged_absolute_schedule_is_suppressed) {
+    ExternalLimitsCache cache(std::chrono::seconds(3600));
+    const ocpp::DateTime now;
+
+    ASSERT_TRUE(cache.update(1, make_schedule({make_period(0, 32), make_period(600, 16)}), now).has_value());
+    // one minute later the same absolute step is reported 60 seconds closer (and off by one second of rounding)
+    EXPECT_FALSE(cache.update(1, make_schedule({make_period(0, 32), make_period(541, 16)}), at(now, 60)).has_value());
+    EXPECT_EQ(cache.get_stats().updates_suppressed, 1);
+}
+
+TEST(ExternalLimitsCache, changes_are_sent_per_connector) {
+    ExternalLimitsCache cache(std::chrono::seconds(3600));
+    const ocpp::DateTime now;
+
+    ASSERT_TRUE(cache.update(1, make_schedule({make_period(0, 32)}), now).has_value());
+    ASSERT_TRUE(cache.update(2, make_schedule({make_period(0, 32)}), now).has_value());
+
+    // only connector 2 got a new profile
+    EXPECT_FALSE(cache.update(1, make_schedule({make_period(0, 32)}), at(now, 10)).has_value());
+    EXPECT_TRUE(cache.update(2, make_schedule({make_period(0, 10)}), at(now, 10)).has_value());
+
+    // a moved step and a new step are changes as well
+    EXPECT_TRUE(cache.update(1, make_schedule({make_period(0, 32), make_period(600, 6)}), at(now, 20)).has_value());
+    EXPECT_TRUE(cache.update(1, make_schedule({make_period(0, 32), make_period(900, 6)}), at(now, 20)).has_value());
+
+    // number of phases and unit are part of the effective schedule
+    auto phases = make_schedule({make_period(0, 32), make_period(880, 6)});
+    phases.chargingSchedulePeriod.at(1).numberPhases = 1;
+    EXPECT_TRUE(cache.update(1, phases, at(now, 40)).has_value());
+    auto watts = phases;
+    watts.chargingRateUnit = ChargingRateUnit::W;
+    EXPECT_TRUE(cache.update(1, watts, at(now, 40)).has_value());
+
+    EXPECT_EQ(cache.get_stats().updates_sent, 7);
+    EXPECT_EQ(cache.get_stats().updates_suppressed, 1);
+}
+
+TEST(ExternalLimitsCache, refresh_after_max_age) {
+    ExternalLimitsCache cache(std::chrono::seconds(300));
+    const ocpp::DateTime now;
+
+    ASSERT_TRUE(cache.update(1, make_schedule({make_period(0, 32)}), now).has_value());
+    EXPECT_FALSE(cache.update(1, make_schedule({make_period(0, 32)}), at(now, 299)).has_value());
+    EXPECT_TRUE(cache.update(1, make_schedule({make_period(0, 32)}), at(now, 300)).has_value());
+}
+
+TEST(ExternalLimitsCache, invalidate) {
+    ExternalLimitsCache cache(std::chrono::seconds(3600));
+    const ocpp::DateTime now;
+
+    ASSERT_TRUE(cache.update(1, make_schedule({make_period(0, 32)}), now).has_value());
+    cache.invalidate(1);
+    EXPECT_TRUE(cache.update(1, make_schedule({make_period(0, 32)}), now).has_value());
+}
+
+} // namespace
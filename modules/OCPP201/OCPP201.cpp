@@ -108,14 +108,53 @@ ocpp::v201::TriggerReasonEnum stop_reason_to_trigger_reason_enum(const ocpp::v20
     }
 }
 
-void OCPP201::init_evse_maps() {
-    std::lock_guard<std::mutex> lk(this->evse_ready_mutex);
-    for (size_t evse_id = 1; evse_id <= this->r_evse_manager.size(); evse_id++) {
-        this->evse_ready_map[evse_id] = false;
-        this->evse_soc_map[evse_id] = std::nullopt;
+void OCPP201::init_evse_states() {
+    this->evse_states = std::make_unique<EvseStateTable>(this->r_evse_manager.size());
+
+    if (this->config.MeterValueAggregationInterval > 0) {
+        const auto reduction = meter_value_reduction_from_string(this->config.MeterValueAggregationReduction);
+        for (size_t evse_id = 1; evse_id <= this->r_evse_manager.size(); evse_id++) {
+            this->meter_value_aggregators.push_back(std::make_unique<MeterValueAggregator>(
+                std::chrono::seconds(this->config.MeterValueAggregationInterval), reduction));
+        }
+        // sends an interval at its end, even if the next sample is late
+        this->meter_value_aggregation_timer = std::make_unique<Everest::SteadyTimer>([this]() {
+            const auto now = std::chrono::system_clock::now();
+            for (size_t i = 0; i < this->meter_value_aggregators.size(); i++) {
+                const auto aggregated = this->meter_value_aggregators.at(i)->close_if_due(now);
+                if (aggregated.has_value()) {
+                    this->send_meter_value(static_cast<int32_t>(i + 1), aggregated.value());
+                }
+            }
+        });
+        this->meter_value_aggregation_timer->interval(std::chrono::seconds(1));
+    }
+}
+
+void OCPP201::flush_meter_value(const int32_t evse_id) {
+    if (this->meter_value_aggregators.empty()) {
+        return;
+    }
+    const auto aggregated = this->meter_value_aggregators.at(evse_id - 1)->flush();
+    if (aggregated.has_value()) {
+        this->send_meter_value(evse_id, aggregated.value());
     }
 }
 
+void OCPP201::send_meter_value(const int32_t evse_id, const types::powermeter::Powermeter& power_meter) {
+    auto meter_value = conversions::to_ocpp_meter_value(power_meter, ocpp::v201::ReadingContextEnum::Sample_Periodic,
+                                                        power_meter.signed_meter_value);
+    const auto soc = this->evse_states->get_soc(evse_id);
+    if (soc.has_value()) {
+        auto sampled_soc_value = conversions::to_ocpp_sampled_value(ocpp::v201::ReadingContextEnum::Sample_Periodic,
+                                                                    ocpp::v201::MeasurandEnum::SoC, "Percent",
+                                                                    std::nullopt, ocpp::v201::LocationEnum::EV);
+        sampled_soc_value.value = soc.value();
+        meter_value.sampledValue.push_back(sampled_soc_value);
+    }
+    this->charge_point->on_meter_value(evse_id, meter_value);
+}
+
 std::map<int32_t, int32_t> OCPP201::get_connector_structure() {
     std::map<int32_t, int32_t> evse_connector_structure;
     int evse_id = 1;
@@ -229,28 +268,30 @@ std::optional<ocpp::v201::IdToken> get_authorized_id_token(const types::evse_man
 }
 
 bool OCPP201::all_evse_ready() {
-    for (auto const& [evse, ready] : this->evse_ready_map) {
-        if (!ready) {
-            return false;
-        }
+    if (!this->evse_states->all_ready()) {
+        return false;
     }
     EVLOG_info << "All EVSE ready. Starting OCPP2.0.1 service";
     return true;
 }
 
 void OCPP201::init() {
+    tracing::init(this->info.id);
+    this->startup_profiler = std::make_unique<StartupProfiler>(this->info.id);
+    auto phase = this->startup_profiler->measure("init");
+
     invoke_init(*p_main);
     invoke_init(*p_auth_provider);
     invoke_init(*p_auth_validator);
 
-    this->init_evse_maps();
+    this->init_evse_states();
 
     for (size_t evse_id = 1; evse_id <= this->r_evse_manager.size(); evse_id++) {
         this->r_evse_manager.at(evse_id - 1)->subscribe_ready([this, evse_id](bool ready) {
             std::lock_guard<std::mutex> lk(this->evse_ready_mutex);
             if (ready) {
                 EVLOG_info << "EVSE " << evse_id << " ready.";
-                this->evse_ready_map[evse_id] = true;
+                this->evse_states->set_ready(evse_id);
                 this->evse_ready_cv.notify_one();
             }
         });
@@ -258,6 +299,8 @@ void OCPP201::init() {
 }
 
 void OCPP201::ready() {
+    auto phase = this->startup_profiler->measure("ready");
+
     invoke_ready(*p_main);
     invoke_ready(*p_auth_provider);
     invoke_ready(*p_auth_validator);
@@ -532,11 +575,22 @@ void OCPP201::ready() {
     const auto sql_init_path = this->ocpp_share_path / SQL_CORE_MIGRATIONS;
 
     std::map<int32_t, int32_t> evse_connector_structure = this->get_connector_structure();
-    this->charge_point = std::make_unique<ocpp::v201::ChargePoint>(
-        evse_connector_structure, device_model_database_path, true, device_model_database_migration_path,
-        device_model_schema_path, config_file_path, this->ocpp_share_path.string(), this->config.CoreDatabasePath,
-        sql_init_path.string(), this->config.MessageLogPath, std::make_shared<EvseSecurity>(*this->r_security),
-        callbacks);
+    {
+        // migrates and loads the device model database
+        auto charge_point_phase = this->startup_profiler->measure("charge_point");
+        this->charge_point = std::make_unique<ocpp::v201::ChargePoint>(
+            evse_connector_structure, device_model_database_path, true, device_model_database_migration_path,
+            device_model_schema_path, config_file_path, this->ocpp_share_path.string(), this->config.CoreDatabasePath,
+            sql_init_path.string(), this->config.MessageLogPath, std::make_shared<EvseSecurity>(*this->r_security),
+            callbacks);
+    }
+
+    this->certificate_request_bridge = std::make_unique<CertificateRequestBridge>(
+        "Get15118EVCertificate",
+        [this](const ocpp::v201::Get15118EVCertificateRequest& request) {
+            return this->charge_point->on_get_15118_ev_certificate_request(request);
+        },
+        this->config.CertificateRequestWorkers);
 
     const auto ev_connection_timeout_request_value_response = this->charge_point->request_value<int32_t>(
         ocpp::v201::Component{"TxCtrlr"}, ocpp::v201::Variable{"EVConnectionTimeOut"},
@@ -605,35 +659,44 @@ void OCPP201::ready() {
         });
 
         evse->subscribe_powermeter([this, evse_id](const types::powermeter::Powermeter& power_meter) {
-            auto meter_value = conversions::to_ocpp_meter_value(
-                power_meter, ocpp::v201::ReadingContextEnum::Sample_Periodic, power_meter.signed_meter_value);
-            if (this->evse_soc_map[evse_id].has_value()) {
-                auto sampled_soc_value = conversions::to_ocpp_sampled_value(
-                    ocpp::v201::ReadingContextEnum::Sample_Periodic, ocpp::v201::MeasurandEnum::SoC, "Percent",
-                    std::nullopt, ocpp::v201::LocationEnum::EV);
-                sampled_soc_value.value = this->evse_soc_map[evse_id].value();
-                meter_value.sampledValue.push_back(sampled_soc_value);
+            if (this->meter_value_aggregators.empty()) {
+                this->send_meter_value(evse_id, power_meter);
+                return;
+            }
+            const auto aggregated =
+                this->meter_value_aggregators.at(evse_id - 1)->add(power_meter, std::chrono::system_clock::now());
+            if (aggregated.has_value()) {
+                this->send_meter_value(evse_id, aggregated.value());
             }
-            this->charge_point->on_meter_value(evse_id, meter_value);
         });
 
         evse->subscribe_ev_info([this, evse_id](const types::evse_manager::EVInfo& ev_info) {
             if (ev_info.soc.has_value()) {
-                this->evse_soc_map[evse_id] = ev_info.soc.value();
+                this->evse_states->set_soc(evse_id, ev_info.soc.value());
             }
         });
 
         evse->subscribe_iso15118_certificate_request(
             [this, evse_id](const types::iso15118_charger::RequestExiStreamSchema& certificate_request) {
-                auto ocpp_response = this->charge_point->on_get_15118_ev_certificate_request(
-                    conversions::to_ocpp_get_15118_certificate_request(certificate_request));
-                EVLOG_debug << "Received response from get_15118_ev_certificate_request: " << ocpp_response;
-                // transform response, inject action, send to associated EvseManager
-                const auto everest_response_status =
-                    conversions::to_everest_iso15118_charger_status(ocpp_response.status);
-                const types::iso15118_charger::ResponseExiStreamStatus everest_response{
-                    everest_response_status, certificate_request.certificate_action, ocpp_response.exiResponse};
-                this->r_evse_manager.at(evse_id - 1)->call_set_get_certificate_response(everest_response);
+                // the CSMS round trip runs on the workers of the bridge, so this subscription does not block the
+                // events of the other EVSEs
+                this->certificate_request_bridge->submit(
+                    evse_id, conversions::to_ocpp_get_15118_certificate_request(certificate_request),
+                    [this, evse_id, certificate_action = certificate_request.certificate_action](
+                        const std::optional<ocpp::v201::Get15118EVCertificateResponse>& ocpp_response) {
+                        // transform response, inject action, send to associated EvseManager
+                        types::iso15118_charger::ResponseExiStreamStatus everest_response;
+                        everest_response.status = types::iso15118_charger::Status::Failed;
+                        everest_response.certificate_action = certificate_action;
+                        if (ocpp_response.has_value()) {
+                            EVLOG_debug << "Received response from get_15118_ev_certificate_request: "
+                                        << ocpp_response.value();
+                            everest_response.status =
+                                conversions::to_everest_iso15118_charger_status(ocpp_response->status);
+                            everest_response.exi_response.emplace(ocpp_response->exiResponse.get());
+                        }
+                        this->r_evse_manager.at(evse_id - 1)->call_set_get_certificate_response(everest_response);
+                    });
             });
 
         auto fault_handler = [this, evse_id](const Everest::error::Error& error) {
@@ -659,19 +722,25 @@ void OCPP201::ready() {
                                                        status.request_id);
     });
 
+    auto wait_phase = this->startup_profiler->measure("wait_for_evses");
     std::unique_lock lk(this->evse_ready_mutex);
     while (!this->all_evse_ready()) {
         this->evse_ready_cv.wait(lk);
     }
     // In case (for some reason) EvseManager ready signals are sent after this point, this will prevent a hang
     lk.unlock();
+    wait_phase.done();
 
     const auto boot_reason = conversions::to_ocpp_boot_reason(this->r_system->call_get_boot_reason());
     this->charge_point->set_message_queue_resume_delay(std::chrono::seconds(this->config.MessageQueueResumeDelay));
     this->charge_point->start(boot_reason);
+
+    phase.done();
+    this->startup_profiler->ready_done();
 }
 
 void OCPP201::process_session_event(const int32_t evse_id, const types::evse_manager::SessionEvent& session_event) {
+    EVTRACE_SCOPE_ID("OCPP201::process_session_event", tracing::trace_id_from_session(session_event.uuid));
     const auto connector_id = session_event.connector_id.value_or(1);
     std::lock_guard<std::mutex> lg(this->session_event_mutex);
     switch (session_event.event) {
@@ -680,6 +749,7 @@ void OCPP201::process_session_event(const int32_t evse_id, const types::evse_man
         break;
     }
     case types::evse_manager::SessionEventEnum::SessionFinished: {
+        this->flush_meter_value(evse_id);
         this->process_session_finished(evse_id, connector_id, session_event);
         break;
     }
@@ -688,6 +758,7 @@ void OCPP201::process_session_event(const int32_t evse_id, const types::evse_man
         break;
     }
     case types::evse_manager::SessionEventEnum::TransactionFinished: {
+        this->flush_meter_value(evse_id);
         this->process_transaction_finished(evse_id, connector_id, session_event);
         break;
     }
@@ -821,7 +892,7 @@ void OCPP201::process_session_started(const int32_t evse_id, const int32_t conne
 
 void OCPP201::process_session_finished(const int32_t evse_id, const int32_t connector_id,
                                        const types::evse_manager::SessionEvent& session_event) {
-    this->evse_soc_map[evse_id].reset();
+    this->evse_states->reset_soc(evse_id);
     auto transaction_data = this->transaction_handler->get_transaction_data(evse_id);
     if (transaction_data != nullptr) {
         transaction_data->charging_state = ocpp::v201::ChargingStateEnum::Idle;
@@ -28,7 +28,13 @@
 // insert your custom include headers here
 #include <tuple>
 
+#include <async_request_bridge.hpp>
+#include <everest/timer.hpp>
+#include <evse_state_table.hpp>
+#include <meter_value_aggregator.hpp>
 #include <ocpp/v201/charge_point.hpp>
+#include <startup_profiler/startup_profiler.hpp>
+#include <tracing/tracing.hpp>
 #include <transaction_handler.hpp>
 // ev@4bf81b14-a215-475c-a1d3-0a484ae48918:v1
 
@@ -43,6 +49,9 @@ struct Conf {
     std::string ConfigFilePath;
     bool EnableExternalWebsocketControl;
     int MessageQueueResumeDelay;
+    int CertificateRequestWorkers;
+    int MeterValueAggregationInterval;
+    std::string MeterValueAggregationReduction;
 };
 
 class OCPP201 : public Everest::ModuleBase {
@@ -100,17 +109,29 @@ private:
 
     // ev@211cfdbe-f69a-4cd6-a4ec-f8aaa3d1b6c8:v1
     // insert your private definitions here
+    std::unique_ptr<StartupProfiler> startup_profiler;
     std::unique_ptr<TransactionHandler> transaction_handler;
 
+    using CertificateRequestBridge =
+        AsyncRequestBridge<ocpp::v201::Get15118EVCertificateRequest, ocpp::v201::Get15118EVCertificateResponse>;
+    // declared after charge_point, so its workers are stopped before charge_point is destroyed
+    std::unique_ptr<CertificateRequestBridge> certificate_request_bridge;
+
     std::filesystem::path ocpp_share_path;
 
     // key represents evse_id, value indicates if ready
-    std::map<int32_t, bool> evse_ready_map;
-    std::map<int32_t, std::optional<float>> evse_soc_map;
+    std::unique_ptr<EvseStateTable> evse_states;
+    // one per EVSE, empty if meter values are not aggregated
+    std::vector<std::unique_ptr<MeterValueAggregator>> meter_value_aggregators;
+    // declared after the aggregators, so it is stopped before they are destroyed
+    std::unique_ptr<Everest::SteadyTimer> meter_value_aggregation_timer;
+    void send_meter_value(const int32_t evse_id, const types::powermeter::Powermeter& power_meter);
+    // sends the samples of the current interval, so they are part of the transaction that ends
+    void flush_meter_value(const int32_t evse_id);
     std::mutex evse_ready_mutex;
     std::mutex session_event_mutex;
     std::condition_variable evse_ready_cv;
-    void init_evse_maps();
+    void init_evse_states();
     bool all_evse_ready();
     std::map<int32_t, int32_t> get_connector_structure();
     void process_session_event(const int32_t evse_id, const types::evse_manager::SessionEvent& session_event);
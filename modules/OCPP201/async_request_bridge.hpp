@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <everest/logging.hpp>
+
+namespace module {
+
+/// \brief Runs requests that wait for a CSMS round trip (e.g. Get15118EVCertificate) on a pool of worker threads, so
+/// the thread that received them (the MQTT dispatch of a subscription) is not blocked until the CSMS answers.
+///
+/// Requests of different EVSEs run concurrently. Requests of the same EVSE run one after another in the order they
+/// were submitted.
+template <typename Request, typename Response> class AsyncRequestBridge {
+public:
+    /// \brief sends \p request to the CSMS and returns its response, blocks for the round trip
+    using Sender = std::function<Response(const Request& request)>;
+    /// \brief called on a worker with the response of a submitted request, std::nullopt if sending failed
+    using Callback = std::function<void(const std::optional<Response>& response)>;
+
+    /// \brief latencies from submit() until the response arrived
+    struct Statistics {
+        std::uint64_t completed{0};
+        std::uint64_t failed{0};
+        std::chrono::milliseconds last_latency{0};
+        std::chrono::milliseconds max_latency{0};
+        std::chrono::milliseconds total_latency{0};
+    };
+
+    /// \brief starts \p worker_count workers (at least one), \p name is used in log messages
+    AsyncRequestBridge(const std::string& name, Sender sender, std::size_t worker_count) :
+        name(name), sender(std::move(sender)) {
+        worker_count = std::max<std::size_t>(worker_count, 1);
+        for (std::size_t i = 0; i < worker_count; i++) {
+            workers.emplace_back([this]() { run_worker(); });
+        }
+    }
+
+    /// \brief waits for the requests currently sent, requests still queued are dropped without calling their callback
+    ~AsyncRequestBridge() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    AsyncRequestBridge(const AsyncRequestBridge&) = delete;
+    AsyncRequestBridge& operator=(const AsyncRequestBridge&) = delete;
+
+    /// \brief queues \p request of \p evse_id and returns immediately, \p callback is called on a worker
+    void submit(std::int32_t evse_id, Request request, Callback callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(Job{evse_id, std::move(request), std::move(callback), std::chrono::steady_clock::now()});
+        }
+        cv.notify_one();
+    }
+
+    /// \brief statistics of the requests of \p evse_id that have been answered so far
+    Statistics get_statistics(std::int32_t evse_id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = statistics.find(evse_id);
+        return it != statistics.end() ? it->second : Statistics{};
+    }
+
+    /// \brief number of requests that are queued or being sent
+    std::size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size() + busy_evses.size();
+    }
+
+private:
+    struct Job {
+        std::int32_t evse_id;
+        Request request;
+        Callback callback;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    // first queued job of an EVSE that has no request being sent, must be called with mutex locked
+    typename std::deque<Job>::iterator next_job() {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (busy_evses.count(it->evse_id) == 0) {
+                return it;
+            }
+        }
+        return queue.end();
+    }
+
+    void run_worker() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [this]() { return not running or next_job() != queue.end(); });
+            if (not running) {
+                return;
+            }
+
+            const auto it = next_job();
+            Job job = std::move(*it);
+            queue.erase(it);
+            busy_evses.insert(job.evse_id);
+            lock.unlock();
+
+            const auto started = std::chrono::steady_clock::now();
+            std::optional<Response> response;
+            try {
+                response = sender(job.request);
+            } catch (const std::exception& e) {
+                EVLOG_error << name << " for EVSE " << job.evse_id << " failed: " << e.what();
+            }
+            const auto finished = std::chrono::steady_clock::now();
+            const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(finished - job.submitted);
+            EVLOG_info << name << " for EVSE " << job.evse_id << " took " << latency.count() << "ms (queued "
+                       << std::chrono::duration_cast<std::chrono::milliseconds>(started - job.submitted).count()
+                       << "ms)";
+
+            try {
+                job.callback(response);
+            } catch (const std::exception& e) {
+                EVLOG_error << name << " for EVSE " << job.evse_id << ": handling the response failed: " << e.what();
+            }
+
+            lock.lock();
+            auto& evse_statistics = statistics[job.evse_id];
+            if (response.has_value()) {
+                evse_statistics.completed++;
+            } else {
+                evse_statistics.failed++;
+            }
+            evse_statistics.last_latency = latency;
+            evse_statistics.max_latency = std::max(evse_statistics.max_latency, latency);
+            evse_statistics.total_latency += latency;
+            busy_evses.erase(job.evse_id);
+            // the next request of this EVSE may be waiting for it
+            cv.notify_all();
+        }
+    }
+
+    const std::string name;
+    const Sender sender;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool running{true};
+    std::deque<Job> queue;
+    std::set<std::int32_t> busy_evses;
+    std::map<std::int32_t, Statistics> statistics;
+
+    std::vector<std::thread> workers;
+};
+
+} // namespace module
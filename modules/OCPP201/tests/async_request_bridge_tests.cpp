@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <stdexcept>
+
+#include <async_request_bridge.hpp>
+
+namespace module {
+
+struct StubRequest {
+    std::int32_t evse_id;
+    int number;
+};
+
+struct StubResponse {
+    std::int32_t evse_id;
+    int number;
+};
+
+/// \brief CSMS that answers a request once it has been released by the test
+class StubCsms {
+public:
+    StubResponse handle(const StubRequest& request) {
+        std::unique_lock<std::mutex> lock(mutex);
+        in_flight++;
+        max_in_flight = std::max(max_in_flight, in_flight);
+        received.push_back(request.number);
+        cv.notify_all();
+        cv.wait(lock, [this, &request]() { return released.count(request.number) > 0; });
+        in_flight--;
+        if (request.number < 0) {
+            throw std::runtime_error("connection lost");
+        }
+        return {request.evse_id, request.number};
+    }
+
+    void release(int number) {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.insert(number);
+        cv.notify_all();
+    }
+
+    bool wait_for_received(std::size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(5), [this, count]() { return received.size() >= count; });
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<int> released;
+    std::vector<int> received;
+    int in_flight{0};
+    int max_in_flight{0};
+};
+
+class AsyncRequestBridgeTest : public ::testing::Test {
+protected:
+    using Bridge = AsyncRequestBridge<StubRequest, StubResponse>;
+
+    std::unique_ptr<Bridge> make_bridge(std::size_t workers) {
+        return std::make_unique<Bridge>(
+            "StubRequest", [this](const StubRequest& request) { return csms.handle(request); }, workers);
+    }
+
+    StubCsms csms;
+};
+
+TEST_F(AsyncRequestBridgeTest, test_requests_of_different_evses_overlap) {
+    auto bridge = make_bridge(3);
+    std::promise<StubResponse> responses[3];
+
+    // submit returns before the CSMS answers
+    for (int evse_id = 1; evse_id <= 3; evse_id++) {
+        bridge->submit(evse_id, {evse_id, evse_id}, [&responses, evse_id](const std::optional<StubResponse>& response) {
+            responses[evse_id - 1].set_value(response.value());
+        });
+    }
+
+    // all three are at the CSMS at the same time
+    ASSERT_TRUE(csms.wait_for_received(3));
+    EXPECT_EQ(csms.max_in_flight, 3);
+
+    // answered out of order, each response goes to its own EVSE
+    for (int number : {3, 1, 2}) {
+        csms.release(number);
+    }
+    for (int evse_id = 1; evse_id <= 3; evse_id++) {
+        const auto response = responses[evse_id - 1].get_future().get();
+        EXPECT_EQ(response.evse_id, evse_id);
+        EXPECT_EQ(response.number, evse_id);
+    }
+}
+
+TEST_F(AsyncRequestBridgeTest, test_requests_of_one_evse_in_order) {
+    auto bridge = make_bridge(3);
+    std::promise<void> done;
+    std::vector<int> answered;
+
+    for (int number = 1; number <= 3; number++) {
+        bridge->submit(1, {1, number}, [&answered, &done](const std::optional<StubResponse>& response) {
+            answered.push_back(response->number);
+            if (answered.size() == 3) {
+                done.set_value();
+            }
+        });
+    }
+
+    // the second request is not sent before the first one is answered
+    ASSERT_TRUE(csms.wait_for_received(1));
+    EXPECT_EQ(bridge->pending(), 3);
+    for (int number = 1; number <= 3; number++) {
+        csms.release(number);
+    }
+    done.get_future().get();
+
+    EXPECT_EQ(answered, std::vector<int>({1, 2, 3}));
+    EXPECT_EQ(csms.received, std::vector<int>({1, 2, 3}));
+    EXPECT_EQ(csms.max_in_flight, 1);
+}
+
+TEST_F(AsyncRequestBridgeTest, test_failed_request_and_statistics) {
+    auto bridge = make_bridge(1);
+    std::promise<std::optional<StubResponse>> failed;
+    std::promise<std::optional<StubResponse>> completed;
+
+    csms.release(-1);
+    csms.release(2);
+    bridge->submit(1, {1, -1}, [&failed](const std::optional<StubResponse>& response) { failed.set_value(response); });
+    bridge->submit(1, {1, 2},
+                   [&completed](const std::optional<StubResponse>& response) { completed.set_value(response); });
+
+    EXPECT_FALSE(failed.get_future().get().has_value());
+    EXPECT_TRUE(completed.get_future().get().has_value());
+
+    // statistics are updated after the callback returned
+    while (bridge->pending() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto statistics = bridge->get_statistics(1);
+    EXPECT_EQ(statistics.completed, 1);
+    EXPECT_EQ(statistics.failed, 1);
+    EXPECT_GE(statistics.max_latency, statistics.last_latency);
+    EXPECT_EQ(bridge->get_statistics(2).completed, 0);
+}
+
+} // namespace module
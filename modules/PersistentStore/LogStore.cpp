@@ -0,0 +1,393 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "LogStore.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+namespace module {
+
+namespace {
+
+// file layout: MAGIC followed by records of
+//   crc32 (4) | record type (1) | type length (1) | key length (2) | value length (4) | key | type | value
+// all integers are little endian, the crc covers everything after the crc field itself
+constexpr std::array<std::uint8_t, 8> MAGIC = {'E', 'V', 'K', 'V', 'L', 'O', 'G', 1};
+constexpr std::size_t RECORD_HEADER_SIZE = 12;
+constexpr std::size_t MAX_KEY_LENGTH = 0xFFFF;
+constexpr std::size_t MAX_TYPE_LENGTH = 0xFF;
+constexpr std::size_t MAX_VALUE_LENGTH = 0xFFFFFFFF;
+
+constexpr std::array<std::uint32_t, 256> make_crc_table() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; i++) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr auto CRC_TABLE = make_crc_table();
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t len) {
+    std::uint32_t c = 0xFFFFFFFFU;
+    for (std::size_t i = 0; i < len; i++) {
+        c = CRC_TABLE[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFU;
+}
+
+void put_u16(std::uint8_t* p, std::uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+void put_u32(std::uint8_t* p, std::uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+std::uint16_t get_u16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t get_u32(const std::uint8_t* p) {
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint64_t record_size(const std::string& key, const LogStoreEntry& entry) {
+    return RECORD_HEADER_SIZE + key.size() + entry.type.size() + entry.value.size();
+}
+
+void write_all(int fd, const std::uint8_t* data, std::size_t len, const fs::path& path) {
+    while (len > 0) {
+        const auto written = ::write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("PersistentStore log write error on " + path.string() + ": " +
+                                     std::strerror(errno));
+        }
+        data += written;
+        len -= written;
+    }
+}
+
+void sync_directory(const fs::path& directory) {
+    const int dir_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        return;
+    }
+    (void)::fsync(dir_fd);
+    ::close(dir_fd);
+}
+
+fs::path compaction_path(const fs::path& path) {
+    auto tmp_path = path;
+    tmp_path += ".compact";
+    return tmp_path;
+}
+
+} // namespace
+
+LogStore::LogStore(const fs::path& path_, const LogStoreConfig& config_) : path(path_), config(config_) {
+    const auto directory = this->path.parent_path();
+    if (!directory.empty() && !fs::exists(directory)) {
+        fs::create_directories(directory);
+    }
+
+    // a left over compaction file means we lost power before the rename, the original log is still intact
+    const auto tmp_path = compaction_path(this->path);
+    if (fs::exists(tmp_path)) {
+        EVLOG_warning << "Removing incomplete PersistentStore compaction file " << tmp_path;
+        fs::remove(tmp_path);
+    }
+
+    this->open_log();
+    this->recover();
+    this->maybe_compact();
+}
+
+LogStore::~LogStore() {
+    if (this->fd >= 0) {
+        ::close(this->fd);
+    }
+}
+
+void LogStore::open_log() {
+    this->fd = ::open(this->path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (this->fd < 0) {
+        throw std::runtime_error("Could not open PersistentStore log " + this->path.string() + ": " +
+                                 std::strerror(errno));
+    }
+}
+
+void LogStore::recover() {
+    struct stat st {};
+    if (::fstat(this->fd, &st) != 0) {
+        throw std::runtime_error("Could not stat PersistentStore log " + this->path.string());
+    }
+
+    std::vector<std::uint8_t> content(st.st_size);
+    std::size_t read_total = 0;
+    while (read_total < content.size()) {
+        const auto res = ::pread(this->fd, content.data() + read_total, content.size() - read_total, read_total);
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res <= 0) {
+            throw std::runtime_error("Could not read PersistentStore log " + this->path.string());
+        }
+        read_total += res;
+    }
+
+    this->index.clear();
+    this->live_size = 0;
+
+    if (content.size() < MAGIC.size()) {
+        // new log or power cut while writing the magic, start from scratch
+        if (::ftruncate(this->fd, 0) != 0) {
+            throw std::runtime_error("Could not truncate PersistentStore log " + this->path.string());
+        }
+        write_all(this->fd, MAGIC.data(), MAGIC.size(), this->path);
+        (void)::fdatasync(this->fd);
+        sync_directory(this->path.parent_path().empty() ? fs::path(".") : this->path.parent_path());
+        this->stats.bytes_written += MAGIC.size();
+        this->file_size = MAGIC.size();
+        return;
+    }
+
+    if (std::memcmp(content.data(), MAGIC.data(), MAGIC.size()) != 0) {
+        throw std::runtime_error("PersistentStore log " + this->path.string() + " has an unknown format");
+    }
+
+    std::size_t offset = MAGIC.size();
+    while (offset + RECORD_HEADER_SIZE <= content.size()) {
+        const auto* header = content.data() + offset;
+        const auto stored_crc = get_u32(header);
+        const auto record_type = static_cast<RecordType>(header[4]);
+        const std::size_t type_len = header[5];
+        const std::size_t key_len = get_u16(header + 6);
+        const std::size_t value_len = get_u32(header + 8);
+        const std::size_t total = RECORD_HEADER_SIZE + key_len + type_len + value_len;
+
+        if (offset + total > content.size()) {
+            break;
+        }
+        if (crc32(header + 4, total - 4) != stored_crc) {
+            break;
+        }
+
+        const char* payload = reinterpret_cast<const char*>(header + RECORD_HEADER_SIZE);
+        std::string key(payload, key_len);
+
+        const auto previous = this->index.find(key);
+        if (previous != this->index.end()) {
+            this->live_size -= record_size(previous->first, previous->second);
+        }
+
+        if (record_type == RecordType::Store) {
+            LogStoreEntry entry{std::string(payload + key_len, type_len),
+                                std::string(payload + key_len + type_len, value_len)};
+            this->live_size += record_size(key, entry);
+            this->index.insert_or_assign(std::move(key), std::move(entry));
+        } else if (record_type == RecordType::Remove) {
+            if (previous != this->index.end()) {
+                this->index.erase(previous);
+            }
+        } else {
+            // a record with a valid crc but unknown type cannot be written by us
+            break;
+        }
+
+        offset += total;
+    }
+
+    if (offset != content.size()) {
+        EVLOG_warning << "PersistentStore log " << this->path << " has an incomplete or corrupt tail, dropping "
+                      << content.size() - offset << " bytes";
+        if (::ftruncate(this->fd, offset) != 0) {
+            throw std::runtime_error("Could not truncate PersistentStore log " + this->path.string());
+        }
+        (void)::fdatasync(this->fd);
+        this->stats.recovered_truncations++;
+    }
+
+    this->file_size = offset;
+}
+
+void LogStore::encode_record(std::vector<std::uint8_t>& buffer, RecordType record_type, const std::string& key,
+                             const std::string& type, const std::string& value) {
+    if (key.size() > MAX_KEY_LENGTH || type.size() > MAX_TYPE_LENGTH || value.size() > MAX_VALUE_LENGTH) {
+        throw std::runtime_error("PersistentStore record for key '" + key + "' is too large");
+    }
+
+    const auto offset = buffer.size();
+    buffer.resize(offset + RECORD_HEADER_SIZE + key.size() + type.size() + value.size());
+
+    auto* p = buffer.data() + offset;
+    p[4] = static_cast<std::uint8_t>(record_type);
+    p[5] = static_cast<std::uint8_t>(type.size());
+    put_u16(p + 6, static_cast<std::uint16_t>(key.size()));
+    put_u32(p + 8, static_cast<std::uint32_t>(value.size()));
+
+    auto* payload = p + RECORD_HEADER_SIZE;
+    std::memcpy(payload, key.data(), key.size());
+    std::memcpy(payload + key.size(), type.data(), type.size());
+    std::memcpy(payload + key.size() + type.size(), value.data(), value.size());
+
+    put_u32(p, crc32(p + 4, buffer.size() - offset - 4));
+}
+
+void LogStore::rollback_append() {
+    // do not leave a partial or unsynced record in front of the next append
+    if (::ftruncate(this->fd, this->file_size) == 0) {
+        return;
+    }
+    // the record stays, at least append behind it and not over it
+    struct stat st {};
+    if (::fstat(this->fd, &st) == 0) {
+        this->file_size = st.st_size;
+    }
+}
+
+void LogStore::append(const std::vector<std::uint8_t>& buffer) {
+    try {
+        write_all(this->fd, buffer.data(), buffer.size(), this->path);
+    } catch (const std::runtime_error&) {
+        this->rollback_append();
+        throw;
+    }
+    if (this->config.sync_writes && ::fdatasync(this->fd) != 0) {
+        const auto error = std::string(std::strerror(errno));
+        this->rollback_append();
+        throw std::runtime_error("PersistentStore log sync error on " + this->path.string() + ": " + error);
+    }
+    this->file_size += buffer.size();
+    this->stats.bytes_written += buffer.size();
+    this->stats.logical_writes++;
+}
+
+void LogStore::store(const std::string& key, const std::string& type, const std::string& value) {
+    this->record_buffer.clear();
+    encode_record(this->record_buffer, RecordType::Store, key, type, value);
+    this->append(this->record_buffer);
+
+    auto entry = this->index.find(key);
+    if (entry != this->index.end()) {
+        this->live_size -= record_size(key, entry->second);
+        entry->second.type = type;
+        entry->second.value = value;
+    } else {
+        entry = this->index.emplace(key, LogStoreEntry{type, value}).first;
+    }
+    this->live_size += record_size(key, entry->second);
+
+    this->maybe_compact();
+}
+
+std::optional<LogStoreEntry> LogStore::load(const std::string& key) const {
+    const auto entry = this->index.find(key);
+    if (entry == this->index.end()) {
+        return std::nullopt;
+    }
+    return entry->second;
+}
+
+void LogStore::remove(const std::string& key) {
+    const auto entry = this->index.find(key);
+    if (entry == this->index.end()) {
+        // nothing to do, do not grow the log
+        return;
+    }
+
+    this->record_buffer.clear();
+    encode_record(this->record_buffer, RecordType::Remove, key, "", "");
+    this->append(this->record_buffer);
+
+    this->live_size -= record_size(key, entry->second);
+    this->index.erase(entry);
+
+    this->maybe_compact();
+}
+
+bool LogStore::exists(const std::string& key) const {
+    return this->index.find(key) != this->index.end();
+}
+
+void LogStore::maybe_compact() {
+    if (this->file_size < this->config.compaction_min_size) {
+        return;
+    }
+    if (static_cast<double>(this->file_size) < this->config.compaction_ratio * (MAGIC.size() + this->live_size)) {
+        return;
+    }
+    this->compact();
+}
+
+void LogStore::compact() {
+    const auto tmp_path = compaction_path(this->path);
+
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(MAGIC.size() + this->live_size);
+    buffer.insert(buffer.end(), MAGIC.begin(), MAGIC.end());
+    for (const auto& [key, entry] : this->index) {
+        encode_record(buffer, RecordType::Store, key, entry.type, entry.value);
+    }
+
+    const int tmp_fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (tmp_fd < 0) {
+        throw std::runtime_error("Could not create PersistentStore compaction file " + tmp_path.string());
+    }
+    try {
+        write_all(tmp_fd, buffer.data(), buffer.size(), tmp_path);
+        if (::fsync(tmp_fd) != 0) {
+            throw std::runtime_error("PersistentStore compaction sync error on " + tmp_path.string());
+        }
+    } catch (...) {
+        ::close(tmp_fd);
+        fs::remove(tmp_path);
+        throw;
+    }
+    ::close(tmp_fd);
+
+    // rename() is atomic, after a power cut we either see the old or the compacted log
+    fs::rename(tmp_path, this->path);
+    sync_directory(this->path.parent_path().empty() ? fs::path(".") : this->path.parent_path());
+
+    ::close(this->fd);
+    this->open_log();
+
+    this->file_size = buffer.size();
+    this->stats.bytes_written += buffer.size();
+    this->stats.compactions++;
+}
+
+const LogStoreStats& LogStore::get_stats() const {
+    return this->stats;
+}
+
+std::uint64_t LogStore::get_file_size() const {
+    return this->file_size;
+}
+
+std::uint64_t LogStore::get_live_size() const {
+    return this->live_size;
+}
+
+} // namespace module
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef PERSISTENT_STORE_LOG_STORE_HPP
+#define PERSISTENT_STORE_LOG_STORE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace module {
+
+/// \brief A stored value together with the name of its type, as used by the kvs implementation
+struct LogStoreEntry {
+    std::string type;
+    std::string value;
+};
+
+/// \brief Configuration of the append-only log store
+struct LogStoreConfig {
+    /// fdatasync() after every appended record
+    bool sync_writes = true;
+    /// compact once the log is this many times larger than its live records
+    double compaction_ratio = 2.0;
+    /// never compact logs smaller than this (in bytes)
+    std::uint64_t compaction_min_size = 64 * 1024;
+};
+
+/// \brief Counters describing the write behaviour of the log store
+struct LogStoreStats {
+    /// number of store and remove operations
+    std::uint64_t logical_writes = 0;
+    /// bytes handed to the kernel, including compaction
+    std::uint64_t bytes_written = 0;
+    std::uint64_t compactions = 0;
+    /// number of times a torn or corrupt log tail was dropped on open
+    std::uint64_t recovered_truncations = 0;
+};
+
+/// \brief Crash-consistent, append-only key-value log with an in-memory index
+///
+/// Every store and remove operation appends one CRC-32 protected record to the log file. On open the log is
+/// replayed into the index and the file is truncated at the first incomplete or corrupt record, so a power cut
+/// during a write only ever loses that last write. Once the log grows beyond compaction_ratio times the size of
+/// the live records it is rewritten into a temporary file that atomically replaces the log.
+class LogStore {
+public:
+    explicit LogStore(const fs::path& path, const LogStoreConfig& config = LogStoreConfig());
+    ~LogStore();
+
+    LogStore(const LogStore&) = delete;
+    LogStore& operator=(const LogStore&) = delete;
+
+    void store(const std::string& key, const std::string& type, const std::string& value);
+    std::optional<LogStoreEntry> load(const std::string& key) const;
+    void remove(const std::string& key);
+    bool exists(const std::string& key) const;
+
+    /// \brief Rewrite the log so that it only contains live records
+    void compact();
+
+    const LogStoreStats& get_stats() const;
+    std::uint64_t get_file_size() const;
+    std::uint64_t get_live_size() const;
+
+private:
+    enum class RecordType : std::uint8_t {
+        Store = 1,
+        Remove = 2,
+    };
+
+    static void encode_record(std::vector<std::uint8_t>& buffer, RecordType record_type, const std::string& key,
+                              const std::string& type, const std::string& value);
+
+    void open_log();
+    void recover();
+    void append(const std::vector<std::uint8_t>& buffer);
+    void rollback_append();
+    void maybe_compact();
+
+    const fs::path path;
+    const LogStoreConfig config;
+    int fd{-1};
+
+    std::unordered_map<std::string, LogStoreEntry> index;
+    std::uint64_t file_size{0};
+    std::uint64_t live_size{0};
+    LogStoreStats stats;
+
+    std::vector<std::uint8_t> record_buffer;
+};
+
+} // namespace module
+
+#endif // PERSISTENT_STORE_LOG_STORE_HPP
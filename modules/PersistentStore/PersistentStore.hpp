@@ -20,7 +20,12 @@
 namespace module {
 
 struct Conf {
+    std::string backend;
     std::string sqlite_db_file_path;
+    std::string log_file_path;
+    bool log_sync_writes;
+    double log_compaction_ratio;
+    int log_compaction_min_size;
 };
 
 class PersistentStore : public Everest::ModuleBase {
@@ -48,6 +48,16 @@ public:
 };
 
 void kvsImpl::init() {
+    if (mod->config.backend == "log") {
+        LogStoreConfig log_config;
+        log_config.sync_writes = mod->config.log_sync_writes;
+        log_config.compaction_ratio = mod->config.log_compaction_ratio;
+        log_config.compaction_min_size = mod->config.log_compaction_min_size;
+        this->log_store = std::make_unique<LogStore>(fs::absolute(fs::path(mod->config.log_file_path)), log_config);
+        EVLOG_debug << "Using append-only log backend";
+        return;
+    }
+
     // open and initialize database
     fs::path sqlite_db_path = fs::absolute(fs::path(mod->config.sqlite_db_file_path));
     fs::path database_directory = sqlite_db_path.parent_path();
@@ -155,7 +165,12 @@ void kvsImpl::handle_store(std::string& key,
                            std::variant<std::nullptr_t, Array, Object, bool, double, int, std::string>& value) {
     std::string type = std::visit(TypeNameVisitor(), value);
     std::string string_value = std::visit(StringValueVisitor(), value);
-    ;
+
+    if (this->log_store) {
+        std::lock_guard<std::mutex> lock(this->db_mutex);
+        this->log_store->store(key, type, string_value);
+        return;
+    }
 
     std::string insert_sql_str = "INSERT OR REPLACE INTO KVS (KEY, VALUE, TYPE) VALUES "
                                  "(@key, @value, @type)";
@@ -175,7 +190,43 @@ void kvsImpl::handle_store(std::string& key,
     insert_statement.finalize("Error inserting into KVS table");
 };
 
+static std::variant<std::nullptr_t, Array, Object, bool, double, int, std::string>
+to_value(const std::string& type_str, const std::string& value_str) {
+    std::variant<std::nullptr_t, Array, Object, bool, double, int, std::string> value;
+
+    if (type_str == "Array") {
+        Array value_array = json::parse(value_str);
+        value = value_array;
+    } else if (type_str == "Object") {
+        Object value_object = json::parse(value_str);
+        value = value_object;
+    } else if (type_str == "bool") {
+        if (value_str == "true") {
+            value = true;
+        } else {
+            value = false;
+        }
+    } else if (type_str == "double") {
+        value = std::stod(value_str);
+    } else if (type_str == "int") {
+        value = std::stoi(value_str);
+    } else if (type_str == "std::string") {
+        value = value_str;
+    }
+
+    return value;
+}
+
 std::variant<std::nullptr_t, Array, Object, bool, double, int, std::string> kvsImpl::handle_load(std::string& key) {
+    if (this->log_store) {
+        std::lock_guard<std::mutex> lock(this->db_mutex);
+        const auto entry = this->log_store->load(key);
+        if (!entry.has_value()) {
+            return {};
+        }
+        return to_value(entry->type, entry->value);
+    }
+
     std::string select_sql_str = "SELECT KEY, VALUE, TYPE FROM KVS WHERE KEY = @key";
     Sqlite3_Stmt select_statement;
     sqlite3_prepare_v2(db, select_sql_str.c_str(), select_sql_str.size(), &select_statement, NULL);
@@ -196,25 +247,7 @@ std::variant<std::nullptr_t, Array, Object, bool, double, int, std::string> kvsI
         auto type_ptr = sqlite3_column_text(select_statement, 2);
         if (type_ptr != nullptr) {
             std::string type_str = std::string(reinterpret_cast<const char*>(type_ptr));
-            if (type_str == "Array") {
-                Array value_array = json::parse(value_str);
-                value = value_array;
-            } else if (type_str == "Object") {
-                Object value_object = json::parse(value_str);
-                value = value_object;
-            } else if (type_str == "bool") {
-                if (value_str == "true") {
-                    value = true;
-                } else {
-                    value = false;
-                }
-            } else if (type_str == "double") {
-                value = std::stod(value_str);
-            } else if (type_str == "int") {
-                value = std::stoi(value_str);
-            } else if (type_str == "std::string") {
-                value = value_str;
-            }
+            value = to_value(type_str, value_str);
         }
     }
 
@@ -223,6 +256,12 @@ std::variant<std::nullptr_t, Array, Object, bool, double, int, std::string> kvsI
 };
 
 void kvsImpl::handle_delete(std::string& key) {
+    if (this->log_store) {
+        std::lock_guard<std::mutex> lock(this->db_mutex);
+        this->log_store->remove(key);
+        return;
+    }
+
     std::string delete_sql_str = "DELETE FROM KVS WHERE KEY = @key";
     Sqlite3_Stmt delete_statement;
     sqlite3_prepare_v2(db, delete_sql_str.c_str(), delete_sql_str.size(), &delete_statement, NULL);
@@ -239,6 +278,11 @@ void kvsImpl::handle_delete(std::string& key) {
 };
 
 bool kvsImpl::handle_exists(std::string& key) {
+    if (this->log_store) {
+        std::lock_guard<std::mutex> lock(this->db_mutex);
+        return this->log_store->exists(key);
+    }
+
     std::string select_sql_str = "SELECT KEY FROM KVS WHERE KEY = @key";
     Sqlite3_Stmt select_statement;
     sqlite3_prepare_v2(db, select_sql_str.c_str(), select_sql_str.size(), &select_statement, NULL);
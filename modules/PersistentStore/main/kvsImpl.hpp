@@ -14,8 +14,11 @@
 
 // ev@75ac1216-19eb-4182-a85c-820f1fc2c091:v1
 // insert your custom include headers here
+#include <memory>
 #include <mutex>
 #include <sqlite3.h>
+
+#include "../LogStore.hpp"
 // ev@75ac1216-19eb-4182-a85c-820f1fc2c091:v1
 
 namespace module {
@@ -58,6 +61,7 @@ private:
     // insert your private definitions here
     sqlite3* db;
     std::mutex db_mutex;
+    std::unique_ptr<LogStore> log_store;
     // ev@3370e4dd-95f4-47a9-aaec-ea76f34a66c9:v1
 };
 
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Compares the log backend of PersistentStore with the SQLite backend.
+// Reports writes per second and the bytes the process handed to the kernel per logical write (from /proc/self/io,
+// so journal and WAL writes of SQLite are included). Run it on the target flash:
+//   everest-core_PersistentStore_benchmark [directory] [number of writes]
+
+#include <LogStore.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <sqlite3.h>
+
+namespace {
+
+constexpr int NUMBER_OF_KEYS = 32;
+
+std::uint64_t process_bytes_written() {
+    std::ifstream io("/proc/self/io");
+    std::string name;
+    std::uint64_t value = 0;
+    while (io >> name >> value) {
+        if (name == "wchar:") {
+            return value;
+        }
+    }
+    return 0;
+}
+
+std::string value_for(int i) {
+    return "{\"counter\":" + std::to_string(i) + ",\"id\":\"some_transaction_id\"}";
+}
+
+void report(const std::string& name, int writes, std::chrono::steady_clock::duration duration,
+            std::uint64_t bytes_written) {
+    const auto seconds = std::chrono::duration<double>(duration).count();
+    std::cout << name << ": " << writes / seconds << " writes/s, "
+              << static_cast<double>(bytes_written) / writes << " bytes written per logical write" << std::endl;
+}
+
+void run_log_store(const fs::path& path, int writes) {
+    module::LogStore store(path);
+
+    const auto bytes_before = process_bytes_written();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < writes; i++) {
+        store.store("key" + std::to_string(i % NUMBER_OF_KEYS), "Object", value_for(i));
+    }
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    report("log", writes, duration, process_bytes_written() - bytes_before);
+    std::cout << "  log bytes per logical write (own accounting): "
+              << static_cast<double>(store.get_stats().bytes_written) / store.get_stats().logical_writes
+              << ", compactions: " << store.get_stats().compactions << std::endl;
+}
+
+void run_sqlite(const fs::path& path, int writes) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Could not open " << path << std::endl;
+        return;
+    }
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS KVS (KEY TEXT UNIQUE, VALUE TEXT, TYPE TEXT);", nullptr, nullptr,
+                 nullptr);
+
+    // same statement the kvs implementation uses for every store
+    const std::string insert_sql = "INSERT OR REPLACE INTO KVS (KEY, VALUE, TYPE) VALUES (@key, @value, @type)";
+
+    const auto bytes_before = process_bytes_written();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < writes; i++) {
+        const auto key = "key" + std::to_string(i % NUMBER_OF_KEYS);
+        const auto value = value_for(i);
+        sqlite3_stmt* statement = nullptr;
+        sqlite3_prepare_v2(db, insert_sql.c_str(), insert_sql.size(), &statement, nullptr);
+        sqlite3_bind_text(statement, 1, key.c_str(), -1, nullptr);
+        sqlite3_bind_text(statement, 2, value.c_str(), -1, nullptr);
+        sqlite3_bind_text(statement, 3, "Object", -1, nullptr);
+        sqlite3_step(statement);
+        sqlite3_finalize(statement);
+    }
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    report("sqlite", writes, duration, process_bytes_written() - bytes_before);
+    sqlite3_close(db);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const fs::path directory = argc > 1 ? fs::path(argv[1]) : fs::temp_directory_path() / "everest_kvs_benchmark";
+    const int writes = argc > 2 ? std::stoi(argv[2]) : 2000;
+
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    run_sqlite(directory / "store.db", writes);
+    run_log_store(directory / "store.log", writes);
+
+    fs::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <LogStore.hpp>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+
+namespace {
+
+using module::LogStore;
+using module::LogStoreConfig;
+
+using State = std::map<std::string, std::string>;
+
+class LogStoreTest : public ::testing::Test {
+protected:
+    fs::path dir;
+    fs::path log_path;
+
+    void SetUp() override {
+        const auto* test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir = fs::temp_directory_path() / (std::string("everest_log_store_") + test_info->name());
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        log_path = dir / "store.log";
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    static std::vector<char> read_file(const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    static void write_file(const fs::path& path, const std::vector<char>& content, std::size_t len) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), len);
+    }
+
+    static State dump(const LogStore& store, const std::vector<std::string>& keys) {
+        State state;
+        for (const auto& key : keys) {
+            const auto entry = store.load(key);
+            if (entry.has_value()) {
+                state[key] = entry->type + ":" + entry->value;
+            }
+        }
+        return state;
+    }
+};
+
+TEST_F(LogStoreTest, store_load_remove) {
+    LogStore store(log_path);
+    EXPECT_FALSE(store.exists("a"));
+    EXPECT_FALSE(store.load("a").has_value());
+
+    store.store("a", "int", "42");
+    ASSERT_TRUE(store.exists("a"));
+    EXPECT_EQ(store.load("a")->type, "int");
+    EXPECT_EQ(store.load("a")->value, "42");
+
+    store.store("a", "std::string", "hello");
+    EXPECT_EQ(store.load("a")->type, "std::string");
+    EXPECT_EQ(store.load("a")->value, "hello");
+
+    store.remove("a");
+    EXPECT_FALSE(store.exists("a"));
+    EXPECT_EQ(store.get_stats().logical_writes, 3);
+
+    // removing an unknown key must not grow the log
+    const auto size = store.get_file_size();
+    store.remove("a");
+    EXPECT_EQ(store.get_file_size(), size);
+}
+
+TEST_F(LogStoreTest, reopen) {
+    {
+        LogStore store(log_path);
+        store.store("a", "int", "1");
+        store.store("b", "Object", "{\"x\":1}");
+        store.store("c", "bool", "true");
+        store.remove("c");
+        store.store("a", "int", "2");
+    }
+    LogStore store(log_path);
+    EXPECT_EQ(store.load("a")->value, "2");
+    EXPECT_EQ(store.load("b")->value, "{\"x\":1}");
+    EXPECT_FALSE(store.exists("c"));
+    EXPECT_EQ(store.get_stats().recovered_truncations, 0);
+}
+
+TEST_F(LogStoreTest, compaction) {
+    LogStoreConfig config;
+    config.sync_writes = false;
+    config.compaction_min_size = 1024;
+    config.compaction_ratio = 2.0;
+
+    {
+        LogStore store(log_path, config);
+        for (int i = 0; i < 1000; i++) {
+            store.store("key" + std::to_string(i % 10), "int", std::to_string(i));
+        }
+        EXPECT_GT(store.get_stats().compactions, 0);
+        EXPECT_LE(store.get_file_size(), 2 * 1024);
+        EXPECT_EQ(fs::file_size(log_path), store.get_file_size());
+    }
+
+    LogStore store(log_path, config);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(store.load("key" + std::to_string(i))->value, std::to_string(990 + i));
+    }
+}
+
+TEST_F(LogStoreTest, power_cut_at_every_byte) {
+    // run a sequence of writes and remember the log size and the visible state after each of them
+    std::vector<std::string> keys = {"a", "b", "c", "d"};
+    std::vector<std::pair<std::uint64_t, State>> checkpoints;
+    {
+        LogStoreConfig config;
+        config.compaction_min_size = 1024 * 1024;
+        LogStore store(log_path, config);
+        checkpoints.emplace_back(store.get_file_size(), dump(store, keys));
+
+        std::mt19937 rng(1234);
+        for (int i = 0; i < 40; i++) {
+            const auto& key = keys.at(rng() % keys.size());
+            if (rng() % 4 == 0) {
+                store.remove(key);
+            } else {
+                store.store(key, "std::string", std::string(rng() % 50, 'a' + i % 26));
+            }
+            checkpoints.emplace_back(store.get_file_size(), dump(store, keys));
+        }
+    }
+
+    const auto content = read_file(log_path);
+    ASSERT_EQ(content.size(), checkpoints.back().first);
+
+    // cut power after every single byte: the recovered state must be exactly the state of the last complete write
+    const auto cut_path = dir / "cut.log";
+    for (std::size_t len = 0; len <= content.size(); len++) {
+        write_file(cut_path, content, len);
+
+        auto expected = checkpoints.front().second;
+        for (const auto& [size, state] : checkpoints) {
+            if (size <= len) {
+                expected = state;
+            }
+        }
+
+        LogStore store(cut_path);
+        EXPECT_EQ(dump(store, keys), expected) << "power cut after " << len << " bytes";
+
+        // the store must be writable after recovery and the write must survive the next reopen
+        store.store("after_recovery", "int", "1");
+        LogStore reopened(cut_path);
+        EXPECT_TRUE(reopened.exists("after_recovery")) << "power cut after " << len << " bytes";
+        EXPECT_EQ(reopened.get_stats().recovered_truncations, 0);
+    }
+}
+
+TEST_F(LogStoreTest, power_cut_during_compaction) {
+    {
+        LogStore store(log_path);
+        store.store("a", "int", "1");
+        store.store("b", "int", "2");
+    }
+    // a half written compaction file next to an intact log
+    const auto content = read_file(log_path);
+    auto tmp_path = log_path;
+    tmp_path += ".compact";
+    write_file(tmp_path, content, content.size() / 2);
+
+    LogStore store(log_path);
+    EXPECT_EQ(store.load("a")->value, "1");
+    EXPECT_EQ(store.load("b")->value, "2");
+    EXPECT_FALSE(fs::exists(tmp_path));
+}
+
+TEST_F(LogStoreTest, corrupt_record_is_dropped) {
+    {
+        LogStore store(log_path);
+        store.store("a", "int", "1");
+        store.store("b", "int", "2");
+    }
+    auto content = read_file(log_path);
+    // flip a bit in the value of the last record
+    content.back() ^= 0x01;
+    write_file(log_path, content, content.size());
+
+    LogStore store(log_path);
+    EXPECT_EQ(store.load("a")->value, "1");
+    EXPECT_FALSE(store.exists("b"));
+    EXPECT_EQ(store.get_stats().recovered_truncations, 1);
+}
+
+TEST_F(LogStoreTest, unknown_format) {
+    {
+        std::ofstream out(log_path, std::ios::binary);
+        out << "SQLite format 3";
+    }
+    EXPECT_THROW(LogStore store(log_path), std::runtime_error);
+}
+
+} // namespace
@@ -26,41 +26,42 @@ types::sunspec_ac_meter::Result sunspec_ac_meterImpl::handle_get_sunspec_ac_mete
 
         transport::DataVector data = transport->fetch(known_model::Sunspec_ACMeter);
 
-        sunspec_model::ACMeter acmeter(data);
+        using View = sunspec_model::ACMeterView;
+        const View acmeter(data);
 
-        result.A = acmeter.A();
-        result.AphA = acmeter.AphA();
-        result.AphB = acmeter.AphB();
-        result.AphC = acmeter.AphC();
-        result.A_SF = acmeter.A_SF();
-        result.PhVphA = acmeter.PhVphA();
-        result.PhVphB = acmeter.PhVphB();
-        result.PhVphC = acmeter.PhVphC();
-        result.V_SF = acmeter.V_SF();
-        result.Hz = acmeter.Hz();
-        result.Hz_SF = acmeter.Hz_SF();
-        result.W = acmeter.W();
-        result.WphA = acmeter.WphA();
-        result.WphB = acmeter.WphB();
-        result.WphC = acmeter.WphC();
-        result.W_SF = acmeter.W_SF();
-        result.VA = acmeter.VA();
-        result.VAphA = acmeter.VAphA();
-        result.VAphB = acmeter.VAphB();
-        result.VAphC = acmeter.VAphC();
-        result.VA_SF = acmeter.VAR_SF();
-        result.VAR = acmeter.VAR();
-        result.VARphA = acmeter.VARphA();
-        result.VARphB = acmeter.VARphB();
-        result.VARphC = acmeter.VARphC();
-        result.VAR_SF = acmeter.VAR_SF();
-        result.PFphA = acmeter.PFphA();
-        result.PFphB = acmeter.PFphB();
-        result.PFphC = acmeter.PFphC();
-        result.PF_SF = acmeter.PF_SF();
-        result.TotWhIm = acmeter.TotWhIm();
-        result.TotWh_SF = acmeter.TotWh_SF();
-        result.Evt = acmeter.Evt();
+        result.A = acmeter.get<View::A>();
+        result.AphA = acmeter.get<View::AphA>();
+        result.AphB = acmeter.get<View::AphB>();
+        result.AphC = acmeter.get<View::AphC>();
+        result.A_SF = acmeter.get<View::A_SF>();
+        result.PhVphA = acmeter.get<View::PhVphA>();
+        result.PhVphB = acmeter.get<View::PhVphB>();
+        result.PhVphC = acmeter.get<View::PhVphC>();
+        result.V_SF = acmeter.get<View::V_SF>();
+        result.Hz = acmeter.get<View::Hz>();
+        result.Hz_SF = acmeter.get<View::Hz_SF>();
+        result.W = acmeter.get<View::W>();
+        result.WphA = acmeter.get<View::WphA>();
+        result.WphB = acmeter.get<View::WphB>();
+        result.WphC = acmeter.get<View::WphC>();
+        result.W_SF = acmeter.get<View::W_SF>();
+        result.VA = acmeter.get<View::VA>();
+        result.VAphA = acmeter.get<View::VAphA>();
+        result.VAphB = acmeter.get<View::VAphB>();
+        result.VAphC = acmeter.get<View::VAphC>();
+        result.VA_SF = acmeter.get<View::VA_SF>();
+        result.VAR = acmeter.get<View::VAR>();
+        result.VARphA = acmeter.get<View::VARphA>();
+        result.VARphB = acmeter.get<View::VARphB>();
+        result.VARphC = acmeter.get<View::VARphC>();
+        result.VAR_SF = acmeter.get<View::VAR_SF>();
+        result.PFphA = acmeter.get<View::PFphA>();
+        result.PFphB = acmeter.get<View::PFphB>();
+        result.PFphC = acmeter.get<View::PFphC>();
+        result.PF_SF = acmeter.get<View::PF_SF>();
+        result.TotWhIm = acmeter.get<View::TotWhIm>();
+        result.TotWh_SF = acmeter.get<View::TotWh_SF>();
+        result.Evt = acmeter.get<View::Evt>();
 
     } catch (const std::runtime_error& e) {
         EVLOG_error << __PRETTY_FUNCTION__ << " Error: " << e.what() << std::endl;
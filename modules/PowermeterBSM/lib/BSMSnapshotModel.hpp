@@ -5,6 +5,7 @@
 #define POWERMETER_BSM_BSMSNAPSHOTMODEL_HPP
 
 #include "sunspec_base.hpp"
+#include "sunspec_view.hpp"
 
 namespace bsm {
 
@@ -238,6 +239,61 @@ public:
         return string_at_with_length(Model[index].offset, Model[index].length_in_bytes);
     }
 };
+//////////////////////////////////////////////////////////////////////
+//
+// zero copy views, point indices are resolved at compile time
+
+class SignedSnapshotView : public sunspec_view::ModelView<SignedSnapshot> {
+
+public:
+    using ModelView::ModelView;
+
+    // clang-format off
+    static constexpr std::size_t Type        = sunspec_view::point_index(Model, "Type");
+    static constexpr std::size_t Status      = sunspec_view::point_index(Model, "Status");
+    static constexpr std::size_t RCR         = sunspec_view::point_index(Model, "RCR");
+    static constexpr std::size_t TotWhImp    = sunspec_view::point_index(Model, "TotWhImp");
+    static constexpr std::size_t Wh_SF       = sunspec_view::point_index(Model, "Wh_SF");
+    static constexpr std::size_t W           = sunspec_view::point_index(Model, "W");
+    static constexpr std::size_t W_SF        = sunspec_view::point_index(Model, "W_SF");
+    static constexpr std::size_t MA1         = sunspec_view::point_index(Model, "MA1");
+    static constexpr std::size_t RCnt        = sunspec_view::point_index(Model, "RCnt");
+    static constexpr std::size_t OS          = sunspec_view::point_index(Model, "OS");
+    static constexpr std::size_t Epoch       = sunspec_view::point_index(Model, "Epoch");
+    static constexpr std::size_t TZO         = sunspec_view::point_index(Model, "TZO");
+    static constexpr std::size_t EpochSetCnt = sunspec_view::point_index(Model, "EpochSetCnt");
+    static constexpr std::size_t EpochSetOS  = sunspec_view::point_index(Model, "EpochSetOS");
+    static constexpr std::size_t DI          = sunspec_view::point_index(Model, "DI");
+    static constexpr std::size_t DO          = sunspec_view::point_index(Model, "DO");
+    static constexpr std::size_t Meta1       = sunspec_view::point_index(Model, "Meta1");
+    static constexpr std::size_t Meta2       = sunspec_view::point_index(Model, "Meta2");
+    static constexpr std::size_t Meta3       = sunspec_view::point_index(Model, "Meta3");
+    static constexpr std::size_t Evt         = sunspec_view::point_index(Model, "Evt");
+    static constexpr std::size_t NSig        = sunspec_view::point_index(Model, "NSig");
+    static constexpr std::size_t BSig        = sunspec_view::point_index(Model, "BSig");
+    static constexpr std::size_t Sig         = sunspec_view::point_index(Model, "Sig");
+    // clang-format on
+
+    // the signature, its length is given by BSig
+    sunspec_view::Bytes signature() const {
+        return bytes<Sig>(get<BSig>());
+    }
+};
+
+class SignedOCMFSnapshotView : public sunspec_view::ModelView<SignedOCMFSnapshot> {
+
+public:
+    using ModelView::ModelView;
+
+    // clang-format off
+    static constexpr std::size_t ID   = sunspec_view::point_index(Model, "ID");
+    static constexpr std::size_t L    = sunspec_view::point_index(Model, "L");
+    static constexpr std::size_t Type = sunspec_view::point_index(Model, "Type");
+    static constexpr std::size_t St   = sunspec_view::point_index(Model, "St");
+    static constexpr std::size_t O    = sunspec_view::point_index(Model, "O");
+    // clang-format on
+};
+
 } // namespace bsm
 
 #endif // POWERMETER_BSM_BSMSNAPSHOTMODEL_HPP
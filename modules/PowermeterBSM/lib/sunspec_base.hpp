@@ -10,6 +10,7 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <endian.h>
 #include <exception>
 #include <initializer_list>
@@ -32,6 +33,7 @@ enum struct PointType {
     sunssf,
     uint16,
     uint32,
+    float32,
     string,
     blob
 };
@@ -46,6 +48,7 @@ const std::uint16_t pad{0x8000};
 const std::uint16_t sunssf{0x8000};
 const std::uint16_t uint16{0xffff};
 const std::uint32_t uint32{0xffffffff};
+const std::uint32_t float32{0x7fc00000}; // quiet NaN, any NaN is treated as not available
 
 inline bool valid_string(std::string s) {
     return not(s.empty() || s.at(0) == 0); // string starts with a endmarker
@@ -64,6 +67,7 @@ const std::map<PointType,std::string> point_to_string_map {
     { PointType::sunssf , "sunssf" },
     { PointType::uint16 , "uint16" },
     { PointType::uint32 , "uint32" },
+    { PointType::float32 , "float32" },
     { PointType::string , "string" },
     { PointType::blob   , "blob" },
 
@@ -83,6 +87,7 @@ constexpr std::uint16_t point_length_in_bytes(PointType pointType) {
     case PointType::acc32:
     case PointType::bitfield32:
     case PointType::uint32:
+    case PointType::float32:
         return 4;
 
     case PointType::enum16:
@@ -129,6 +134,13 @@ inline std::uint32_t uint32_at(const transport::DataVector& data, transport::Dat
     return be32toh((*reinterpret_cast<const std::uint32_t*>(std::addressof(data.data()[offset]))));
 }
 
+inline float float32_at(const transport::DataVector& data, transport::DataVector::size_type offset) {
+    const std::uint32_t bits = uint32_at(data, offset);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 inline std::string string_at_with_length(const transport::DataVector& data, transport::DataVector::size_type offset,
                                          transport::DataVector::size_type length) {
     // if dirty, then be completely dirty..
@@ -156,6 +168,8 @@ inline std::string point_value_to_string(const transport::DataVector& data, cons
     case PointType::bitfield32:
     case PointType::uint32:
         return std::to_string(sunspec_decoder::uint32_at(data, point.offset));
+    case PointType::float32:
+        return std::to_string(sunspec_decoder::float32_at(data, point.offset));
     case PointType::enum16:
     case PointType::pad:
     case PointType::sunssf:
@@ -222,6 +236,7 @@ using pad        = std::int16_t;
 using sunssf     = std::int16_t;
 using uint16     = std::uint16_t;
 using uint32     = std::uint32_t;
+using float32    = float;
 using string     = std::string;
 
 }
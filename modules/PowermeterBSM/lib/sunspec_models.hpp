@@ -5,6 +5,7 @@
 #define POWERMETER_BSM_SUNSPEC_MODELS_HPP
 
 #include "sunspec_base.hpp"
+#include "sunspec_view.hpp"
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -324,6 +325,300 @@ public:
     }
 };
 
+//////////////////////////////////////////////////////////////////////
+//
+// zero copy views, point indices are resolved at compile time
+
+class CommonView : public sunspec_view::ModelView<Common> {
+
+public:
+    using ModelView::ModelView;
+
+    // clang-format off
+    static constexpr std::size_t ID  = sunspec_view::point_index(Model, "ID");
+    static constexpr std::size_t L   = sunspec_view::point_index(Model, "L");
+    static constexpr std::size_t Mn  = sunspec_view::point_index(Model, "Mn");
+    static constexpr std::size_t Md  = sunspec_view::point_index(Model, "Md");
+    static constexpr std::size_t Opt = sunspec_view::point_index(Model, "Opt");
+    static constexpr std::size_t Vr  = sunspec_view::point_index(Model, "Vr");
+    static constexpr std::size_t SN  = sunspec_view::point_index(Model, "SN");
+    static constexpr std::size_t DA  = sunspec_view::point_index(Model, "DA");
+    // clang-format on
+};
+
+class ACMeterView : public sunspec_view::ModelView<ACMeter> {
+
+public:
+    using ModelView::ModelView;
+
+    // clang-format off
+    static constexpr std::size_t ID       = sunspec_view::point_index(Model, "ID");
+    static constexpr std::size_t L        = sunspec_view::point_index(Model, "L");
+    static constexpr std::size_t A        = sunspec_view::point_index(Model, "A");
+    static constexpr std::size_t AphA     = sunspec_view::point_index(Model, "AphA");
+    static constexpr std::size_t AphB     = sunspec_view::point_index(Model, "AphB");
+    static constexpr std::size_t AphC     = sunspec_view::point_index(Model, "AphC");
+    static constexpr std::size_t A_SF     = sunspec_view::point_index(Model, "A_SF");
+    static constexpr std::size_t PhVphA   = sunspec_view::point_index(Model, "PhVphA");
+    static constexpr std::size_t PhVphB   = sunspec_view::point_index(Model, "PhVphB");
+    static constexpr std::size_t PhVphC   = sunspec_view::point_index(Model, "PhVphC");
+    static constexpr std::size_t V_SF     = sunspec_view::point_index(Model, "V_SF");
+    static constexpr std::size_t Hz       = sunspec_view::point_index(Model, "Hz");
+    static constexpr std::size_t Hz_SF    = sunspec_view::point_index(Model, "Hz_SF");
+    static constexpr std::size_t W        = sunspec_view::point_index(Model, "W");
+    static constexpr std::size_t WphA     = sunspec_view::point_index(Model, "WphA");
+    static constexpr std::size_t WphB     = sunspec_view::point_index(Model, "WphB");
+    static constexpr std::size_t WphC     = sunspec_view::point_index(Model, "WphC");
+    static constexpr std::size_t W_SF     = sunspec_view::point_index(Model, "W_SF");
+    static constexpr std::size_t VA       = sunspec_view::point_index(Model, "VA");
+    static constexpr std::size_t VAphA    = sunspec_view::point_index(Model, "VAphA");
+    static constexpr std::size_t VAphB    = sunspec_view::point_index(Model, "VAphB");
+    static constexpr std::size_t VAphC    = sunspec_view::point_index(Model, "VAphC");
+    static constexpr std::size_t VA_SF    = sunspec_view::point_index(Model, "VA_SF");
+    static constexpr std::size_t VAR      = sunspec_view::point_index(Model, "VAR");
+    static constexpr std::size_t VARphA   = sunspec_view::point_index(Model, "VARphA");
+    static constexpr std::size_t VARphB   = sunspec_view::point_index(Model, "VARphB");
+    static constexpr std::size_t VARphC   = sunspec_view::point_index(Model, "VARphC");
+    static constexpr std::size_t VAR_SF   = sunspec_view::point_index(Model, "VAR_SF");
+    static constexpr std::size_t PFphA    = sunspec_view::point_index(Model, "PFphA");
+    static constexpr std::size_t PFphB    = sunspec_view::point_index(Model, "PFphB");
+    static constexpr std::size_t PFphC    = sunspec_view::point_index(Model, "PFphC");
+    static constexpr std::size_t PF_SF    = sunspec_view::point_index(Model, "PF_SF");
+    static constexpr std::size_t TotWhIm  = sunspec_view::point_index(Model, "TotWhIm");
+    static constexpr std::size_t TotWh_SF = sunspec_view::point_index(Model, "TotWh_SF");
+    static constexpr std::size_t Evt      = sunspec_view::point_index(Model, "Evt");
+    // clang-format on
+};
+
+//////////////////////////////////////////////////////////////////////
+//
+// standard sunspec meter models, as found on devices other than the BSM meter
+
+// clang-format off
+// models 201 - 204 (single phase, split phase, wye and delta meter) share this layout, values are scaled by *_SF
+inline constexpr PointInitializerList IntegerMeterInitList = {
+
+    { "ID"              , PointType::uint16 },
+    { "L"               , PointType::uint16 },
+    { "A"               , PointType::int16 },
+    { "AphA"            , PointType::int16 },
+    { "AphB"            , PointType::int16 },
+    { "AphC"            , PointType::int16 },
+    { "A_SF"            , PointType::sunssf },
+    { "PhV"             , PointType::int16 },
+    { "PhVphA"          , PointType::int16 },
+    { "PhVphB"          , PointType::int16 },
+    { "PhVphC"          , PointType::int16 },
+    { "PPV"             , PointType::int16 },
+    { "PPVphAB"         , PointType::int16 },
+    { "PPVphBC"         , PointType::int16 },
+    { "PPVphCA"         , PointType::int16 },
+    { "V_SF"            , PointType::sunssf },
+    { "Hz"              , PointType::int16 },
+    { "Hz_SF"           , PointType::sunssf },
+    { "W"               , PointType::int16 },
+    { "WphA"            , PointType::int16 },
+    { "WphB"            , PointType::int16 },
+    { "WphC"            , PointType::int16 },
+    { "W_SF"            , PointType::sunssf },
+    { "VA"              , PointType::int16 },
+    { "VAphA"           , PointType::int16 },
+    { "VAphB"           , PointType::int16 },
+    { "VAphC"           , PointType::int16 },
+    { "VA_SF"           , PointType::sunssf },
+    { "VAR"             , PointType::int16 },
+    { "VARphA"          , PointType::int16 },
+    { "VARphB"          , PointType::int16 },
+    { "VARphC"          , PointType::int16 },
+    { "VAR_SF"          , PointType::sunssf },
+    { "PF"              , PointType::int16 },
+    { "PFphA"           , PointType::int16 },
+    { "PFphB"           , PointType::int16 },
+    { "PFphC"           , PointType::int16 },
+    { "PF_SF"           , PointType::sunssf },
+    { "TotWhExp"        , PointType::acc32 },
+    { "TotWhExpPhA"     , PointType::acc32 },
+    { "TotWhExpPhB"     , PointType::acc32 },
+    { "TotWhExpPhC"     , PointType::acc32 },
+    { "TotWhImp"        , PointType::acc32 },
+    { "TotWhImpPhA"     , PointType::acc32 },
+    { "TotWhImpPhB"     , PointType::acc32 },
+    { "TotWhImpPhC"     , PointType::acc32 },
+    { "TotWh_SF"        , PointType::sunssf },
+    { "TotVAhExp"       , PointType::acc32 },
+    { "TotVAhExpPhA"    , PointType::acc32 },
+    { "TotVAhExpPhB"    , PointType::acc32 },
+    { "TotVAhExpPhC"    , PointType::acc32 },
+    { "TotVAhImp"       , PointType::acc32 },
+    { "TotVAhImpPhA"    , PointType::acc32 },
+    { "TotVAhImpPhB"    , PointType::acc32 },
+    { "TotVAhImpPhC"    , PointType::acc32 },
+    { "TotVAh_SF"       , PointType::sunssf },
+    { "TotVArhImpQ1"    , PointType::acc32 },
+    { "TotVArhImpQ1PhA" , PointType::acc32 },
+    { "TotVArhImpQ1PhB" , PointType::acc32 },
+    { "TotVArhImpQ1PhC" , PointType::acc32 },
+    { "TotVArhImpQ2"    , PointType::acc32 },
+    { "TotVArhImpQ2PhA" , PointType::acc32 },
+    { "TotVArhImpQ2PhB" , PointType::acc32 },
+    { "TotVArhImpQ2PhC" , PointType::acc32 },
+    { "TotVArhExpQ3"    , PointType::acc32 },
+    { "TotVArhExpQ3PhA" , PointType::acc32 },
+    { "TotVArhExpQ3PhB" , PointType::acc32 },
+    { "TotVArhExpQ3PhC" , PointType::acc32 },
+    { "TotVArhExpQ4"    , PointType::acc32 },
+    { "TotVArhExpQ4PhA" , PointType::acc32 },
+    { "TotVArhExpQ4PhB" , PointType::acc32 },
+    { "TotVArhExpQ4PhC" , PointType::acc32 },
+    { "TotVArh_SF"      , PointType::sunssf },
+    { "Evt"             , PointType::bitfield32 }
+
+};
+
+// models 211 - 214, the same meters with float32 points and without scale factors
+inline constexpr PointInitializerList FloatMeterInitList = {
+
+    { "ID"              , PointType::uint16 },
+    { "L"               , PointType::uint16 },
+    { "A"               , PointType::float32 },
+    { "AphA"            , PointType::float32 },
+    { "AphB"            , PointType::float32 },
+    { "AphC"            , PointType::float32 },
+    { "PhV"             , PointType::float32 },
+    { "PhVphA"          , PointType::float32 },
+    { "PhVphB"          , PointType::float32 },
+    { "PhVphC"          , PointType::float32 },
+    { "PPV"             , PointType::float32 },
+    { "PPVphAB"         , PointType::float32 },
+    { "PPVphBC"         , PointType::float32 },
+    { "PPVphCA"         , PointType::float32 },
+    { "Hz"              , PointType::float32 },
+    { "W"               , PointType::float32 },
+    { "WphA"            , PointType::float32 },
+    { "WphB"            , PointType::float32 },
+    { "WphC"            , PointType::float32 },
+    { "VA"              , PointType::float32 },
+    { "VAphA"           , PointType::float32 },
+    { "VAphB"           , PointType::float32 },
+    { "VAphC"           , PointType::float32 },
+    { "VAR"             , PointType::float32 },
+    { "VARphA"          , PointType::float32 },
+    { "VARphB"          , PointType::float32 },
+    { "VARphC"          , PointType::float32 },
+    { "PF"              , PointType::float32 },
+    { "PFphA"           , PointType::float32 },
+    { "PFphB"           , PointType::float32 },
+    { "PFphC"           , PointType::float32 },
+    { "TotWhExp"        , PointType::float32 },
+    { "TotWhExpPhA"     , PointType::float32 },
+    { "TotWhExpPhB"     , PointType::float32 },
+    { "TotWhExpPhC"     , PointType::float32 },
+    { "TotWhImp"        , PointType::float32 },
+    { "TotWhImpPhA"     , PointType::float32 },
+    { "TotWhImpPhB"     , PointType::float32 },
+    { "TotWhImpPhC"     , PointType::float32 },
+    { "TotVAhExp"       , PointType::float32 },
+    { "TotVAhExpPhA"    , PointType::float32 },
+    { "TotVAhExpPhB"    , PointType::float32 },
+    { "TotVAhExpPhC"    , PointType::float32 },
+    { "TotVAhImp"       , PointType::float32 },
+    { "TotVAhImpPhA"    , PointType::float32 },
+    { "TotVAhImpPhB"    , PointType::float32 },
+    { "TotVAhImpPhC"    , PointType::float32 },
+    { "TotVArhImpQ1"    , PointType::float32 },
+    { "TotVArhImpQ1PhA" , PointType::float32 },
+    { "TotVArhImpQ1PhB" , PointType::float32 },
+    { "TotVArhImpQ1PhC" , PointType::float32 },
+    { "TotVArhImpQ2"    , PointType::float32 },
+    { "TotVArhImpQ2PhA" , PointType::float32 },
+    { "TotVArhImpQ2PhB" , PointType::float32 },
+    { "TotVArhImpQ2PhC" , PointType::float32 },
+    { "TotVArhExpQ3"    , PointType::float32 },
+    { "TotVArhExpQ3PhA" , PointType::float32 },
+    { "TotVArhExpQ3PhB" , PointType::float32 },
+    { "TotVArhExpQ3PhC" , PointType::float32 },
+    { "TotVArhExpQ4"    , PointType::float32 },
+    { "TotVArhExpQ4PhA" , PointType::float32 },
+    { "TotVArhExpQ4PhB" , PointType::float32 },
+    { "TotVArhExpQ4PhC" , PointType::float32 },
+    { "Evt"             , PointType::bitfield32 }
+
+};
+// clang-format on
+
+using IntegerMeter = SunspecModelBase<IntegerMeterInitList.size(), IntegerMeterInitList>;
+using FloatMeter = SunspecModelBase<FloatMeterInitList.size(), FloatMeterInitList>;
+
+// model length including ID and L
+static_assert(calc_model_size_in_register(IntegerMeter::Model) == 2 + 105);
+static_assert(calc_model_size_in_register(FloatMeter::Model) == 2 + 124);
+
+class IntegerMeterView : public sunspec_view::ModelView<IntegerMeter> {
+
+public:
+    using ModelView::ModelView;
+
+    // clang-format off
+    static constexpr std::size_t ID       = sunspec_view::point_index(Model, "ID");
+    static constexpr std::size_t L        = sunspec_view::point_index(Model, "L");
+    static constexpr std::size_t A        = sunspec_view::point_index(Model, "A");
+    static constexpr std::size_t AphA     = sunspec_view::point_index(Model, "AphA");
+    static constexpr std::size_t AphB     = sunspec_view::point_index(Model, "AphB");
+    static constexpr std::size_t AphC     = sunspec_view::point_index(Model, "AphC");
+    static constexpr std::size_t A_SF     = sunspec_view::point_index(Model, "A_SF");
+    static constexpr std::size_t PhVphA   = sunspec_view::point_index(Model, "PhVphA");
+    static constexpr std::size_t PhVphB   = sunspec_view::point_index(Model, "PhVphB");
+    static constexpr std::size_t PhVphC   = sunspec_view::point_index(Model, "PhVphC");
+    static constexpr std::size_t V_SF     = sunspec_view::point_index(Model, "V_SF");
+    static constexpr std::size_t Hz       = sunspec_view::point_index(Model, "Hz");
+    static constexpr std::size_t Hz_SF    = sunspec_view::point_index(Model, "Hz_SF");
+    static constexpr std::size_t W        = sunspec_view::point_index(Model, "W");
+    static constexpr std::size_t WphA     = sunspec_view::point_index(Model, "WphA");
+    static constexpr std::size_t WphB     = sunspec_view::point_index(Model, "WphB");
+    static constexpr std::size_t WphC     = sunspec_view::point_index(Model, "WphC");
+    static constexpr std::size_t W_SF     = sunspec_view::point_index(Model, "W_SF");
+    static constexpr std::size_t VAR      = sunspec_view::point_index(Model, "VAR");
+    static constexpr std::size_t VARphA   = sunspec_view::point_index(Model, "VARphA");
+    static constexpr std::size_t VARphB   = sunspec_view::point_index(Model, "VARphB");
+    static constexpr std::size_t VARphC   = sunspec_view::point_index(Model, "VARphC");
+    static constexpr std::size_t VAR_SF   = sunspec_view::point_index(Model, "VAR_SF");
+    static constexpr std::size_t TotWhExp = sunspec_view::point_index(Model, "TotWhExp");
+    static constexpr std::size_t TotWhImp = sunspec_view::point_index(Model, "TotWhImp");
+    static constexpr std::size_t TotWh_SF = sunspec_view::point_index(Model, "TotWh_SF");
+    static constexpr std::size_t Evt      = sunspec_view::point_index(Model, "Evt");
+    // clang-format on
+};
+
+class FloatMeterView : public sunspec_view::ModelView<FloatMeter> {
+
+public:
+    using ModelView::ModelView;
+
+    // clang-format off
+    static constexpr std::size_t ID       = sunspec_view::point_index(Model, "ID");
+    static constexpr std::size_t L        = sunspec_view::point_index(Model, "L");
+    static constexpr std::size_t A        = sunspec_view::point_index(Model, "A");
+    static constexpr std::size_t AphA     = sunspec_view::point_index(Model, "AphA");
+    static constexpr std::size_t AphB     = sunspec_view::point_index(Model, "AphB");
+    static constexpr std::size_t AphC     = sunspec_view::point_index(Model, "AphC");
+    static constexpr std::size_t PhVphA   = sunspec_view::point_index(Model, "PhVphA");
+    static constexpr std::size_t PhVphB   = sunspec_view::point_index(Model, "PhVphB");
+    static constexpr std::size_t PhVphC   = sunspec_view::point_index(Model, "PhVphC");
+    static constexpr std::size_t Hz       = sunspec_view::point_index(Model, "Hz");
+    static constexpr std::size_t W        = sunspec_view::point_index(Model, "W");
+    static constexpr std::size_t WphA     = sunspec_view::point_index(Model, "WphA");
+    static constexpr std::size_t WphB     = sunspec_view::point_index(Model, "WphB");
+    static constexpr std::size_t WphC     = sunspec_view::point_index(Model, "WphC");
+    static constexpr std::size_t VAR      = sunspec_view::point_index(Model, "VAR");
+    static constexpr std::size_t VARphA   = sunspec_view::point_index(Model, "VARphA");
+    static constexpr std::size_t VARphB   = sunspec_view::point_index(Model, "VARphB");
+    static constexpr std::size_t VARphC   = sunspec_view::point_index(Model, "VARphC");
+    static constexpr std::size_t TotWhExp = sunspec_view::point_index(Model, "TotWhExp");
+    static constexpr std::size_t TotWhImp = sunspec_view::point_index(Model, "TotWhImp");
+    static constexpr std::size_t Evt      = sunspec_view::point_index(Model, "Evt");
+    // clang-format on
+};
+
 } // namespace sunspec_model
 
 #endif // POWERMETER_BSM_SUNSPEC_MODELS_HPP
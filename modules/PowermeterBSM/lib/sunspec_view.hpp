@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#ifndef POWERMETER_BSM_SUNSPEC_VIEW_HPP
+#define POWERMETER_BSM_SUNSPEC_VIEW_HPP
+
+#include "sunspec_base.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+/**
+ * Typed, non owning views on sunspec models.
+ *
+ * The SunspecModelBase derived classes copy the register buffer and return std::string for string points. A
+ * ModelView reads the same layout (MODEL::Model, offsets calculated at compile time by calc_offset) straight from the
+ * register buffer of the transport: point indices, types and offsets are constant expressions, values are decoded
+ * on access and strings are returned as std::string_view into the buffer. The buffer has to outlive the view.
+ */
+namespace sunspec_view {
+
+template <PointType PT> struct point_value;
+
+// clang-format off
+template <> struct point_value<PointType::acc32>      { using type = sunspec::acc32; };
+template <> struct point_value<PointType::bitfield32> { using type = sunspec::bitfield32; };
+template <> struct point_value<PointType::enum16>     { using type = sunspec::enum16; };
+template <> struct point_value<PointType::int16>      { using type = sunspec::int16; };
+template <> struct point_value<PointType::pad>        { using type = sunspec::pad; };
+template <> struct point_value<PointType::sunssf>     { using type = sunspec::sunssf; };
+template <> struct point_value<PointType::uint16>     { using type = sunspec::uint16; };
+template <> struct point_value<PointType::uint32>     { using type = sunspec::uint32; };
+template <> struct point_value<PointType::float32>    { using type = sunspec::float32; };
+template <> struct point_value<PointType::string>     { using type = std::string_view; };
+// clang-format on
+
+template <PointType PT> using point_value_t = typename point_value<PT>::type;
+
+/**
+ * Binary data inside the register buffer
+ */
+struct Bytes {
+    const std::uint8_t* data;
+    std::size_t size;
+};
+
+/**
+ * Index of the first point named \p id in \p model, usable in constant expressions. Fails to compile (when used in a
+ * constant expression) if there is no such point.
+ */
+template <std::size_t N> constexpr std::size_t point_index(const PointArray<N>& model, std::string_view id) {
+    for (std::size_t index = 0; index < N; ++index) {
+        if (std::string_view(model[index].id) == id)
+            return index;
+    }
+    throw std::logic_error("unknown point id");
+}
+
+constexpr std::uint16_t load_be16(const std::uint8_t* data) {
+    return static_cast<std::uint16_t>((data[0] << 8) | data[1]);
+}
+
+constexpr std::uint32_t load_be32(const std::uint8_t* data) {
+    return (static_cast<std::uint32_t>(load_be16(data)) << 16) | load_be16(data + 2);
+}
+
+/**
+ * 10^sf for the scale factors seen in practice, std::nullopt for the "not implemented" value and out of range factors.
+ */
+constexpr std::optional<double> pow10(sunspec::sunssf sf) {
+    constexpr double powers[] = {1e-10, 1e-9, 1e-8, 1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1e0,
+                                 1e1,   1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10};
+    if (sf < -10 || sf > 10)
+        return std::nullopt;
+    return powers[sf + 10];
+}
+
+template <typename MODEL> class ModelView {
+
+public:
+    static constexpr const auto& Model = MODEL::Model;
+    static constexpr std::size_t model_size_in_bytes = calc_model_size_in_bytes(Model);
+    static constexpr std::size_t model_size_in_register = calc_model_size_in_register(Model);
+
+    ModelView() = delete;
+
+    ModelView(const std::uint8_t* data, std::size_t size) : m_data(data), m_size(size) {
+        if (data == nullptr || size < model_size_in_bytes)
+            throw std::runtime_error(""s + __PRETTY_FUNCTION__ + " Data container size (" + std::to_string(size) +
+                                     ") is smaller than model size (" + std::to_string(model_size_in_bytes) + ") !");
+    }
+
+    explicit ModelView(const transport::DataVector& data) : ModelView(data.data(), data.size()) {
+    }
+
+    // a view on a temporary buffer would dangle
+    explicit ModelView(transport::DataVector&& data) = delete;
+
+    /**
+     * Raw value of point \p I, typed after its PointType. Strings end at the first \0 like SunspecModelBase strings.
+     */
+    template <std::size_t I> point_value_t<Model[I].pointType> get() const {
+        static_assert(I < Model.size(), "point index out of range");
+        constexpr Point point = Model[I];
+        const std::uint8_t* data = m_data + point.offset;
+
+        if constexpr (point.pointType == PointType::string) {
+            const auto* begin = reinterpret_cast<const char*>(data);
+            std::size_t length = 0;
+            while (length < point.length_in_bytes && begin[length] != '\0')
+                ++length;
+            return std::string_view(begin, length);
+        } else if constexpr (point.pointType == PointType::float32) {
+            const std::uint32_t bits = load_be32(data);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        } else if constexpr (point_length_in_bytes(point.pointType) == 4) {
+            return load_be32(data);
+        } else {
+            return static_cast<point_value_t<point.pointType>>(load_be16(data));
+        }
+    }
+
+    /**
+     * true if point \p I does not hold the sunspec "not implemented" value of its type
+     */
+    template <std::size_t I> bool valid() const {
+        constexpr PointType type = Model[I].pointType;
+        const auto value = get<I>();
+
+        if constexpr (type == PointType::acc32)
+            return value != invalid_point_value::acc32;
+        else if constexpr (type == PointType::bitfield32)
+            return value != invalid_point_value::bitfield32;
+        else if constexpr (type == PointType::enum16)
+            return value != invalid_point_value::enum16;
+        else if constexpr (type == PointType::int16)
+            return value != invalid_point_value::int16;
+        else if constexpr (type == PointType::sunssf || type == PointType::pad)
+            return static_cast<std::uint16_t>(value) != invalid_point_value::sunssf;
+        else if constexpr (type == PointType::uint16)
+            return value != invalid_point_value::uint16;
+        else if constexpr (type == PointType::uint32)
+            return value != invalid_point_value::uint32;
+        else if constexpr (type == PointType::float32)
+            return not std::isnan(value);
+        else
+            return not value.empty();
+    }
+
+    /**
+     * Value of point \p I scaled by the scale factor point \p SF, std::nullopt if either is not implemented.
+     */
+    template <std::size_t I, std::size_t SF> std::optional<double> scaled() const {
+        constexpr PointType type = Model[I].pointType;
+        constexpr PointType sf_type = Model[SF].pointType;
+        static_assert(type != PointType::string && type != PointType::pad && type != PointType::blob,
+                      "only numeric points can be scaled");
+        // some vendor tables declare their scale factors as int16
+        static_assert(sf_type == PointType::sunssf || sf_type == PointType::int16, "scale factor has to be a sunssf");
+
+        if (not valid<I>())
+            return std::nullopt;
+        const auto sf = static_cast<sunspec::sunssf>(get<SF>());
+        if (static_cast<std::uint16_t>(sf) == invalid_point_value::sunssf)
+            return std::nullopt;
+        const auto factor = pow10(sf);
+        if (not factor.has_value())
+            return std::nullopt;
+        return static_cast<double>(get<I>()) * factor.value();
+    }
+
+    /**
+     * \p length bytes of binary data starting at point \p I (e.g. a blob whose length is given by another point).
+     */
+    template <std::size_t I> Bytes bytes(std::size_t length) const {
+        constexpr Point point = Model[I];
+        if (point.offset + length > m_size)
+            throw std::out_of_range(""s + __PRETTY_FUNCTION__ + " " + std::to_string(length) +
+                                    " bytes exceed the data container");
+        return Bytes{m_data + point.offset, length};
+    }
+
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+};
+
+} // namespace sunspec_view
+
+#endif // POWERMETER_BSM_SUNSPEC_VIEW_HPP
@@ -7,8 +7,8 @@
 #include <utils/date.hpp>
 
 #include <chrono>
-#include <cmath>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
 using namespace std::chrono_literals;
@@ -16,6 +16,14 @@ using namespace std::chrono_literals;
 namespace module {
 namespace main {
 
+namespace {
+std::optional<float> to_float(const std::optional<double>& value) {
+    if (not value.has_value())
+        return std::nullopt;
+    return static_cast<float>(value.value());
+}
+} // namespace
+
 //////////////////////////////////////////////////////////////////////
 //
 // module related stuff
@@ -107,38 +115,42 @@ void powermeterImpl::worker() {
 
                 transport::DataVector data = transport->fetch(known_model::Sunspec_ACMeter);
 
-                sunspec_model::ACMeter acmeter(data);
+                using View = sunspec_model::ACMeterView;
+                const View acmeter(data);
                 types::powermeter::Powermeter result;
 
                 result.timestamp = Everest::Date::to_rfc3339(date::utc_clock::now());
 
                 result.meter_id = mod->config.meter_id;
 
-                float scale_factor_Wh_import = pow(10, acmeter.TotWh_SF());
-                result.energy_Wh_import.total = acmeter.TotWhIm() * scale_factor_Wh_import;
-
-                float scale_factor_W = pow(10, acmeter.W_SF());
-                result.power_W = types::units::Power{.total = static_cast<float>(acmeter.W() * scale_factor_W)};
-
-                float scale_factor_current = pow(10, acmeter.A_SF());
-                result.current_A = types::units::Current{.L1 = static_cast<float>(acmeter.A() * scale_factor_current)};
-
-                float scale_factor_voltage = pow(10, acmeter.V_SF());
-                result.voltage_V =
-                    types::units::Voltage{.L1 = static_cast<float>(acmeter.PhVphA() * scale_factor_voltage),
-                                          .L2 = static_cast<float>(acmeter.PhVphB() * scale_factor_voltage),
-                                          .L3 = static_cast<float>(acmeter.PhVphC() * scale_factor_voltage)};
-
-                float scale_factor_frequency = pow(10, acmeter.Hz_SF());
-                result.frequency_Hz =
-                    types::units::Frequency{.L1 = static_cast<float>(acmeter.Hz() * scale_factor_frequency)};
-
-                float scale_factor_reactive_power = pow(10, acmeter.VAR_SF());
-                result.VAR = types::units::ReactivePower{
-                    .total = static_cast<float>(acmeter.VAR() * scale_factor_reactive_power),
-                    .L1 = static_cast<float>(acmeter.VARphA() * scale_factor_reactive_power),
-                    .L2 = static_cast<float>(acmeter.VARphB() * scale_factor_reactive_power),
-                    .L3 = static_cast<float>(acmeter.VARphC() * scale_factor_reactive_power)};
+                const auto energy_Wh_import = acmeter.scaled<View::TotWhIm, View::TotWh_SF>();
+                if (not energy_Wh_import.has_value()) {
+                    // publishing 0 Wh would corrupt the energy readings of the consumers
+                    throw std::runtime_error("TotWhIm or TotWh_SF not implemented by the meter");
+                }
+                result.energy_Wh_import.total = energy_Wh_import.value();
+
+                if (const auto power = acmeter.scaled<View::W, View::W_SF>()) {
+                    result.power_W = types::units::Power{.total = static_cast<float>(power.value())};
+                }
+
+                result.current_A = types::units::Current{.L1 = to_float(acmeter.scaled<View::A, View::A_SF>())};
+
+                result.voltage_V = types::units::Voltage{.L1 = to_float(acmeter.scaled<View::PhVphA, View::V_SF>()),
+                                                         .L2 = to_float(acmeter.scaled<View::PhVphB, View::V_SF>()),
+                                                         .L3 = to_float(acmeter.scaled<View::PhVphC, View::V_SF>())};
+
+                if (const auto frequency = acmeter.scaled<View::Hz, View::Hz_SF>()) {
+                    result.frequency_Hz = types::units::Frequency{.L1 = static_cast<float>(frequency.value())};
+                }
+
+                if (const auto reactive_power = acmeter.scaled<View::VAR, View::VAR_SF>()) {
+                    result.VAR = types::units::ReactivePower{
+                        .total = static_cast<float>(reactive_power.value()),
+                        .L1 = to_float(acmeter.scaled<View::VARphA, View::VAR_SF>()),
+                        .L2 = to_float(acmeter.scaled<View::VARphB, View::VAR_SF>()),
+                        .L3 = to_float(acmeter.scaled<View::VARphC, View::VAR_SF>())};
+                }
 
                 publish_powermeter(result);
 
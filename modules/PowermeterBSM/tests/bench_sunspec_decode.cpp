@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Compares decoding an AC meter model and a signed snapshot with the copying SunspecModelBase classes and with the
+// zero copy views. Not run as a test, start it manually on the target:
+//   ./PowermeterBSM_bench_sunspec_decode [iterations]
+
+#include "lib/BSMSnapshotModel.hpp"
+#include "lib/sunspec_models.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+// keeps the compiler from optimizing the decoding away
+volatile double sink_double;
+volatile std::size_t sink_size;
+
+transport::DataVector make_ac_meter_data() {
+    transport::DataVector data(sunspec_model::ACMeterView::model_size_in_bytes);
+    for (std::size_t i = 0; i < data.size(); i += 2) {
+        data[i] = 0x00;
+        data[i + 1] = static_cast<std::uint8_t>(i);
+    }
+    // scale factors of -1
+    for (const auto index : {sunspec_model::ACMeterView::A_SF, sunspec_model::ACMeterView::V_SF,
+                             sunspec_model::ACMeterView::W_SF, sunspec_model::ACMeterView::VAR_SF,
+                             sunspec_model::ACMeterView::TotWh_SF, sunspec_model::ACMeterView::Hz_SF}) {
+        data[sunspec_model::ACMeterView::Model[index].offset] = 0xff;
+        data[sunspec_model::ACMeterView::Model[index].offset + 1] = 0xff;
+    }
+    return data;
+}
+
+transport::DataVector make_snapshot_data() {
+    transport::DataVector data(bsm::SignedSnapshotView::model_size_in_bytes + 128, 0x00);
+    const std::string meter_address{"001BZR1521070019"};
+    std::copy(meter_address.begin(), meter_address.end(),
+              data.begin() + bsm::SignedSnapshotView::Model[bsm::SignedSnapshotView::MA1].offset);
+    data[bsm::SignedSnapshotView::Model[bsm::SignedSnapshotView::BSig].offset + 1] = 71;
+    return data;
+}
+
+template <typename F> void run(const char* name, std::size_t iterations, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+        f();
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() / iterations << " ns per decode" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    const auto ac_meter_data = make_ac_meter_data();
+    const auto snapshot_data = make_snapshot_data();
+
+    // what powermeterImpl publishes per interval
+    run("ACMeter            ", iterations, [&]() {
+        sunspec_model::ACMeter acmeter(ac_meter_data);
+        sink_double = acmeter.TotWhIm() * pow(10, acmeter.TotWh_SF()) + acmeter.W() * pow(10, acmeter.W_SF()) +
+                      acmeter.A() * pow(10, acmeter.A_SF()) + acmeter.PhVphA() * pow(10, acmeter.V_SF()) +
+                      acmeter.PhVphB() * pow(10, acmeter.V_SF()) + acmeter.PhVphC() * pow(10, acmeter.V_SF()) +
+                      acmeter.Hz() * pow(10, acmeter.Hz_SF()) + acmeter.VAR() * pow(10, acmeter.VAR_SF());
+    });
+
+    run("ACMeterView        ", iterations, [&]() {
+        using View = sunspec_model::ACMeterView;
+        View acmeter(ac_meter_data);
+        sink_double = acmeter.scaled<View::TotWhIm, View::TotWh_SF>().value_or(0) +
+                      acmeter.scaled<View::W, View::W_SF>().value_or(0) +
+                      acmeter.scaled<View::A, View::A_SF>().value_or(0) +
+                      acmeter.scaled<View::PhVphA, View::V_SF>().value_or(0) +
+                      acmeter.scaled<View::PhVphB, View::V_SF>().value_or(0) +
+                      acmeter.scaled<View::PhVphC, View::V_SF>().value_or(0) +
+                      acmeter.scaled<View::Hz, View::Hz_SF>().value_or(0) +
+                      acmeter.scaled<View::VAR, View::VAR_SF>().value_or(0);
+    });
+
+    run("SignedSnapshot     ", iterations, [&]() {
+        bsm::SignedSnapshot snapshot(snapshot_data);
+        sink_size = snapshot.MA1().size() + snapshot.Meta1().size() + snapshot.Meta2().size() +
+                    snapshot.Meta3().size() + snapshot.TotWhImp() + snapshot.RCnt();
+    });
+
+    run("SignedSnapshotView ", iterations, [&]() {
+        using View = bsm::SignedSnapshotView;
+        View snapshot(snapshot_data);
+        sink_size = snapshot.get<View::MA1>().size() + snapshot.get<View::Meta1>().size() +
+                    snapshot.get<View::Meta2>().size() + snapshot.get<View::Meta3>().size() +
+                    snapshot.get<View::TotWhImp>() + snapshot.get<View::RCnt>();
+    });
+
+    return 0;
+}
@@ -8,6 +8,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
 #include <initializer_list>
 #include <iostream>
 #include <numeric>
@@ -329,6 +331,42 @@ TEST(TestModel, BSMSignedSnapshot) {
     //                                               8, // response counter
     //                                               9, // Operation seconds
     //     } );
+
+    // the zero copy view decodes the same values
+    using View = bsm::SignedSnapshotView;
+    View view(data);
+
+    EXPECT_EQ(view.get<View::Type>(), signed_snapshot.Type());
+    EXPECT_EQ(view.get<View::Status>(), signed_snapshot.Status());
+    EXPECT_EQ(view.get<View::RCR>(), signed_snapshot.RCR());
+    EXPECT_EQ(view.get<View::TotWhImp>(), signed_snapshot.TotWhImp());
+    EXPECT_EQ(view.get<View::Wh_SF>(), signed_snapshot.Wh_SF());
+    EXPECT_EQ(view.get<View::W>(), signed_snapshot.W());
+    EXPECT_EQ(view.get<View::W_SF>(), signed_snapshot.W_SF());
+    EXPECT_EQ(view.get<View::MA1>(), signed_snapshot.MA1());
+    EXPECT_EQ(view.get<View::RCnt>(), signed_snapshot.RCnt());
+    EXPECT_EQ(view.get<View::OS>(), signed_snapshot.OS());
+    EXPECT_EQ(view.get<View::Epoch>(), signed_snapshot.Epoch());
+    EXPECT_EQ(view.get<View::TZO>(), signed_snapshot.TZO());
+    EXPECT_EQ(view.get<View::EpochSetCnt>(), signed_snapshot.EpochSetCnt());
+    EXPECT_EQ(view.get<View::EpochSetOS>(), signed_snapshot.EpochSetOS());
+    EXPECT_EQ(view.get<View::DI>(), signed_snapshot.DI());
+    EXPECT_EQ(view.get<View::DO>(), signed_snapshot.DO());
+    EXPECT_EQ(view.get<View::Meta1>(), signed_snapshot.Meta1());
+    EXPECT_EQ(view.get<View::Meta2>(), signed_snapshot.Meta2());
+    EXPECT_EQ(view.get<View::Meta3>(), signed_snapshot.Meta3());
+    EXPECT_EQ(view.get<View::Evt>(), signed_snapshot.Evt());
+    EXPECT_EQ(view.get<View::NSig>(), signed_snapshot.NSig());
+    EXPECT_EQ(view.get<View::BSig>(), signed_snapshot.BSig());
+
+    EXPECT_FALSE(view.valid<View::Epoch>());
+    EXPECT_FALSE(view.valid<View::TZO>());
+    EXPECT_FALSE(view.valid<View::Meta1>());
+    EXPECT_TRUE(view.valid<View::MA1>());
+
+    const auto signature = view.signature();
+    ASSERT_EQ(signature.size, signed_snapshot.BSig());
+    EXPECT_EQ(std::memcmp(signature.data, data.data() + View::Model[View::Sig].offset, signature.size), 0);
 }
 
 TEST(TestModel, BSMOCMFSignedSnapshot) {
@@ -443,6 +481,11 @@ bsm_ocmf:
 
     // This should be enough testing here...
     EXPECT_EQ(signedOCMFSnapshot.O(), expected_ocmf_string);
+
+    bsm::SignedOCMFSnapshotView view(data);
+    EXPECT_EQ(view.get<bsm::SignedOCMFSnapshotView::O>(), expected_ocmf_string);
+    EXPECT_EQ(view.get<bsm::SignedOCMFSnapshotView::ID>(), signedOCMFSnapshot.ID());
+    EXPECT_EQ(view.get<bsm::SignedOCMFSnapshotView::L>(), signedOCMFSnapshot.L());
 }
 
 TEST(TestModel, SunspecACMeter) {
@@ -571,6 +614,118 @@ ac_meter:
     EXPECT_FLOAT_EQ(ac_meter.VARphA() * pow(10, ac_meter.VAR_SF()), -20.0);
 
     EXPECT_FLOAT_EQ(ac_meter.PFphA() * pow(10, ac_meter.PF_SF()), 68.60000000000001);
+
+    // the zero copy view decodes the same raw values and applies the scale factors itself
+    using View = sunspec_model::ACMeterView;
+    View view(data);
+
+    EXPECT_EQ(view.get<View::ID>(), ac_meter.ID());
+    EXPECT_EQ(view.get<View::L>(), ac_meter.L());
+    EXPECT_EQ(view.get<View::A>(), ac_meter.A());
+    EXPECT_EQ(view.get<View::AphB>(), ac_meter.AphB());
+    EXPECT_EQ(view.get<View::AphC>(), ac_meter.AphC());
+    EXPECT_EQ(view.get<View::A_SF>(), ac_meter.A_SF());
+    EXPECT_EQ(view.get<View::PhVphA>(), ac_meter.PhVphA());
+    EXPECT_EQ(view.get<View::PhVphB>(), ac_meter.PhVphB());
+    EXPECT_EQ(view.get<View::PhVphC>(), ac_meter.PhVphC());
+    EXPECT_EQ(view.get<View::V_SF>(), ac_meter.V_SF());
+    EXPECT_EQ(view.get<View::Hz>(), ac_meter.Hz());
+    EXPECT_EQ(view.get<View::Hz_SF>(), ac_meter.Hz_SF());
+    EXPECT_EQ(view.get<View::W>(), ac_meter.W());
+    EXPECT_EQ(view.get<View::WphA>(), ac_meter.WphA());
+    EXPECT_EQ(view.get<View::WphB>(), ac_meter.WphB());
+    EXPECT_EQ(view.get<View::WphC>(), ac_meter.WphC());
+    EXPECT_EQ(view.get<View::W_SF>(), ac_meter.W_SF());
+    EXPECT_EQ(view.get<View::VA>(), ac_meter.VA());
+    EXPECT_EQ(view.get<View::VAphA>(), ac_meter.VAphA());
+    EXPECT_EQ(view.get<View::VAphB>(), ac_meter.VAphB());
+    EXPECT_EQ(view.get<View::VAphC>(), ac_meter.VAphC());
+    EXPECT_EQ(view.get<View::VA_SF>(), ac_meter.VA_SF());
+    EXPECT_EQ(view.get<View::VAR>(), ac_meter.VAR());
+    EXPECT_EQ(view.get<View::VARphA>(), ac_meter.VARphA());
+    EXPECT_EQ(view.get<View::VARphB>(), ac_meter.VARphB());
+    EXPECT_EQ(view.get<View::VARphC>(), ac_meter.VARphC());
+    EXPECT_EQ(view.get<View::VAR_SF>(), ac_meter.VAR_SF());
+    EXPECT_EQ(view.get<View::PFphA>(), ac_meter.PFphA());
+    EXPECT_EQ(view.get<View::PFphB>(), ac_meter.PFphB());
+    EXPECT_EQ(view.get<View::PFphC>(), ac_meter.PFphC());
+    EXPECT_EQ(view.get<View::PF_SF>(), ac_meter.PF_SF());
+    EXPECT_EQ(view.get<View::TotWhIm>(), ac_meter.TotWhIm());
+    EXPECT_EQ(view.get<View::TotWh_SF>(), ac_meter.TotWh_SF());
+    EXPECT_EQ(view.get<View::Evt>(), ac_meter.Evt());
+
+    // ACMeter::AphA() returns the offset of the point instead of its value
+    EXPECT_EQ(view.get<View::AphA>(), 13);
+
+    EXPECT_DOUBLE_EQ((view.scaled<View::A, View::A_SF>().value()), 0.13);
+    EXPECT_DOUBLE_EQ((view.scaled<View::PhVphA, View::V_SF>().value()), 236.4);
+    EXPECT_DOUBLE_EQ((view.scaled<View::Hz, View::Hz_SF>().value()), 50.0);
+    EXPECT_DOUBLE_EQ((view.scaled<View::W, View::W_SF>().value()), 20.0);
+    EXPECT_DOUBLE_EQ((view.scaled<View::VAphA, View::VA_SF>().value()), 30.0);
+    EXPECT_DOUBLE_EQ((view.scaled<View::VAR, View::VAR_SF>().value()), -20.0);
+    EXPECT_DOUBLE_EQ((view.scaled<View::PFphA, View::PF_SF>().value()), 68.60000000000001);
+    EXPECT_DOUBLE_EQ((view.scaled<View::TotWhIm, View::TotWh_SF>().value()), 8870.0);
+
+    // not implemented points are not scaled
+    transport::DataVector not_implemented{data};
+    not_implemented.at(View::Model[View::PhVphB].offset) = 0x80;
+    not_implemented.at(View::Model[View::PhVphB].offset + 1) = 0x00;
+    View not_implemented_view(not_implemented);
+    EXPECT_FALSE(not_implemented_view.valid<View::PhVphB>());
+    EXPECT_FALSE((not_implemented_view.scaled<View::PhVphB, View::V_SF>().has_value()));
+    EXPECT_TRUE((not_implemented_view.scaled<View::PhVphA, View::V_SF>().has_value()));
+}
+
+TEST(TestModelView, CompileTimeLayout) {
+
+    using View = sunspec_model::ACMeterView;
+
+    // indices and offsets are constant expressions
+    static_assert(View::A == 2);
+    static_assert(View::Evt == 40);
+    static_assert(View::Model[View::TotWhIm].offset == 92);
+    static_assert(View::Model[View::Evt].offset == 210);
+    static_assert(View::model_size_in_register == sunspec_model::ACMeter::Model.back().offset / 2 + 2);
+    static_assert(std::is_same_v<decltype(std::declval<View>().get<View::TotWhIm>()), sunspec::acc32>);
+    static_assert(std::is_same_v<decltype(std::declval<View>().get<View::V_SF>()), sunspec::sunssf>);
+    static_assert(std::is_same_v<decltype(std::declval<sunspec_model::CommonView>().get<sunspec_model::CommonView::Mn>()),
+                                 std::string_view>);
+    static_assert(bsm::SignedSnapshotView::model_size_in_bytes == calc_model_size_in_bytes(bsm::SignedSnapshot::Model));
+
+    static_assert(sunspec_view::load_be16(std::array<std::uint8_t, 2>{0xfb, 0x2e}.data()) == 0xfb2e);
+    static_assert(sunspec_view::pow10(-2).value() == 1e-2);
+    static_assert(not sunspec_view::pow10(static_cast<sunspec::sunssf>(invalid_point_value::sunssf)).has_value());
+}
+
+TEST(TestModelView, EmptyContainer) {
+
+    transport::DataVector empty;
+    ASSERT_THROW(sunspec_model::CommonView view(empty), std::runtime_error);
+
+    transport::DataVector too_small(sunspec_model::ACMeterView::model_size_in_bytes - 1);
+    ASSERT_THROW(sunspec_model::ACMeterView view(too_small), std::runtime_error);
+}
+
+TEST(TestModelView, CommonStrings) {
+
+    transport::DataVector data(sunspec_model::CommonView::model_size_in_bytes);
+    const std::string manufacturer{"BAUER Electronic"};
+    const std::string model{"BSM-WS36A-H01-1311-0000"};
+    std::copy(manufacturer.begin(), manufacturer.end(), data.begin() + 4);
+    std::copy(model.begin(), model.end(), data.begin() + 36);
+
+    sunspec_model::Common common(data);
+    sunspec_model::CommonView view(data);
+
+    EXPECT_EQ(view.get<sunspec_model::CommonView::Mn>(), common.Mn());
+    EXPECT_EQ(view.get<sunspec_model::CommonView::Md>(), common.Md());
+    EXPECT_EQ(view.get<sunspec_model::CommonView::Vr>(), common.Vr());
+    EXPECT_FALSE(view.valid<sunspec_model::CommonView::SN>());
+
+    // a string filling its whole point ends at the point
+    std::fill(data.begin() + 4, data.begin() + 36, 'x');
+    EXPECT_EQ(view.get<sunspec_model::CommonView::Mn>(), std::string(32, 'x'));
+    EXPECT_EQ(view.get<sunspec_model::CommonView::Mn>(), sunspec_model::Common(data).Mn());
 }
 
 template <typename MODEL>
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "SunspecPowermeter.hpp"
+
+namespace module {
+
+void SunspecPowermeter::init() {
+    invoke_init(*p_main);
+}
+
+void SunspecPowermeter::ready() {
+    invoke_ready(*p_main);
+}
+
+} // namespace module
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "sunspec_device.hpp"
+
+#include <sunspec_models.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace sunspec_device {
+
+namespace {
+
+// the chain of a real device is much shorter, this only protects against looping on garbage
+constexpr std::size_t MAX_MODELS_IN_CHAIN = 64;
+
+void copy_registers(const Registers& registers, transport::DataVector& image, std::size_t byte_offset) {
+    for (const auto value : registers) {
+        if (byte_offset + 1 >= image.size())
+            return;
+        image[byte_offset++] = static_cast<std::uint8_t>(value >> 8);
+        image[byte_offset++] = static_cast<std::uint8_t>(value & 0xff);
+    }
+}
+
+std::string trimmed(std::string_view value) {
+    // sunspec strings are \0 terminated, but some vendors pad with blanks
+    const auto end = value.find_last_not_of(' ');
+    return std::string(end == std::string_view::npos ? std::string_view{} : value.substr(0, end + 1));
+}
+
+void read_common_model(const ReadRegisters& read, const ModelHeader& header, DeviceInfo& device) {
+    using View = sunspec_model::CommonView;
+
+    const auto count = std::min<std::size_t>(2 + header.length, View::model_size_in_register);
+    const auto registers = read(header.address, count);
+    if (not registers.has_value())
+        return; // the common model is informational only
+
+    transport::DataVector image(View::model_size_in_bytes, 0);
+    copy_registers(registers.value(), image, 0);
+    const View common(image);
+    device.manufacturer = trimmed(common.get<View::Mn>());
+    device.model = trimmed(common.get<View::Md>());
+    device.serial_number = trimmed(common.get<View::SN>());
+}
+
+std::optional<DeviceInfo> walk_model_chain(const ReadRegisters& read, std::uint16_t base_address) {
+    DeviceInfo device{base_address, {}, {}, {}, {}};
+
+    std::uint32_t address = base_address + 2;
+    while (device.models.size() < MAX_MODELS_IN_CHAIN) {
+        if (address + 2 > 0x10000)
+            return std::nullopt;
+
+        const auto header = read(static_cast<std::uint16_t>(address), 2);
+        if (not header.has_value() || header->size() != 2)
+            return std::nullopt;
+
+        const auto id = header->at(0);
+        if (id == END_MODEL_ID)
+            break;
+
+        device.models.push_back({id, static_cast<std::uint16_t>(address), header->at(1)});
+        address += 2 + header->at(1);
+    }
+
+    if (not device.models.empty() && device.models.front().id == COMMON_MODEL_ID)
+        read_common_model(read, device.models.front(), device);
+
+    return device;
+}
+
+template <typename VIEW> std::size_t payload_length() {
+    return VIEW::model_size_in_register - 2;
+}
+
+template <typename VIEW> ReadBlock span(const ModelHeader& meter, std::size_t index) {
+    const auto& point = VIEW::Model[index];
+    return {static_cast<std::uint16_t>(meter.address + point.offset / 2),
+            static_cast<std::uint16_t>(point.length_in_bytes / 2)};
+}
+
+template <typename VIEW> std::vector<ReadBlock> spans(const ModelHeader& meter, std::initializer_list<std::size_t> points) {
+    std::vector<ReadBlock> result;
+    result.reserve(points.size());
+    for (const auto index : points)
+        result.push_back(span<VIEW>(meter, index));
+    return result;
+}
+
+// acc32 has 0 as "not accumulated" value, which is also what a new meter reports
+template <std::size_t I, std::size_t SF>
+std::optional<double> accumulated(const sunspec_model::IntegerMeterView& meter) {
+    const auto sf = meter.get<SF>();
+    if (static_cast<std::uint16_t>(sf) == invalid_point_value::sunssf)
+        return std::nullopt;
+    const auto factor = sunspec_view::pow10(sf);
+    if (not factor.has_value())
+        return std::nullopt;
+    return meter.get<I>() * factor.value();
+}
+
+template <std::size_t I> std::optional<double> value(const sunspec_model::FloatMeterView& meter) {
+    if (not meter.valid<I>())
+        return std::nullopt;
+    return meter.get<I>();
+}
+
+Reading decode(const sunspec_model::IntegerMeterView& meter) {
+    using View = sunspec_model::IntegerMeterView;
+
+    Reading reading;
+    reading.energy_Wh_import = accumulated<View::TotWhImp, View::TotWh_SF>(meter);
+    reading.energy_Wh_export = accumulated<View::TotWhExp, View::TotWh_SF>(meter);
+    reading.power_W = {meter.scaled<View::W, View::W_SF>(), meter.scaled<View::WphA, View::W_SF>(),
+                       meter.scaled<View::WphB, View::W_SF>(), meter.scaled<View::WphC, View::W_SF>()};
+    reading.current_A = {meter.scaled<View::A, View::A_SF>(), meter.scaled<View::AphA, View::A_SF>(),
+                         meter.scaled<View::AphB, View::A_SF>(), meter.scaled<View::AphC, View::A_SF>()};
+    reading.voltage_V = {std::nullopt, meter.scaled<View::PhVphA, View::V_SF>(),
+                         meter.scaled<View::PhVphB, View::V_SF>(), meter.scaled<View::PhVphC, View::V_SF>()};
+    reading.reactive_power_VAR = {meter.scaled<View::VAR, View::VAR_SF>(), meter.scaled<View::VARphA, View::VAR_SF>(),
+                                  meter.scaled<View::VARphB, View::VAR_SF>(),
+                                  meter.scaled<View::VARphC, View::VAR_SF>()};
+    reading.frequency_Hz = meter.scaled<View::Hz, View::Hz_SF>();
+    return reading;
+}
+
+Reading decode(const sunspec_model::FloatMeterView& meter) {
+    using View = sunspec_model::FloatMeterView;
+
+    Reading reading;
+    reading.energy_Wh_import = value<View::TotWhImp>(meter);
+    reading.energy_Wh_export = value<View::TotWhExp>(meter);
+    reading.power_W = {value<View::W>(meter), value<View::WphA>(meter), value<View::WphB>(meter),
+                       value<View::WphC>(meter)};
+    reading.current_A = {value<View::A>(meter), value<View::AphA>(meter), value<View::AphB>(meter),
+                         value<View::AphC>(meter)};
+    reading.voltage_V = {std::nullopt, value<View::PhVphA>(meter), value<View::PhVphB>(meter),
+                         value<View::PhVphC>(meter)};
+    reading.reactive_power_VAR = {value<View::VAR>(meter), value<View::VARphA>(meter), value<View::VARphB>(meter),
+                                  value<View::VARphC>(meter)};
+    reading.frequency_Hz = value<View::Hz>(meter);
+    return reading;
+}
+
+} // namespace
+
+std::optional<DeviceInfo> discover(const ReadRegisters& read, const std::vector<std::uint16_t>& base_addresses) {
+    for (const auto base_address : base_addresses) {
+        const auto marker = read(base_address, 2);
+        if (marker.has_value() && marker->size() == 2 && marker->at(0) == SUNS_MARKER_0 &&
+            marker->at(1) == SUNS_MARKER_1)
+            return walk_model_chain(read, base_address);
+    }
+    return std::nullopt;
+}
+
+std::optional<MeterKind> meter_kind(std::uint16_t model_id) {
+    if (model_id >= 201 && model_id <= 204)
+        return MeterKind::Integer;
+    if (model_id >= 211 && model_id <= 214)
+        return MeterKind::Float;
+    return std::nullopt;
+}
+
+std::optional<ModelHeader> select_meter(const DeviceInfo& device, std::uint16_t model_id) {
+    for (const auto& model : device.models) {
+        const auto kind = meter_kind(model.id);
+        if (not kind.has_value() || (model_id != 0 && model.id != model_id))
+            continue;
+
+        // a shorter model would make us read into the next one
+        const auto expected = kind == MeterKind::Integer ? payload_length<sunspec_model::IntegerMeterView>()
+                                                         : payload_length<sunspec_model::FloatMeterView>();
+        if (model.length >= expected)
+            return model;
+    }
+    return std::nullopt;
+}
+
+bool operator==(const ReadBlock& lhs, const ReadBlock& rhs) {
+    return lhs.address == rhs.address && lhs.count == rhs.count;
+}
+
+std::vector<ReadBlock> plan_reads(std::vector<ReadBlock> spans, std::uint16_t max_gap, std::uint16_t max_registers) {
+    std::sort(spans.begin(), spans.end(),
+              [](const ReadBlock& lhs, const ReadBlock& rhs) { return lhs.address < rhs.address; });
+
+    std::vector<ReadBlock> plan;
+    for (const auto& span : spans) {
+        if (span.count == 0)
+            continue;
+        if (span.count > max_registers)
+            throw std::invalid_argument("sunspec point larger than a single read");
+
+        if (not plan.empty()) {
+            auto& last = plan.back();
+            const std::uint32_t last_end = last.address + last.count;
+            const std::uint32_t span_end = span.address + span.count;
+            if (span_end <= last_end)
+                continue; // already covered
+            if (span.address <= last_end + max_gap && span_end - last.address <= max_registers) {
+                last.count = static_cast<std::uint16_t>(span_end - last.address);
+                continue;
+            }
+        }
+        plan.push_back(span);
+    }
+    return plan;
+}
+
+MeterReader::MeterReader(const ModelHeader& meter, std::uint16_t max_gap) : m_meter(meter) {
+    const auto kind = meter_kind(meter.id);
+    if (not kind.has_value())
+        throw std::invalid_argument("sunspec model " + std::to_string(meter.id) + " is not a supported meter");
+    m_kind = kind.value();
+
+    if (m_kind == MeterKind::Integer) {
+        using View = sunspec_model::IntegerMeterView;
+        m_plan = plan_reads(spans<View>(meter, {View::A, View::AphA, View::AphB, View::AphC, View::A_SF, View::PhVphA,
+                                                View::PhVphB, View::PhVphC, View::V_SF, View::Hz, View::Hz_SF, View::W,
+                                                View::WphA, View::WphB, View::WphC, View::W_SF, View::VAR,
+                                                View::VARphA, View::VARphB, View::VARphC, View::VAR_SF,
+                                                View::TotWhExp, View::TotWhImp, View::TotWh_SF}),
+                            max_gap);
+    } else {
+        using View = sunspec_model::FloatMeterView;
+        m_plan = plan_reads(spans<View>(meter, {View::A, View::AphA, View::AphB, View::AphC, View::PhVphA,
+                                                View::PhVphB, View::PhVphC, View::Hz, View::W, View::WphA, View::WphB,
+                                                View::WphC, View::VAR, View::VARphA, View::VARphB, View::VARphC,
+                                                View::TotWhExp, View::TotWhImp}),
+                            max_gap);
+    }
+}
+
+std::optional<Reading> MeterReader::read(const ReadRegisters& read) const {
+    // registers outside of the plan stay 0, they are never decoded
+    transport::DataVector image(m_kind == MeterKind::Integer ? sunspec_model::IntegerMeterView::model_size_in_bytes
+                                                             : sunspec_model::FloatMeterView::model_size_in_bytes,
+                                0);
+
+    for (const auto& block : m_plan) {
+        const auto registers = read(block.address, block.count);
+        if (not registers.has_value() || registers->size() != block.count)
+            return std::nullopt;
+        copy_registers(registers.value(), image, (block.address - m_meter.address) * 2);
+    }
+
+    if (m_kind == MeterKind::Integer)
+        return decode(sunspec_model::IntegerMeterView(image));
+    return decode(sunspec_model::FloatMeterView(image));
+}
+
+} // namespace sunspec_device
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef SUNSPEC_POWERMETER_SUNSPEC_DEVICE_HPP
+#define SUNSPEC_POWERMETER_SUNSPEC_DEVICE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Discovery and polling of standard sunspec meters (models 201 - 204 and 211 - 214).
+ *
+ * Nothing in here talks to the bus directly: all register access goes through a ReadRegisters callback, which the
+ * module implements on top of the SerialCommHub and the tests implement with an emulated device. The model layouts
+ * are the ones from the PowermeterBSM sunspec library (lib/sunspec_models.hpp).
+ */
+namespace sunspec_device {
+
+using Registers = std::vector<std::uint16_t>;
+
+/**
+ * Reads \p count holding registers starting at the modbus (protocol) address \p address. Returns std::nullopt if the
+ * transfer failed or the device answered with an exception.
+ */
+using ReadRegisters = std::function<std::optional<Registers>(std::uint16_t address, std::uint16_t count)>;
+
+// "SunS" in the first two registers of the sunspec register map
+constexpr std::uint16_t SUNS_MARKER_0 = 0x5375;
+constexpr std::uint16_t SUNS_MARKER_1 = 0x6e53;
+constexpr std::uint16_t END_MODEL_ID = 0xffff;
+constexpr std::uint16_t COMMON_MODEL_ID = 1;
+
+// the base addresses the sunspec specification allows, in the order they are scanned
+const std::vector<std::uint16_t> STANDARD_BASE_ADDRESSES{40000, 0, 50000};
+
+// limit of a modbus "read holding registers" request
+constexpr std::uint16_t MAX_REGISTERS_PER_READ = 125;
+
+struct ModelHeader {
+    std::uint16_t id;
+    std::uint16_t address; // address of the ID register
+    std::uint16_t length;  // L, the number of registers following ID and L
+};
+
+struct DeviceInfo {
+    std::uint16_t base_address;
+    std::vector<ModelHeader> models; // in the order of the model chain, without the end model
+    std::string manufacturer;        // from the common model, empty if the device has none
+    std::string model;
+    std::string serial_number;
+};
+
+/**
+ * Looks for the "SunS" marker at \p base_addresses (in that order) and walks the model chain of the first device
+ * found. Needs one read per model plus one for the common model. Returns std::nullopt if there is no sunspec device
+ * or the chain could not be read completely.
+ */
+std::optional<DeviceInfo> discover(const ReadRegisters& read, const std::vector<std::uint16_t>& base_addresses);
+
+enum class MeterKind {
+    Integer, // 201 - 204, int16 / acc32 values with scale factors
+    Float,   // 211 - 214, float32 values
+};
+
+std::optional<MeterKind> meter_kind(std::uint16_t model_id);
+
+/**
+ * The meter model with id \p model_id, or the first supported meter in the chain if \p model_id is 0.
+ */
+std::optional<ModelHeader> select_meter(const DeviceInfo& device, std::uint16_t model_id);
+
+struct ReadBlock {
+    std::uint16_t address;
+    std::uint16_t count;
+};
+
+bool operator==(const ReadBlock& lhs, const ReadBlock& rhs);
+
+/**
+ * Covers \p spans with as few reads as possible: spans are sorted and merged as long as the registers in between are
+ * at most \p max_gap and a read does not exceed \p max_registers. Reading a few unused registers is a lot cheaper on
+ * a RS-485 bus than another request / response round trip.
+ */
+std::vector<ReadBlock> plan_reads(std::vector<ReadBlock> spans, std::uint16_t max_gap,
+                                  std::uint16_t max_registers = MAX_REGISTERS_PER_READ);
+
+struct PhaseValues {
+    std::optional<double> total;
+    std::optional<double> L1;
+    std::optional<double> L2;
+    std::optional<double> L3;
+};
+
+/**
+ * Scaled meter values, points the meter does not implement are std::nullopt.
+ */
+struct Reading {
+    std::optional<double> energy_Wh_import;
+    std::optional<double> energy_Wh_export;
+    PhaseValues power_W;
+    PhaseValues current_A;
+    PhaseValues voltage_V; // total is not used, the meter models only have an average phase voltage
+    PhaseValues reactive_power_VAR;
+    std::optional<double> frequency_Hz;
+};
+
+/**
+ * Polls one meter model with the read plan calculated at construction.
+ */
+class MeterReader {
+public:
+    MeterReader(const ModelHeader& meter, std::uint16_t max_gap);
+
+    const ModelHeader& meter() const {
+        return m_meter;
+    }
+
+    MeterKind kind() const {
+        return m_kind;
+    }
+
+    const std::vector<ReadBlock>& plan() const {
+        return m_plan;
+    }
+
+    /**
+     * Executes the read plan, std::nullopt if one of the reads failed.
+     */
+    std::optional<Reading> read(const ReadRegisters& read) const;
+
+private:
+    ModelHeader m_meter;
+    MeterKind m_kind;
+    std::vector<ReadBlock> m_plan;
+};
+
+} // namespace sunspec_device
+
+#endif // SUNSPEC_POWERMETER_SUNSPEC_DEVICE_HPP
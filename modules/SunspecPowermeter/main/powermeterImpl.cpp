@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "powermeterImpl.hpp"
+
+#include <chrono>
+#include <utils/date.hpp>
+
+namespace module {
+namespace main {
+
+namespace {
+
+// after this many failed polls in a row the device is discovered again, it may have been replaced
+constexpr int REDISCOVERY_AFTER_FAILED_READS = 10;
+
+constexpr auto DISCOVERY_RETRY_INTERVAL = std::chrono::seconds(10);
+
+std::optional<float> to_float(const std::optional<double>& value) {
+    if (not value.has_value()) {
+        return std::nullopt;
+    }
+    return static_cast<float>(value.value());
+}
+
+} // namespace
+
+void powermeterImpl::init() {
+}
+
+void powermeterImpl::ready() {
+    std::thread t([this] {
+        while (true) {
+            if (this->reader == nullptr && not this->discover()) {
+                std::this_thread::sleep_for(DISCOVERY_RETRY_INTERVAL);
+                continue;
+            }
+            this->read_powermeter_values();
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.update_interval_ms));
+        }
+    });
+    t.detach();
+}
+
+types::powermeter::TransactionStopResponse powermeterImpl::handle_stop_transaction(std::string& transaction_id) {
+    return {types::powermeter::TransactionRequestStatus::NOT_SUPPORTED,
+            {},
+            {},
+            "SunSpec powermeter does not support the stop_transaction command"};
+};
+
+types::powermeter::TransactionStartResponse
+powermeterImpl::handle_start_transaction(types::powermeter::TransactionReq& value) {
+    return {types::powermeter::TransactionRequestStatus::NOT_SUPPORTED,
+            "SunSpec powermeter does not support the start_transaction command"};
+}
+
+std::optional<sunspec_device::Registers> powermeterImpl::read_registers(std::uint16_t address, std::uint16_t count) {
+    const auto response =
+        mod->r_serial_comm_hub->call_modbus_read_holding_registers(config.powermeter_device_id, address, count);
+    if (response.status_code != types::serial_comm_hub_requests::StatusCodeEnum::Success ||
+        not response.value.has_value()) {
+        return std::nullopt;
+    }
+
+    sunspec_device::Registers registers;
+    registers.reserve(response.value->size());
+    for (const auto value : response.value.value()) {
+        registers.push_back(static_cast<std::uint16_t>(value));
+    }
+    return registers;
+}
+
+bool powermeterImpl::discover() {
+    std::vector<std::uint16_t> base_addresses{static_cast<std::uint16_t>(config.sunspec_base_address)};
+    for (const auto address : sunspec_device::STANDARD_BASE_ADDRESSES) {
+        if (address != config.sunspec_base_address) {
+            base_addresses.push_back(address);
+        }
+    }
+
+    const auto read = [this](std::uint16_t address, std::uint16_t count) { return read_registers(address, count); };
+    const auto device = sunspec_device::discover(read, base_addresses);
+    if (not device.has_value()) {
+        EVLOG_warning << "No SunSpec device found at device id " << config.powermeter_device_id;
+        return false;
+    }
+
+    const auto meter = sunspec_device::select_meter(device.value(), config.meter_model_id);
+    if (not meter.has_value()) {
+        EVLOG_error << "SunSpec device at base address " << device->base_address << " ("
+                    << device->models.size() << " models) has no supported meter model"
+                    << (config.meter_model_id != 0 ? " with id " + std::to_string(config.meter_model_id) : "");
+        return false;
+    }
+
+    this->reader = std::make_unique<sunspec_device::MeterReader>(meter.value(), config.max_register_gap);
+    this->failed_reads = 0;
+
+    EVLOG_info << "SunSpec meter " << device->manufacturer << " " << device->model << " (" << device->serial_number
+               << "): model " << meter->id << " at register " << meter->address << ", "
+               << this->reader->plan().size() << " read(s) per update";
+    return true;
+}
+
+void powermeterImpl::read_powermeter_values() {
+    const auto read = [this](std::uint16_t address, std::uint16_t count) { return read_registers(address, count); };
+    const auto reading = this->reader->read(read);
+
+    if (not reading.has_value()) {
+        if (not meter_is_unavailable) {
+            EVLOG_warning << "Could not read SunSpec meter values, communication with power meter lost.";
+            meter_is_unavailable = true;
+        }
+        if (++failed_reads >= REDISCOVERY_AFTER_FAILED_READS) {
+            this->reader.reset();
+        }
+        return;
+    }
+
+    failed_reads = 0;
+    if (meter_is_unavailable) {
+        EVLOG_info << "Communication with power meter restored.";
+        meter_is_unavailable = false;
+    }
+
+    if (not reading->energy_Wh_import.has_value()) {
+        // publishing 0 Wh would corrupt the energy readings of the consumers
+        EVLOG_warning << "SunSpec meter does not report imported energy, values are not published.";
+        return;
+    }
+
+    types::powermeter::Powermeter result;
+    result.timestamp = Everest::Date::to_rfc3339(date::utc_clock::now());
+    result.meter_id = std::string(this->mod->info.id);
+    result.energy_Wh_import.total = static_cast<float>(reading->energy_Wh_import.value());
+
+    if (reading->energy_Wh_export.has_value()) {
+        result.energy_Wh_export = types::units::Energy{.total = static_cast<float>(reading->energy_Wh_export.value())};
+    }
+
+    if (reading->power_W.total.has_value()) {
+        result.power_W = types::units::Power{.total = static_cast<float>(reading->power_W.total.value()),
+                                             .L1 = to_float(reading->power_W.L1),
+                                             .L2 = to_float(reading->power_W.L2),
+                                             .L3 = to_float(reading->power_W.L3)};
+    }
+
+    result.current_A = types::units::Current{.L1 = to_float(reading->current_A.L1),
+                                             .L2 = to_float(reading->current_A.L2),
+                                             .L3 = to_float(reading->current_A.L3)};
+
+    result.voltage_V = types::units::Voltage{.L1 = to_float(reading->voltage_V.L1),
+                                             .L2 = to_float(reading->voltage_V.L2),
+                                             .L3 = to_float(reading->voltage_V.L3)};
+
+    if (reading->reactive_power_VAR.total.has_value()) {
+        result.VAR =
+            types::units::ReactivePower{.total = static_cast<float>(reading->reactive_power_VAR.total.value()),
+                                        .L1 = to_float(reading->reactive_power_VAR.L1),
+                                        .L2 = to_float(reading->reactive_power_VAR.L2),
+                                        .L3 = to_float(reading->reactive_power_VAR.L3)};
+    }
+
+    if (reading->frequency_Hz.has_value()) {
+        result.frequency_Hz = types::units::Frequency{.L1 = static_cast<float>(reading->frequency_Hz.value())};
+    }
+
+    this->publish_powermeter(result);
+}
+
+} // namespace main
+} // namespace module
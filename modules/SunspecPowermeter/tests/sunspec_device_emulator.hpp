@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef SUNSPEC_POWERMETER_SUNSPEC_DEVICE_EMULATOR_HPP
+#define SUNSPEC_POWERMETER_SUNSPEC_DEVICE_EMULATOR_HPP
+
+#include <lib/sunspec_device.hpp>
+
+#include <cstring>
+#include <map>
+#include <string>
+
+/**
+ * Register map of a sunspec device as seen over modbus. Reads of unmapped registers fail like a modbus "illegal data
+ * address" exception, every read counts as one transaction.
+ */
+class SunspecDeviceEmulator {
+public:
+    explicit SunspecDeviceEmulator(std::uint16_t base_address) : m_next(base_address) {
+        append({sunspec_device::SUNS_MARKER_0, sunspec_device::SUNS_MARKER_1});
+    }
+
+    // appends a model to the chain and returns the address of its ID register
+    std::uint16_t add_model(std::uint16_t id, const sunspec_device::Registers& payload) {
+        const auto address = m_next;
+        append({id, static_cast<std::uint16_t>(payload.size())});
+        append(payload);
+        return address;
+    }
+
+    std::uint16_t add_common_model(const std::string& manufacturer, const std::string& model,
+                                   const std::string& serial_number) {
+        sunspec_device::Registers payload(65, 0);
+        set_string(payload, 0, 16, manufacturer);
+        set_string(payload, 16, 16, model);
+        set_string(payload, 48, 16, serial_number);
+        payload[64] = 1; // DA
+        return add_model(sunspec_device::COMMON_MODEL_ID, payload);
+    }
+
+    void add_end_model() {
+        append({sunspec_device::END_MODEL_ID, 0});
+    }
+
+    void set(std::uint16_t address, std::uint16_t value) {
+        m_registers[address] = value;
+    }
+
+    void set_float(std::uint16_t address, float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        set(address, static_cast<std::uint16_t>(bits >> 16));
+        set(address + 1, static_cast<std::uint16_t>(bits & 0xffff));
+    }
+
+    void set_online(bool online) {
+        m_online = online;
+    }
+
+    std::optional<sunspec_device::Registers> read(std::uint16_t address, std::uint16_t count) {
+        ++m_transactions;
+        m_registers_read += count;
+        if (not m_online || count == 0 || count > sunspec_device::MAX_REGISTERS_PER_READ)
+            return std::nullopt;
+
+        sunspec_device::Registers result;
+        for (std::uint32_t current = address; current < static_cast<std::uint32_t>(address) + count; ++current) {
+            const auto it = m_registers.find(static_cast<std::uint16_t>(current));
+            if (it == m_registers.end())
+                return std::nullopt;
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    sunspec_device::ReadRegisters reader() {
+        return [this](std::uint16_t address, std::uint16_t count) { return read(address, count); };
+    }
+
+    std::size_t transactions() const {
+        return m_transactions;
+    }
+
+    std::size_t registers_read() const {
+        return m_registers_read;
+    }
+
+    void reset_counters() {
+        m_transactions = 0;
+        m_registers_read = 0;
+    }
+
+private:
+    void append(const sunspec_device::Registers& registers) {
+        for (const auto value : registers)
+            m_registers[m_next++] = value;
+    }
+
+    static void set_string(sunspec_device::Registers& payload, std::size_t offset, std::size_t length,
+                           const std::string& value) {
+        for (std::size_t index = 0; index < value.size() && index < length * 2; ++index) {
+            auto& reg = payload[offset + index / 2];
+            if (index % 2 == 0)
+                reg = static_cast<std::uint16_t>(static_cast<std::uint8_t>(value[index]) << 8);
+            else
+                reg |= static_cast<std::uint8_t>(value[index]);
+        }
+    }
+
+    std::map<std::uint16_t, std::uint16_t> m_registers;
+    std::uint16_t m_next;
+    bool m_online{true};
+    std::size_t m_transactions{0};
+    std::size_t m_registers_read{0};
+};
+
+#endif // SUNSPEC_POWERMETER_SUNSPEC_DEVICE_EMULATOR_HPP
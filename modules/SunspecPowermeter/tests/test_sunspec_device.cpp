@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "sunspec_device_emulator.hpp"
+
+#include <sunspec_models.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+namespace {
+
+using namespace sunspec_device;
+
+// address of point I of the meter model starting at model_address
+template <typename VIEW> std::uint16_t point_address(std::uint16_t model_address, std::size_t index) {
+    return model_address + VIEW::Model[index].offset / 2;
+}
+
+std::uint16_t add_integer_meter(SunspecDeviceEmulator& device, std::uint16_t id) {
+    using View = sunspec_model::IntegerMeterView;
+    const auto model = device.add_model(id, Registers(105, 0));
+    const auto set = [&](std::size_t index, std::uint16_t value) {
+        device.set(point_address<View>(model, index), value);
+    };
+
+    set(View::A, 123);
+    set(View::AphA, 41);
+    set(View::AphB, 0x8000); // not implemented
+    set(View::AphC, 41);
+    set(View::A_SF, static_cast<std::uint16_t>(-1));
+    set(View::PhVphA, 2301);
+    set(View::PhVphB, 2302);
+    set(View::PhVphC, 2303);
+    set(View::V_SF, static_cast<std::uint16_t>(-1));
+    set(View::Hz, 5000);
+    set(View::Hz_SF, static_cast<std::uint16_t>(-2));
+    set(View::W, 2830);
+    set(View::W_SF, 0);
+    set(View::VAR, static_cast<std::uint16_t>(-5));
+    set(View::VAR_SF, 1);
+    device.set(point_address<View>(model, View::TotWhImp), 0x0001);
+    device.set(point_address<View>(model, View::TotWhImp) + 1, 0x2345);
+    set(View::TotWh_SF, 0);
+    return model;
+}
+
+std::uint16_t add_float_meter(SunspecDeviceEmulator& device, std::uint16_t id) {
+    using View = sunspec_model::FloatMeterView;
+    const auto model = device.add_model(id, Registers(124, 0));
+    const auto set = [&](std::size_t index, float value) {
+        device.set_float(point_address<View>(model, index), value);
+    };
+
+    set(View::A, 16.5f);
+    set(View::AphA, 16.5f);
+    set(View::AphB, std::numeric_limits<float>::quiet_NaN());
+    set(View::PhVphA, 229.5f);
+    set(View::Hz, 49.98f);
+    set(View::W, 3700.f);
+    set(View::TotWhImp, 1234567.f);
+    set(View::TotWhExp, 0.f);
+    return model;
+}
+
+TEST(SunspecDevice, discoversModelChain) {
+    SunspecDeviceEmulator device(40000);
+    device.add_common_model("Pionix", "Emulated Meter", "SN0815");
+    device.add_model(120, Registers(26, 0)); // nameplate, not a meter
+    const auto meter = add_integer_meter(device, 203);
+    device.add_end_model();
+
+    const auto info = discover(device.reader(), STANDARD_BASE_ADDRESSES);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->base_address, 40000);
+    ASSERT_EQ(info->models.size(), 3);
+    EXPECT_EQ(info->models[0].id, COMMON_MODEL_ID);
+    EXPECT_EQ(info->models[1].id, 120);
+    EXPECT_EQ(info->models[2].id, 203);
+    EXPECT_EQ(info->models[2].address, meter);
+    EXPECT_EQ(info->models[2].length, 105);
+    EXPECT_EQ(info->manufacturer, "Pionix");
+    EXPECT_EQ(info->model, "Emulated Meter");
+    EXPECT_EQ(info->serial_number, "SN0815");
+
+    // marker, one header per model and the end model, the common model
+    EXPECT_EQ(device.transactions(), 1 + 4 + 1);
+}
+
+TEST(SunspecDevice, scansStandardBaseAddresses) {
+    SunspecDeviceEmulator device(50000);
+    device.add_common_model("Pionix", "Emulated Meter", "SN0815");
+    device.add_end_model();
+
+    const auto info = discover(device.reader(), STANDARD_BASE_ADDRESSES);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->base_address, 50000);
+
+    SunspecDeviceEmulator no_device(40000);
+    no_device.set(40000, 0);
+    EXPECT_FALSE(discover(no_device.reader(), STANDARD_BASE_ADDRESSES).has_value());
+}
+
+TEST(SunspecDevice, brokenChain) {
+    SunspecDeviceEmulator device(40000);
+    device.add_common_model("Pionix", "Emulated Meter", "SN0815");
+    // no end model, the read of the next header fails
+    EXPECT_FALSE(discover(device.reader(), {40000}).has_value());
+}
+
+TEST(SunspecDevice, selectMeter) {
+    DeviceInfo info{40000, {{1, 40002, 66}, {213, 40070, 124}, {203, 40196, 105}, {211, 40303, 100}}, {}, {}, {}};
+
+    EXPECT_EQ(select_meter(info, 0)->id, 213);
+    EXPECT_EQ(select_meter(info, 203)->id, 203);
+    // too short for a float meter
+    EXPECT_FALSE(select_meter(info, 211).has_value());
+    EXPECT_FALSE(select_meter(info, 1).has_value());
+
+    EXPECT_EQ(meter_kind(201), MeterKind::Integer);
+    EXPECT_EQ(meter_kind(214), MeterKind::Float);
+    EXPECT_FALSE(meter_kind(210).has_value());
+}
+
+TEST(SunspecDevice, planReads) {
+    // gaps up to max_gap are read along
+    EXPECT_EQ(plan_reads({{10, 2}, {0, 4}, {6, 1}}, 2), (std::vector<ReadBlock>{{0, 7}, {10, 2}}));
+    EXPECT_EQ(plan_reads({{10, 2}, {0, 4}, {6, 1}}, 3), (std::vector<ReadBlock>{{0, 12}}));
+    // overlapping and duplicate spans
+    EXPECT_EQ(plan_reads({{0, 4}, {2, 1}, {3, 2}}, 0), (std::vector<ReadBlock>{{0, 5}}));
+    // a read never exceeds max_registers
+    EXPECT_EQ(plan_reads({{0, 2}, {2, 2}, {4, 2}}, 0, 4), (std::vector<ReadBlock>{{0, 4}, {4, 2}}));
+    EXPECT_THROW(plan_reads({{0, 10}}, 0, 4), std::invalid_argument);
+}
+
+TEST(SunspecDevice, integerMeterInOneRead) {
+    SunspecDeviceEmulator device(40000);
+    device.add_common_model("Pionix", "Emulated Meter", "SN0815");
+    const auto address = add_integer_meter(device, 203);
+    device.add_end_model();
+
+    const auto info = discover(device.reader(), STANDARD_BASE_ADDRESSES);
+    ASSERT_TRUE(info.has_value());
+    const auto meter = select_meter(info.value(), 0);
+    ASSERT_TRUE(meter.has_value());
+
+    const MeterReader reader(meter.value(), 16);
+    EXPECT_EQ(reader.kind(), MeterKind::Integer);
+    ASSERT_EQ(reader.plan().size(), 1);
+    // from A up to TotWh_SF, the apparent and reactive energy values are left out
+    EXPECT_EQ(reader.plan().front().address, address + 2);
+    EXPECT_EQ(reader.plan().front().count, 53);
+
+    device.reset_counters();
+    const auto reading = reader.read(device.reader());
+    EXPECT_EQ(device.transactions(), 1);
+    ASSERT_TRUE(reading.has_value());
+
+    EXPECT_DOUBLE_EQ(reading->energy_Wh_import.value(), 0x12345);
+    EXPECT_DOUBLE_EQ(reading->energy_Wh_export.value(), 0);
+    EXPECT_DOUBLE_EQ(reading->current_A.total.value(), 12.3);
+    EXPECT_DOUBLE_EQ(reading->current_A.L1.value(), 4.1);
+    EXPECT_FALSE(reading->current_A.L2.has_value());
+    EXPECT_DOUBLE_EQ(reading->voltage_V.L3.value(), 230.3);
+    EXPECT_DOUBLE_EQ(reading->frequency_Hz.value(), 50.0);
+    EXPECT_DOUBLE_EQ(reading->power_W.total.value(), 2830);
+    EXPECT_DOUBLE_EQ(reading->reactive_power_VAR.total.value(), -50);
+}
+
+TEST(SunspecDevice, floatMeterInOneRead) {
+    SunspecDeviceEmulator device(0);
+    device.add_common_model("Pionix", "Emulated Meter", "SN0815");
+    add_float_meter(device, 213);
+    device.add_end_model();
+
+    const auto info = discover(device.reader(), STANDARD_BASE_ADDRESSES);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->base_address, 0);
+
+    const MeterReader reader(select_meter(info.value(), 0).value(), 16);
+    EXPECT_EQ(reader.kind(), MeterKind::Float);
+    ASSERT_EQ(reader.plan().size(), 1);
+    // from A up to TotWhImp
+    EXPECT_EQ(reader.plan().front().count, 68);
+
+    device.reset_counters();
+    const auto reading = reader.read(device.reader());
+    EXPECT_EQ(device.transactions(), 1);
+    ASSERT_TRUE(reading.has_value());
+
+    EXPECT_DOUBLE_EQ(reading->energy_Wh_import.value(), 1234567.f);
+    EXPECT_DOUBLE_EQ(reading->current_A.L1.value(), 16.5f);
+    EXPECT_FALSE(reading->current_A.L2.has_value());
+    EXPECT_DOUBLE_EQ(reading->voltage_V.L1.value(), 229.5f);
+    EXPECT_DOUBLE_EQ(reading->frequency_Hz.value(), 49.98f);
+    EXPECT_DOUBLE_EQ(reading->power_W.total.value(), 3700.f);
+}
+
+TEST(SunspecDevice, smallGapSplitsRead) {
+    SunspecDeviceEmulator device(40000);
+    const auto address = add_integer_meter(device, 201);
+    device.add_end_model();
+
+    // with no gap allowed every group of consecutive points is a read on its own
+    const MeterReader reader({201, address, 105}, 0);
+    EXPECT_GT(reader.plan().size(), 1);
+    const auto reading = reader.read(device.reader());
+    ASSERT_TRUE(reading.has_value());
+    EXPECT_EQ(device.transactions(), reader.plan().size());
+    EXPECT_DOUBLE_EQ(reading->power_W.total.value(), 2830);
+}
+
+TEST(SunspecDevice, communicationError) {
+    SunspecDeviceEmulator device(40000);
+    const auto address = add_integer_meter(device, 203);
+    device.add_end_model();
+
+    const MeterReader reader({203, address, 105}, 16);
+    device.set_online(false);
+    EXPECT_FALSE(reader.read(device.reader()).has_value());
+    EXPECT_FALSE(discover(device.reader(), STANDARD_BASE_ADDRESSES).has_value());
+
+    EXPECT_THROW(MeterReader({120, address, 26}, 16), std::invalid_argument);
+}
+
+} // namespace
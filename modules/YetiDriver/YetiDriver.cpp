@@ -92,7 +92,7 @@ void YetiDriver::ready() {
         }
     });
 
-    serial.signalErrorFlags.connect([this](ErrorFlags e) { error_handling(e); });
+    serial.signalErrorFlags.connect([this](const ErrorFlags& e) { error_handling(e); });
 
     if (not serial.is_open()) {
         auto err = p_board_support->error_factory->create_error("evse_board_support/CommunicationFault", "",
@@ -124,7 +124,7 @@ void YetiDriver::clear_errors_on_unplug() {
     error_MREC1ConnectorLockFailure = false;
 }
 
-void YetiDriver::error_handling(ErrorFlags e) {
+void YetiDriver::error_handling(const ErrorFlags& e) {
 
     if (e.diode_fault and not last_error_flags.diode_fault) {
         Everest::error::Error error_object = p_board_support->error_factory->create_error(
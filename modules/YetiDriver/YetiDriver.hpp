@@ -77,7 +77,7 @@ private:
     Everest::TelemetryMap telemetry_rcd;
     std::mutex telemetry_mutex;
     Everest::Thread telemetryThreadHandle;
-    void error_handling(ErrorFlags e);
+    void error_handling(const ErrorFlags& e);
     ErrorFlags last_error_flags;
 
     std::atomic_bool error_MREC2GroundFailure{false};
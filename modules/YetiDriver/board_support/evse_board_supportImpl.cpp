@@ -111,7 +111,7 @@ void evse_board_supportImpl::init() {
         publish_ac_pp_ampacity(last_pp);
     });
 
-    mod->serial.signalKeepAliveLo.connect([this](KeepAliveLo l) {
+    mod->serial.signalKeepAliveLo.connect([this](const KeepAliveLo& l) {
         std::lock_guard<std::mutex> lock(capsMutex);
 
         caps.min_current_A_import =
@@ -49,7 +49,8 @@ private:
     virtual void ready() override;
 
     // ev@3370e4dd-95f4-47a9-aaec-ea76f34a66c9:v1
-    // insert your private definitions here
+    // reused for every power meter message (only touched from the serial read thread)
+    types::powermeter::Powermeter powermeter;
     // ev@3370e4dd-95f4-47a9-aaec-ea76f34a66c9:v1
 };
 
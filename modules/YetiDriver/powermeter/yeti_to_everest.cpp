@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "yeti_to_everest.hpp"
+
+#include <cstdio>
+
+#include <date/date.h>
+
+namespace module {
+namespace powermeter {
+
+void format_rfc3339(const std::chrono::system_clock::time_point& t, std::string& out) {
+    const auto ms = date::floor<std::chrono::milliseconds>(t);
+    const auto day = date::floor<date::days>(ms);
+    const date::year_month_day ymd{day};
+    const date::hh_mm_ss<std::chrono::milliseconds> time{ms - day};
+
+    char buffer[32];
+    const auto length = std::snprintf(
+        buffer, sizeof(buffer), "%04d-%02u-%02uT%02d:%02d:%02d.%03dZ", static_cast<int>(ymd.year()),
+        static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()), static_cast<int>(time.hours().count()),
+        static_cast<int>(time.minutes().count()), static_cast<int>(time.seconds().count()),
+        static_cast<int>(time.subseconds().count()));
+    out.assign(buffer, length);
+}
+
+void yeti_to_everest(const PowerMeter& p, const std::chrono::system_clock::time_point& now,
+                     types::powermeter::Powermeter& j) {
+    format_rfc3339(now, j.timestamp);
+    j.phase_seq_error = p.phaseSeqError;
+
+    j.energy_Wh_import.total = p.totalWattHr;
+    j.energy_Wh_import.L1 = p.wattHrL1;
+    j.energy_Wh_import.L2 = p.wattHrL2;
+    j.energy_Wh_import.L3 = p.wattHrL3;
+
+    types::units::Power pwr;
+    pwr.total = p.wattL1 + p.wattL2 + p.wattL3;
+    pwr.L1 = p.wattL1;
+    pwr.L2 = p.wattL2;
+    pwr.L3 = p.wattL3;
+    j.power_W = pwr;
+
+    types::units::Voltage volt;
+    volt.L1 = p.vrmsL1;
+    volt.L2 = p.vrmsL2;
+    volt.L3 = p.vrmsL3;
+    j.voltage_V = volt;
+
+    types::units::Current amp;
+    amp.L1 = p.irmsL1;
+    amp.L2 = p.irmsL2;
+    amp.L3 = p.irmsL3;
+    amp.N = p.irmsN;
+    j.current_A = amp;
+
+    types::units::Frequency freq;
+    freq.L1 = p.freqL1;
+    freq.L2 = p.freqL2;
+    freq.L3 = p.freqL3;
+    j.frequency_Hz = freq;
+}
+
+} // namespace powermeter
+} // namespace module
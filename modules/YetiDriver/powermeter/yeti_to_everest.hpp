@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef POWERMETER_YETI_TO_EVEREST_HPP
+#define POWERMETER_YETI_TO_EVEREST_HPP
+
+#include <chrono>
+#include <string>
+
+#include <generated/types/powermeter.hpp>
+
+#include "yeti.pb.h"
+
+namespace module {
+namespace powermeter {
+
+/// @brief Writes \p t as RFC 3339 UTC timestamp with milliseconds (same format as Everest::Date::to_rfc3339) into
+/// \p out. Does not allocate once \p out has held a timestamp before.
+void format_rfc3339(const std::chrono::system_clock::time_point& t, std::string& out);
+
+/// @brief Converts a power meter message of the MCU into \p out. All members are overwritten in place, so a
+/// Powermeter object that is reused for every message does not allocate after the first conversion.
+void yeti_to_everest(const PowerMeter& p, const std::chrono::system_clock::time_point& now,
+                     types::powermeter::Powermeter& out);
+
+} // namespace powermeter
+} // namespace module
+
+#endif // POWERMETER_YETI_TO_EVEREST_HPP
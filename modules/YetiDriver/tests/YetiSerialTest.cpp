@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <everest/3rd_party/nanopb/pb_encode.h>
+
+#include "evSerial.h"
+#include "powermeter/yeti_to_everest.hpp"
+
+namespace {
+std::atomic<std::size_t> heap_allocations{0};
+} // namespace
+
+// count every heap allocation of the test binary
+void* operator new(std::size_t size) {
+    heap_allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+PowerMeter power_meter_message() {
+    PowerMeter p = PowerMeter_init_zero;
+    p.vrmsL1 = 230.1;
+    p.vrmsL2 = 230.2;
+    p.vrmsL3 = 230.3;
+    p.irmsL1 = 16.0;
+    p.irmsL2 = 15.9;
+    p.irmsL3 = 16.1;
+    p.totalWattHr = 12345.6;
+    p.wattL1 = 3680;
+    p.wattL2 = 3660;
+    p.wattL3 = 3700;
+    p.freqL1 = 50.0;
+    return p;
+}
+
+// protobuf + crc32, cobs encoded, as the MCU sends it
+std::vector<uint8_t> encode_frame(evSerial& serial, const McuToEverest& message) {
+    uint8_t packet[McuToEverest_size + 4];
+    pb_ostream_t ostream = pb_ostream_from_buffer(packet, sizeof(packet) - 4);
+    EXPECT_TRUE(pb_encode(&ostream, McuToEverest_fields, &message));
+
+    size_t length = ostream.bytes_written;
+    uint32_t crc = serial.crc32(packet, length);
+    for (int byte_pos = 0; byte_pos < 4; ++byte_pos) {
+        packet[length++] = crc & 0xFF;
+        crc = crc >> 8;
+    }
+
+    std::vector<uint8_t> frame(length + length / 254 + 2);
+    frame.resize(serial.cobsEncode(packet, length, frame.data()));
+    return frame;
+}
+
+} // namespace
+
+TEST(YetiSerialTest, powerMeterPacketWithoutAllocation) {
+    evSerial serial;
+    McuToEverest message = McuToEverest_init_zero;
+    message.which_payload = McuToEverest_power_meter_tag;
+    message.payload.power_meter = power_meter_message();
+    auto frame = encode_frame(serial, message);
+
+    types::powermeter::Powermeter powermeter;
+    powermeter.meter_id = "YETI_POWERMETER";
+    int received = 0;
+    serial.signalPowerMeter.connect([&](const PowerMeter& p) {
+        // the slot gets a reference into the receive slot, nothing is copied on the way
+        EXPECT_EQ(&p, &serial.msg_in.payload.power_meter);
+        module::powermeter::yeti_to_everest(p, std::chrono::system_clock::now(), powermeter);
+        received++;
+    });
+
+    // the first message sizes the timestamp string
+    serial.cobsDecode(frame.data(), frame.size());
+    ASSERT_EQ(received, 1);
+
+    const auto allocations_before = heap_allocations.load();
+    for (int i = 0; i < 100; i++) {
+        serial.cobsDecode(frame.data(), frame.size());
+    }
+    EXPECT_EQ(heap_allocations.load() - allocations_before, 0);
+    EXPECT_EQ(received, 101);
+
+    EXPECT_FLOAT_EQ(powermeter.energy_Wh_import.total, 12345.6);
+    ASSERT_TRUE(powermeter.power_W.has_value());
+    EXPECT_FLOAT_EQ(powermeter.power_W->total, 3680 + 3660 + 3700);
+    ASSERT_TRUE(powermeter.voltage_V.has_value());
+    EXPECT_FLOAT_EQ(powermeter.voltage_V->L2.value(), 230.2);
+    EXPECT_EQ(powermeter.meter_id, "YETI_POWERMETER");
+    EXPECT_EQ(powermeter.timestamp.size(), std::string("2024-01-01T00:00:00.000Z").size());
+}
+
+TEST(YetiSerialTest, crcMismatch) {
+    evSerial serial;
+    McuToEverest message = McuToEverest_init_zero;
+    message.which_payload = McuToEverest_power_meter_tag;
+    message.payload.power_meter = power_meter_message();
+    auto frame = encode_frame(serial, message);
+    frame[2] ^= 0x01;
+
+    int received = 0;
+    serial.signalPowerMeter.connect([&](const PowerMeter&) { received++; });
+    serial.cobsDecode(frame.data(), frame.size());
+    EXPECT_EQ(received, 0);
+}
+
+TEST(YetiToEverest, formatRfc3339) {
+    using namespace std::chrono;
+    std::string timestamp;
+    module::powermeter::format_rfc3339(system_clock::time_point{seconds{1700000000} + milliseconds{42}}, timestamp);
+    EXPECT_EQ(timestamp, "2023-11-14T22:13:20.042Z");
+}
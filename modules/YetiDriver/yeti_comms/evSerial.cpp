@@ -27,6 +27,7 @@ evSerial::evSerial() {
     baud = 0;
     reset_done_flag = false;
     forced_reset = false;
+    msg_in = McuToEverest_init_zero;
     cobsDecodeReset();
 }
 
@@ -142,7 +143,6 @@ void evSerial::handlePacket(uint8_t* buf, int len) {
 
     len -= 4;
 
-    McuToEverest msg_in;
     pb_istream_t istream = pb_istream_from_buffer(buf, len);
 
     if (pb_decode(&istream, McuToEverest_fields, &msg_in))
@@ -11,6 +11,10 @@
 #include <termios.h>
 #include <utils/thread.hpp>
 
+#ifdef BUILD_TESTING_MODULE_YETI_DRIVER
+#include <gtest/gtest_prod.h>
+#endif
+
 class evSerial {
 
 public:
@@ -34,11 +38,12 @@ public:
     void forceUnlock();
     void set_number_of_phases(bool p);
 
-    sigslot::signal<KeepAliveLo> signalKeepAliveLo;
-    sigslot::signal<PowerMeter> signalPowerMeter;
+    // The message signals hand out references into the receive slot, they are only valid during the slot call.
+    sigslot::signal<const KeepAliveLo&> signalKeepAliveLo;
+    sigslot::signal<const PowerMeter&> signalPowerMeter;
     sigslot::signal<CpState> signalCPState;
     sigslot::signal<PpState> signalPPState;
-    sigslot::signal<ErrorFlags> signalErrorFlags;
+    sigslot::signal<const ErrorFlags&> signalErrorFlags;
     sigslot::signal<bool> signalRelaisState;
     sigslot::signal<bool> signalLockState;
 
@@ -58,6 +63,8 @@ private:
     void cobsDecodeByte(uint8_t byte);
     size_t cobsEncode(const void* data, size_t length, uint8_t* buffer);
     uint8_t msg[2048];
+    // receive slot, every packet is decoded into this message (only used by the read thread)
+    McuToEverest msg_in;
     uint8_t code;
     uint8_t block;
     uint8_t* decode;
@@ -74,6 +81,11 @@ private:
     bool serial_timed_out();
     void timeoutDetectionThread();
     std::chrono::time_point<date::utc_clock> last_keep_alive_lo_timestamp;
+
+#ifdef BUILD_TESTING_MODULE_YETI_DRIVER
+    FRIEND_TEST(YetiSerialTest, powerMeterPacketWithoutAllocation);
+    FRIEND_TEST(YetiSerialTest, crcMismatch);
+#endif
 };
 
 #endif
@@ -15,7 +15,7 @@ std::atomic_bool sw_version_received = false;
 YetiFirmwareVersion installed_fw_version;
 std::string installed_fw_version_orig;
 
-void recvKeepAliveLo(KeepAliveLo s) {
+void recvKeepAliveLo(const KeepAliveLo& s) {
     installed_fw_version = s.sw_version_string;
     installed_fw_version_orig = s.sw_version_string;
     sw_version_received = true;
@@ -8,6 +8,12 @@ import pytest
 def pytest_addoption(parser):
     parser.addoption("--everest-prefix", action="store", default="../build/dist",
                      help="everest prefix path; default = '../build/dist'")
+    parser.addoption("--soak-sessions", action="store", type=int, default=2000,
+                     help="charging sessions of the soak tests; default = 2000")
+    parser.addoption("--soak-max-heap-growth", action="store", type=float, default=256.0,
+                     help="live heap in bytes a module may grow per session in the soak tests; default = 256")
+    parser.addoption("--soak-max-rss-growth", action="store", type=float, default=4096.0,
+                     help="rss in bytes a module may grow per session in the soak tests; default = 4096")
 
 
 def pytest_configure(config):
@@ -3,6 +3,7 @@
 # SPDX-License-Identifier: Apache-2.0
 # Copyright 2020 - 2022 Pionix GmbH and Contributors to EVerest
 
+import json
 import logging
 import pytest
 import time
@@ -106,3 +107,49 @@ async def test_001_start_test_module(everest_core: EverestCore):
         logging.info("set all modules started event...")
 
     assert probe.test(20)
+
+
+# modules of config-sil-ocpp201-pnc.yaml that report their startup
+STARTUP_REPORT_MODULES = ['evse_manager_1', 'evse_manager_2', 'evse_security', 'ocpp']
+
+
+def wait_for_startup_reports(report_dir, module_ids, timeout: float) -> dict:
+    reports = {}
+    end_of_time = time.time() + timeout
+    while len(reports) < len(module_ids) and time.time() < end_of_time:
+        for module_id in module_ids:
+            path = report_dir / f'{module_id}.json'
+            if module_id in reports or not path.exists():
+                continue
+            report = json.loads(path.read_text())
+            if report['ready']:
+                reports[module_id] = report
+        time.sleep(0.1)
+    return reports
+
+
+@pytest.mark.everest_core_config('config-sil-ocpp201-pnc.yaml')
+@pytest.mark.asyncio
+async def test_002_startup_report(everest_core: EverestCore, tmp_path, monkeypatch):
+    logging.info(">>>>>>>>> test_002_startup_report <<<<<<<<<")
+
+    # inherited by the manager and the modules it spawns
+    monkeypatch.setenv('EVEREST_STARTUP_REPORT_DIR', str(tmp_path))
+    everest_core.start()
+
+    reports = wait_for_startup_reports(tmp_path, STARTUP_REPORT_MODULES, 60)
+    assert set(reports) == set(STARTUP_REPORT_MODULES)
+
+    # all times relative to the module that was created first
+    t0 = min(report['created_ms'] for report in reports.values())
+    logging.info("Startup report (start and end relative to the first module, in ms):")
+    for module_id, report in sorted(reports.items()):
+        for entry in report['entries']:
+            start = entry['start_ms'] - t0
+            logging.info("%-16s %-20s %-10s %8d %8d%s", module_id, entry['name'], entry['kind'], start,
+                         start + entry['duration_ms'], ' FAILED' if entry['failed'] else '')
+
+    for module_id in ['evse_manager_1', 'evse_manager_2']:
+        names = [entry['name'] for entry in reports[module_id]['entries']]
+        assert 'ready_to_charge' in names
+    assert not any(entry['failed'] for report in reports.values() for entry in report['entries'])
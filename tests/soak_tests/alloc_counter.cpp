@@ -0,0 +1,487 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+/*
+ * Allocation counter of the soak tests, loaded into the manager and every module process with LD_PRELOAD.
+ *
+ * malloc, the C++ operators new and delete and their variants are forwarded to the glibc allocator. Every allocation
+ * is counted per call site, which is the return address of the allocating call. The live heap is tracked with the
+ * usable size of the blocks, so it matches what the allocator actually holds.
+ *
+ * If EVEREST_ALLOC_COUNTER_DIR is set, a thread writes the counters of the process every
+ * EVEREST_ALLOC_COUNTER_INTERVAL_MS (default 1000) to EVEREST_ALLOC_COUNTER_DIR/<name>-<pid>.json, where name is the
+ * module id for module processes. Allocations of that thread are not counted.
+ *
+ * Processes that fork without exec keep the counters of their parent, but do not write them.
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <dlfcn.h>
+#include <malloc.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+// power of two
+constexpr std::size_t MAX_SITES = 8192;
+constexpr std::size_t MAX_PROBES = 64;
+
+struct Site {
+    std::atomic<std::uintptr_t> address{0};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> bytes{0};
+};
+
+Site sites[MAX_SITES];
+// allocations of call sites that did not fit into the table
+Site other_sites;
+
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> frees{0};
+std::atomic<std::uint64_t> allocated_bytes{0};
+std::atomic<std::int64_t> live_bytes{0};
+std::atomic<std::int64_t> live_blocks{0};
+
+// set on the thread writing the counters, initial-exec so reading it never allocates
+__thread bool not_counted __attribute__((tls_model("initial-exec"))) = false;
+
+Site& site_of(std::uintptr_t address) {
+    // Fibonacci hashing, return addresses are not evenly distributed in the low bits
+    const auto index = static_cast<std::size_t>((address * 11400714819323198485ull) >> 40);
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe) {
+        auto& site = sites[(index + probe) & (MAX_SITES - 1)];
+        auto current = site.address.load(std::memory_order_relaxed);
+        if (current == 0) {
+            if (site.address.compare_exchange_strong(current, address, std::memory_order_relaxed) or
+                current == address) {
+                return site;
+            }
+        } else if (current == address) {
+            return site;
+        }
+    }
+    return other_sites;
+}
+
+void count_allocation(void* ptr, void* caller) {
+    if (ptr == nullptr or not_counted) {
+        return;
+    }
+    const auto size = malloc_usable_size(ptr);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    live_bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    live_blocks.fetch_add(1, std::memory_order_relaxed);
+
+    auto& site = site_of(reinterpret_cast<std::uintptr_t>(caller));
+    site.count.fetch_add(1, std::memory_order_relaxed);
+    site.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void count_free(void* ptr) {
+    if (ptr == nullptr or not_counted) {
+        return;
+    }
+    frees.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    live_blocks.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void* aligned_allocation(std::size_t alignment, std::size_t size, void* caller) {
+    auto* ptr = __libc_memalign(alignment, size);
+    count_allocation(ptr, caller);
+    return ptr;
+}
+
+void* new_allocation(std::size_t size, std::size_t alignment, void* caller) {
+    while (true) {
+        auto* ptr = alignment == 0 ? __libc_malloc(size) : __libc_memalign(alignment, size);
+        if (ptr != nullptr) {
+            count_allocation(ptr, caller);
+            return ptr;
+        }
+        const auto handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* new_allocation_nothrow(std::size_t size, std::size_t alignment, void* caller) noexcept {
+    try {
+        return new_allocation(size, alignment, caller);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void delete_allocation(void* ptr) noexcept {
+    count_free(ptr);
+    __libc_free(ptr);
+}
+
+// writing the counters
+
+std::string json_escape(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const auto c : value) {
+        if (c == '"' or c == '\\') {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped.push_back(' ');
+        } else {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+// module id for module processes, the name of the executable otherwise
+std::string process_name() {
+    std::ifstream cmdline_file("/proc/self/cmdline");
+    const std::string cmdline{std::istreambuf_iterator<char>(cmdline_file), std::istreambuf_iterator<char>()};
+    std::vector<std::string> arguments;
+    for (std::size_t start = 0; start < cmdline.size();) {
+        const auto end = cmdline.find('\0', start);
+        arguments.push_back(cmdline.substr(start, end - start));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    for (std::size_t i = 0; i + 1 < arguments.size(); ++i) {
+        if (arguments[i] == "--module" or arguments[i] == "-m") {
+            return arguments[i + 1];
+        }
+    }
+    if (arguments.empty()) {
+        return "unknown";
+    }
+    const auto slash = arguments[0].find_last_of('/');
+    return slash == std::string::npos ? arguments[0] : arguments[0].substr(slash + 1);
+}
+
+struct Symbol {
+    std::string object;
+    std::string name;
+    std::uintptr_t offset; // relative to the load address of object, for addr2line
+};
+
+Symbol symbolize(std::uintptr_t address) {
+    Symbol symbol{"", "", address};
+    Dl_info info{};
+    // the return address points after the call, look up the call itself
+    if (dladdr(reinterpret_cast<void*>(address - 1), &info) == 0) {
+        return symbol;
+    }
+    if (info.dli_fname != nullptr) {
+        symbol.object = info.dli_fname;
+    }
+    symbol.offset = address - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+    if (info.dli_sname != nullptr) {
+        int status = 0;
+        auto* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        symbol.name = status == 0 ? demangled : info.dli_sname;
+        std::free(demangled);
+        symbol.name += "+" + std::to_string(address - reinterpret_cast<std::uintptr_t>(info.dli_saddr));
+    }
+    return symbol;
+}
+
+std::int64_t now_ms() {
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+std::int64_t rss_bytes() {
+    long pages = 0;
+    if (auto* statm = std::fopen("/proc/self/statm", "r")) {
+        long size = 0;
+        if (std::fscanf(statm, "%ld %ld", &size, &pages) != 2) {
+            pages = 0;
+        }
+        std::fclose(statm);
+    }
+    return static_cast<std::int64_t>(pages) * sysconf(_SC_PAGESIZE);
+}
+
+void write_counters(const std::string& path, const std::string& name, std::uint64_t sequence,
+                    std::unordered_map<std::uintptr_t, Symbol>& symbols) {
+    const auto tmp_path = path + ".tmp";
+    auto* file = std::fopen(tmp_path.c_str(), "w");
+    if (file == nullptr) {
+        return;
+    }
+
+#if __GLIBC_PREREQ(2, 33)
+    const auto heap = mallinfo2();
+#else
+    const auto heap = mallinfo();
+#endif
+
+    std::fprintf(file, "{\"name\":\"%s\",\"pid\":%d,\"sequence\":%llu,\"time_ms\":%lld,\"rss_bytes\":%lld,\n",
+                 json_escape(name).c_str(), static_cast<int>(getpid()), static_cast<unsigned long long>(sequence),
+                 static_cast<long long>(now_ms()), static_cast<long long>(rss_bytes()));
+    std::fprintf(file,
+                 "\"allocations\":%llu,\"frees\":%llu,\"allocated_bytes\":%llu,\"live_bytes\":%lld,"
+                 "\"live_blocks\":%lld,\n",
+                 static_cast<unsigned long long>(allocations.load(std::memory_order_relaxed)),
+                 static_cast<unsigned long long>(frees.load(std::memory_order_relaxed)),
+                 static_cast<unsigned long long>(allocated_bytes.load(std::memory_order_relaxed)),
+                 static_cast<long long>(live_bytes.load(std::memory_order_relaxed)),
+                 static_cast<long long>(live_blocks.load(std::memory_order_relaxed)));
+    std::fprintf(file, "\"malloc\":{\"arena\":%llu,\"mmap\":%llu,\"in_use\":%llu,\"free\":%llu,\"releasable\":%llu},\n",
+                 static_cast<unsigned long long>(heap.arena), static_cast<unsigned long long>(heap.hblkhd),
+                 static_cast<unsigned long long>(heap.uordblks), static_cast<unsigned long long>(heap.fordblks),
+                 static_cast<unsigned long long>(heap.keepcost));
+
+    std::fprintf(file, "\"sites\":[\n");
+    bool first = true;
+    const auto write_site = [&](const Site& site, const Symbol& symbol) {
+        std::fprintf(file, "%s{\"object\":\"%s\",\"offset\":%llu,\"symbol\":\"%s\",\"count\":%llu,\"bytes\":%llu}",
+                     first ? "" : ",\n", json_escape(symbol.object).c_str(),
+                     static_cast<unsigned long long>(symbol.offset), json_escape(symbol.name).c_str(),
+                     static_cast<unsigned long long>(site.count.load(std::memory_order_relaxed)),
+                     static_cast<unsigned long long>(site.bytes.load(std::memory_order_relaxed)));
+        first = false;
+    };
+    for (const auto& site : sites) {
+        const auto address = site.address.load(std::memory_order_relaxed);
+        if (address == 0 or site.count.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        auto symbol = symbols.find(address);
+        if (symbol == symbols.end()) {
+            symbol = symbols.emplace(address, symbolize(address)).first;
+        }
+        write_site(site, symbol->second);
+    }
+    if (other_sites.count.load(std::memory_order_relaxed) > 0) {
+        write_site(other_sites, Symbol{"", "<other call sites>", 0});
+    }
+    std::fprintf(file, "\n]}\n");
+
+    if (std::fclose(file) == 0) {
+        std::rename(tmp_path.c_str(), path.c_str());
+    }
+}
+
+void writer(std::string dir, std::chrono::milliseconds interval) {
+    not_counted = true;
+
+    const auto name = process_name();
+    const auto path = dir + "/" + name + "-" + std::to_string(getpid()) + ".json";
+    // symbolizing a call site is slow, each is looked up once
+    std::unordered_map<std::uintptr_t, Symbol> symbols;
+    std::uint64_t sequence = 0;
+    while (true) {
+        write_counters(path, name, sequence++, symbols);
+        std::this_thread::sleep_for(interval);
+    }
+}
+
+__attribute__((constructor)) void start_writer() {
+    const auto* dir = std::getenv("EVEREST_ALLOC_COUNTER_DIR");
+    if (dir == nullptr or *dir == '\0') {
+        return;
+    }
+    auto interval = std::chrono::milliseconds(1000);
+    if (const auto* interval_ms = std::getenv("EVEREST_ALLOC_COUNTER_INTERVAL_MS")) {
+        const auto value = std::atol(interval_ms);
+        if (value > 0) {
+            interval = std::chrono::milliseconds(value);
+        }
+    }
+    std::thread(writer, std::string(dir), interval).detach();
+}
+
+} // namespace
+
+// C allocator
+
+extern "C" {
+
+void* malloc(size_t size) {
+    auto* ptr = __libc_malloc(size);
+    count_allocation(ptr, __builtin_return_address(0));
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+    auto* ptr = __libc_calloc(count, size);
+    count_allocation(ptr, __builtin_return_address(0));
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        auto* new_ptr = __libc_malloc(size);
+        count_allocation(new_ptr, __builtin_return_address(0));
+        return new_ptr;
+    }
+    const auto old_size = malloc_usable_size(ptr);
+    auto* new_ptr = __libc_realloc(ptr, size);
+    if (new_ptr == nullptr and size != 0) {
+        // the old block is untouched
+        return nullptr;
+    }
+    if (not not_counted) {
+        // a resize counts as free of the old and allocation of the new block
+        frees.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(static_cast<std::int64_t>(old_size), std::memory_order_relaxed);
+        live_blocks.fetch_sub(1, std::memory_order_relaxed);
+    }
+    count_allocation(new_ptr, __builtin_return_address(0));
+    return new_ptr;
+}
+
+void free(void* ptr) {
+    count_free(ptr);
+    __libc_free(ptr);
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 or (alignment & (alignment - 1)) != 0 or alignment == 0) {
+        return EINVAL;
+    }
+    auto* ptr = aligned_allocation(alignment, size, __builtin_return_address(0));
+    if (ptr == nullptr) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return aligned_allocation(alignment, size, __builtin_return_address(0));
+}
+
+void* memalign(size_t alignment, size_t size) {
+    return aligned_allocation(alignment, size, __builtin_return_address(0));
+}
+
+void* valloc(size_t size) {
+    auto* ptr = __libc_valloc(size);
+    count_allocation(ptr, __builtin_return_address(0));
+    return ptr;
+}
+
+void* pvalloc(size_t size) {
+    auto* ptr = __libc_pvalloc(size);
+    count_allocation(ptr, __builtin_return_address(0));
+    return ptr;
+}
+}
+
+// C++ allocator, replaced as well so the call site is the caller of new and not operator new in libstdc++
+
+void* operator new(std::size_t size) {
+    return new_allocation(size, 0, __builtin_return_address(0));
+}
+
+void* operator new[](std::size_t size) {
+    return new_allocation(size, 0, __builtin_return_address(0));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return new_allocation_nothrow(size, 0, __builtin_return_address(0));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return new_allocation_nothrow(size, 0, __builtin_return_address(0));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return new_allocation(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return new_allocation(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return new_allocation_nothrow(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return new_allocation_nothrow(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+void operator delete(void* ptr) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    delete_allocation(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    delete_allocation(ptr);
+}
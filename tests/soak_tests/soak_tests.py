@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright Pionix GmbH and Contributors to EVerest
+
+"""Soak test: runs thousands of simulated charging sessions and checks that the module processes do not grow.
+
+Every process of the run is started with the allocation counter (libeverest_alloc_counter.so) preloaded, which writes
+the RSS, the live heap and the allocations per call site of each module to a directory. The growth per session is
+fitted over samples taken during the run, a module fails if it grows more than --soak-max-heap-growth or
+--soak-max-rss-growth per session. The call sites that allocated the most per session are logged for every module.
+"""
+
+import json
+import logging
+import queue
+import threading
+import time
+from pathlib import Path
+
+import pytest
+import yaml
+
+from everest.testing.core_utils.fixtures import *
+from everest.testing.core_utils.everest_core import EverestCore, Requirement
+
+from everest.framework import Module, RuntimeSession
+
+
+# alternating IEC 61851 and ISO 15118 sessions, so EvseManager and EvseV2G both run their session paths
+SESSIONS = [
+    'sleep 1;iec_wait_pwr_ready;sleep 1;draw_power_regulated 16,3;sleep 2;unplug',
+    'sleep 1;iso_wait_slac_matched;iso_start_v2g_session AC;iso_wait_pwr_ready;iso_draw_power_regulated 16,3;'
+    'sleep 2;iso_stop_charging;iso_wait_v2g_session_stopped;unplug',
+]
+
+# sessions before the baseline sample, caches and pools of the modules are filled by then
+WARMUP_SESSIONS = 20
+# samples taken over the soak run, the growth is fitted over all of them
+SAMPLES = 20
+SESSION_TIMEOUT = 60
+# hotspots logged per module
+HOTSPOTS = 10
+
+
+class SessionRunner:
+    """Runs charging sessions with the car simulator and waits until the EVSE is available again."""
+
+    def __init__(self, session: RuntimeSession):
+        m = Module('probe', session)
+        self._setup = m.say_hello()
+
+        evse_manager_ff = self._setup.connections['connector_1'][0]
+        m.subscribe_variable(evse_manager_ff, 'session_event', self._handle_session_event)
+
+        self._events = queue.Queue()
+        self._ready_event = threading.Event()
+        self._mod = m
+        m.init_done(self._ready)
+
+    def _ready(self):
+        self._ready_event.set()
+
+    def _handle_session_event(self, args):
+        self._events.put(args['event'])
+
+    def wait_for_ready(self, timeout: float) -> bool:
+        if not self._ready_event.wait(timeout):
+            return False
+        self._mod.call_command(self._setup.connections['test_control'][0], 'enable', {'value': True})
+        return True
+
+    def run_session(self, commands: str, timeout: float) -> bool:
+        self._mod.call_command(self._setup.connections['test_control'][0], 'execute_charging_session',
+                               {'value': commands})
+        end_of_time = time.time() + timeout
+        while True:
+            time_left = end_of_time - time.time()
+            if time_left <= 0:
+                return False
+            try:
+                if self._events.get(timeout=time_left) == 'SessionFinished':
+                    return True
+            except queue.Empty:
+                return False
+
+
+def find_alloc_counter(prefix: Path):
+    for path in sorted(prefix.glob('lib*/libeverest_alloc_counter.so')):
+        return path
+    return None
+
+
+def read_counters(counter_dir: Path, module_ids, not_before_ms: int, timeout: float) -> dict:
+    """Latest counters of every module, written after not_before_ms."""
+    counters = {}
+    end_of_time = time.time() + timeout
+    while True:
+        for path in counter_dir.glob('*.json'):
+            try:
+                counter = json.loads(path.read_text())
+            except (OSError, ValueError):
+                continue
+            name = counter['name']
+            if name in module_ids and counter['time_ms'] >= not_before_ms and (
+                    name not in counters or counter['time_ms'] > counters[name]['time_ms']):
+                counters[name] = counter
+        if set(counters) == module_ids or time.time() > end_of_time:
+            return counters
+        time.sleep(0.2)
+
+
+def growth_per_session(samples) -> float:
+    """Least squares slope of (session, value) samples."""
+    mean_x = sum(x for x, _ in samples) / len(samples)
+    mean_y = sum(y for _, y in samples) / len(samples)
+    variance = sum((x - mean_x) ** 2 for x, _ in samples)
+    if variance == 0:
+        return 0.0
+    return sum((x - mean_x) * (y - mean_y) for x, y in samples) / variance
+
+
+def hotspots(baseline: dict, final: dict, sessions: int):
+    """Call sites with the most allocations per session between two samples of a module."""
+    def key(site):
+        return (site['object'], site['offset'])
+
+    baseline_sites = {key(site): site for site in baseline['sites']}
+    result = []
+    for site in final['sites']:
+        before = baseline_sites.get(key(site), {'count': 0, 'bytes': 0})
+        count = site['count'] - before['count']
+        if count > 0:
+            result.append((count / sessions, (site['bytes'] - before['bytes']) / sessions, site))
+    result.sort(key=lambda hotspot: hotspot[0], reverse=True)
+    return result[:HOTSPOTS]
+
+
+@pytest.mark.everest_core_config('config-sil.yaml')
+@pytest.mark.asyncio
+async def test_001_soak_charging_sessions(everest_core: EverestCore, request, tmp_path, monkeypatch):
+    logging.info(">>>>>>>>> test_001_soak_charging_sessions <<<<<<<<<")
+
+    sessions = request.config.getoption('--soak-sessions')
+    max_heap_growth = request.config.getoption('--soak-max-heap-growth')
+    max_rss_growth = request.config.getoption('--soak-max-rss-growth')
+
+    alloc_counter = find_alloc_counter(Path(everest_core.prefix_path))
+    if alloc_counter is None:
+        pytest.skip('libeverest_alloc_counter.so not installed, build with EVEREST_CORE_BUILD_TESTING')
+
+    counter_dir = tmp_path / 'alloc_counter'
+    counter_dir.mkdir()
+    # inherited by the manager and the modules it spawns
+    monkeypatch.setenv('LD_PRELOAD', str(alloc_counter))
+    monkeypatch.setenv('EVEREST_ALLOC_COUNTER_DIR', str(counter_dir))
+
+    test_connections = {
+        'test_control': [Requirement('ev_manager', 'main')],
+        'connector_1': [Requirement('connector_1', 'evse')]
+    }
+    everest_core.start(standalone_module='probe', test_connections=test_connections)
+
+    runner = SessionRunner(RuntimeSession(str(everest_core.prefix_path), str(everest_core.everest_config_path)))
+    if everest_core.status_listener.wait_for_status(10, ["ALL_MODULES_STARTED"]):
+        everest_core.all_modules_started_event.set()
+    assert runner.wait_for_ready(30)
+
+    module_ids = set(yaml.safe_load(Path(everest_core.everest_config_path).read_text())['active_modules'])
+
+    def run_sessions(first: int, count: int):
+        for session in range(first, first + count):
+            assert runner.run_session(SESSIONS[session % len(SESSIONS)], SESSION_TIMEOUT), \
+                f'session {session} did not finish'
+
+    def sample():
+        # only modules written by the allocation counter under their module id are sampled, e.g. no JS modules
+        return read_counters(counter_dir, module_ids, int(time.time() * 1000), 10)
+
+    run_sessions(0, WARMUP_SESSIONS)
+    baseline = sample()
+    assert baseline, 'no module wrote allocation counters'
+    logging.info("Sampling modules %s", ', '.join(sorted(baseline)))
+
+    samples = {module_id: [(0, counter)] for module_id, counter in baseline.items()}
+    sessions_per_sample = max(1, sessions // SAMPLES)
+    done = 0
+    while done < sessions:
+        count = min(sessions_per_sample, sessions - done)
+        run_sessions(WARMUP_SESSIONS + done, count)
+        done += count
+        for module_id, counter in sample().items():
+            if module_id in samples and counter['pid'] == samples[module_id][0][1]['pid']:
+                samples[module_id].append((done, counter))
+        logging.info("%d of %d sessions done", done, sessions)
+
+    failures = []
+    for module_id, module_samples in sorted(samples.items()):
+        assert len(module_samples) > 1, f'{module_id} restarted or stopped writing allocation counters'
+        heap_growth = growth_per_session([(x, counter['live_bytes']) for x, counter in module_samples])
+        rss_growth = growth_per_session([(x, counter['rss_bytes']) for x, counter in module_samples])
+        first, last = module_samples[0][1], module_samples[-1][1]
+        logging.info("%-24s heap %10d -> %10d B (%8.1f B/session), rss %10d -> %10d B (%8.1f B/session)", module_id,
+                     first['live_bytes'], last['live_bytes'], heap_growth, first['rss_bytes'], last['rss_bytes'],
+                     rss_growth)
+        for allocations, allocated_bytes, site in hotspots(first, last, module_samples[-1][0]):
+            logging.info("    %8.1f allocations %10.1f B per session at %s (%s+0x%x)", allocations, allocated_bytes,
+                         site['symbol'] or '?', site['object'], site['offset'])
+
+        if heap_growth > max_heap_growth:
+            failures.append(f'{module_id}: heap grows {heap_growth:.1f} B per session')
+        if rss_growth > max_rss_growth:
+            failures.append(f'{module_id}: rss grows {rss_growth:.1f} B per session')
+
+    (tmp_path / 'soak_report.json').write_text(json.dumps(
+        {module_id: [{'session': x, **{k: v for k, v in counter.items() if k != 'sites'}} for x, counter in s]
+         for module_id, s in samples.items()}, indent=2))
+    logging.info("Samples written to %s", tmp_path / 'soak_report.json')
+
+    assert not failures, '\n'.join(failures)